@@ -0,0 +1,437 @@
+//	----==== BENCHMARK.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Micro-benchmarks for the math and utility code. To compare the SIMD
+//					code paths against the scalar ones, build once normally and once with
+//					NO_SIMD defined and compare the two output files.
+//	-------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <math.h>
+#include "Benchmark.h"
+#include "MathCode/Matrix4x4.h"
+#include "MathCode/Vector3.h"
+#include "MathCode/Vector4.h"
+#include "MathCode/Vector3Stream.h"
+#include "MathCode/Quaternion.h"
+#include "UtilityCode/SIMD.h"
+#include "UtilityCode/LookupManager.h"
+#include "UtilityCode/FastTrig.h"
+#include "UtilityCode/TrigTables.h"
+#include "UtilityCode/BinAngle.h"
+#include "UtilityCode/HiResTimer.h"
+
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define BENCH_ITERATIONS	10000000
+#define BENCH_STREAMSIZE	4096		// vectors per stream, small enough to stay in cache
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+//-------------------------------------------------------------------------------------------
+//	Measures the time between start and stop with the clock in hirestimer.h
+//-------------------------------------------------------------------------------------------
+class BenchTimer {
+	private:
+
+		int64		startTime;
+
+	public:
+
+		void		start(void) { startTime = getTicks(); }
+		double		stop(void) const { return ticksToSeconds(getTicks() - startTime); }
+
+		explicit BenchTimer() : startTime(0) {}
+};
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+// results are accumulated here so the optimizer cannot remove the work being timed
+volatile float	benchSink = 0;
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+void printResult(FILE *out, const char *name, double seconds, int count)
+{
+	fprintf(out, "  %-32s %10.2f ns/op %10.2f Mops/s\n", name,
+			seconds * 1.0e9 / count, count / seconds * 1.0e-6);
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Matrix multiply, row vector * matrix, transpose and inverse throughput for Matrix4x4
+//-------------------------------------------------------------------------------------------
+void benchMatrix(FILE *out)
+{
+	BenchTimer	t;
+	Matrix4x4	a, b, c;
+	Vector4		v(1.0f, 2.0f, 3.0f, 1.0f);
+
+	a.setIdentity();
+	a.rotateX(0.01f);
+	a.translate(0.1f, 0.2f, 0.3f);
+	b.setIdentity();
+	b.rotateY(0.02f);
+	c.setIdentity();
+
+	fprintf(out, "Matrix4x4 (%s)\n", SIMD_NAME);
+
+	// each result feeds the next multiply so the loop cannot be hoisted
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n += 2) {
+		c.multiply(a, b);
+		a.multiply(c, b);
+	}
+	printResult(out, "matrix multiply", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + a.i[0];
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n++) {
+		c *= b;
+	}
+	printResult(out, "matrix *= matrix", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + c.i[0];
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n++) {
+		v *= b;
+	}
+	printResult(out, "vector *= matrix", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + v.x;
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n += 2) {
+		c = a.getTranspose();
+		a = c.getTranspose();
+	}
+	printResult(out, "transpose", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + a.i[1];
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n += 2) {
+		c.inverse(a);
+		a.inverse(c);
+	}
+	printResult(out, "inverse", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + a.i[1];
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n += 2) {
+		c.affineInverse(a);
+		a.affineInverse(c);
+	}
+	printResult(out, "affine inverse", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + a.i[1];
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n += 2) {
+		c.orthonormalInverse(a);
+		a.orthonormalInverse(c);
+	}
+	printResult(out, "orthonormal inverse", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + a.i[1];
+
+	fprintf(out, "\n");
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Transforming and normalizing an array of Vector3 one at a time versus a Vector3Stream
+//-------------------------------------------------------------------------------------------
+void benchVector3Stream(FILE *out)
+{
+	BenchTimer		t;
+	Matrix4x4		m;
+	Vector3			*points = new Vector3[BENCH_STREAMSIZE];
+	Vector3			*result = new Vector3[BENCH_STREAMSIZE];
+	Vector3Stream	src(BENCH_STREAMSIZE), dst(BENCH_STREAMSIZE);
+	const int		passes = BENCH_ITERATIONS / BENCH_STREAMSIZE;
+
+	m.setIdentity();
+	m.rotateY(0.3f);
+	m.translate(1.0f, 2.0f, 3.0f);
+
+	for (int v = 0; v < BENCH_STREAMSIZE; ++v) {
+		points[v].assign((float)(v % 64), (float)(v % 7), (float)(v / 64));
+	}
+	src.load(points, BENCH_STREAMSIZE);
+
+	fprintf(out, "Vector3Stream (%s)\n", SIMD_NAME);
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		for (int v = 0; v < BENCH_STREAMSIZE; ++v) {
+			result[v] = points[v] * m;
+		}
+		benchSink = benchSink + result[n % BENCH_STREAMSIZE].x;
+	}
+	printResult(out, "Vector3 * matrix (AoS)", t.stop(), passes * BENCH_STREAMSIZE);
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		dst.transformVectors(src, m);
+		benchSink = benchSink + dst.getX()[n % BENCH_STREAMSIZE];
+	}
+	printResult(out, "stream transformVectors", t.stop(), passes * BENCH_STREAMSIZE);
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		dst.transformPoints(src, m);
+		benchSink = benchSink + dst.getX()[n % BENCH_STREAMSIZE];
+	}
+	printResult(out, "stream transformPoints", t.stop(), passes * BENCH_STREAMSIZE);
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		for (int v = 0; v < BENCH_STREAMSIZE; ++v) {
+			result[v] = points[v];
+			result[v].normalize();
+		}
+		benchSink = benchSink + result[n % BENCH_STREAMSIZE].x;
+	}
+	printResult(out, "Vector3 normalize (AoS)", t.stop(), passes * BENCH_STREAMSIZE);
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		dst.copy(src);
+		dst.normalize();
+		benchSink = benchSink + dst.getX()[n % BENCH_STREAMSIZE];
+	}
+	printResult(out, "stream copy + normalize", t.stop(), passes * BENCH_STREAMSIZE);
+
+	fprintf(out, "\n");
+
+	delete [] points;
+	delete [] result;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Quaternion composition, interpolation and rotation of a Vector3Stream
+//-------------------------------------------------------------------------------------------
+void benchQuaternion(FILE *out)
+{
+	BenchTimer		t;
+	Quaternion		a(Vector3(0,1,0), 0.01f), b(Vector3(1,0,0), 0.02f), c, d(Vector3(0,0,1), 2.0f);
+	Vector3			p(1.0f, 2.0f, 3.0f);
+	Vector3Stream	src(BENCH_STREAMSIZE), dst(BENCH_STREAMSIZE);
+	const int		passes = BENCH_ITERATIONS / BENCH_STREAMSIZE;
+
+	for (int v = 0; v < BENCH_STREAMSIZE; ++v) {
+		src.set(v, Vector3((float)(v % 64), (float)(v % 7), (float)(v / 64)));
+	}
+
+	fprintf(out, "Quaternion (%s)\n", SIMD_NAME);
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n += 2) {
+		c.multiply(a, b);
+		a.multiply(c, b);
+	}
+	printResult(out, "quaternion multiply", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + a.x;
+
+	float step = 1.0f / BENCH_ITERATIONS;
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n++) {
+		c.nlerp(b, d, n * step);
+		benchSink = benchSink + c.x;
+	}
+	printResult(out, "nlerp", t.stop(), BENCH_ITERATIONS);
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n++) {
+		c.slerp(b, d, n * step);
+		benchSink = benchSink + c.x;
+	}
+	printResult(out, "slerp", t.stop(), BENCH_ITERATIONS);
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n++) {
+		c.slerpFast(b, d, n * step);
+		benchSink = benchSink + c.x;
+	}
+	printResult(out, "slerpFast", t.stop(), BENCH_ITERATIONS);
+
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; n++) {
+		b.rotate(p, p);
+	}
+	printResult(out, "rotate Vector3", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + p.x;
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		dst.rotate(src, b);
+		benchSink = benchSink + dst.getX()[n % BENCH_STREAMSIZE];
+	}
+	printResult(out, "stream rotate", t.stop(), passes * BENCH_STREAMSIZE);
+
+	fprintf(out, "\n");
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Sine and cosine from each LookupManager mode against sinf/cosf. The angles are
+//	visited in a scattered order, as they would be by many objects with unrelated rotations,
+//	so the full tables pay for their cache misses. The LookupManager is left in the mode it
+//	was in before the benchmark.
+//-------------------------------------------------------------------------------------------
+void benchTrig(FILE *out)
+{
+	static const char *modeNames[] = { "full tables", "quarter wave linear", "quarter wave cubic", "polynomial" };
+
+	BenchTimer	t;
+	TrigMode	oldMode = math.getTrigMode();
+	const int	angleCount = math.ANGLE360;
+	const int	stride = 7919;		// prime, so every angle is visited once per sweep
+	float		angleFix = math.getAngleInc() * DEGTORAD;
+	char		name[64];
+
+	int			*lookups = new int[BENCH_STREAMSIZE];
+	float		*angles = new float[BENCH_STREAMSIZE];
+	float		*sinOut = new float[BENCH_STREAMSIZE];
+	float		*cosOut = new float[BENCH_STREAMSIZE];
+	const int	passes = BENCH_ITERATIONS / BENCH_STREAMSIZE;
+
+	for (int i = 0, a = 0; i < BENCH_STREAMSIZE; ++i) {
+		lookups[i] = a;
+		angles[i] = (float)a * angleFix;
+		a += stride;
+		if (a >= angleCount) a -= angleCount;
+	}
+
+	fprintf(out, "Trig (precision %d)\n", math.getAnglePrec());
+
+	for (int mode = TRIG_FULLTABLES; mode <= TRIG_POLYNOMIAL; ++mode) {
+		t.start();
+		math.setTrigMode((TrigMode)mode);
+		sprintf(name, "setup %s", modeNames[mode]);
+		printResult(out, name, t.stop(), 1);
+
+		double maxError = 0;
+		for (int a = 0; a < angleCount; ++a) {
+			double e = fabs(math.getSin(a) - sin((double)a * angleFix));
+			if (e > maxError) maxError = e;
+		}
+
+		float sum = 0;
+		int a = 0;
+		t.start();
+		for (int n = 0; n < BENCH_ITERATIONS; ++n) {
+			float s, c;
+			math.getSinCos(a, s, c);
+			sum += s * c;
+			a += stride;
+			if (a >= angleCount) a -= angleCount;
+		}
+		double seconds = t.stop();
+		benchSink = benchSink + sum;
+
+		sprintf(name, "sincos %s", modeNames[mode]);
+		printResult(out, name, seconds, BENCH_ITERATIONS);
+
+		t.start();
+		for (int n = 0; n < passes; ++n) {
+			math.getSinCos(lookups, sinOut, cosOut, BENCH_STREAMSIZE);
+			benchSink = benchSink + sinOut[n % BENCH_STREAMSIZE];
+		}
+		seconds = t.stop();
+
+		sprintf(name, "sincos batch %s", modeNames[mode]);
+		printResult(out, name, seconds, passes * BENCH_STREAMSIZE);
+		fprintf(out, "  %-32s %10d bytes, max error %g\n", "", math.getTableBytes(), maxError);
+	}
+
+	float sum = 0;
+	int a = 0;
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; ++n) {
+		float r = (float)a * angleFix;
+		sum += sinf(r) * cosf(r);
+		a += stride;
+		if (a >= angleCount) a -= angleCount;
+	}
+	printResult(out, "sinf+cosf", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + sum;
+
+	t.start();
+	for (int n = 0; n < passes; ++n) {
+		fastSinCos(angles, sinOut, cosOut, BENCH_STREAMSIZE);
+		benchSink = benchSink + sinOut[n % BENCH_STREAMSIZE];
+	}
+	printResult(out, "fastSinCos batch (radians)", t.stop(), passes * BENCH_STREAMSIZE);
+
+	// the static tables use TRIG_PRECISION units, the same as the LookupManager at precision 80
+	sum = 0;
+	a = 0;
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; ++n) {
+		float s, c;
+		trigSinCos(a, s, c);
+		sum += s * c;
+		a += stride;
+		if (a >= TRIG_ANGLE360) a -= TRIG_ANGLE360;
+	}
+	printResult(out, "trigSinCos static table", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + sum;
+
+	// binary angles wrap by themselves, the stride is about 66 degrees
+	BinAngle ba, bstride(0x2F000001u);
+	sum = 0;
+	t.start();
+	for (int n = 0; n < BENCH_ITERATIONS; ++n) {
+		float s, c;
+		ba.sinCos(s, c);
+		sum += s * c;
+		ba += bstride;
+	}
+	printResult(out, "BinAngle sinCos", t.stop(), BENCH_ITERATIONS);
+	benchSink = benchSink + sum;
+
+	math.setTrigMode(oldMode);
+
+	delete [] lookups;
+	delete [] angles;
+	delete [] sinOut;
+	delete [] cosOut;
+	fprintf(out, "\n");
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Runs all benchmarks and writes the results to the file given. Returns false if the file
+//	could not be opened. The LookupManager must already be constructed.
+//-------------------------------------------------------------------------------------------
+bool runBenchmarks(const char *filename)
+{
+	FILE *out = fopen(filename, "w");
+	if (!out) return false;
+
+	fprintf(out, "Clock %s, %.0f ticks per second\n\n", getTickSource(), (double)getTickFrequency());
+
+	benchMatrix(out);
+	benchVector3Stream(out);
+	benchQuaternion(out);
+	benchTrig(out);
+
+	fclose(out);
+	return true;
+}
@@ -0,0 +1,21 @@
+//	----==== BENCHMARK.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Micro-benchmarks for the math and utility code. Run the program with
+//					-bench on the command line to write the results to a text file
+//					instead of opening the window.
+//	-------------------------------------------------------------------------------------
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+bool runBenchmarks(const char *filename);
+
+#endif
@@ -0,0 +1,1121 @@
+//	----==== LINUX_MAIN.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Headless host for batch runs and benchmarks on build servers. There is
+//					no window, no OpenGL and no input; the surface scene is simulated by
+//					the LoopScheduler exactly as under Win32, and each frame the view is
+//					built and every patch tessellated and transformed to view space in
+//					place of drawing. With -raster the patches are drawn by the software
+//					rasterizer instead, and -image saves the last frame. After the
+//					requested number of frames the timing is reported on stdout.
+//
+//					surfaces [-frames N] [-threaded] [-fpscap N] [-seed N] [-regen N]
+//							 [-nospin] [-raster] [-strips] [-optimize] [-rthreads N]
+//							 [-width N] [-height N] [-image file]
+//							 [-packed 8|16] [-heightfield file [-hfquery N] [-tilecache MB]
+//							  [-tileradius N]]
+//							 [-trace file] [-csv file] [-bench [file]] [-meshstats] [-packstats]
+//							 [-writehf file [-hfsize N] [-hftile N] [-hffloat] [-hfdelta]]
+//							 [-import file [-rawsize WxH] [-rawbe] [-hscale S] [-hoffset O]
+//							  [-ithreads N] [-interpolate]] [-exportmap file [-hfsize N]]
+//							 [-scatterfit N|file [-fitsize N] [-smoothing S] [-fthreads N]]
+//							 [-hierarchy [-savehier file]] [-loadhier file] [-hlevels N]
+//							 [-derivatives [-dsamples N] [-dthreads N]]
+//							 [-classify file [-csamples N] [-cthreads N]]
+//	-------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "UtilityCode/Platform.h"
+#include "UtilityCode/LookupManager.h"
+#include "UtilityCode/Timer.h"
+#include "UtilityCode/Profiler.h"
+#include "UtilityCode/LoopScheduler.h"
+#include "UtilityCode/HiResTimer.h"
+#include "RenderCode/FrameBuffer.h"
+#include "RenderCode/SoftRasterizer.h"
+#include "RenderCode/MeshOptimizer.h"
+#include "RenderCode/PackedVertex.h"
+#include "TerrainCode/HeightField.h"
+#include "TerrainCode/HeightMapReader.h"
+#include "TerrainCode/TileCache.h"
+#include "TerrainCode/SplineFit.h"
+#include "TerrainCode/ScatteredFit.h"
+#include "TerrainCode/SplineHierarchy.h"
+#include "TerrainCode/SurfaceDerivatives.h"
+#include "TerrainCode/TerrainClassMap.h"
+#include "SurfaceScene.h"
+#include "Benchmark.h"
+
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define DEFAULT_FRAMES		1000
+#define DEFAULT_WIDTH		800
+#define DEFAULT_HEIGHT		600
+#define DEFAULT_HFSIZE		4096
+#define DEFAULT_FITSIZE		259			// 256 patches a side, halves down to 19
+#define FITSPACING			4.0f		// between the knots of the grid fitted to generated points
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+// Sum of the view space vertices, printed at the end so the tessellation cannot be optimized
+// away. It only repeats between runs with -nospin, the spin depends on the real frame times.
+double		checksum = 0;
+
+TriMesh			surfaceMesh;
+int				meshFlags = 0;
+
+// With -packed the rasterizer draws the mesh after a round trip through the packed format
+int				packedBits = 0;
+PackedMesh8		packedMesh8;
+PackedMesh16	packedMesh16;
+TriMesh			decodedMesh;
+
+// With -heightfield or -import the surface heights come from a window into the file or the
+// imported map, -regen moves it
+HeightField		heightField;
+std::vector<float>	importedHeights;
+int				importedWidth = 0, importedHeight = 0;
+int				windowX = 0, windowZ = 0;
+
+// With -tilecache the window is paged from the heightfield by the tile cache. Until the tiles
+// under a new window are resident the surface stays where it was.
+TileCache		tileCache;
+bool			windowLoaded = false;
+int				staleFrames = 0;
+
+// Software rendering, only used with -raster
+FrameBuffer		*frameBuffer = 0;
+SoftRasterizer	*rasterizer = 0;
+Matrix4x4		projection;
+int64			rasterTriangles = 0;		// totals over all frames
+int64			rasterTicks = 0;
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+void renderRaster(float alpha)
+{
+	PROFILE_ZONE("renderScene");
+
+	buildView(alpha);
+	tessellateSurface(surfaceMesh, meshFlags);
+
+	const TriMesh *mesh = &surfaceMesh;
+	if (packedBits) {
+		PROFILE_ZONE("packMesh");
+
+		const float spacing = (float)PATCHSPACING / SUBDIVISIONS;
+		if (packedBits == 8) {
+			packedMesh8.pack(surfaceMesh, spacing);
+			packedMesh8.unpack(decodedMesh.vertices);
+		} else {
+			packedMesh16.pack(surfaceMesh, spacing);
+			packedMesh16.unpack(decodedMesh.vertices);
+		}
+		decodedMesh.indices = surfaceMesh.indices;
+		decodedMesh.strip = surfaceMesh.strip;
+		mesh = &decodedMesh;
+	}
+
+	Matrix4x4 viewProjection;
+	viewProjection.multiply(viewMatrix, projection);
+	rasterizer->setViewProjection(viewProjection);
+	rasterizer->beginFrame(MAKE_RGBA(255,255,255,255));
+
+	if (meshFlags & MESH_STRIP) {
+		rasterizer->drawIndexedStrip(&mesh->vertices[0], mesh->getNumVertices(),
+									 &mesh->strip[0], (int)mesh->strip.size());
+	} else {
+		rasterizer->drawIndexed(&mesh->vertices[0], mesh->getNumVertices(),
+								&mesh->indices[0], (int)mesh->indices.size());
+	}
+
+	rasterizer->endFrame();
+
+	const RasterStats &stats = rasterizer->getStats();
+	rasterTriangles += stats.trianglesIn;
+	rasterTicks += stats.setupTicks + stats.rasterTicks;
+	checksum += (double)stats.pixelsWritten;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Does the work of SurfaceTest's renderScene without OpenGL
+//-------------------------------------------------------------------------------------------
+void renderHeadless(float alpha)
+{
+	PROFILE_ZONE("renderScene");
+
+	buildView(alpha);
+	tessellateSurface(surfaceMesh, meshFlags);
+
+	PROFILE_ZONE("transformMesh");
+
+	Vector3 viewPoint;
+	for (int v = 0; v < surfaceMesh.getNumVertices(); v++) {
+		viewPoint.multiplyMatrix(surfaceMesh.vertices[v].position, viewMatrix);
+		checksum += viewPoint.x + viewPoint.y + viewPoint.z;
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Vertex cache statistics of the surface mesh in grid order and optimized, for a range of
+//	subdivisions. The strip is in grid order too, its restarts are not counted as triangles.
+//-------------------------------------------------------------------------------------------
+void printMeshStats(void)
+{
+	static const int levels[] = { 1, 2, 4, 8, SUBDIVISIONS, 16, 32, 64 };
+	static const int fifoSizes[] = { MESH_FIFOSIZE, MESH_CACHESIZE };
+
+	printf("Vertex cache, ACMR (transforms per triangle) / ATVR (transforms per vertex)\n");
+	printf("subdiv  triangles  vertices  fifo   list          strip         optimized     optimize ms\n");
+
+	for (int l = 0; l < (int)(sizeof(levels) / sizeof(levels[0])); l++) {
+		if (l > 0 && levels[l] == levels[l-1]) continue;
+
+		TriMesh grid, optimized;
+		buildSurfaceIndices(grid, levels[l], MESH_STRIP);
+
+		int64 start = getTicks();
+		buildSurfaceIndices(optimized, levels[l], MESH_OPTIMIZE);
+		double ms = ticksToSeconds(getTicks() - start) * 1000.0;
+
+		int side = PATCHESPERSIDE * levels[l] + 1;
+		int numVerts = side * side;
+
+		// the strip as the list it draws, in the same order
+		TriMesh stripList;
+		stripList.strip = grid.strip;
+		stripList.stripToList();
+
+		for (int f = 0; f < 2; f++) {
+			MeshCacheStats listStats, stripStats, optStats;
+			MeshOptimizer::calcCacheStats(listStats, &grid.indices[0], (int)grid.indices.size(), numVerts, fifoSizes[f]);
+			MeshOptimizer::calcCacheStats(stripStats, &stripList.indices[0], (int)stripList.indices.size(), numVerts, fifoSizes[f]);
+			MeshOptimizer::calcCacheStats(optStats, &optimized.indices[0], (int)optimized.indices.size(), numVerts, fifoSizes[f]);
+
+			if (f == 0) {
+				printf("%6d  %9d  %8d  %4d   %.3f/%.3f   %.3f/%.3f   %.3f/%.3f   %8.2f\n", levels[l],
+					   grid.getNumTriangles(), numVerts, fifoSizes[f], listStats.acmr, listStats.atvr,
+					   stripStats.acmr, stripStats.atvr, optStats.acmr, optStats.atvr, ms);
+			} else {
+				printf("%6s  %9s  %8s  %4d   %.3f/%.3f   %.3f/%.3f   %.3f/%.3f\n", "", "", "", fifoSizes[f],
+					   listStats.acmr, listStats.atvr, stripStats.acmr, stripStats.atvr,
+					   optStats.acmr, optStats.atvr);
+			}
+		}
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Size and error of the packed vertex formats against the float vertices of the surface,
+//	with the decode time per vertex
+//-------------------------------------------------------------------------------------------
+template <class N>
+void printPackedStats(const char *name, const TriMesh &mesh)
+{
+	PackedMeshT<N> packed;
+	if (!packed.pack(mesh, (float)PATCHSPACING / SUBDIVISIONS)) {
+		printf("%-8s could not pack the mesh\n", name);
+		return;
+	}
+
+	PackedError err;
+	packed.calcError(err, mesh);
+
+	std::vector<RenderVertex> decoded;
+	int64 start = getTicks();
+	for (int r = 0; r < 100; r++) packed.unpack(decoded);
+	double ns = ticksToSeconds(getTicks() - start) * 1.0e9 / (100.0 * mesh.getNumVertices());
+
+	printf("%-8s %5d  %9d   %.2e   %.2e   %7.4f   %7.4f   %6.2f\n", name,
+		   PackedMeshT<N>::getVertexSize(), PackedMeshT<N>::getVertexSize() * mesh.getNumVertices(),
+		   err.maxPosition, err.rmsPosition, err.maxNormalDeg, err.avgNormalDeg, ns);
+}
+
+
+void printPackStats(unsigned int seed)
+{
+	initSurfacePoints(seed);
+	buildView(0);
+
+	TriMesh mesh;
+	tessellateSurface(mesh, 0);
+
+	printf("%d vertices, grid spacing %.3f, heights quantized to 1/65535th of their range\n", mesh.getNumVertices(),
+		   (float)PATCHSPACING / SUBDIVISIONS);
+	printf("format   bytes  mesh bytes  max pos    rms pos    max deg   avg deg   decode ns\n");
+	printf("%-8s %5d  %9d\n", "float", (int)sizeof(RenderVertex), (int)sizeof(RenderVertex) * mesh.getNumVertices());
+	printPackedStats<signed char>("oct 2x8", mesh);
+	printPackedStats<short>("oct 2x16", mesh);
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Test terrain for -writehf, three octaves of value noise with the same range as the random
+//	heights of initSurfacePoints. Any sample can be computed alone, so the file is written
+//	without holding the field in memory.
+//-------------------------------------------------------------------------------------------
+static float latticeValue(int x, int z, unsigned int seed)
+{
+	uint32 h = (uint32)x * 73856093u ^ (uint32)z * 19349663u ^ seed * 83492791u;
+	h ^= h >> 13;
+	h *= 0x5bd1e995u;
+	h ^= h >> 15;
+	return (h & 0xFFFF) / 32767.5f - 1.0f;
+}
+
+
+float generateHeight(int x, int z, void *param)
+{
+	unsigned int seed = *(unsigned int *)param;
+	float height = 0, amplitude = 6.0f * 0.57f;
+
+	for (int octave = 0, cell = 256; octave < 3; octave++, cell /= 4, amplitude *= 0.5f) {
+		int cx = x / cell, cz = z / cell;
+		float fx = (float)(x - cx * cell) / cell, fz = (float)(z - cz * cell) / cell;
+		float h0 = latticeValue(cx, cz, seed + octave), h1 = latticeValue(cx+1, cz, seed + octave);
+		float h2 = latticeValue(cx, cz+1, seed + octave), h3 = latticeValue(cx+1, cz+1, seed + octave);
+		height += amplitude * ((h0 * (1-fx) + h1 * fx) * (1-fz) + (h2 * (1-fx) + h3 * fx) * fz);
+	}
+	return height;
+}
+
+
+// Source for writing the imported map to a heightfield file
+float importedSample(int x, int z, void *param)
+{
+	return importedHeights[(size_t)z * importedWidth + x];
+}
+
+
+int writeHeightField(const char *filename, int argc, char **argv, unsigned int seed);
+
+
+void loadWindow(void)
+{
+	if (tileCache.isOpen()) {
+		windowLoaded = loadSurfacePoints(tileCache, windowX, windowZ);
+	} else if (heightField.isOpen()) {
+		loadSurfacePoints(heightField, windowX, windowZ);
+	} else {
+		loadSurfacePoints(&importedHeights[0], importedWidth, importedHeight, windowX, windowZ);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Moves the window one patch across the heightfield, to the next row of patches at the
+//	end of a row, and releases the tiles it has left
+//-------------------------------------------------------------------------------------------
+void advanceWindow(void)
+{
+	int oldX = windowX, oldZ = windowZ;
+	int fieldWidth = heightField.isOpen() ? heightField.getWidth() : importedWidth;
+	int fieldHeight = heightField.isOpen() ? heightField.getHeight() : importedHeight;
+
+	windowX += PATCHESPERSIDE;
+	if (windowX + POINTSPERSIDE > fieldWidth) {
+		windowX = 0;
+		windowZ += PATCHESPERSIDE;
+		if (windowZ + POINTSPERSIDE > fieldHeight) windowZ = 0;
+	}
+
+	// the tile cache frees the tiles itself
+	if (!heightField.isOpen() || tileCache.isOpen()) {
+		loadWindow();
+		return;
+	}
+
+	int ts = heightField.getTileSize();
+	for (int tz = oldZ / ts; tz <= (oldZ + POINTSPERSIDE - 1) / ts; tz++) {
+		for (int tx = oldX / ts; tx <= (oldX + POINTSPERSIDE - 1) / ts; tx++) {
+			bool inNew = (tx >= windowX / ts && tx <= (windowX + POINTSPERSIDE - 1) / ts &&
+						  tz >= windowZ / ts && tz <= (windowZ + POINTSPERSIDE - 1) / ts);
+			if (!inNew && tx < heightField.getTilesX() && tz < heightField.getTilesZ()) {
+				heightField.releaseTile(tx, tz);
+			}
+		}
+	}
+
+	loadWindow();
+}
+
+
+// Random single samples spread over the whole field, most of them fault a page in
+void queryHeightField(int queries, unsigned int seed)
+{
+	srand(seed);
+	double sum = 0;
+	int64 start = getTicks();
+	for (int q = 0; q < queries; q++) {
+		int x = (int)(((uint64)rand() * RAND_MAX + rand()) % heightField.getWidth());
+		int z = (int)(((uint64)rand() * RAND_MAX + rand()) % heightField.getHeight());
+		sum += heightField.getSample(x, z);
+	}
+	double seconds = ticksToSeconds(getTicks() - start);
+	checksum += sum;
+	printf("%d random samples in %.3f ms, %.3f us per sample\n", queries, seconds * 1000.0,
+		   seconds * 1.0e6 / queries);
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Returns the argument after the option, or 0 if the option is not on the command line
+//-------------------------------------------------------------------------------------------
+const char *findOption(int argc, char **argv, const char *option, bool hasValue)
+{
+	for (int a = 1; a < argc; a++) {
+		if (strcmp(argv[a], option) == 0) {
+			if (!hasValue) return argv[a];
+			return (a + 1 < argc && argv[a+1][0] != '-') ? argv[a+1] : 0;
+		}
+	}
+	return 0;
+}
+
+
+void printUsage(void)
+{
+	printf(	"usage: surfaces [options]\n"
+			"  -frames N      frames to run, default %d\n"
+			"  -threaded      run the simulation steps on a second thread\n"
+			"  -fpscap N      limit the frame rate to N frames per second\n"
+			"  -seed N        seed for the surface heights, default 1\n"
+			"  -regen N       new surface heights every N frames\n"
+			"  -nospin        keep the surface still\n"
+			"  -raster        draw with the software rasterizer\n"
+			"  -strips        tessellate to triangle strips instead of a list\n"
+			"  -optimize      reorder the mesh for the vertex cache and vertex fetch\n"
+			"  -rthreads N    rasterizer threads, default one per hardware thread\n"
+			"  -width N       frame buffer width, default %d\n"
+			"  -height N      frame buffer height, default %d\n"
+			"  -image file    draw with the rasterizer and save the last frame, .png or .ppm\n"
+			"  -trace file    write the profiler events as a Chrome trace\n"
+			"  -csv file      write the frame time history\n"
+			"  -bench [file]  run the math benchmarks instead, default benchmark.txt\n"
+			"  -packed 8|16   rasterize the mesh after packing it with 8 or 16 bit normals\n"
+			"  -heightfield f take the heights from a heightfield file, -regen moves across it\n"
+			"  -hfquery N     time N random samples of the heightfield before running\n"
+			"  -tilecache MB  page the heightfield through a tile cache of MB megabytes\n"
+			"    -tileradius N  tiles loaded around the window, default %d\n"
+			"  -meshstats     print the vertex cache statistics of the mesh instead\n"
+			"  -packstats     print the size and error of the packed vertex formats instead\n"
+			"  -writehf file  write a generated heightfield instead, with\n"
+			"    -hfsize N    samples on a side, default %d\n"
+			"    -hftile N    samples on a side of a tile, default %d\n"
+			"    -hffloat     float samples instead of 16 bit\n"
+			"    -hfdelta     delta compress the 16 bit tiles\n"
+			"                 with -import the imported map is written\n"
+			"  -import file   take the heights from a .raw, .r16, .pgm or .png heightmap\n"
+			"    -rawsize WxH size of a RAW map, default square\n"
+			"    -rawbe       RAW samples are big endian\n"
+			"    -hscale S    height of one 16 bit step, default 12 * VERTSCALE / 65535\n"
+			"    -hoffset O   height of sample 0, default -6 * VERTSCALE\n"
+			"    -ithreads N  conversion threads, default one per hardware thread\n"
+			"    -interpolate fit control heights so the surface passes through the samples\n"
+			"  -exportmap f   write the generated terrain as a 16 bit heightmap instead\n"
+			"  -scatterfit N|file  take the heights from a grid fitted to N generated points or\n"
+			"                 the \"x y z\" lines of a file, z up\n"
+			"    -fitsize N   controls on a side, default %d\n"
+			"    -smoothing S weight of the smoothing, default %g\n"
+			"    -fthreads N  fitting threads, default one per hardware thread\n"
+			"  -hierarchy     split the imported or fitted controls into a coarse grid and levels\n"
+			"                 of detail\n"
+			"    -savehier f  write the levels to a file\n"
+			"  -loadhier f    take the heights from a file of levels\n"
+			"    -hlevels N   levels of either used for the heights, default all\n"
+			"  -derivatives   time the gradient, Hessian and curvature maps of the imported or\n"
+			"                 fitted controls\n"
+			"    -dsamples N  samples between knots, default 1\n"
+			"    -dthreads N  threads, default one per hardware thread\n"
+			"  -classify f    write the slope, aspect and curvature classes of the imported or\n"
+			"                 fitted controls to a raster file\n"
+			"    -csamples N  texels between knots, default 1\n"
+			"    -cthreads N  threads, default one per hardware thread\n",
+			DEFAULT_FRAMES, DEFAULT_WIDTH, DEFAULT_HEIGHT, TILECACHE_RADIUS, DEFAULT_HFSIZE, HF_TILESIZE,
+			DEFAULT_FITSIZE, FIT_SMOOTHING);
+}
+
+
+void printReport(int frames, double seconds, int updates, bool threaded)
+{
+	FrameStats stats;
+	timer.calcFrameStats(stats);
+
+	printf("Platform %s, %s, clock %s\n", PLATFORM_NAME, COMPILER_NAME, getTickSource());
+	printf("Frames %d in %.3f s, %.1f fps, %d updates, %s\n", frames, seconds,
+		   (seconds > 0) ? frames / seconds : 0.0, updates, threaded ? "threaded" : "single thread");
+	printf("Frame ms over the last %d frames: p50 %.3f  p95 %.3f  p99 %.3f  min %.3f  max %.3f  avg %.3f\n",
+		   stats.samples, stats.p50, stats.p95, stats.p99, stats.minMs, stats.maxMs, stats.avgMs);
+	printf("Hitches %d\n", timer.getHitchCount());
+	printf("Checksum %.6e\n", checksum);
+
+	if (rasterizer) {
+		const RasterStats &rs = rasterizer->getStats();
+		double rasterSeconds = ticksToSeconds(rasterTicks);
+		printf("Raster %dx%d, %d threads, %d pixel tiles\n", frameBuffer->getWidth(),
+			   frameBuffer->getHeight(), rasterizer->getNumThreads(), rasterizer->getTileSize());
+		printf("Last frame: %d triangles, %d culled, %d clipped, %d drawn, %d bin entries, %lld pixels\n",
+			   rs.trianglesIn, rs.trianglesCulled, rs.trianglesClipped, rs.trianglesSetup,
+			   rs.binEntries, (long long)rs.pixelsWritten);
+		printf("%.2f M triangles per second, %.3f ms per frame in the rasterizer\n",
+			   (rasterSeconds > 0) ? rasterTriangles / rasterSeconds / 1000000.0 : 0.0,
+			   rasterSeconds * 1000.0 / frames);
+	}
+	if (tileCache.isOpen()) {
+		const TileCacheStats &ts = tileCache.getStats();
+		printf("Tile cache %.1f MB, radius %d, %.2f MB per tile: %d resident (%.1f MB, peak %.1f MB), %d queued\n",
+			   tileCache.getBudget() / 1048576.0, tileCache.getRadius(), tileCache.getTileMemory() / 1048576.0,
+			   ts.residentTiles, ts.residentBytes / 1048576.0, ts.peakBytes / 1048576.0, ts.queuedTiles);
+		printf("%lld faults, %lld hits, %lld loads (%.3f ms each), %lld evictions, %lld cancelled, %lld failed\n",
+			   (long long)ts.faults, (long long)ts.hits, (long long)ts.loads,
+			   (ts.loads > 0) ? ts.loadSeconds * 1000.0 / ts.loads : 0.0, (long long)ts.evictions,
+			   (long long)ts.cancels, (long long)ts.failures);
+		printf("%d frames drawn on a stale window\n", staleFrames);
+	}
+	printf("\n");
+
+	if (profiler.getNumZones() == 0) return;
+
+	printf("Zone                  avg ms   min ms   max ms  calls\n");
+	for (int z = 0; z < profiler.getNumZones(); z++) {
+		const ProfileZoneStats &zone = profiler.getZone(z);
+		printf("%-20s %7.3f  %7.3f  %7.3f  %5.0f\n", zone.name, zone.avgMs, zone.minMs,
+			   zone.maxMs, zone.callsPerFrame);
+	}
+}
+
+
+int writeHeightField(const char *filename, int argc, char **argv, unsigned int seed)
+{
+	const char *opt;
+	int size = (opt = findOption(argc, argv, "-hfsize", true)) ? atoi(opt) : DEFAULT_HFSIZE;
+
+	HeightFieldDesc desc;
+	if ((opt = findOption(argc, argv, "-hftile", true))) desc.tileSize = atoi(opt);
+	if (findOption(argc, argv, "-hffloat", false)) desc.format = HF_FLOAT32;
+	if (findOption(argc, argv, "-hfdelta", false)) desc.compression = HF_DELTA;
+	desc.spacing = HORZSCALE;
+	desc.minHeight = -6.0f;
+	desc.maxHeight = 6.0f;
+
+	int64 start = getTicks();
+	bool ok;
+	int sizeZ = size;
+	if (!importedHeights.empty()) {
+		size = importedWidth;
+		sizeZ = importedHeight;
+		desc.minHeight = desc.maxHeight = 0;	// found from the samples
+		ok = HeightField::write(filename, size, sizeZ, desc, importedSample, 0);
+	} else {
+		ok = (size > 0) && HeightField::write(filename, size, size, desc, generateHeight, &seed);
+	}
+	double seconds = ticksToSeconds(getTicks() - start);
+
+	if (!ok) {
+		printf("Could not write %s\n", filename);
+		return -1;
+	}
+
+	HeightField written;
+	written.open(filename);
+	printf("Heightfield %s written in %.2f s, %dx%d samples, %.1f MB, %.2f bytes per sample\n",
+		   filename, seconds, size, sizeZ, written.getFileSize() / 1048576.0,
+		   (double)written.getFileSize() / ((double)size * sizeZ));
+	return 0;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Reads the whole heightmap into importedHeights and reports the throughput
+//-------------------------------------------------------------------------------------------
+bool importHeightMap(const char *filename, int argc, char **argv)
+{
+	const char *opt;
+	int rawWidth = 0, rawHeight = 0;
+	if ((opt = findOption(argc, argv, "-rawsize", true))) sscanf(opt, "%dx%d", &rawWidth, &rawHeight);
+	bool rawBigEndian = (findOption(argc, argv, "-rawbe", false) != 0);
+	float scale = (opt = findOption(argc, argv, "-hscale", true)) ? (float)atof(opt) : 12.0f * VERTSCALE / 65535.0f;
+	float offset = (opt = findOption(argc, argv, "-hoffset", true)) ? (float)atof(opt) : -6.0f * VERTSCALE;
+	int threads = (opt = findOption(argc, argv, "-ithreads", true)) ? atoi(opt) : 0;
+
+	HeightMapReader reader;
+	int64 start = getTicks();
+	if (!reader.open(filename, rawWidth, rawHeight, rawBigEndian)) {
+		printf("Could not open heightmap %s\n", filename);
+		return false;
+	}
+
+	importedWidth = reader.getWidth();
+	importedHeight = reader.getHeight();
+	importedHeights.resize((size_t)importedWidth * importedHeight);
+	if (importedWidth < POINTSPERSIDE || importedHeight < POINTSPERSIDE ||
+		!reader.read(&importedHeights[0], scale, offset, threads))
+	{
+		printf("Could not read heightmap %s\n", filename);
+		importedHeights.clear();
+		return false;
+	}
+	double seconds = ticksToSeconds(getTicks() - start);
+	double samples = (double)importedWidth * importedHeight;
+
+	printf("Imported %s, %dx%d samples, %.1f MB in %.3f s, %.1f MB/s, %.1f M samples/s\n", filename,
+		   importedWidth, importedHeight, reader.getFileSize() / 1048576.0, seconds,
+		   reader.getFileSize() / 1048576.0 / seconds, samples / 1.0e6 / seconds);
+
+	// the map becomes control heights whose surface passes through every sample
+	if (findOption(argc, argv, "-interpolate", false)) {
+		std::vector<float> controls(importedHeights.size());
+		start = getTicks();
+		SplineFit::interpolate(&importedHeights[0], &controls[0], importedWidth, importedHeight, threads);
+		seconds = ticksToSeconds(getTicks() - start);
+
+		float maxError = SplineFit::calcMaxError(&importedHeights[0], &controls[0], importedWidth, importedHeight);
+		printf("Interpolated in %.3f s, %.1f M samples/s, max error %.3e\n", seconds,
+			   samples / 1.0e6 / seconds, maxError);
+		importedHeights.swap(controls);
+	}
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Fits a control grid to scattered points and makes it the imported map. The points are
+//	read from a text file of "x y z" lines with z up, or N of them are generated at random
+//	positions on the generated terrain.
+//-------------------------------------------------------------------------------------------
+bool fitScatteredPoints(const char *source, int argc, char **argv, unsigned int seed)
+{
+	const char *opt;
+	int size = (opt = findOption(argc, argv, "-fitsize", true)) ? atoi(opt) : DEFAULT_FITSIZE;
+	float smoothing = (opt = findOption(argc, argv, "-smoothing", true)) ? (float)atof(opt) : FIT_SMOOTHING;
+	int threads = (opt = findOption(argc, argv, "-fthreads", true)) ? atoi(opt) : 0;
+	if (size < POINTSPERSIDE || smoothing < 0) return false;
+
+	FitGrid grid;
+	grid.width = grid.height = size;
+	std::vector<Vector3> points;
+
+	if (source[0] >= '0' && source[0] <= '9') {
+		int numPoints = atoi(source);
+		float extent = (size - 3) * FITSPACING;
+		grid.originX = grid.originZ = 0;
+		grid.spacing = FITSPACING;
+
+		srand(seed);
+		points.resize(numPoints);
+		for (int p = 0; p < numPoints; p++) {
+			float x = extent * rand() / (float)RAND_MAX, z = extent * rand() / (float)RAND_MAX;
+			int ix = (int)x, iz = (int)z;
+			float fx = x - ix, fz = z - iz;
+			float h0 = generateHeight(ix, iz, &seed), h1 = generateHeight(ix + 1, iz, &seed);
+			float h2 = generateHeight(ix, iz + 1, &seed), h3 = generateHeight(ix + 1, iz + 1, &seed);
+			points[p].assign(x, (h0 * (1-fx) + h1 * fx) * (1-fz) + (h2 * (1-fx) + h3 * fx) * fz, z);
+		}
+	} else {
+		FILE *f = fopen(source, "r");
+		if (!f) {
+			printf("Could not open %s\n", source);
+			return false;
+		}
+		char line[256];
+		float minX = 0, maxX = 0, minZ = 0, maxZ = 0;
+		while (fgets(line, sizeof(line), f)) {
+			float x, y, z;
+			if (line[0] == '#' || sscanf(line, "%f %f %f", &x, &y, &z) != 3) continue;
+			if (points.empty() || x < minX) minX = x;
+			if (points.empty() || x > maxX) maxX = x;
+			if (points.empty() || y < minZ) minZ = y;
+			if (points.empty() || y > maxZ) maxZ = y;
+			points.push_back(Vector3(x, z, y));
+		}
+		fclose(f);
+
+		grid.originX = minX;
+		grid.originZ = minZ;
+		grid.spacing = ((maxX - minX > maxZ - minZ) ? maxX - minX : maxZ - minZ) / (size - 3);
+		if (grid.spacing <= 0) grid.spacing = 1.0f;
+	}
+
+	FitStats stats;
+	std::vector<float> controls;
+	if (points.empty() || !ScatteredFit::fit(&points[0], (int)points.size(), grid, controls, stats, smoothing, threads)) {
+		printf("Could not fit the points of %s\n", source);
+		return false;
+	}
+
+	float rms, maxError;
+	ScatteredFit::calcError(&controls[0], grid, &points[0], (int)points.size(), rms, maxError);
+	printf("Fitted %d points to %dx%d controls on %d grids, assembly %.3f s, solve %.3f s\n",
+		   (int)points.size(), size, size, stats.levels, stats.assembleSeconds, stats.solveSeconds);
+	printf("%d iterations on the finest grid, %d in all, residual %.2e, rms error %.4f, max error %.4f, %d points outside\n",
+		   stats.iterations, stats.totalIterations, stats.residual, rms, maxError, stats.pointsOutside);
+
+	importedHeights.swap(controls);
+	importedWidth = importedHeight = size;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Splits the imported map into a hierarchy of detail levels, or loads one, and makes the
+//	levels asked for the imported map. Reports the size of the detail and the cost of a
+//	height query summed over more and more levels.
+//-------------------------------------------------------------------------------------------
+bool useHierarchy(int argc, char **argv, unsigned int seed)
+{
+	const char *opt;
+	int useLevels = (opt = findOption(argc, argv, "-hlevels", true)) ? atoi(opt) : 0;
+	const char *loadFile = findOption(argc, argv, "-loadhier", true);
+	SplineHierarchy hierarchy;
+
+	if (loadFile) {
+		int64 start = getTicks();
+		if (!hierarchy.load(loadFile, useLevels)) {
+			printf("Could not load %s\n", loadFile);
+			return false;
+		}
+		printf("Loaded %d levels of %s in %.3f s\n", hierarchy.getNumLevels(), loadFile,
+			   ticksToSeconds(getTicks() - start));
+	} else {
+		if (importedHeights.empty()) {
+			printf("-hierarchy needs -import or -scatterfit\n");
+			return false;
+		}
+		int64 start = getTicks();
+		hierarchy.build(&importedHeights[0], importedWidth, importedHeight);
+		printf("Built %d levels in %.3f s\n", hierarchy.getNumLevels(), ticksToSeconds(getTicks() - start));
+
+		std::vector<float> controls;
+		hierarchy.reconstruct(hierarchy.getNumLevels() - 1, controls);
+		float maxDiff = 0;
+		for (size_t c = 0; c < controls.size(); c++) {
+			float d = fabsf(controls[c] - importedHeights[c]);
+			if (d > maxDiff) maxDiff = d;
+		}
+		printf("Reconstruction max difference %.3e\n", maxDiff);
+
+		const char *saveFile = findOption(argc, argv, "-savehier", true);
+		if (saveFile && !hierarchy.save(saveFile)) {
+			printf("Could not write %s\n", saveFile);
+			return false;
+		}
+	}
+
+	int numLevels = hierarchy.getNumLevels();
+	int finest = numLevels - 1;
+	for (int l = 0; l < numLevels; l++) {
+		float rms, maxAbs;
+		hierarchy.calcLevelStats(l, rms, maxAbs);
+		printf("  level %d: %dx%d controls, %s rms %.4f, max %.4f\n", l, hierarchy.getWidth(l),
+			   hierarchy.getHeight(l), (l == 0) ? "height" : "detail", rms, maxAbs);
+	}
+
+	// random queries over the finest level, summing 1 to all levels
+	const int numQueries = 1000000;
+	std::vector<float> qx(numQueries), qz(numQueries);
+	float extentX = (float)(hierarchy.getWidth(finest) - 3), extentZ = (float)(hierarchy.getHeight(finest) - 3);
+	srand(seed);
+	for (int q = 0; q < numQueries; q++) {
+		qx[q] = extentX * rand() / (float)RAND_MAX;
+		qz[q] = extentZ * rand() / (float)RAND_MAX;
+	}
+	for (int l = 0; l < numLevels; l++) {
+		float sum = 0;
+		int64 start = getTicks();
+		for (int q = 0; q < numQueries; q++) sum += hierarchy.getHeight(qx[q], qz[q], l);
+		double seconds = ticksToSeconds(getTicks() - start);
+		printf("  %d levels: %.1f ns per height query (sum %.1f)\n", l + 1, seconds * 1.0e9 / numQueries, sum);
+	}
+
+	int level = (useLevels > 0 && useLevels < numLevels) ? useLevels - 1 : finest;
+	hierarchy.reconstruct(level, importedHeights);
+	importedWidth = hierarchy.getWidth(level);
+	importedHeight = hierarchy.getHeight(level);
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Evaluates every derivative layer of the imported controls, reports the throughput and
+//	the range of slope and curvature, and checks the tiled evaluation against single points
+//-------------------------------------------------------------------------------------------
+bool calcDerivativeMaps(int argc, char **argv, unsigned int seed)
+{
+	if (importedHeights.empty()) {
+		printf("-derivatives needs -import, -scatterfit or -loadhier\n");
+		return false;
+	}
+
+	const char *opt;
+	DerivativeSurface surface;
+	surface.controls = &importedHeights[0];
+	surface.width = importedWidth;
+	surface.height = importedHeight;
+	surface.spacing = HORZSCALE;
+	surface.samplesPerKnot = (opt = findOption(argc, argv, "-dsamples", true)) ? atoi(opt) : 1;
+	int threads = (opt = findOption(argc, argv, "-dthreads", true)) ? atoi(opt) : 0;
+
+	DerivativeMaps maps;
+	int64 start = getTicks();
+	if (!SurfaceDerivatives::calcMaps(surface, DERIV_ALL, maps, threads)) {
+		printf("Could not evaluate the derivatives\n");
+		return false;
+	}
+	double seconds = ticksToSeconds(getTicks() - start);
+	double samples = (double)maps.width * maps.height;
+	printf("Derivatives of %dx%d samples in %.3f s, %.1f M samples/s\n", maps.width, maps.height,
+		   seconds, samples / 1.0e6 / seconds);
+
+	float maxSlope = 0, minMean = 0, maxMean = 0, minGaussian = 0, maxGaussian = 0;
+	for (size_t i = 0; i < maps.mean.size(); i++) {
+		float slope = maps.dx[i] * maps.dx[i] + maps.dz[i] * maps.dz[i];
+		if (slope > maxSlope) maxSlope = slope;
+		if (i == 0 || maps.mean[i] < minMean) minMean = maps.mean[i];
+		if (i == 0 || maps.mean[i] > maxMean) maxMean = maps.mean[i];
+		if (i == 0 || maps.gaussian[i] < minGaussian) minGaussian = maps.gaussian[i];
+		if (i == 0 || maps.gaussian[i] > maxGaussian) maxGaussian = maps.gaussian[i];
+	}
+	printf("Steepest slope %.1f degrees, mean curvature %.4f to %.4f, Gaussian %.4f to %.4f\n",
+		   atanf(sqrtf(maxSlope)) * 57.29578f, minMean, maxMean, minGaussian, maxGaussian);
+
+	// the tiles against single points at random samples, and at every sample of the last row
+	// and column where the edge tiles can be narrower than samplesPerKnot
+	float maxDiff = 0;
+	srand(seed);
+	for (int q = 0; q < 10000 + maps.width + maps.height; q++) {
+		int x, z;
+		if (q < 10000) {
+			x = rand() % maps.width;
+			z = rand() % maps.height;
+		} else if (q < 10000 + maps.width) {
+			x = q - 10000;
+			z = maps.height - 1;
+		} else {
+			x = maps.width - 1;
+			z = q - 10000 - maps.width;
+		}
+		size_t i = (size_t)z * maps.width + x;
+		SurfacePoint p;
+		SurfaceDerivatives::calcPoint(surface, (float)x / surface.samplesPerKnot,
+									  (float)z / surface.samplesPerKnot, p);
+		float d[6] = { p.height - maps.heights[i], p.dx - maps.dx[i], p.dz - maps.dz[i],
+					   p.dxx - maps.dxx[i], p.dzz - maps.dzz[i], p.mean - maps.mean[i] };
+		for (int k = 0; k < 6; k++) if (fabsf(d[k]) > maxDiff) maxDiff = fabsf(d[k]);
+	}
+	printf("Largest difference from single points %.3e\n", maxDiff);
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Classifies the imported controls into a raster file, reads it back and reports the share
+//	of each slope class and landform
+//-------------------------------------------------------------------------------------------
+bool classifySurface(const char *filename, int argc, char **argv)
+{
+	if (importedHeights.empty()) {
+		printf("-classify needs -import, -scatterfit or -loadhier\n");
+		return false;
+	}
+
+	const char *opt;
+	ClassifySettings settings;
+	settings.setDefaults();
+	if ((opt = findOption(argc, argv, "-csamples", true))) settings.samplesPerKnot = atoi(opt);
+	int threads = (opt = findOption(argc, argv, "-cthreads", true)) ? atoi(opt) : 0;
+
+	TerrainClassMap classes;
+	int64 start = getTicks();
+	if (!classes.build(&importedHeights[0], importedWidth, importedHeight, HORZSCALE, settings, threads)) {
+		printf("Could not classify the surface\n");
+		return false;
+	}
+	double seconds = ticksToSeconds(getTicks() - start);
+	double texels = (double)classes.getWidth() * classes.getHeight();
+	printf("Classified %dx%d texels in %.3f s, %.1f M texels/s\n", classes.getWidth(), classes.getHeight(),
+		   seconds, texels / 1.0e6 / seconds);
+
+	if (!classes.save(filename) || !classes.open(filename)) {
+		printf("Could not write %s\n", filename);
+		return false;
+	}
+
+	// the slope and curvature of the texels against single points at random texels, and at
+	// every texel of the last row and column where the edge tiles can be narrower than
+	// samplesPerKnot
+	DerivativeSurface surface;
+	surface.controls = &importedHeights[0];
+	surface.width = importedWidth;
+	surface.height = importedHeight;
+	surface.spacing = HORZSCALE;
+	surface.samplesPerKnot = settings.samplesPerKnot;
+
+	int maxDiff = 0;
+	srand(12345);
+	for (int q = 0; q < 10000 + classes.getWidth() + classes.getHeight(); q++) {
+		int x, z;
+		if (q < 10000) {
+			x = rand() % classes.getWidth();
+			z = rand() % classes.getHeight();
+		} else if (q < 10000 + classes.getWidth()) {
+			x = q - 10000;
+			z = classes.getHeight() - 1;
+		} else {
+			x = classes.getWidth() - 1;
+			z = q - 10000 - classes.getWidth();
+		}
+		SurfacePoint p;
+		SurfaceDerivatives::calcPoint(surface, (float)x / surface.samplesPerKnot,
+									  (float)z / surface.samplesPerKnot, p);
+		float slope = atanf(sqrtf(p.dx * p.dx + p.dz * p.dz)) * (255.0f / 1.5707963f);
+		float curvature = 128.0f + p.mean * 127.0f / settings.curvatureScale;
+		curvature = (curvature < 0) ? 0.0f : (curvature > 255.0f) ? 255.0f : curvature;
+
+		const TerrainTexel &t = classes.getTexel(x, z);
+		int d0 = abs(t.slope - (int)(slope + 0.5f)), d1 = abs(t.curvature - (int)(curvature + 0.5f));
+		if (d0 > maxDiff) maxDiff = d0;
+		if (d1 > maxDiff) maxDiff = d1;
+	}
+	printf("Largest slope or curvature difference from single points %d steps\n", maxDiff);
+
+	static const char *slopeNames[SLOPE_CLASSES] = { "flat", "gentle", "steep", "cliff" };
+	static const char *landNames[LAND_CLASSES] = { "planar", "peak", "pit", "ridge", "valley",
+												   "saddle ridge", "saddle valley", "saddle" };
+	int64 slopeCounts[SLOPE_CLASSES], landCounts[LAND_CLASSES];
+	classes.countClasses(slopeCounts, landCounts);
+
+	printf("Raster %s written, slope", filename);
+	for (int c = 0; c < SLOPE_CLASSES; c++) printf(" %s %.1f%%", slopeNames[c], 100.0 * slopeCounts[c] / texels);
+	printf("\n  landform");
+	for (int c = 0; c < LAND_CLASSES; c++) printf(" %s %.1f%%", landNames[c], 100.0 * landCounts[c] / texels);
+	printf("\n");
+	return true;
+}
+
+
+int exportHeightMap(const char *filename, int argc, char **argv, unsigned int seed)
+{
+	const char *opt;
+	int size = (opt = findOption(argc, argv, "-hfsize", true)) ? atoi(opt) : DEFAULT_HFSIZE;
+	if (size <= 0) return -1;
+
+	// -6 to 6 maps to the full 16 bit range, the inverse of the default import scale
+	std::vector<ushort> samples((size_t)size * size);
+	for (int z = 0; z < size; z++) {
+		for (int x = 0; x < size; x++) {
+			float q = (generateHeight(x, z, &seed) + 6.0f) * (65535.0f / 12.0f) + 0.5f;
+			samples[(size_t)z * size + x] = (ushort)((q < 0) ? 0 : (q > 65535.0f) ? 65535.0f : q);
+		}
+	}
+
+	if (!HeightMapReader::write(filename, &samples[0], size, size)) {
+		printf("Could not write %s\n", filename);
+		return -1;
+	}
+	printf("Heightmap %s written, %dx%d samples\n", filename, size, size);
+	return 0;
+}
+
+
+int main(int argc, char **argv)
+{
+	if (findOption(argc, argv, "-help", false) || findOption(argc, argv, "-h", false)) {
+		printUsage();
+		return 0;
+	}
+
+	// Allocate the singleton classes in the correct order
+	Timer				timerInst;
+	Profiler			profilerInst;
+	LookupManager		lookupInst(80, TRIG_FULLTABLES, "trig.tbl");	// 1/80th of a degree, tables cached in trig.tbl
+
+	if (findOption(argc, argv, "-bench", false)) {
+		const char *benchFile = findOption(argc, argv, "-bench", true);
+		if (!benchFile) benchFile = "benchmark.txt";
+		bool ok = runBenchmarks(benchFile);
+		printf(ok ? "Benchmarks written to %s\n" : "Could not write %s\n", benchFile);
+		return ok ? 0 : -1;
+	}
+
+	if (findOption(argc, argv, "-meshstats", false)) {
+		printMeshStats();
+		return 0;
+	}
+
+	const char *opt;
+	int frames = (opt = findOption(argc, argv, "-frames", true)) ? atoi(opt) : DEFAULT_FRAMES;
+	unsigned int seed = (opt = findOption(argc, argv, "-seed", true)) ? (unsigned int)atoi(opt) : 1;
+
+	if (findOption(argc, argv, "-packstats", false)) {
+		printPackStats(seed);
+		return 0;
+	}
+	if (findOption(argc, argv, "-exportmap", false)) {
+		const char *mapFile = findOption(argc, argv, "-exportmap", true);
+		if (!mapFile) {
+			printUsage();
+			return -1;
+		}
+		return exportHeightMap(mapFile, argc, argv, seed);
+	}
+	const char *importFile = findOption(argc, argv, "-import", true);
+	if (importFile && !importHeightMap(importFile, argc, argv)) return -1;
+	const char *fitSource = findOption(argc, argv, "-scatterfit", true);
+	if (fitSource && !fitScatteredPoints(fitSource, argc, argv, seed)) return -1;
+	if ((findOption(argc, argv, "-hierarchy", false) || findOption(argc, argv, "-loadhier", false)) &&
+		!useHierarchy(argc, argv, seed)) return -1;
+	if (findOption(argc, argv, "-derivatives", false) && !calcDerivativeMaps(argc, argv, seed)) return -1;
+	const char *classFile = findOption(argc, argv, "-classify", true);
+	if (classFile && !classifySurface(classFile, argc, argv)) return -1;
+
+	if (findOption(argc, argv, "-writehf", false)) {
+		const char *hfFile = findOption(argc, argv, "-writehf", true);
+		if (!hfFile) {
+			printUsage();
+			return -1;
+		}
+		return writeHeightField(hfFile, argc, argv, seed);
+	}
+	int regen = (opt = findOption(argc, argv, "-regen", true)) ? atoi(opt) : 0;
+	const char *traceFile = findOption(argc, argv, "-trace", true);
+	const char *csvFile = findOption(argc, argv, "-csv", true);
+	const char *imageFile = findOption(argc, argv, "-image", true);
+	packedBits = (opt = findOption(argc, argv, "-packed", true)) ? atoi(opt) : 0;
+	bool raster = (imageFile || packedBits || findOption(argc, argv, "-raster", false));
+	if (findOption(argc, argv, "-strips", false)) meshFlags |= MESH_STRIP;
+	if (findOption(argc, argv, "-optimize", false)) meshFlags |= MESH_OPTIMIZE;
+
+	int width = (opt = findOption(argc, argv, "-width", true)) ? atoi(opt) : DEFAULT_WIDTH;
+	int height = (opt = findOption(argc, argv, "-height", true)) ? atoi(opt) : DEFAULT_HEIGHT;
+	int rasterThreads = (opt = findOption(argc, argv, "-rthreads", true)) ? atoi(opt) : 0;
+
+	if (frames <= 0 || width <= 0 || height <= 0 || (packedBits != 0 && packedBits != 8 && packedBits != 16)) {
+		printUsage();
+		return -1;
+	}
+
+	// Set up the timer
+	timer.initTimer();
+
+	// set up scene, the heights are seeded so runs can be compared
+	const char *hfFile = findOption(argc, argv, "-heightfield", true);
+	if (hfFile) {
+		if (!heightField.open(hfFile)) {
+			printf("Could not open heightfield %s\n", hfFile);
+			return -1;
+		}
+		printf("Heightfield %s, %dx%d samples in %dx%d tiles of %d, %.1f MB\n", hfFile,
+			   heightField.getWidth(), heightField.getHeight(), heightField.getTilesX(),
+			   heightField.getTilesZ(), heightField.getTileSize(), heightField.getFileSize() / 1048576.0);
+		if ((opt = findOption(argc, argv, "-hfquery", true))) queryHeightField(atoi(opt), seed);
+
+		// the cache is filled around the first window before the first frame
+		if ((opt = findOption(argc, argv, "-tilecache", true))) {
+			int radius = TILECACHE_RADIUS;
+			const char *radiusOpt = findOption(argc, argv, "-tileradius", true);
+			if (radiusOpt) radius = atoi(radiusOpt);
+			if (!tileCache.open(heightField, (int64)(atof(opt) * 1048576.0), radius)) {
+				printf("Could not start the tile cache, it needs a positive budget, a radius of 0 or more and tiles "
+					   "of at least %d samples\n", TILECACHE_MINTILESIZE);
+				return -1;
+			}
+			tileCache.update(windowX + POINTSPERSIDE/2, windowZ + POINTSPERSIDE/2);
+			tileCache.waitIdle();
+			tileCache.update(windowX + POINTSPERSIDE/2, windowZ + POINTSPERSIDE/2);
+		}
+		loadWindow();
+	} else if (!importedHeights.empty()) {
+		loadWindow();
+	} else {
+		initSurfacePoints(seed);
+	}
+	spinRequested = (findOption(argc, argv, "-nospin", false) == 0);
+
+	// the software rasterizer looks down on the surface, Win32 starts level and uses the mouse
+	if (raster) {
+		frameBuffer = new FrameBuffer(width, height);
+		rasterizer = new SoftRasterizer(rasterThreads);
+		rasterizer->setTarget(frameBuffer);
+		rasterizer->setLight(Vector3(0.5f, 1.0f, 0.3f), 0.25f);
+		rasterizer->setColor(0.45f, 0.7f, 0.3f);
+		projection.setPerspective(45.0f * DEGTORAD, (float)width / (float)height, 0.01f, 1000.0f);
+		viewOrientation = Quaternion(Vector3(1,0,0), 35.0f * DEGTORAD);
+	}
+
+	// The scene is simulated in fixed 60Hz steps, the same as under Win32
+	LoopScheduler loop(updateScene, syncScene, raster ? renderRaster : renderHeadless, 1.0 / 60.0);
+	if (findOption(argc, argv, "-threaded", false)) loop.setThreaded(true);
+	if ((opt = findOption(argc, argv, "-fpscap", true))) loop.setFrameCap((float)atof(opt));
+
+	int64 start = getTicks();
+
+	for (int f = 0; f < frames; f++) {
+		timer.calcTimeFix();
+
+		profiler.beginFrame();
+
+		if (regen > 0 && f > 0 && f % regen == 0) {
+			if (heightField.isOpen() || !importedHeights.empty()) advanceWindow();
+			else initSurfacePoints(seed + f);
+		}
+
+		// the window is retried every frame until its tiles are in
+		if (tileCache.isOpen()) {
+			tileCache.update(windowX + POINTSPERSIDE/2, windowZ + POINTSPERSIDE/2);
+			if (!windowLoaded) loadWindow();
+			if (!windowLoaded) staleFrames++;
+		}
+
+		loop.frame();
+
+		timer.calcFPS();
+
+		profiler.endFrame();
+	}
+
+	double seconds = ticksToSeconds(getTicks() - start);
+
+	// stop the update thread before reading its count
+	bool threaded = loop.isThreaded();
+	loop.setThreaded(false);
+
+	printReport(frames, seconds, loop.getUpdateCount(), threaded);
+
+	if (traceFile) {
+		if (profiler.writeChromeTrace(traceFile)) printf("\nTrace written to %s\n", traceFile);
+		else printf("\nCould not write %s\n", traceFile);
+	}
+	if (csvFile) {
+		if (timer.writeFrameTimesCSV(csvFile)) printf("Frame times written to %s\n", csvFile);
+		else printf("Could not write %s\n", csvFile);
+	}
+	if (imageFile) {
+		if (frameBuffer->writeImage(imageFile)) printf("Image written to %s\n", imageFile);
+		else printf("Could not write %s\n", imageFile);
+	}
+
+	delete rasterizer;
+	delete frameBuffer;
+	tileCache.close();
+
+	return 0;
+}
@@ -8,8 +8,8 @@
 //					curve, and Bezier surface
 //	--------------------------------------------------------------------------------
 
-#include "bezier.h"
-#include "vector3.h"
+#include "Bezier.h"
+#include "Vector3.h"
 
 
 /*-----------------
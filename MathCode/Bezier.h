@@ -11,14 +11,13 @@
 #ifndef BEZIER_H
 #define BEZIER_H
 
-//#include "matrix4x4.h"
+//#include "Matrix4x4.h"
+#include "MathTypes.h"
 
 /*------------------
 ---- STRUCTURES ----
 ------------------*/
 
-class Vector3;
-//class Vector4;
 
 
 class BezierCurve {
@@ -0,0 +1,45 @@
+//	----==== MATHTYPES.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Forward declarations of the math class templates and the typedefs
+//					for their float and double instantiations. Include this instead of
+//					forward declaring a class, since the vector and matrix types are
+//					templates on their scalar type. The float types keep their original
+//					names, the double types are used for large world coordinates.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef MATHTYPES_H
+#define MATHTYPES_H
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+template <class T> class Vector2T;
+template <class T> class Vector3T;
+template <class T> class Vector4T;
+template <class T> class Matrix4x4T;
+template <class T> class QuaternionT;
+
+
+/*----------------
+---- TYPEDEFS ----
+----------------*/
+
+typedef Vector2T<float>			Vector2;
+typedef Vector3T<float>			Vector3;
+typedef Vector4T<float>			Vector4;
+typedef Matrix4x4T<float>		Matrix4x4;
+typedef QuaternionT<float>		Quaternion;
+
+typedef Vector2T<double>		Vector2d;
+typedef Vector3T<double>		Vector3d;
+typedef Vector4T<double>		Vector4d;
+typedef Matrix4x4T<double>		Matrix4x4d;
+typedef QuaternionT<double>		Quaterniond;
+
+#endif
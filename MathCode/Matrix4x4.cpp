@@ -9,20 +9,21 @@
 //----------------------------------------------------------------------------------------
 
 
-#include <math.h>
-#include "matrix4x4.h"
-#include "vector3.h"
-#include "vector4.h"
-#include "..\UTILITYCODE\msgassert.h"
-#include "..\UTILITYCODE\lookupmanager.h"
+#include <cmath>
+#include "Matrix4x4.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "../UtilityCode/MsgAssert.h"
+#include "../UtilityCode/LookupManager.h"
 
 /*-----------------
 ---- FUNCTIONS ----
 -----------------*/
 
-////////// class Matrix4x4 //////////
+////////// class Matrix4x4T //////////
 
-void Matrix4x4::operator *=(const Vector4 &v)
+template <class T>
+void Matrix4x4T<T>::operator *=(const Vector4T<T> &v)
 {
 	i[0]  *= v.x; i[1]  *= v.y; i[2]  *= v.z; i[3]  *= v.w;
 	i[4]  *= v.x; i[5]  *= v.y; i[6]  *= v.z; i[7]  *= v.w;
@@ -30,7 +31,8 @@ void Matrix4x4::operator *=(const Vector4 &v)
 	i[12] *= v.x; i[13] *= v.y; i[14] *= v.z; i[15] *= v.w;
 }
 
-void Matrix4x4::set(const Vector4 &r1, const Vector4 &r2, const Vector4 &r3, const Vector4 &r4)
+template <class T>
+void Matrix4x4T<T>::set(const Vector4T<T> &r1, const Vector4T<T> &r2, const Vector4T<T> &r3, const Vector4T<T> &r4)
 {
 	i[0]  = r1.x; i[1]  = r1.y; i[2]  = r1.z; i[3]  = r1.w;
 	i[4]  = r2.x; i[5]  = r2.y; i[6]  = r2.z; i[7]  = r2.w;
@@ -39,11 +41,12 @@ void Matrix4x4::set(const Vector4 &r1, const Vector4 &r2, const Vector4 &r3, con
 }
 
 
-void Matrix4x4::setRotation(float h, float p, float b)
+template <class T>
+void Matrix4x4T<T>::setRotation(T h, T p, T b)
 {
-	float sh = sinf(h); float ch = cosf(h);
-	float sp = sinf(p); float cp = cosf(p);
-	float sb = sinf(b); float cb = cosf(b);
+	T sh = std::sin(h); T ch = std::cos(h);
+	T sp = std::sin(p); T cp = std::cos(p);
+	T sb = std::sin(b); T cb = std::cos(b);
 	
 	i[0] = ch * cb + sh * sp * sb;
 	i[1] = -ch * sb + sh * sp * cb;
@@ -61,42 +64,46 @@ void Matrix4x4::setRotation(float h, float p, float b)
 }
 
 
-void Matrix4x4::rotateX(float a)
+template <class T>
+void Matrix4x4T<T>::rotateX(T a)
 {
-	i[5] = cosf(a);
-	i[6] = sinf(a);
+	i[5] = std::cos(a);
+	i[6] = std::sin(a);
 	i[9] = -i[6];	
 	i[10] = i[5];
 }
 
 
-void Matrix4x4::rotateY(float a)
+template <class T>
+void Matrix4x4T<T>::rotateY(T a)
 {
-	i[0] = cosf(a);
-	i[8] = sinf(a);
+	i[0] = std::cos(a);
+	i[8] = std::sin(a);
 	i[2] = -i[8];	
 	i[10] = i[0];
 }
 
 
-void Matrix4x4::rotateZ(float a)
+template <class T>
+void Matrix4x4T<T>::rotateZ(T a)
 {
-	i[0] = cosf(a);
-	i[1] = sinf(a);
+	i[0] = std::cos(a);
+	i[1] = std::sin(a);
 	i[4] = -i[1];	
 	i[5] = i[0];
 }
 
 
-void Matrix4x4::setRotation(int h, int p, int b)
+template <class T>
+void Matrix4x4T<T>::setRotation(int h, int p, int b)
 {
 	assert(h >= 0 && h < math.ANGLE360);
 	assert(p >= 0 && p < math.ANGLE360);
 	assert(b >= 0 && b < math.ANGLE360);
 
-	float sh = math.getSin(h); float ch = math.getCos(h);
-	float sp = math.getSin(p); float cp = math.getCos(p);
-	float sb = math.getSin(b); float cb = math.getCos(b);
+	T sh = math.getSin(h); T ch = math.getCos(h);
+	T sp = math.getSin(p); T cp = math.getCos(p);
+	T sb = math.getSin(b); T cb = math.getCos(b);
 	
 	i[0] = ch * cb + sh * sp * sb;
 	i[1] = -ch * sb + sh * sp * cb;
@@ -114,7 +121,8 @@ void Matrix4x4::setRotation(int h, int p, int b)
 }
 
 
-void Matrix4x4::rotateX(int a)
+template <class T>
+void Matrix4x4T<T>::rotateX(int a)
 {
 	assert(a >= 0 && a < math.ANGLE360);
 
@@ -125,7 +133,8 @@ void Matrix4x4::rotateX(int a)
 }
 
 
-void Matrix4x4::rotateY(int a)
+template <class T>
+void Matrix4x4T<T>::rotateY(int a)
 {
 	assert(a >= 0 && a < math.ANGLE360);
 
@@ -136,7 +145,8 @@ void Matrix4x4::rotateY(int a)
 }
 
 
-void Matrix4x4::rotateZ(int a)
+template <class T>
+void Matrix4x4T<T>::rotateZ(int a)
 {
 	assert(a >= 0 && a < math.ANGLE360);
 
@@ -147,19 +157,240 @@ void Matrix4x4::rotateZ(int a)
 }
 
 
+template <class T>
+void Matrix4x4T<T>::setRotation(BinAngle h, BinAngle p, BinAngle b)
+{
+	float fsh, fch, fsp, fcp, fsb, fcb;
+	h.sinCos(fsh, fch);
+	p.sinCos(fsp, fcp);
+	b.sinCos(fsb, fcb);
+
+	T sh = fsh; T ch = fch;
+	T sp = fsp; T cp = fcp;
+	T sb = fsb; T cb = fcb;
+
+	i[0] = ch * cb + sh * sp * sb;
+	i[1] = -ch * sb + sh * sp * cb;
+	i[2] = sh * cp;
+
+	i[4] = sb * cp;
+	i[5] = cb * cp;
+	i[6] = -sp;
+
+	i[8] = -sh * cb + ch * sp * sb;
+	i[9] = sb * sh + ch * sp * cb;
+	i[10] = ch * cp;
+
+	i[12] = i[13] = i[14] = 0;
+}
+
+
+template <class T>
+void Matrix4x4T<T>::rotateX(BinAngle a)
+{
+	i[5] = a.cos();
+	i[6] = a.sin();
+	i[9] = -i[6];
+	i[10] = i[5];
+}
+
+
+template <class T>
+void Matrix4x4T<T>::rotateY(BinAngle a)
+{
+	i[0] = a.cos();
+	i[8] = a.sin();
+	i[2] = -i[8];
+	i[10] = i[0];
+}
+
+
+template <class T>
+void Matrix4x4T<T>::rotateZ(BinAngle a)
+{
+	i[0] = a.cos();
+	i[1] = a.sin();
+	i[4] = -i[1];
+	i[5] = i[0];
+}
+
+
 // get transpose of matrix, usually used for giving to OpenGL
-Matrix4x4 Matrix4x4::getTranspose(void) const
+template <class T>
+Matrix4x4T<T> Matrix4x4T<T>::getTranspose(void) const
+{
+	Vector4T<T> r1(i[0], i[4], i[8],  i[12]);
+	Vector4T<T> r2(i[1], i[5], i[9],  i[13]);
+	Vector4T<T> r3(i[2], i[6], i[10], i[14]);
+	Vector4T<T> r4(i[3], i[7], i[11], i[15]);
+
+	return Matrix4x4T<T>(r1, r2, r3, r4);
+}
+
+
+//----------------------------------------------------------------------------------------
+//	The 2x2 determinants of the top two rows (s) and the bottom two rows (c) are shared by
+//	the determinant and all of the cofactors, so they are only calculated once
+//----------------------------------------------------------------------------------------
+template <class T>
+bool Matrix4x4T<T>::inverse(const Matrix4x4T<T> &m)
+{
+	const T *a = m.i;
+
+	T s0 = a[0]*a[5] - a[4]*a[1];
+	T s1 = a[0]*a[6] - a[4]*a[2];
+	T s2 = a[0]*a[7] - a[4]*a[3];
+	T s3 = a[1]*a[6] - a[5]*a[2];
+	T s4 = a[1]*a[7] - a[5]*a[3];
+	T s5 = a[2]*a[7] - a[6]*a[3];
+
+	T c5 = a[10]*a[15] - a[14]*a[11];
+	T c4 = a[9]*a[15]  - a[13]*a[11];
+	T c3 = a[9]*a[14]  - a[13]*a[10];
+	T c2 = a[8]*a[15]  - a[12]*a[11];
+	T c1 = a[8]*a[14]  - a[12]*a[10];
+	T c0 = a[8]*a[13]  - a[12]*a[9];
+
+	T det = s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+	if (det == 0) return false;
+	det = T(1) / det;
+
+	T b[16];
+	b[0]  = ( a[5]*c5  - a[6]*c4  + a[7]*c3)  * det;
+	b[1]  = (-a[1]*c5  + a[2]*c4  - a[3]*c3)  * det;
+	b[2]  = ( a[13]*s5 - a[14]*s4 + a[15]*s3) * det;
+	b[3]  = (-a[9]*s5  + a[10]*s4 - a[11]*s3) * det;
+
+	b[4]  = (-a[4]*c5  + a[6]*c2  - a[7]*c1)  * det;
+	b[5]  = ( a[0]*c5  - a[2]*c2  + a[3]*c1)  * det;
+	b[6]  = (-a[12]*s5 + a[14]*s2 - a[15]*s1) * det;
+	b[7]  = ( a[8]*s5  - a[10]*s2 + a[11]*s1) * det;
+
+	b[8]  = ( a[4]*c4  - a[5]*c2  + a[7]*c0)  * det;
+	b[9]  = (-a[0]*c4  + a[1]*c2  - a[3]*c0)  * det;
+	b[10] = ( a[12]*s4 - a[13]*s2 + a[15]*s0) * det;
+	b[11] = (-a[8]*s4  + a[9]*s2  - a[11]*s0) * det;
+
+	b[12] = (-a[4]*c3  + a[5]*c1  - a[6]*c0)  * det;
+	b[13] = ( a[0]*c3  - a[1]*c1  + a[2]*c0)  * det;
+	b[14] = (-a[12]*s3 + a[13]*s1 - a[14]*s0) * det;
+	b[15] = ( a[8]*s3  - a[9]*s1  + a[10]*s0) * det;
+
+	for (int c = 0; c < 16; c++) i[c] = b[c];
+	return true;
+}
+
+
+template <class T>
+T Matrix4x4T<T>::getDeterminant(void) const
+{
+	return	(i[0]*i[5] - i[4]*i[1]) * (i[10]*i[15] - i[14]*i[11]) -
+			(i[0]*i[6] - i[4]*i[2]) * (i[9]*i[15]  - i[13]*i[11]) +
+			(i[0]*i[7] - i[4]*i[3]) * (i[9]*i[14]  - i[13]*i[10]) +
+			(i[1]*i[6] - i[5]*i[2]) * (i[8]*i[15]  - i[12]*i[11]) -
+			(i[1]*i[7] - i[5]*i[3]) * (i[8]*i[14]  - i[12]*i[10]) +
+			(i[2]*i[7] - i[6]*i[3]) * (i[8]*i[13]  - i[12]*i[9]);
+}
+
+
+//----------------------------------------------------------------------------------------
+//	For the 3x3 portion with rows a, b, c the inverse has the columns bxc, cxa and axb
+//	divided by the determinant a.(bxc). The translation row t becomes -t * inverse(3x3).
+//----------------------------------------------------------------------------------------
+template <class T>
+bool Matrix4x4T<T>::affineInverse(const Matrix4x4T<T> &m)
+{
+	Vector3T<T> a(m.i[0], m.i[1], m.i[2]);
+	Vector3T<T> b(m.i[4], m.i[5], m.i[6]);
+	Vector3T<T> c(m.i[8], m.i[9], m.i[10]);
+	Vector3T<T> t(m.i[12], m.i[13], m.i[14]);
+	Vector3T<T> bc, ca, ab;
+
+	bc.crossProduct(b, c);
+	ca.crossProduct(c, a);
+	ab.crossProduct(a, b);
+
+	T det = a * bc;
+	if (det == 0) return false;
+	det = T(1) / det;
+
+	i[0] = bc.x * det; i[1] = ca.x * det; i[2]  = ab.x * det; i[3]  = 0;
+	i[4] = bc.y * det; i[5] = ca.y * det; i[6]  = ab.y * det; i[7]  = 0;
+	i[8] = bc.z * det; i[9] = ca.z * det; i[10] = ab.z * det; i[11] = 0;
+
+	i[12] = -(t.x*i[0] + t.y*i[4] + t.z*i[8]);
+	i[13] = -(t.x*i[1] + t.y*i[5] + t.z*i[9]);
+	i[14] = -(t.x*i[2] + t.y*i[6] + t.z*i[10]);
+	i[15] = 1;
+
+	return true;
+}
+
+
+// the inverse of a rotation is its transpose, so only the translation needs calculating
+template <class T>
+void Matrix4x4T<T>::orthonormalInverse(const Matrix4x4T<T> &m)
+{
+	T r[9] = {	m.i[0], m.i[1], m.i[2],
+				m.i[4], m.i[5], m.i[6],
+				m.i[8], m.i[9], m.i[10] };
+	T tx = m.i[12], ty = m.i[13], tz = m.i[14];
+
+	i[0] = r[0]; i[1] = r[3]; i[2]  = r[6]; i[3]  = 0;
+	i[4] = r[1]; i[5] = r[4]; i[6]  = r[7]; i[7]  = 0;
+	i[8] = r[2]; i[9] = r[5]; i[10] = r[8]; i[11] = 0;
+
+	i[12] = -(tx*r[0] + ty*r[1] + tz*r[2]);
+	i[13] = -(tx*r[3] + ty*r[4] + tz*r[5]);
+	i[14] = -(tx*r[6] + ty*r[7] + tz*r[8]);
+	i[15] = 1;
+}
+
+
+// the transpose of the inverse 3x3 simply has the rows bxc, cxa and axb (see affineInverse)
+template <class T>
+bool Matrix4x4T<T>::normalMatrix(const Matrix4x4T<T> &m)
+{
+	Vector3T<T> a(m.i[0], m.i[1], m.i[2]);
+	Vector3T<T> b(m.i[4], m.i[5], m.i[6]);
+	Vector3T<T> c(m.i[8], m.i[9], m.i[10]);
+	Vector3T<T> bc, ca, ab;
+
+	bc.crossProduct(b, c);
+	ca.crossProduct(c, a);
+	ab.crossProduct(a, b);
+
+	T det = a * bc;
+	if (det == 0) return false;
+	det = T(1) / det;
+
+	i[0]  = bc.x * det; i[1]  = bc.y * det; i[2]  = bc.z * det; i[3]  = 0;
+	i[4]  = ca.x * det; i[5]  = ca.y * det; i[6]  = ca.z * det; i[7]  = 0;
+	i[8]  = ab.x * det; i[9]  = ab.y * det; i[10] = ab.z * det; i[11] = 0;
+	i[12] = 0;			i[13] = 0;			i[14] = 0;			i[15] = 1;
+
+	return true;
+}
+
+
+// the transpose of the gluPerspective matrix, since vectors are rows here
+template <class T>
+void Matrix4x4T<T>::setPerspective(T fovY, T aspect, T zNear, T zFar)
 {
-	Vector4 r1(i[0], i[4], i[8],  i[12]);
-	Vector4 r2(i[1], i[5], i[9],  i[13]);
-	Vector4 r3(i[2], i[6], i[10], i[14]);
-	Vector4 r4(i[3], i[7], i[11], i[15]);
+	assert(aspect != 0 && zNear != zFar);
+
+	T f = T(1) / (T)tan(fovY * T(0.5));
+	T nf = T(1) / (zNear - zFar);
 
-	return Matrix4x4(r1, r2, r3, r4);
+	i[0]  = f / aspect;	i[1]  = 0;	i[2]  = 0;						i[3]  = 0;
+	i[4]  = 0;			i[5]  = f;	i[6]  = 0;						i[7]  = 0;
+	i[8]  = 0;			i[9]  = 0;	i[10] = (zFar + zNear) * nf;	i[11] = -1;
+	i[12] = 0;			i[13] = 0;	i[14] = 2 * zFar * zNear * nf;	i[15] = 0;
 }
 
 
-Matrix4x4::Matrix4x4(const Vector4 &r1, const Vector4 &r2, const Vector4 &r3, const Vector4 &r4)
+template <class T>
+Matrix4x4T<T>::Matrix4x4T(const Vector4T<T> &r1, const Vector4T<T> &r2, const Vector4T<T> &r3, const Vector4T<T> &r4)
 {
 	i[0]  = r1.x; i[1]  = r1.y; i[2]  = r1.z; i[3]  = r1.w;
 	i[4]  = r2.x; i[5]  = r2.y; i[6]  = r2.z; i[7]  = r2.w;
@@ -168,9 +399,201 @@ Matrix4x4::Matrix4x4(const Vector4 &r1, const Vector4 &r2, const Vector4 &r3, co
 }
 
 
-Matrix4x4::Matrix4x4(const float *p, int l)
+template <class T>
+Matrix4x4T<T>::Matrix4x4T(const T *p, int l)
 {
 	assert(p && l > 0 && l < 16);
 
 	for (int c = 0; c < l; c++) i[c] = p[c];
-}
\ No newline at end of file
+}
+
+
+#if defined(USE_SSE)
+
+template <>
+Matrix4x4T<float> Matrix4x4T<float>::getTranspose(void) const
+{
+	Matrix4x4T<float> m;
+
+	__m128 r0 = _mm_load_ps(&i[0]);
+	__m128 r1 = _mm_load_ps(&i[4]);
+	__m128 r2 = _mm_load_ps(&i[8]);
+	__m128 r3 = _mm_load_ps(&i[12]);
+
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	_mm_store_ps(&m.i[0],  r0);
+	_mm_store_ps(&m.i[4],  r1);
+	_mm_store_ps(&m.i[8],  r2);
+	_mm_store_ps(&m.i[12], r3);
+
+	return m;
+}
+
+
+/*---- SSE helpers ----*/
+
+// cross product of the xyz lanes, w of the result is 0 when u.w and v.w are finite
+static __inline __m128 crossSSE(__m128 u, __m128 v)
+{
+	return _mm_sub_ps(
+		_mm_mul_ps(_mm_shuffle_ps(u,u,_MM_SHUFFLE(3,0,2,1)), _mm_shuffle_ps(v,v,_MM_SHUFFLE(3,1,0,2))),
+		_mm_mul_ps(_mm_shuffle_ps(u,u,_MM_SHUFFLE(3,1,0,2)), _mm_shuffle_ps(v,v,_MM_SHUFFLE(3,0,2,1))));
+}
+
+
+// sum of all four lanes, broadcast to every lane
+static __inline __m128 horizontalSumSSE(__m128 a)
+{
+	a = _mm_add_ps(a, _mm_shuffle_ps(a,a,_MM_SHUFFLE(2,3,0,1)));
+	return _mm_add_ps(a, _mm_shuffle_ps(a,a,_MM_SHUFFLE(1,0,3,2)));
+}
+
+
+// A 2x2 matrix is held in one register as | x y |
+//											| z w |
+static __inline __m128 mat2MulSSE(__m128 a, __m128 b)			// a * b
+{
+	return _mm_add_ps(	_mm_mul_ps(a, _mm_shuffle_ps(b,b,_MM_SHUFFLE(3,0,3,0))),
+						_mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(2,3,0,1)), _mm_shuffle_ps(b,b,_MM_SHUFFLE(1,2,1,2))));
+}
+
+
+static __inline __m128 mat2AdjMulSSE(__m128 a, __m128 b)		// adjugate(a) * b
+{
+	return _mm_sub_ps(	_mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(0,0,3,3)), b),
+						_mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(2,2,1,1)), _mm_shuffle_ps(b,b,_MM_SHUFFLE(1,0,3,2))));
+}
+
+
+static __inline __m128 mat2MulAdjSSE(__m128 a, __m128 b)		// a * adjugate(b)
+{
+	return _mm_sub_ps(	_mm_mul_ps(a, _mm_shuffle_ps(b,b,_MM_SHUFFLE(0,3,0,3))),
+						_mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(2,3,0,1)), _mm_shuffle_ps(b,b,_MM_SHUFFLE(1,2,1,2))));
+}
+
+
+//----------------------------------------------------------------------------------------
+//	Block inverse, the matrix is split into the 2x2 matrices	| A B |
+//																| C D |
+//	and the inverse is built from their adjugates and determinants, which needs far fewer
+//	multiplies than the cofactor expansion and keeps everything in registers.
+//----------------------------------------------------------------------------------------
+template <>
+bool Matrix4x4T<float>::inverse(const Matrix4x4T<float> &m)
+{
+	const __m128 r0 = _mm_load_ps(&m.i[0]);
+	const __m128 r1 = _mm_load_ps(&m.i[4]);
+	const __m128 r2 = _mm_load_ps(&m.i[8]);
+	const __m128 r3 = _mm_load_ps(&m.i[12]);
+
+	const __m128 A = _mm_movelh_ps(r0, r1);
+	const __m128 B = _mm_movehl_ps(r1, r0);
+	const __m128 C = _mm_movelh_ps(r2, r3);
+	const __m128 D = _mm_movehl_ps(r3, r2);
+
+	// determinants of A, B, C and D in one register
+	const __m128 detSub = _mm_sub_ps(
+		_mm_mul_ps(_mm_shuffle_ps(r0,r2,_MM_SHUFFLE(2,0,2,0)), _mm_shuffle_ps(r1,r3,_MM_SHUFFLE(3,1,3,1))),
+		_mm_mul_ps(_mm_shuffle_ps(r0,r2,_MM_SHUFFLE(3,1,3,1)), _mm_shuffle_ps(r1,r3,_MM_SHUFFLE(2,0,2,0))));
+	const __m128 detA = _mm_shuffle_ps(detSub,detSub,_MM_SHUFFLE(0,0,0,0));
+	const __m128 detB = _mm_shuffle_ps(detSub,detSub,_MM_SHUFFLE(1,1,1,1));
+	const __m128 detC = _mm_shuffle_ps(detSub,detSub,_MM_SHUFFLE(2,2,2,2));
+	const __m128 detD = _mm_shuffle_ps(detSub,detSub,_MM_SHUFFLE(3,3,3,3));
+
+	const __m128 DC = mat2AdjMulSSE(D, C);
+	const __m128 AB = mat2AdjMulSSE(A, B);
+
+	// adjugates of the four blocks of the inverse
+	__m128 X = _mm_sub_ps(_mm_mul_ps(detD, A), mat2MulSSE(B, DC));
+	__m128 W = _mm_sub_ps(_mm_mul_ps(detA, D), mat2MulSSE(C, AB));
+	__m128 Y = _mm_sub_ps(_mm_mul_ps(detB, C), mat2MulAdjSSE(D, AB));
+	__m128 Z = _mm_sub_ps(_mm_mul_ps(detC, B), mat2MulAdjSSE(A, DC));
+
+	// det = |A||D| + |B||C| - trace(AB * DC)
+	__m128 det = _mm_add_ps(_mm_mul_ps(detA, detD), _mm_mul_ps(detB, detC));
+	det = _mm_sub_ps(det, horizontalSumSSE(_mm_mul_ps(AB, _mm_shuffle_ps(DC,DC,_MM_SHUFFLE(3,1,2,0)))));
+	if (_mm_cvtss_f32(det) == 0.0f) return false;
+
+	const __m128 rDet = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+	X = _mm_mul_ps(X, rDet);
+	Y = _mm_mul_ps(Y, rDet);
+	Z = _mm_mul_ps(Z, rDet);
+	W = _mm_mul_ps(W, rDet);
+
+	// the shuffles take the adjugate of each block and interleave them back into rows
+	_mm_store_ps(&i[0],  _mm_shuffle_ps(X,Y,_MM_SHUFFLE(1,3,1,3)));
+	_mm_store_ps(&i[4],  _mm_shuffle_ps(X,Y,_MM_SHUFFLE(0,2,0,2)));
+	_mm_store_ps(&i[8],  _mm_shuffle_ps(Z,W,_MM_SHUFFLE(1,3,1,3)));
+	_mm_store_ps(&i[12], _mm_shuffle_ps(Z,W,_MM_SHUFFLE(0,2,0,2)));
+
+	return true;
+}
+
+
+template <>
+bool Matrix4x4T<float>::affineInverse(const Matrix4x4T<float> &m)
+{
+	const __m128 a = _mm_load_ps(&m.i[0]);
+	const __m128 b = _mm_load_ps(&m.i[4]);
+	const __m128 c = _mm_load_ps(&m.i[8]);
+	const __m128 t = _mm_load_ps(&m.i[12]);
+
+	__m128 r0 = crossSSE(b, c);
+	__m128 r1 = crossSSE(c, a);
+	__m128 r2 = crossSSE(a, b);
+	__m128 r3 = _mm_setzero_ps();
+
+	const __m128 det = horizontalSumSSE(_mm_mul_ps(a, r0));
+	if (_mm_cvtss_f32(det) == 0.0f) return false;
+
+	// the division by the determinant is applied last so it overlaps with the transpose
+	const __m128 rDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	// translation = -t * inverse(3x3), w = 1
+	r3 = _mm_add_ps(_mm_mul_ps(_mm_shuffle_ps(t,t,_MM_SHUFFLE(0,0,0,0)), r0),
+					_mm_mul_ps(_mm_shuffle_ps(t,t,_MM_SHUFFLE(1,1,1,1)), r1));
+	r3 = _mm_add_ps(r3, _mm_mul_ps(_mm_shuffle_ps(t,t,_MM_SHUFFLE(2,2,2,2)), r2));
+	r3 = _mm_sub_ps(_mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f), _mm_mul_ps(r3, rDet));
+
+	_mm_store_ps(&i[0],  _mm_mul_ps(r0, rDet));
+	_mm_store_ps(&i[4],  _mm_mul_ps(r1, rDet));
+	_mm_store_ps(&i[8],  _mm_mul_ps(r2, rDet));
+	_mm_store_ps(&i[12], r3);
+
+	return true;
+}
+
+
+template <>
+bool Matrix4x4T<float>::normalMatrix(const Matrix4x4T<float> &m)
+{
+	const __m128 a = _mm_load_ps(&m.i[0]);
+	const __m128 b = _mm_load_ps(&m.i[4]);
+	const __m128 c = _mm_load_ps(&m.i[8]);
+	const __m128 bc = crossSSE(b, c);
+
+	const __m128 det = horizontalSumSSE(_mm_mul_ps(a, bc));
+	if (_mm_cvtss_f32(det) == 0.0f) return false;
+
+	const __m128 rDet = _mm_div_ps(_mm_set1_ps(1.0f), det);
+
+	_mm_store_ps(&i[0],  _mm_mul_ps(bc, rDet));
+	_mm_store_ps(&i[4],  _mm_mul_ps(crossSSE(c, a), rDet));
+	_mm_store_ps(&i[8],  _mm_mul_ps(crossSSE(a, b), rDet));
+	_mm_store_ps(&i[12], _mm_setr_ps(0.0f, 0.0f, 0.0f, 1.0f));
+
+	return true;
+}
+
+#endif
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class Matrix4x4T<float>;
+template class Matrix4x4T<double>;
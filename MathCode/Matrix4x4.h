@@ -5,50 +5,55 @@
 //	Version:		1
 //	Date:			5/04
 //	Description:	This is a 4x4 matrix stored in row-major format, so 4d vectors are
-//					represented as a row when multiplying
+//					represented as a row when multiplying. Storage is 16 byte aligned so
+//					the float matrix can use SSE (or AVX) for multiplication,
+//					transposing and inversion, see simd.h for the compile time selection.
 //----------------------------------------------------------------------------------------
 
 #ifndef MATRIX4X4_H
 #define MATRIX4X4_H
 
+#include "MathTypes.h"
+#include "../UtilityCode/SIMD.h"
+#include "../UtilityCode/BinAngle.h"
+
 /*------------------
 ---- STRUCTURES ----
 ------------------*/
 
-class Vector4;
-
 
-class Matrix4x4 {
+template <class T>
+class ALIGN16 Matrix4x4T {
 
 	public:
 
 		///// Variables
 
-		float				i[16];
+		T					i[16];
 
 		///// Overloaded Operators
 
-		__inline void		operator= (const Matrix4x4 &m);
-		__inline void		operator*=(const Matrix4x4 &m);
-		void				operator*=(const Vector4 &v);	// post multiply a column vector
+		__inline void		operator= (const Matrix4x4T &m);
+		__inline void		operator*=(const Matrix4x4T &m);
+		void				operator*=(const Vector4T<T> &v);	// post multiply a column vector
 
-		__inline void		multiply(const Matrix4x4 &m1, const Matrix4x4 &m2);
+		__inline void		multiply(const Matrix4x4T &m1, const Matrix4x4T &m2);
 		__inline void		setIdentity(void);
-		__inline void		setTranslation(float x, float y, float z);
-		__inline void		setScaling(float x, float y, float z);
-		__inline void		translate(float x, float y, float z);
-		__inline void		scale(float x, float y, float z);
+		__inline void		setTranslation(T x, T y, T z);
+		__inline void		setScaling(T x, T y, T z);
+		__inline void		translate(T x, T y, T z);
+		__inline void		scale(T x, T y, T z);
 		
 		///// Functions
 
-		void				set(const Matrix4x4 &m) { for (int c = 0; c < 16; c++) i[c] = m.i[c]; }
-		void				set(const Vector4 &r1, const Vector4 &r2, const Vector4 &r3, const Vector4 &r4);
+		void				set(const Matrix4x4T &m) { for (int c = 0; c < 16; c++) i[c] = m.i[c]; }
+		void				set(const Vector4T<T> &r1, const Vector4T<T> &r2, const Vector4T<T> &r3, const Vector4T<T> &r4);
 
 		// floating point angles, uses trig calculations, SLOW
-		void				setRotation(float x, float y, float z);
-		void				rotateX(float a);	// these functions should not be concatenated, in other
-		void				rotateY(float a);	// words they should only be used to quickly set a matrix
-		void				rotateZ(float a);	// that is already known to be the identity matrix
+		void				setRotation(T x, T y, T z);
+		void				rotateX(T a);	// these functions should not be concatenated, in other
+		void				rotateY(T a);	// words they should only be used to quickly set a matrix
+		void				rotateZ(T a);	// that is already known to be the identity matrix
 		
 		// integer angles used with LookupManager, uses trig tables, FAST
 		void				setRotation(int x, int y, int z);
@@ -56,17 +61,38 @@ class Matrix4x4 {
 		void				rotateY(int a);
 		void				rotateZ(int a);
 
+		// binary angles, any value is valid and no LookupManager is needed, FAST
+		void				setRotation(BinAngle x, BinAngle y, BinAngle z);
+		void				rotateX(BinAngle a);	// same as above
+		void				rotateY(BinAngle a);
+		void				rotateZ(BinAngle a);
+
 		// get transpose of matrix, usually used for giving to OpenGL
-		Matrix4x4			getTranspose(void) const;
+		Matrix4x4T			getTranspose(void) const;
 		__inline void		setTranspose(void);
 
+		// set this matrix to the inverse of m, m may be this matrix. The affine versions
+		// require the last column of m to be 0,0,0,1 and are much faster than inverse
+		bool				inverse(const Matrix4x4T &m);			// returns false if m is singular
+		bool				affineInverse(const Matrix4x4T &m);		// rotation, scale, shear and translation
+		void				orthonormalInverse(const Matrix4x4T &m);	// rotation and translation only, FAST
+		T					getDeterminant(void) const;
+
+		// set this matrix to the inverse transpose of the 3x3 portion of m, used to transform
+		// normals when m contains non-uniform scaling. Returns false if m is singular
+		bool				normalMatrix(const Matrix4x4T &m);
+
+		// set this matrix to the same projection as gluPerspective, fovY in radians. Clip space
+		// z runs from -w at the near plane to w at the far plane
+		void				setPerspective(T fovY, T aspect, T zNear, T zFar);
+
 		// Constructors / Destructor
-		Matrix4x4() {}
-		Matrix4x4(const Matrix4x4 &m) { for (int c = 0; c < 16; c++) i[c] = m.i[c]; }
-		explicit			Matrix4x4(const Vector4 &r1, const Vector4 &r2, const Vector4 &r3, const Vector4 &r4);
-		explicit			Matrix4x4(const float *p, int l);
+		Matrix4x4T() {}
+		Matrix4x4T(const Matrix4x4T &m) { for (int c = 0; c < 16; c++) i[c] = m.i[c]; }
+		explicit			Matrix4x4T(const Vector4T<T> &r1, const Vector4T<T> &r2, const Vector4T<T> &r3, const Vector4T<T> &r4);
+		explicit			Matrix4x4T(const T *p, int l);
 
-		~Matrix4x4() {}
+		~Matrix4x4T() {}
 };
 
 
@@ -75,15 +101,17 @@ class Matrix4x4 {
 ------------------------*/
 
 
-__inline void Matrix4x4::operator= (const Matrix4x4 &m)
+template <class T>
+__inline void Matrix4x4T<T>::operator= (const Matrix4x4T<T> &m)
 {
 	for (int c = 0; c < 16; c++) i[c] = m.i[c];
 }
 
 
-__inline void Matrix4x4::operator*=(const Matrix4x4 &m)
+template <class T>
+__inline void Matrix4x4T<T>::operator*=(const Matrix4x4T<T> &m)
 {
-	Matrix4x4 orig(*this);
+	Matrix4x4T<T> orig(*this);
 
 	// row 1
 	i[0]  = orig.i[0]*m.i[0] + orig.i[1]*m.i[4] + orig.i[2]*m.i[8]  + orig.i[3]*m.i[12];
@@ -111,7 +139,8 @@ __inline void Matrix4x4::operator*=(const Matrix4x4 &m)
 }
 
 
-__inline void Matrix4x4::multiply(const Matrix4x4 &m1, const Matrix4x4 &m2)
+template <class T>
+__inline void Matrix4x4T<T>::multiply(const Matrix4x4T<T> &m1, const Matrix4x4T<T> &m2)
 {
 	// row 1
 	i[0]  = m1.i[0]*m2.i[0] + m1.i[1]*m2.i[4] + m1.i[2]*m2.i[8]  + m1.i[3]*m2.i[12];
@@ -140,7 +169,8 @@ __inline void Matrix4x4::multiply(const Matrix4x4 &m1, const Matrix4x4 &m2)
 
 
 // Set matrix to the identity matrix
-__inline void Matrix4x4::setIdentity(void)
+template <class T>
+__inline void Matrix4x4T<T>::setIdentity(void)
 {
 	i[0]  = 1; i[1]  = 0; i[2]  = 0; i[3]  = 0;
 	i[4]  = 0; i[5]  = 1; i[6]  = 0; i[7]  = 0;
@@ -150,7 +180,8 @@ __inline void Matrix4x4::setIdentity(void)
 
 
 // Set matrix to a translation matrix
-__inline void Matrix4x4::setTranslation(float x, float y, float z)
+template <class T>
+__inline void Matrix4x4T<T>::setTranslation(T x, T y, T z)
 {
 	i[0]  = 1; i[1]  = 0; i[2]  = 0; i[3]  = 0;
 	i[4]  = 0; i[5]  = 1; i[6]  = 0; i[7]  = 0;
@@ -160,7 +191,8 @@ __inline void Matrix4x4::setTranslation(float x, float y, float z)
 
 
 // Set matrix to a scaling matrix
-__inline void Matrix4x4::setScaling(float x, float y, float z)
+template <class T>
+__inline void Matrix4x4T<T>::setScaling(T x, T y, T z)
 {
 	i[0]  = x; i[1]  = 0; i[2]  = 0; i[3]  = 0;
 	i[4]  = 0; i[5]  = y; i[6]  = 0; i[7]  = 0;
@@ -171,7 +203,8 @@ __inline void Matrix4x4::setScaling(float x, float y, float z)
 
 // Set translation portion of matrix, do not touch rest. This can be called after any other
 // set function, but the translations are not additive
-__inline void Matrix4x4::translate(float x, float y, float z)
+template <class T>
+__inline void Matrix4x4T<T>::translate(T x, T y, T z)
 {
 	i[12] = x;
 	i[13] = y;
@@ -180,7 +213,8 @@ __inline void Matrix4x4::translate(float x, float y, float z)
 
 
 // Set scaling portion of matrix, do not touch rest
-__inline void Matrix4x4::scale(float x, float y, float z)
+template <class T>
+__inline void Matrix4x4T<T>::scale(T x, T y, T z)
 {
 	i[0] = x;
 	i[5] = y;
@@ -189,9 +223,10 @@ __inline void Matrix4x4::scale(float x, float y, float z)
 
 
 // set current matrix to its transpose
-__inline void Matrix4x4::setTranspose(void)
+template <class T>
+__inline void Matrix4x4T<T>::setTranspose(void)
 {
-	float temp = i[1];
+	T temp = i[1];
 	i[1] = i[4];
 	i[4] = temp;
 
@@ -217,4 +252,94 @@ __inline void Matrix4x4::setTranspose(void)
 }
 
 
-#endif
\ No newline at end of file
+/*-----------------------------
+---- SIMD SPECIALIZATIONS ----
+-----------------------------*/
+
+#if defined(USE_SSE)
+
+//----------------------------------------------------------------------------------------
+//	Row r of the product is the sum of the rows of m2, each scaled by one element of row r
+//	of m1. All rows of m2 are loaded before anything is stored and row r of m1 is read
+//	before row r is written, so either argument may be this matrix.
+//----------------------------------------------------------------------------------------
+template <>
+__inline void Matrix4x4T<float>::multiply(const Matrix4x4T<float> &m1, const Matrix4x4T<float> &m2)
+{
+	#if defined(USE_AVX)
+		// two rows of the result per iteration, each 128 bit lane holds one row
+		const __m256 r0 = _mm256_broadcast_ps((const __m128 *)&m2.i[0]);
+		const __m256 r1 = _mm256_broadcast_ps((const __m128 *)&m2.i[4]);
+		const __m256 r2 = _mm256_broadcast_ps((const __m128 *)&m2.i[8]);
+		const __m256 r3 = _mm256_broadcast_ps((const __m128 *)&m2.i[12]);
+
+		for (int r = 0; r < 16; r += 8) {
+			const __m256 a = _mm256_loadu_ps(&m1.i[r]);
+			__m256 out = _mm256_mul_ps(_mm256_shuffle_ps(a,a,0x00), r0);
+			out = _mm256_add_ps(out, _mm256_mul_ps(_mm256_shuffle_ps(a,a,0x55), r1));
+			out = _mm256_add_ps(out, _mm256_mul_ps(_mm256_shuffle_ps(a,a,0xAA), r2));
+			out = _mm256_add_ps(out, _mm256_mul_ps(_mm256_shuffle_ps(a,a,0xFF), r3));
+			_mm256_storeu_ps(&i[r], out);
+		}
+	#else
+		const __m128 r0 = _mm_load_ps(&m2.i[0]);
+		const __m128 r1 = _mm_load_ps(&m2.i[4]);
+		const __m128 r2 = _mm_load_ps(&m2.i[8]);
+		const __m128 r3 = _mm_load_ps(&m2.i[12]);
+
+		for (int r = 0; r < 16; r += 4) {
+			const __m128 a = _mm_load_ps(&m1.i[r]);
+			__m128 out = _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(0,0,0,0)), r0);
+			out = _mm_add_ps(out, _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(1,1,1,1)), r1));
+			out = _mm_add_ps(out, _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(2,2,2,2)), r2));
+			out = _mm_add_ps(out, _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(3,3,3,3)), r3));
+			_mm_store_ps(&i[r], out);
+		}
+	#endif
+}
+
+
+// multiply is safe in place, so no copy of the original is needed
+template <>
+__inline void Matrix4x4T<float>::operator*=(const Matrix4x4T<float> &m)
+{
+	multiply(*this, m);
+}
+
+
+template <>
+__inline void Matrix4x4T<float>::operator= (const Matrix4x4T<float> &m)
+{
+	_mm_store_ps(&i[0],  _mm_load_ps(&m.i[0]));
+	_mm_store_ps(&i[4],  _mm_load_ps(&m.i[4]));
+	_mm_store_ps(&i[8],  _mm_load_ps(&m.i[8]));
+	_mm_store_ps(&i[12], _mm_load_ps(&m.i[12]));
+}
+
+
+template <>
+__inline void Matrix4x4T<float>::setTranspose(void)
+{
+	__m128 r0 = _mm_load_ps(&i[0]);
+	__m128 r1 = _mm_load_ps(&i[4]);
+	__m128 r2 = _mm_load_ps(&i[8]);
+	__m128 r3 = _mm_load_ps(&i[12]);
+
+	_MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+
+	_mm_store_ps(&i[0],  r0);
+	_mm_store_ps(&i[4],  r1);
+	_mm_store_ps(&i[8],  r2);
+	_mm_store_ps(&i[12], r3);
+}
+
+
+template <> Matrix4x4T<float> Matrix4x4T<float>::getTranspose(void) const;
+template <> bool Matrix4x4T<float>::inverse(const Matrix4x4T<float> &m);
+template <> bool Matrix4x4T<float>::affineInverse(const Matrix4x4T<float> &m);
+template <> bool Matrix4x4T<float>::normalMatrix(const Matrix4x4T<float> &m);
+
+#endif
+
+
+#endif
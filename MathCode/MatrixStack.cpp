@@ -0,0 +1,107 @@
+//	----==== MATRIXSTACK.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A stack of transformation matrices that works like the OpenGL matrix
+//					stack, but is computed on the CPU
+//	--------------------------------------------------------------------------------
+
+
+#include "MatrixStack.h"
+#include "Quaternion.h"
+#include "../UtilityCode/MsgAssert.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class MatrixStack //////////
+
+
+bool MatrixStack::push(void)
+{
+	msgAssert(top < MATRIXSTACK_DEPTH-1, "MatrixStack: overflow");
+	if (top >= MATRIXSTACK_DEPTH-1) return false;
+
+	stack[top+1] = stack[top];
+	++top;
+	return true;
+}
+
+
+bool MatrixStack::pop(void)
+{
+	msgAssert(top > 0, "MatrixStack: underflow");
+	if (top == 0) return false;
+
+	--top;
+	return true;
+}
+
+
+void MatrixStack::multiply(const Matrix4x4 &m)
+{
+	Matrix4x4 result;
+	result.multiply(m, stack[top]);
+	stack[top] = result;
+}
+
+
+// A translation only changes the bottom row, which becomes t * top
+void MatrixStack::translate(float x, float y, float z)
+{
+	float *i = stack[top].i;
+
+	i[12] += x*i[0] + y*i[4] + z*i[8];
+	i[13] += x*i[1] + y*i[5] + z*i[9];
+	i[14] += x*i[2] + y*i[6] + z*i[10];
+	i[15] += x*i[3] + y*i[7] + z*i[11];
+}
+
+
+// A scale only changes the first three rows
+void MatrixStack::scale(float x, float y, float z)
+{
+	float *i = stack[top].i;
+
+	i[0] *= x; i[1] *= x; i[2]  *= x; i[3]  *= x;
+	i[4] *= y; i[5] *= y; i[6]  *= y; i[7]  *= y;
+	i[8] *= z; i[9] *= z; i[10] *= z; i[11] *= z;
+}
+
+
+void MatrixStack::rotateX(float a)
+{
+	Matrix4x4 r;
+	r.setIdentity();
+	r.rotateX(a);
+	multiply(r);
+}
+
+
+void MatrixStack::rotateY(float a)
+{
+	Matrix4x4 r;
+	r.setIdentity();
+	r.rotateY(a);
+	multiply(r);
+}
+
+
+void MatrixStack::rotateZ(float a)
+{
+	Matrix4x4 r;
+	r.setIdentity();
+	r.rotateZ(a);
+	multiply(r);
+}
+
+
+void MatrixStack::rotate(const Quaternion &q)
+{
+	Matrix4x4 r;
+	q.getMatrix(r);
+	multiply(r);
+}
@@ -0,0 +1,76 @@
+//	----==== MATRIXSTACK.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A stack of transformation matrices that works like the OpenGL matrix
+//					stack, but is computed on the CPU so the results can also be used for
+//					culling and picking. The top matrix is given to OpenGL with
+//					glLoadMatrixf(stack.getMatrix().i), no transpose is needed.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef MATRIXSTACK_H
+#define MATRIXSTACK_H
+
+#include "Matrix4x4.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define MATRIXSTACK_DEPTH		32		// the minimum depth of the OpenGL modelview stack
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+//----------------------------------------------------------------------------------------
+//	The transform functions concatenate onto the top matrix in the same order as their
+//	OpenGL counterparts, so the last transform given is the first one applied to vertices.
+//	Because vectors are rows, this means the new transform is multiplied on the left.
+//	The class contains aligned matrices, so declare it globally or on the stack rather
+//	than with new.
+//----------------------------------------------------------------------------------------
+class ALIGN16 MatrixStack {
+
+	private:
+
+		///// Variables
+
+		Matrix4x4		stack[MATRIXSTACK_DEPTH];
+		int				top;
+
+	public:
+
+		///// Accessors
+
+		const Matrix4x4 &	getMatrix(void) const { return stack[top]; }
+		int				getDepth(void) const { return top + 1; }
+
+		///// Functions
+
+		bool			push(void);		// duplicates the top matrix, returns false if the stack is full
+		bool			pop(void);		// returns false if only one matrix is on the stack
+
+		void			loadIdentity(void) { stack[top].setIdentity(); }
+		void			load(const Matrix4x4 &m) { stack[top] = m; }
+
+		void			multiply(const Matrix4x4 &m);
+		void			translate(float x, float y, float z);
+		void			scale(float x, float y, float z);
+		void			rotateX(float a);		// angles are in radians
+		void			rotateY(float a);
+		void			rotateZ(float a);
+		void			rotate(const Quaternion &q);
+
+		// Constructors / Destructor
+		explicit MatrixStack() : top(0) { stack[0].setIdentity(); }
+		~MatrixStack() {}
+};
+
+
+#endif
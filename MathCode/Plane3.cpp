@@ -9,7 +9,7 @@
 //	---------------------------------------------------------------------------
 
 
-#include "plane3.h"
+#include "Plane3.h"
 
 /*-----------------
 ---- FUNCTIONS ----
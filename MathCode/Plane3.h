@@ -12,7 +12,7 @@
 #ifndef PLANE3_H
 #define PLANE3_H
 
-#include "vector3.h"
+#include "Vector3.h"
 
 /*------------------
 ---- STRUCTURES ----
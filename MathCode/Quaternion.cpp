@@ -0,0 +1,234 @@
+//	----==== QUATERNION.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Unit quaternion for orientations
+//	--------------------------------------------------------------------------------
+
+
+#include <sstream>
+#include "Quaternion.h"
+#include "Matrix4x4.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class QuaternionT //////////
+
+
+template <class T>
+void QuaternionT<T>::setAxisAngle(const Vector3T<T> &axis, T a)
+{
+	T s = std::sin(a * T(0.5));
+	x = axis.x * s;
+	y = axis.y * s;
+	z = axis.z * s;
+	w = std::cos(a * T(0.5));
+}
+
+
+//----------------------------------------------------------------------------------------
+//	Matrix4x4::setRotation applies heading about y, then pitch about x, then roll about z,
+//	each turning the opposite way to rotateX, rotateY and rotateZ. This is the product
+//	roll * pitch * heading written out, using half angles.
+//----------------------------------------------------------------------------------------
+template <class T>
+void QuaternionT<T>::setRotation(T h, T p, T b)
+{
+	T sh = std::sin(h * T(-0.5)); T ch = std::cos(h * T(0.5));
+	T sp = std::sin(p * T(-0.5)); T cp = std::cos(p * T(0.5));
+	T sb = std::sin(b * T(-0.5)); T cb = std::cos(b * T(0.5));
+
+	x = cb*sp*ch - sb*cp*sh;
+	y = cb*cp*sh + sb*sp*ch;
+	z = cb*sp*sh + sb*cp*ch;
+	w = cb*cp*ch - sb*sp*sh;
+}
+
+
+// the lookup tables hold whole angles only, so the matrix is built and converted instead
+// of halving the angles
+template <class T>
+void QuaternionT<T>::setRotation(int h, int p, int b)
+{
+	Matrix4x4T<T> m;
+	m.setRotation(h, p, b);
+	setMatrix(m);
+}
+
+
+//----------------------------------------------------------------------------------------
+//	Binary angles can be halved with a shift, so unlike the integer angles the half angle
+//	formula of the floating point version can be used without any trig calls
+//----------------------------------------------------------------------------------------
+template <class T>
+void QuaternionT<T>::setRotation(BinAngle h, BinAngle p, BinAngle b)
+{
+	float fsh, fch, fsp, fcp, fsb, fcb;
+	h.half().sinCos(fsh, fch);
+	p.half().sinCos(fsp, fcp);
+	b.half().sinCos(fsb, fcb);
+
+	// sin(-a/2) = -sin(a/2)
+	T sh = -fsh; T ch = fch;
+	T sp = -fsp; T cp = fcp;
+	T sb = -fsb; T cb = fcb;
+
+	x = cb*sp*ch - sb*cp*sh;
+	y = cb*cp*sh + sb*sp*ch;
+	z = cb*sp*sh + sb*cp*ch;
+	w = cb*cp*ch - sb*sp*sh;
+}
+
+
+//----------------------------------------------------------------------------------------
+//	Builds from whichever of w, x, y or z is largest to avoid dividing by a small number
+//----------------------------------------------------------------------------------------
+template <class T>
+void QuaternionT<T>::setMatrix(const Matrix4x4T<T> &m)
+{
+	const T *i = m.i;
+	T trace = i[0] + i[5] + i[10];
+
+	if (trace > 0) {
+		T s = T(0.5) / std::sqrt(trace + 1);
+		w = T(0.25) / s;
+		x = (i[6] - i[9]) * s;
+		y = (i[8] - i[2]) * s;
+		z = (i[1] - i[4]) * s;
+
+	} else if (i[0] > i[5] && i[0] > i[10]) {
+		T s = 2 * std::sqrt(1 + i[0] - i[5] - i[10]);
+		T r = T(1) / s;
+		w = (i[6] - i[9]) * r;
+		x = T(0.25) * s;
+		y = (i[4] + i[1]) * r;
+		z = (i[8] + i[2]) * r;
+
+	} else if (i[5] > i[10]) {
+		T s = 2 * std::sqrt(1 + i[5] - i[0] - i[10]);
+		T r = T(1) / s;
+		w = (i[8] - i[2]) * r;
+		x = (i[4] + i[1]) * r;
+		y = T(0.25) * s;
+		z = (i[9] + i[6]) * r;
+
+	} else {
+		T s = 2 * std::sqrt(1 + i[10] - i[0] - i[5]);
+		T r = T(1) / s;
+		w = (i[1] - i[4]) * r;
+		x = (i[8] + i[2]) * r;
+		y = (i[9] + i[6]) * r;
+		z = T(0.25) * s;
+	}
+}
+
+
+template <class T>
+void QuaternionT<T>::getMatrix(Matrix4x4T<T> &m) const
+{
+	T x2 = x + x, y2 = y + y, z2 = z + z;
+	T xx = x * x2, yy = y * y2, zz = z * z2;
+	T xy = x * y2, xz = x * z2, yz = y * z2;
+	T wx = w * x2, wy = w * y2, wz = w * z2;
+
+	m.i[0]  = 1 - (yy + zz);	m.i[1]  = xy + wz;			m.i[2]  = xz - wy;			m.i[3]  = 0;
+	m.i[4]  = xy - wz;			m.i[5]  = 1 - (xx + zz);	m.i[6]  = yz + wx;			m.i[7]  = 0;
+	m.i[8]  = xz + wy;			m.i[9]  = yz - wx;			m.i[10] = 1 - (xx + yy);	m.i[11] = 0;
+	m.i[12] = 0;				m.i[13] = 0;				m.i[14] = 0;				m.i[15] = 1;
+}
+
+
+template <class T>
+void QuaternionT<T>::nlerp(const QuaternionT<T> &q1, const QuaternionT<T> &q2, T t)
+{
+	// q and -q are the same orientation, negate q2 if needed to take the short way around
+	T t2 = (q1.dot(q2) < 0) ? -t : t;
+	T t1 = 1 - t;
+
+	x = q1.x*t1 + q2.x*t2;
+	y = q1.y*t1 + q2.y*t2;
+	z = q1.z*t1 + q2.z*t2;
+	w = q1.w*t1 + q2.w*t2;
+	normalize();
+}
+
+
+template <class T>
+void QuaternionT<T>::slerp(const QuaternionT<T> &q1, const QuaternionT<T> &q2, T t)
+{
+	T cosAngle = q1.dot(q2);
+	T sign = 1;
+	if (cosAngle < 0) {
+		cosAngle = -cosAngle;
+		sign = -1;
+	}
+
+	// nearly identical orientations, sin(angle) is too small to divide by
+	if (cosAngle > T(0.9995)) {
+		nlerp(q1, q2, t);
+		return;
+	}
+
+	T angle = std::acos(cosAngle);
+	T invSin = T(1) / std::sin(angle);
+	T t1 = std::sin((1 - t) * angle) * invSin;
+	T t2 = std::sin(t * angle) * invSin * sign;
+
+	x = q1.x*t1 + q2.x*t2;
+	y = q1.y*t1 + q2.y*t2;
+	z = q1.z*t1 + q2.z*t2;
+	w = q1.w*t1 + q2.w*t2;
+}
+
+
+//----------------------------------------------------------------------------------------
+//	nlerp moves too slowly near the ends and too quickly in the middle. The cubic in t
+//	below, with coefficients fitted to the angle between q1 and q2, corrects for this
+//	without any trig, so it is only a few multiplies more than nlerp.
+//----------------------------------------------------------------------------------------
+template <class T>
+void QuaternionT<T>::slerpFast(const QuaternionT<T> &q1, const QuaternionT<T> &q2, T t)
+{
+	T d = std::fabs(q1.dot(q2));
+	T a = T(1.0904) + d * (T(-3.2452) + d * (T(3.55645) - d * T(1.43519)));
+	T b = T(0.848013) + d * (T(-1.06021) + d * T(0.215638));
+	T k = a * (t - T(0.5)) * (t - T(0.5)) + b;
+
+	nlerp(q1, q2, t + t * (t - T(0.5)) * (t - 1) * k);
+}
+
+
+template <class T>
+void QuaternionT<T>::normalize(void)
+{
+	T magSq = magSquared();
+
+	if (magSq > 0) {
+		T invMag = T(1) / std::sqrt(magSq);
+		x *= invMag;
+		y *= invMag;
+		z *= invMag;
+		w *= invMag;
+	}
+}
+
+
+template <class T>
+std::string QuaternionT<T>::toString(void) const
+{
+	std::ostringstream returnStr;
+	returnStr << "(" << x << "," << y << "," << z << "," << w << ")";
+	return returnStr.str();
+}
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class QuaternionT<float>;
+template class QuaternionT<double>;
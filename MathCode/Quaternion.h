@@ -0,0 +1,169 @@
+//	----==== QUATERNION.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Unit quaternion for orientations. Quaternions compose and interpolate
+//					without gimbal lock and without rebuilding a matrix from Euler angles.
+//					The product q1 * q2 rotates by q2 first, then by q1. getMatrix gives
+//					the row vector matrix, so v * q.getMatrix() equals q.rotate(v), and
+//					the matrix of q1 * q2 is the matrix of q2 times the matrix of q1.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef QUATERNION_H
+#define QUATERNION_H
+
+#include <string>
+#include <cmath>
+#include "../UtilityCode/MsgAssert.h"
+#include "MathTypes.h"
+#include "Vector3.h"
+#include "../UtilityCode/SIMD.h"
+#include "../UtilityCode/BinAngle.h"
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+template <class T>
+class ALIGN16 QuaternionT {
+
+	public:
+
+		///// Variables
+
+		union {
+			struct {
+				T x, y, z, w;		// x,y,z is the vector part, w the scalar part
+			};
+
+			T v[4];
+		};
+
+
+		///// Overloaded Operators
+
+		bool	operator==(const QuaternionT &q) const { return (x == q.x && y == q.y && z == q.z && w == q.w); }
+		bool	operator!=(const QuaternionT &q) const { return (x != q.x || y != q.y || z != q.z || w != q.w); }
+
+		void	operator= (const QuaternionT &q) { x = q.x; y = q.y; z = q.z; w = q.w; }
+		void	operator*=(const QuaternionT &q) { multiply(*this, q); }
+
+		QuaternionT	operator- (void) const { return QuaternionT(-x,-y,-z,-w); }
+		QuaternionT	operator* (const QuaternionT &q) const { QuaternionT r; r.multiply(*this, q); return r; }
+
+		///// Functions
+
+		__inline void	multiply(const QuaternionT &q1, const QuaternionT &q2);	// q1 or q2 may be this
+
+		void			setIdentity(void) { x = 0; y = 0; z = 0; w = 1; }
+		void			setAxisAngle(const Vector3T<T> &axis, T a);		// axis must be unit length, angle in radians
+		void			setRotation(T h, T p, T b);		// same angles and order as Matrix4x4::setRotation, SLOW
+		void			setRotation(int h, int p, int b);	// integer angles used with LookupManager, FAST
+		void			setRotation(BinAngle h, BinAngle p, BinAngle b);	// binary angles, FASTEST
+		void			setMatrix(const Matrix4x4T<T> &m);	// from the 3x3 rotation portion of m
+		void			getMatrix(Matrix4x4T<T> &m) const;	// sets the 3x3 portion and the identity elsewhere
+
+		// Rotates p by this quaternion, which must be unit length
+		__inline void	rotate(Vector3T<T> &out, const Vector3T<T> &p) const;
+
+		// Interpolation between unit quaternions, always along the shortest arc. nlerp is the
+		// cheapest but its speed is not constant, slerp is exact, slerpFast corrects t so
+		// that nlerp follows the slerp speed to within about 0.002 radians
+		void			nlerp(const QuaternionT &q1, const QuaternionT &q2, T t);
+		void			slerp(const QuaternionT &q1, const QuaternionT &q2, T t);
+		void			slerpFast(const QuaternionT &q1, const QuaternionT &q2, T t);
+
+		T				dot(const QuaternionT &q) const { return x*q.x + y*q.y + z*q.z + w*q.w; }
+		T				mag(void) const { return std::sqrt(x*x + y*y + z*z + w*w); }
+		T				magSquared(void) const { return x*x + y*y + z*z + w*w; }
+		void			normalize(void);
+		void			conjugate(void) { x = -x; y = -y; z = -z; }	// the inverse of a unit quaternion
+
+		// Debugging
+		std::string		toString(void) const;
+
+		// Constructors / Destructor
+		QuaternionT() : x(0), y(0), z(0), w(1) {}
+		QuaternionT(const QuaternionT &q) : x(q.x), y(q.y), z(q.z), w(q.w) {}
+		explicit		QuaternionT(T _x, T _y, T _z, T _w) : x(_x), y(_y), z(_z), w(_w) {}
+		explicit		QuaternionT(const Vector3T<T> &axis, T a) { setAxisAngle(axis, a); }
+		template <class U>
+		explicit		QuaternionT(const QuaternionT<U> &q) : x((T)q.x), y((T)q.y), z((T)q.z), w((T)q.w) {}
+		~QuaternionT() {}
+};
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+
+template <class T>
+__inline void QuaternionT<T>::multiply(const QuaternionT<T> &q1, const QuaternionT<T> &q2)
+{
+	T rx = q1.w*q2.x + q1.x*q2.w + q1.y*q2.z - q1.z*q2.y;
+	T ry = q1.w*q2.y - q1.x*q2.z + q1.y*q2.w + q1.z*q2.x;
+	T rz = q1.w*q2.z + q1.x*q2.y - q1.y*q2.x + q1.z*q2.w;
+	w = q1.w*q2.w - q1.x*q2.x - q1.y*q2.y - q1.z*q2.z;
+	x = rx;
+	y = ry;
+	z = rz;
+}
+
+
+//----------------------------------------------------------------------------------------
+//	p' = p + 2w(u x p) + 2u x (u x p) with u the vector part, which is two cross products
+//	instead of the two quaternion multiplies of q * p * conjugate(q)
+//----------------------------------------------------------------------------------------
+template <class T>
+__inline void QuaternionT<T>::rotate(Vector3T<T> &out, const Vector3T<T> &p) const
+{
+	T tx = 2 * (y*p.z - z*p.y);
+	T ty = 2 * (z*p.x - x*p.z);
+	T tz = 2 * (x*p.y - y*p.x);
+
+	out.assign(	p.x + w*tx + (y*tz - z*ty),
+				p.y + w*ty + (z*tx - x*tz),
+				p.z + w*tz + (x*ty - y*tx));
+}
+
+
+/*-----------------------------
+---- SIMD SPECIALIZATIONS ----
+-----------------------------*/
+
+#if defined(USE_SSE)
+
+//----------------------------------------------------------------------------------------
+//	Each component of q1 is broadcast and multiplied by a shuffled, sign flipped copy of
+//	q2. Both arguments are loaded before the result is stored, so either may be this.
+//----------------------------------------------------------------------------------------
+template <>
+__inline void QuaternionT<float>::multiply(const QuaternionT<float> &q1, const QuaternionT<float> &q2)
+{
+	const __m128 a = _mm_load_ps(q1.v);
+	const __m128 b = _mm_load_ps(q2.v);
+
+	const __m128 signX = _mm_setr_ps( 0.0f, -0.0f,  0.0f, -0.0f);
+	const __m128 signY = _mm_setr_ps( 0.0f,  0.0f, -0.0f, -0.0f);
+	const __m128 signZ = _mm_setr_ps(-0.0f,  0.0f,  0.0f, -0.0f);
+
+	__m128 r = _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(3,3,3,3)), b);
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(0,0,0,0)),
+								 _mm_xor_ps(_mm_shuffle_ps(b,b,_MM_SHUFFLE(0,1,2,3)), signX)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(1,1,1,1)),
+								 _mm_xor_ps(_mm_shuffle_ps(b,b,_MM_SHUFFLE(1,0,3,2)), signY)));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(a,a,_MM_SHUFFLE(2,2,2,2)),
+								 _mm_xor_ps(_mm_shuffle_ps(b,b,_MM_SHUFFLE(2,3,0,1)), signZ)));
+
+	_mm_store_ps(v, r);
+}
+
+#endif
+
+
+#endif
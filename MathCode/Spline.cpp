@@ -9,53 +9,60 @@
 //	--------------------------------------------------------------------------------
 
 
-#include "spline.h"
-#include "vector2.h"
-#include "vector3.h"
-#include "vector4.h"
+#include "Spline.h"
+#include "Vector2.h"
+#include "Vector3.h"
+#include "Vector4.h"
 
 /*----------------------
 ---- STATIC MEMBERS ----
 ----------------------*/
 
-////////// class CatmullRomSpline //////////
+////////// class CatmullRomSplineT //////////
 
-Matrix4x4 CatmullRomSpline::basisMatrix(Vector4( 0.0f,  1.0f,  0.0f,  0.0f),
-										Vector4(-0.5f,  0.0f,  0.5f,  0.0f),
-										Vector4( 1.0f, -2.5f,  2.0f, -0.5f),
-										Vector4(-0.5f,  1.5f, -1.5f,  0.5f));
+template <class T>
+Matrix4x4T<T> CatmullRomSplineT<T>::basisMatrix(Vector4T<T>( 0.0f,  1.0f,  0.0f,  0.0f),
+												Vector4T<T>(-0.5f,  0.0f,  0.5f,  0.0f),
+												Vector4T<T>( 1.0f, -2.5f,  2.0f, -0.5f),
+												Vector4T<T>(-0.5f,  1.5f, -1.5f,  0.5f));
 
-Matrix4x4 CatmullRomSpline::preCalcMatrix;
-Matrix4x4 CatmullRomSpline::splineMatrix;
+template <class T> Matrix4x4T<T> CatmullRomSplineT<T>::preCalcMatrix;
+template <class T> Matrix4x4T<T> CatmullRomSplineT<T>::splineMatrix;
 
 
-////////// class CubicBSpline //////////
+////////// class CubicBSplineT //////////
 
 // x(t)  = (h0)(1/6)(1-3t+3t^2-t^3) + (h1)(1/6)(4-6t^2+3t^3) + (h2)(1/6)(1+3t+3t^2-3t^3) + (h3)(1/6)(t^3)
-Matrix4x4 CubicBSpline::basisMatrix(Vector4( 1.0f, 4.0f, 1.0f, 0.0f)/6.0f,
-									Vector4(-3.0f,    0, 3.0f, 0.0f)/6.0f,
-									Vector4( 3.0f,-6.0f, 3.0f, 0.0f)/6.0f,
-									Vector4(-1.0f, 3.0f,-3.0f, 1.0f)/6.0f);
-
-Matrix4x4 CubicBSpline::basisMatrixT(basisMatrix.getTranspose());
-
-const float CubicBSpline::oneSixth = 1.0f / 6.0f;
-Matrix4x4 CubicBSpline::pointsMatrix;
-Matrix4x4 CubicBSpline::middleMatrix;
-Matrix4x4 const * CubicBSpline::ptrMiddleMatrix = 0;
-float CubicBSpline::hSpacing = 1.0f;
-float CubicBSpline::vSpacing = 1.0f;
-float CubicBSpline::invVSpacing = 1.0f;
-
-Vector4 CubicBSpline::preCalcVector(0,0,0,0);
-Vector3 CubicBSpline::preCalcTangentVector(0,0,0);
-Vector2 CubicBSpline::preCalcConcavityVector(0,0);
+template <class T>
+Matrix4x4T<T> CubicBSplineT<T>::basisMatrix(Vector4T<T>( 1.0f, 4.0f, 1.0f, 0.0f)/T(6),
+											Vector4T<T>(-3.0f,    0, 3.0f, 0.0f)/T(6),
+											Vector4T<T>( 3.0f,-6.0f, 3.0f, 0.0f)/T(6),
+											Vector4T<T>(-1.0f, 3.0f,-3.0f, 1.0f)/T(6));
+
+// transpose of the basis matrix is written out rather than built with getTranspose, since
+// static members of a class template have no guaranteed initialization order
+template <class T>
+Matrix4x4T<T> CubicBSplineT<T>::basisMatrixT(Vector4T<T>( 1.0f,-3.0f, 3.0f,-1.0f)/T(6),
+											 Vector4T<T>( 4.0f,    0,-6.0f, 3.0f)/T(6),
+											 Vector4T<T>( 1.0f, 3.0f, 3.0f,-3.0f)/T(6),
+											 Vector4T<T>( 0.0f, 0.0f, 0.0f, 1.0f)/T(6));
+
+template <class T> const T CubicBSplineT<T>::oneSixth = T(1) / T(6);
+template <class T> Matrix4x4T<T> CubicBSplineT<T>::middleMatrix;
+template <class T> Matrix4x4T<T> const * CubicBSplineT<T>::ptrMiddleMatrix = 0;
+template <class T> T CubicBSplineT<T>::hSpacing = 1.0f;
+template <class T> T CubicBSplineT<T>::vSpacing = 1.0f;
+template <class T> T CubicBSplineT<T>::invVSpacing = 1.0f;
+
+template <class T> Vector4T<T> CubicBSplineT<T>::preCalcVector(0,0,0,0);
+template <class T> Vector3T<T> CubicBSplineT<T>::preCalcTangentVector(0,0,0);
+template <class T> Vector2T<T> CubicBSplineT<T>::preCalcConcavityVector(0,0);
 
 /*-----------------
 ---- FUNCTIONS ----
 -----------------*/
 
-////////// class CatmullRomSpline //////////
+////////// class CatmullRomSplineT //////////
 
 
 ////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -67,22 +74,23 @@ Vector2 CubicBSpline::preCalcConcavityVector(0,0);
 //		segment, making the total 4.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Vector3 CatmullRomSpline::calcPointOnSpline(float t, const Vector3 &p0, const Vector3 &p1,
-											const Vector3 &p2, const Vector3 &p3)
+template <class T>
+Vector3T<T> CatmullRomSplineT<T>::calcPointOnSpline(T t, const Vector3T<T> &p0, const Vector3T<T> &p1,
+											const Vector3T<T> &p2, const Vector3T<T> &p3)
 {
-	const float t2 = t*t;
-	const float t3 = t2*t;
+	const T t2 = t*t;
+	const T t3 = t2*t;
 	
-	float returnX = 0.5f * ((2*p1.x) + (-p0.x + p2.x) * t + 
+	T returnX = 0.5f * ((2*p1.x) + (-p0.x + p2.x) * t + 
 		(2*p0.x - 5*p1.x + 4*p2.x - p3.x) * t2 + (-p0.x + 3*p1.x - 3*p2.x + p3.x) * t3);
 
-	float returnY = 0.5f * ((2*p1.y) + (-p0.y + p2.y) * t + 
+	T returnY = 0.5f * ((2*p1.y) + (-p0.y + p2.y) * t + 
 		(2*p0.y - 5*p1.y + 4*p2.y - p3.y) * t2 + (-p0.y + 3*p1.y - 3*p2.y + p3.y) * t3);
 
-	float returnZ = 0.5f * ((2*p1.z) + (-p0.z + p2.z) * t + 
+	T returnZ = 0.5f * ((2*p1.z) + (-p0.z + p2.z) * t + 
 		(2*p0.z - 5*p1.z + 4*p2.z - p3.z) * t2 + (-p0.z + 3*p1.z - 3*p2.z + p3.z) * t3);
 
-	return Vector3(returnX,returnY,returnZ);
+	return Vector3T<T>(returnX,returnY,returnZ);
 }
 
 
@@ -98,18 +106,20 @@ Vector3 CatmullRomSpline::calcPointOnSpline(float t, const Vector3 &p0, const Ve
 //			f(v, f(u,P0,P1,P2,P3), f(u,P4,P5,P6,P7), f(u,P8,P9,P10,P11), f(u,P12,P13,P14,P15))
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-Vector3 CatmullRomSpline::calcPointOnPatch(float u, float v, Vector3 *pBuffer)
+template <class T>
+Vector3T<T> CatmullRomSplineT<T>::calcPointOnPatch(T u, T v, Vector3T<T> *pBuffer)
 {
-	Vector3 p0(calcPointOnSpline(u, pBuffer[0], pBuffer[1], pBuffer[2], pBuffer[3]));
-	Vector3 p1(calcPointOnSpline(u, pBuffer[4], pBuffer[5], pBuffer[6], pBuffer[7]));
-	Vector3 p2(calcPointOnSpline(u, pBuffer[8], pBuffer[9], pBuffer[10],pBuffer[11]));
-	Vector3 p3(calcPointOnSpline(u, pBuffer[12],pBuffer[13],pBuffer[14],pBuffer[15]));
+	Vector3T<T> p0(calcPointOnSpline(u, pBuffer[0], pBuffer[1], pBuffer[2], pBuffer[3]));
+	Vector3T<T> p1(calcPointOnSpline(u, pBuffer[4], pBuffer[5], pBuffer[6], pBuffer[7]));
+	Vector3T<T> p2(calcPointOnSpline(u, pBuffer[8], pBuffer[9], pBuffer[10],pBuffer[11]));
+	Vector3T<T> p3(calcPointOnSpline(u, pBuffer[12],pBuffer[13],pBuffer[14],pBuffer[15]));
 
 	return calcPointOnSpline(v, p0,p1,p2,p3);
 }
 
 
-void CatmullRomSpline::preCalcCatmullRom(Vector4 &v, float p1, float p2, float p3, float p4)
+template <class T>
+void CatmullRomSplineT<T>::preCalcCatmullRom(Vector4T<T> &v, T p1, T p2, T p3, T p4)
 {
     v.x = p2;
     v.y = (p3 - p1) * 0.5f;
@@ -125,12 +135,13 @@ void CatmullRomSpline::preCalcCatmullRom(Vector4 &v, float p1, float p2, float p
 //		of floats.
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void CatmullRomSpline::setSplineMatrix(int xi, int zi, float *height, int size)
+template <class T>
+void CatmullRomSplineT<T>::setSplineMatrix(int xi, int zi, T *height, int size)
 {
 	int ri = 0;
 
 	for (int i = 0; i < 4; i++) {
-		Vector4 pMatV;
+		Vector4T<T> pMatV;
 
 		int index = (zi+i)*size + xi;
 		preCalcCatmullRom(pMatV, height[index], height[index+1], height[index+2], height[index+3]);
@@ -148,10 +159,11 @@ void CatmullRomSpline::setSplineMatrix(int xi, int zi, float *height, int size)
 }
 
 
-float CatmullRomSpline::calcQuad(float u, float v)
+template <class T>
+T CatmullRomSplineT<T>::calcQuad(T u, T v)
 {
-    Vector4 v1(1.0f, u, u*u, u*u*u);
-	Vector4 v2(1.0f, v, v*v, v*v*v);
+    Vector4T<T> v1(1.0f, u, u*u, u*u*u);
+	Vector4T<T> v2(1.0f, v, v*v, v*v*v);
     
 	// may need to be v1 here
 	v2 *= splineMatrix;
@@ -160,10 +172,10 @@ float CatmullRomSpline::calcQuad(float u, float v)
 }
 
 
-/*float CatmullRomSpline::calcHeightInPatch(float x, float z)
+/*T CatmullRomSpline::calcHeightInPatch(T x, T z)
 {
 	// temp //
-	float quadScaleY = 1.0f, quadBaseY = 0;
+	T quadScaleY = 1.0f, quadBaseY = 0;
 	//////////
 
 	assert(x >= 0 && x <= 1 && z >= 0 && z <= 1);
@@ -173,15 +185,16 @@ float CatmullRomSpline::calcQuad(float u, float v)
 }*/
 
 
-////////// class CubicBSpline //////////
+////////// class CubicBSplineT //////////
 
-float CubicBSpline::calcHeightOnCubicBSpline(float t, float h0, float h1, float h2, float h3)
+template <class T>
+T CubicBSplineT<T>::calcHeightOnCubicBSpline(T t, T h0, T h1, T h2, T h3)
 {
 	// x(t)  = (h0)(1/6)(1-3t+3t^2-t^3) + (h1)(1/6)(4-6t^2+3t^3) + (h2)(1/6)(1+3t+3t^2-3t^3) + (h3)(1/6)(t^3)
 
-	const float oneOverSix = oneSixth;
-	const float t2 = t * t;
-	const float t3 = t2 * t;
+	const T oneOverSix = oneSixth;
+	const T t2 = t * t;
+	const T t3 = t2 * t;
 
 	return	(h0 * oneOverSix * (1 - 3*t + 3*t2 - t3)) +
 			(h1 * oneOverSix * (4 - 6*t2 + 3*t3)) +
@@ -190,12 +203,13 @@ float CubicBSpline::calcHeightOnCubicBSpline(float t, float h0, float h1, float
 }
 
 
-float CubicBSpline::getTangentOnCubicBSpline(float t, float h0, float h1, float h2, float h3)
+template <class T>
+T CubicBSplineT<T>::getTangentOnCubicBSpline(T t, T h0, T h1, T h2, T h3)
 {
 	// x'(t) = (h0)(1/6)(-3+6t-3t^2) + (h1)(1/6)(-12t+9t^2) + (h2)(1/6)(3+6t-9t^2) + (h3)(1/6)(3t^2)
 
-	const float oneOverSix = oneSixth;
-	const float t2 = t * t;
+	const T oneOverSix = oneSixth;
+	const T t2 = t * t;
 
 	return	(h0 * oneOverSix * (-3 + 6*t - 3*t2)) +
 			(h1 * oneOverSix * (-12*t + 9*t2)) +
@@ -204,11 +218,12 @@ float CubicBSpline::getTangentOnCubicBSpline(float t, float h0, float h1, float
 }
 
 
-float CubicBSpline::getConcavityOnCubicBSpline(float t, float h0, float h1, float h2, float h3)
+template <class T>
+T CubicBSplineT<T>::getConcavityOnCubicBSpline(T t, T h0, T h1, T h2, T h3)
 {
 	// x''(t) = (h0)(1/6)(6-6t) + (h1)(1/6)(-12+18t) + (h2)(1/6)(6-18t) + (h3)(1/6)(6t)
 
-	const float oneOverSix = oneSixth;
+	const T oneOverSix = oneSixth;
 
 	return	(h0 * oneOverSix * (6 - 6*t)) +
 			(h1 * oneOverSix * (-12 + 18*t)) +
@@ -217,9 +232,56 @@ float CubicBSpline::getConcavityOnCubicBSpline(float t, float h0, float h1, floa
 }
 
 
-float CubicBSpline::calcHeightOnPatch(float u, float v, const float *hBuffer)
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//	calcBasis
+//
+//		Fills w with the weights of h0 to h3 at t, the terms of calcHeightOnCubicBSpline, so grids
+//		of control heights can be evaluated as weighted sums without building a patch
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class T>
+void CubicBSplineT<T>::calcBasis(T t, T *w)
+{
+	const T t2 = t * t;
+	const T t3 = t2 * t;
+
+	w[0] = oneSixth * (1 - 3*t + 3*t2 - t3);
+	w[1] = oneSixth * (4 - 6*t2 + 3*t3);
+	w[2] = oneSixth * (1 + 3*t + 3*t2 - 3*t3);
+	w[3] = oneSixth * t3;
+}
+
+
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//	calcBasisDerivatives
+//
+//		calcBasis along with the weights of getTangentOnCubicBSpline in dw and of
+//		getConcavityOnCubicBSpline in d2w, for first and second derivatives of control grids
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class T>
+void CubicBSplineT<T>::calcBasisDerivatives(T t, T *w, T *dw, T *d2w)
 {
-	float p0,p1,p2,p3;
+	const T t2 = t * t;
+
+	calcBasis(t, w);
+
+	dw[0] = oneSixth * (-3 + 6*t - 3*t2);
+	dw[1] = oneSixth * (-12*t + 9*t2);
+	dw[2] = oneSixth * (3 + 6*t - 9*t2);
+	dw[3] = oneSixth * (3*t2);
+
+	d2w[0] = 1 - t;
+	d2w[1] = -2 + 3*t;
+	d2w[2] = 1 - 3*t;
+	d2w[3] = t;
+}
+
+
+template <class T>
+T CubicBSplineT<T>::calcHeightOnPatch(T u, T v, const T *hBuffer)
+{
+	T p0,p1,p2,p3;
 	
 	// if u is within range of 1.0, flip spline and use 0
 	if (fabs(u - 1.0f) <= EPSILON) {
@@ -251,7 +313,8 @@ float CubicBSpline::calcHeightOnPatch(float u, float v, const float *hBuffer)
 
 
 ///// Pre-calc functions
-Vector4 CubicBSpline::preCalcSpline(const Vector4 &pts)
+template <class T>
+Vector4T<T> CubicBSplineT<T>::preCalcSpline(const Vector4T<T> &pts)
 {
 //	preCalcVector = pts * basisMatrix;
 
@@ -272,7 +335,8 @@ Vector4 CubicBSpline::preCalcSpline(const Vector4 &pts)
 }
 
 
-Vector3 CubicBSpline::preCalcTangent(const Vector4 &pts)
+template <class T>
+Vector3T<T> CubicBSplineT<T>::preCalcTangent(const Vector4T<T> &pts)
 {
 //	preCalcTangentVector = pts * basisMatrixDerivative;
 
@@ -291,7 +355,8 @@ Vector3 CubicBSpline::preCalcTangent(const Vector4 &pts)
 }
 
 
-Vector2 CubicBSpline::preCalcConcavity(const Vector4 &pts)
+template <class T>
+Vector2T<T> CubicBSplineT<T>::preCalcConcavity(const Vector4T<T> &pts)
 {
 //	preCalcTangentVector = pts * basisMatrixDerivative;
 
@@ -308,25 +373,28 @@ Vector2 CubicBSpline::preCalcConcavity(const Vector4 &pts)
 }
 
 
-float CubicBSpline::getPreCalcHeight(float t)
+template <class T>
+T CubicBSplineT<T>::getPreCalcHeight(T t)
 {
-	Vector4 tVec(1.0f, t, t*t, t*t*t);
+	Vector4T<T> tVec(1.0f, t, t*t, t*t*t);
 
 	return tVec * preCalcVector;
 }
 
 
-float CubicBSpline::getPreCalcTangent(float t)
+template <class T>
+T CubicBSplineT<T>::getPreCalcTangent(T t)
 {
-	Vector3 tVec(1.0f, t, t*t);
+	Vector3T<T> tVec(1.0f, t, t*t);
 	
 	return tVec * preCalcTangentVector;
 }
 
 
-float CubicBSpline::getPreCalcConcavity(float t)
+template <class T>
+T CubicBSplineT<T>::getPreCalcConcavity(T t)
 {
-	Vector2 tVec(1.0f, t);
+	Vector2T<T> tVec(1.0f, t);
 	
 	return tVec * preCalcConcavityVector;
 }
@@ -335,17 +403,33 @@ float CubicBSpline::getPreCalcConcavity(float t)
 ////////////////////////////////////////////////////////////////////////////////////////////////////
 //	preCalcMiddleMatrix
 //
-//		Expects a float buffer of 16 values (11,12,13,14,21,22,23,24,31,32,33,34,41,42,43,44)
+//		Expects a T buffer of 16 values (11,12,13,14,21,22,23,24,31,32,33,34,41,42,43,44)
 //		and sets the middle matrix for the patch
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-void CubicBSpline::preCalcMiddleMatrix(const float *hBuffer)
+template <class T>
+void CubicBSplineT<T>::preCalcMiddleMatrix(const T *hBuffer)
 {
-	for (int c = 0; c < 16; c++) pointsMatrix.i[c] = hBuffer[c];
+	calcMiddleMatrix(hBuffer, middleMatrix);
+}
+
 
-	middleMatrix = basisMatrix;
-	middleMatrix *= pointsMatrix;
-	middleMatrix *= basisMatrixT;
+////////////////////////////////////////////////////////////////////////////////////////////////////
+//	calcMiddleMatrix
+//
+//		Same as preCalcMiddleMatrix but the result goes to out, so patches can be prepared on
+//		other threads and used later with setMiddleMatrixPtr
+//
+////////////////////////////////////////////////////////////////////////////////////////////////////
+template <class T>
+void CubicBSplineT<T>::calcMiddleMatrix(const T *hBuffer, Matrix4x4T<T> &out)
+{
+	Matrix4x4T<T> points;
+	for (int c = 0; c < 16; c++) points.i[c] = hBuffer[c];
+
+	out = basisMatrix;
+	out *= points;
+	out *= basisMatrixT;
 }
 
 
@@ -356,10 +440,11 @@ void CubicBSpline::preCalcMiddleMatrix(const float *hBuffer)
 //		this function for a certain patch
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-float CubicBSpline::calcHeightOnPatchMatrix(float u, float v, bool usePtrMiddleMatrix)
+template <class T>
+T CubicBSplineT<T>::calcHeightOnPatchMatrix(T u, T v, bool usePtrMiddleMatrix)
 {
-	Vector4 v1(1.0f, u, u*u, u*u*u);
-	Vector4 v2(1.0f, v, v*v, v*v*v);
+	Vector4T<T> v1(1.0f, u, u*u, u*u*u);
+	Vector4T<T> v2(1.0f, v, v*v, v*v*v);
 
 	if (usePtrMiddleMatrix) {
 		v2 *= (*ptrMiddleMatrix);
@@ -371,18 +456,20 @@ float CubicBSpline::calcHeightOnPatchMatrix(float u, float v, bool usePtrMiddleM
 }
 
 
-Vector3	CubicBSpline::calcNormalOnPatchMatrix(float u, float v, bool usePtrMiddleMatrix)
+template <class T>
+Vector3T<T> CubicBSplineT<T>::calcNormalOnPatchMatrix(T u, T v, bool usePtrMiddleMatrix)
 {
-	// calc derivative with respect to v
-	Vector4 vec1(1.0f, u, u*u, u*u*u);
-	Vector4 vec2(0, 1, 2*v, 3*v*v);
+	// calc derivative with respect to v, the tangents are scaled to the patch size by
+	// hSpacing and to the height scale by vSpacing
+	Vector4T<T> vec1(1.0f, u, u*u, u*u*u);
+	Vector4T<T> vec2(0, 1, 2*v, 3*v*v);
 
 	if (usePtrMiddleMatrix) {
 		vec2 *= (*ptrMiddleMatrix);
 	} else {
 		vec2 *= middleMatrix;
 	}
-	Vector3 nv(0, (vec1 * vec2)+vSpacing, hSpacing);
+	Vector3T<T> nv(0, (vec1 * vec2)*vSpacing, hSpacing);
 
 	// calc derivative with respect to u
 	vec1.assign(0, 1, 2*u, 3*u*u);
@@ -393,10 +480,10 @@ Vector3	CubicBSpline::calcNormalOnPatchMatrix(float u, float v, bool usePtrMiddl
 	} else {
 		vec2 *= middleMatrix;
 	}
-	Vector3 nu(hSpacing, (vec1 * vec2)+vSpacing, 0);
+	Vector3T<T> nu(hSpacing, (vec1 * vec2)*vSpacing, 0);
 
 	// cross product gives normal
-	Vector3 n;
+	Vector3T<T> n;
 	n.unitNormalOf(nu, nv);
 	
 	return n;
@@ -411,18 +498,19 @@ Vector3	CubicBSpline::calcNormalOnPatchMatrix(float u, float v, bool usePtrMiddl
 //		the control point (t=0 or t=1.0)
 //
 ////////////////////////////////////////////////////////////////////////////////////////////////////
-float CubicBSpline::calcConcavityOnPatchMatrix(float u, float v, bool usePtrMiddleMatrix)
+template <class T>
+T CubicBSplineT<T>::calcConcavityOnPatchMatrix(T u, T v, bool usePtrMiddleMatrix)
 {
 	// calc second derivative with respect to v
-	Vector4 vec1(1.0f, u, u*u, u*u*u);
-	Vector4 vec2(0, 0, 2.0f, 6*v);
+	Vector4T<T> vec1(1.0f, u, u*u, u*u*u);
+	Vector4T<T> vec2(0, 0, 2.0f, 6*v);
 
 	if (usePtrMiddleMatrix) {
 		vec2 *= (*ptrMiddleMatrix);
 	} else {
 		vec2 *= middleMatrix;
 	}
-	float first = fabs((vec1 * vec2) * invVSpacing);
+	T first = fabs((vec1 * vec2) * invVSpacing);
 
 	// calc second derivative with respect to u
 	vec1.assign(0, 0, 2.0f, 6*u);
@@ -433,24 +521,25 @@ float CubicBSpline::calcConcavityOnPatchMatrix(float u, float v, bool usePtrMidd
 	} else {
 		vec2 *= middleMatrix;
 	}
-	float second = fabs((vec1 * vec2) * invVSpacing);
+	T second = fabs((vec1 * vec2) * invVSpacing);
 
 	return (second > first) ? second : first; // consider adding them up and then return abs
 }
 
 
-////////// class BSpline //////////
+////////// class BSplineT //////////
 
 
-float BSpline::N(float t, int i, int k, float *knot)
+template <class T>
+T BSplineT<T>::N(T t, int i, int k, T *knot)
 {
 	if (k == 1) {
 		if (knot[i] <= t && t < knot[i+1]) return 1.0f;
 		return 0;
 	}
 
-	float term1 = 0;
-	float term2 = 0;
+	T term1 = 0;
+	T term2 = 0;
 
 	if (knot[i+k-1] - knot[i] != 0)
 		term1 = (t - knot[i]) * N(t, i, k-1, knot) / (knot[i+k-1] - knot[i]);
@@ -462,24 +551,25 @@ float BSpline::N(float t, int i, int k, float *knot)
 }
 
 
-Vector3 BSpline::calcPointOnBSpline(float t, int k, Vector3 *pts, int numPts, BSplineType splineType)
+template <class T>
+Vector3T<T> BSplineT<T>::calcPointOnBSpline(T t, int k, Vector3T<T> *pts, int numPts, BSplineType splineType)
 {
 	assert(k >= 2 && k <= numPts);
 
-	Vector3 returnVector(0,0,0);
+	Vector3T<T> returnVector(0,0,0);
 
 	// N+k elements == (numPts-1)+k
 	const int n = numPts - 1;
 	const int segments = n - k + 2;
 	const int knotElements = numPts - 1 + k;
 
-	float *knot = new float[knotElements];
+	T *knot = new T[knotElements];
 
 	if (splineType == BSPLINE_TYPE_OPEN_NORMALIZED) {
 
 		// Make an open/uniform knot vector (normalized)
-		float knotStep = 1.0f / segments;
-		float knotVal = 0;
+		T knotStep = T(1) / segments;
+		T knotVal = 0;
 		for (int c = 0; c < knotElements; c++) {			
 			knot[c] = knotVal;
 			if (c >= k-1 && c < numPts) knotVal += knotStep;
@@ -490,15 +580,15 @@ Vector3 BSpline::calcPointOnBSpline(float t, int k, Vector3 *pts, int numPts, BS
 		// Make an open/uniform knot vector
 		int knotVal = 0;
 		for (int c = 0; c < knotElements; c++) {
-			knot[c] = (float)knotVal;
+			knot[c] = (T)knotVal;
 			if (c >= k-1 && c < numPts) knotVal++;
 		}
 
 	} else if (splineType == BSPLINE_TYPE_PERIODIC_NORMALIZED) {
 
 		// Make a periodic/uniform knot vector (normalized)
-		float knotStep = 1.0f / segments;
-		float knotVal = 0;
+		T knotStep = T(1) / segments;
+		T knotVal = 0;
 		for (int s = 0; s < knotElements; s++) {
 			knot[s] = knotVal;
 			knotVal += knotStep;
@@ -509,7 +599,7 @@ Vector3 BSpline::calcPointOnBSpline(float t, int k, Vector3 *pts, int numPts, BS
 		// Make a periodic/uniform knot vector (not normalized)
 		int knotVal = 0;
 		for (int s = 0; s < knotElements; s++) {
-			knot[s] = (float)knotVal;
+			knot[s] = (T)knotVal;
 			knotVal++;
 		}
 
@@ -525,18 +615,19 @@ Vector3 BSpline::calcPointOnBSpline(float t, int k, Vector3 *pts, int numPts, BS
 }
 
 
-Vector3 BSpline::calcPointOnCubicBSpline(float t, Vector3 *pts, int numPts, BSplineType splineType)
+template <class T>
+Vector3T<T> BSplineT<T>::calcPointOnCubicBSpline(T t, Vector3T<T> *pts, int numPts, BSplineType splineType)
 {
-	Vector3 returnVector(0,0,0);
+	Vector3T<T> returnVector(0,0,0);
 
 	// N+k elements == (numPts-1)+k
-	float *knot = new float[numPts+3];
+	T *knot = new T[numPts+3];
 
 	if (splineType == BSPLINE_TYPE_OPEN_NORMALIZED) {
 
 		// Make an open/uniform knot vector (normalized)
-		float knotStep = 1.0f / (numPts-3);
-		float knotVal = 0;
+		T knotStep = T(1) / (numPts-3);
+		T knotVal = 0;
 		for (int c = 0; c < numPts+3; c++) {
 			knot[c] = knotVal;
 			if (c >= 3 && c < numPts) knotVal += knotStep;
@@ -547,15 +638,15 @@ Vector3 BSpline::calcPointOnCubicBSpline(float t, Vector3 *pts, int numPts, BSpl
 		// Make an open/uniform knot vector
 		int knotVal = 0;
 		for (int c = 0; c < numPts+3; c++) {
-			knot[c] = (float)knotVal;
+			knot[c] = (T)knotVal;
 			if (c >= 3 && c < numPts) knotVal++;
 		}
 
 	} else if (splineType == BSPLINE_TYPE_PERIODIC_NORMALIZED) {
 
 		// Make a periodic/uniform knot vector (normalized)
-		float knotStep = 1.0f / (numPts+4);
-		float knotVal = 0;
+		T knotStep = T(1) / (numPts+4);
+		T knotVal = 0;
 		for (int s = 0; s < numPts+3; s++) {
 			knot[s] = knotVal;
 			knotVal += knotStep;
@@ -566,7 +657,7 @@ Vector3 BSpline::calcPointOnCubicBSpline(float t, Vector3 *pts, int numPts, BSpl
 		// Make a periodic/uniform knot vector (not normalized)
 		int knotVal = 0;
 		for (int s = 0; s < numPts+3; s++) {
-			knot[s] = (float)knotVal;
+			knot[s] = (T)knotVal;
 			knotVal++;
 		}
 
@@ -582,12 +673,13 @@ Vector3 BSpline::calcPointOnCubicBSpline(float t, Vector3 *pts, int numPts, BSpl
 }
 
 
-Vector3 BSpline::calcPointOnBiCubicPatch(float u, float v, Vector3 *pBuffer,
+template <class T>
+Vector3T<T> BSplineT<T>::calcPointOnBiCubicPatch(T u, T v, Vector3T<T> *pBuffer,
 								  int bufferWidth, int bufferHeight, BSplineType splineType)
 {
-	Vector3 *p = new Vector3[bufferHeight];
+	Vector3T<T> *p = new Vector3T<T>[bufferHeight];
 
-	Vector3 *bufferPosition = pBuffer;
+	Vector3T<T> *bufferPosition = pBuffer;
 	for (int h = 0; h < bufferHeight; h++) {
 		p[h] = calcPointOnCubicBSpline(u, bufferPosition, bufferWidth, splineType);
 
@@ -595,4 +687,16 @@ Vector3 BSpline::calcPointOnBiCubicPatch(float u, float v, Vector3 *pBuffer,
 	}
 
 	return calcPointOnCubicBSpline(v, p, bufferHeight, splineType);
-}
\ No newline at end of file
+}
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class CatmullRomSplineT<float>;
+template class CatmullRomSplineT<double>;
+template class CubicBSplineT<float>;
+template class CubicBSplineT<double>;
+template class BSplineT<float>;
+template class BSplineT<double>;
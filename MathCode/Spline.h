@@ -11,102 +11,104 @@
 #ifndef SPLINE_H
 #define SPLINE_H
 
-#include "matrix4x4.h"
+#include "MathTypes.h"
+#include "Matrix4x4.h"
 
 /*------------------
 ---- STRUCTURES ----
 ------------------*/
 
-class Vector2;
-class Vector3;
-class Vector4;
 
-
-class CatmullRomSpline {
+template <class T>
+class CatmullRomSplineT {
 
 	private:
 
 		///// Used in precalc stage for heightfield mesh equations
-		static Matrix4x4	basisMatrix;	// stores equation basis values
-		static Matrix4x4	preCalcMatrix;	// stores precalc values of 4 splines in a patch
-		static Matrix4x4	splineMatrix;	// used for finding point in a patch
+		static Matrix4x4T<T>	basisMatrix;	// stores equation basis values
+		static Matrix4x4T<T>	preCalcMatrix;	// stores precalc values of 4 splines in a patch
+		static Matrix4x4T<T>	splineMatrix;	// used for finding point in a patch
 
-		static void			preCalcCatmullRom(Vector4 &v, float p1, float p2, float p3, float p4);
+		static void			preCalcCatmullRom(Vector4T<T> &v, T p1, T p2, T p3, T p4);
 
 	public:
 		
 		///// Complex mesh equations, SLOW
 		
-		static Vector3		calcPointOnSpline(float t, const Vector3 &p0, const Vector3 &p1,
-											const Vector3 &p2, const Vector3 &p3);
+		static Vector3T<T>	calcPointOnSpline(T t, const Vector3T<T> &p0, const Vector3T<T> &p1,
+											const Vector3T<T> &p2, const Vector3T<T> &p3);
 
-		static Vector3		calcPointOnPatch(float u, float v, Vector3 *pBuffer);
+		static Vector3T<T>	calcPointOnPatch(T u, T v, Vector3T<T> *pBuffer);
 
 		///// Heightfield mesh equations, FAST
 
-		static void			setSplineMatrix(int xi, int zi, float *height, int size);
-		static float		calcQuad(float u, float v);
-//		static float		calcHeightInPatch(float u, float v);
+		static void			setSplineMatrix(int xi, int zi, T *height, int size);
+		static T			calcQuad(T u, T v);
+//		static T			calcHeightInPatch(T u, T v);
 };
 
 
-class CubicBSpline {
+template <class T>
+class CubicBSplineT {
 
 	private:
 
-		const static float	oneSixth;
+		const static T		oneSixth;
 
 		///// Used in precalc stage
-		static Matrix4x4	basisMatrix;			// stores equation basis values
-		static Matrix4x4	basisMatrixT;			// stores transpose of basis matrix
-		static Matrix4x4	pointsMatrix;			// stores control points of patch
-		static Matrix4x4	middleMatrix;			// stores precalc values
-		static Matrix4x4 const *ptrMiddleMatrix;	// pointer to a middle matrix, prevents having to copy values
-		static float		hSpacing;				// used to correct surface normals for scaled x,z spacing of surface maps
-		static float		vSpacing;				// used to correct surface normals for scaled y spacing of surface maps
-		static float		invVSpacing;			// for optimized concavity calculation
+		static Matrix4x4T<T>	basisMatrix;			// stores equation basis values
+		static Matrix4x4T<T>	basisMatrixT;			// stores transpose of basis matrix
+		static Matrix4x4T<T>	middleMatrix;			// stores precalc values
+		static Matrix4x4T<T> const *ptrMiddleMatrix;	// pointer to a middle matrix, prevents having to copy values
+		static T			hSpacing;				// used to correct surface normals for scaled x,z spacing of surface maps
+		static T			vSpacing;				// used to correct surface normals for scaled y spacing of surface maps
+		static T			invVSpacing;			// for optimized concavity calculation
 		
-		static Vector4		preCalcVector;			// control points * basis
-		static Vector3		preCalcTangentVector;
-		static Vector2		preCalcConcavityVector;
+		static Vector4T<T>	preCalcVector;			// control points * basis
+		static Vector3T<T>	preCalcTangentVector;
+		static Vector2T<T>	preCalcConcavityVector;
 
 	public:
 
 		///// Heightfield non-matrix form, SLOW
 
-		static float		calcHeightOnCubicBSpline(float t, float h0, float h1, float h2, float h3);
-		static float		getTangentOnCubicBSpline(float t, float h0, float h1, float h2, float h3);
-		static float		getConcavityOnCubicBSpline(float t, float h0, float h1, float h2, float h3);
-		static float		calcHeightOnPatch(float u, float v, const float *hBuffer);
+		static T			calcHeightOnCubicBSpline(T t, T h0, T h1, T h2, T h3);
+		static T			getTangentOnCubicBSpline(T t, T h0, T h1, T h2, T h3);
+		static T			getConcavityOnCubicBSpline(T t, T h0, T h1, T h2, T h3);
+		static T			calcHeightOnPatch(T u, T v, const T *hBuffer);
+		static void			calcBasis(T t, T *w);	// weights of h0..h3 at t
+		static void			calcBasisDerivatives(T t, T *w, T *dw, T *d2w);	// and of the tangent and concavity
 
 		///// Heightfield non-matrix form Pre-calc version, FASTER
 
-		static Vector4		preCalcSpline(const Vector4 &pts);
-		static Vector3		preCalcTangent(const Vector4 &pts);
-		static Vector2		preCalcConcavity(const Vector4 &pts);
-		static float		getPreCalcHeight(float t);
-		static float		getPreCalcTangent(float t);
-		static float		getPreCalcConcavity(float t);
+		static Vector4T<T>	preCalcSpline(const Vector4T<T> &pts);
+		static Vector3T<T>	preCalcTangent(const Vector4T<T> &pts);
+		static Vector2T<T>	preCalcConcavity(const Vector4T<T> &pts);
+		static T			getPreCalcHeight(T t);
+		static T			getPreCalcTangent(T t);
+		static T			getPreCalcConcavity(T t);
 
 		///// Heightfield matrix form, FASTEST
 
-		static void			preCalcMiddleMatrix(const float *hBuffer);
-		static void			setMiddleMatrix(const Matrix4x4 &m) { middleMatrix.set(m); }
-		static void			setMiddleMatrixPtr(const Matrix4x4 &m) { ptrMiddleMatrix = &m; }
-		static void			setSpacing(float h, float v) { hSpacing = h; vSpacing = v; invVSpacing = (vSpacing == 0) ? 0 : 1.0f / vSpacing; }
-		static float		calcHeightOnPatchMatrix(float u, float v, bool usePtrMiddleMatrix);
-		static Vector3		calcNormalOnPatchMatrix(float u, float v, bool usePtrMiddleMatrix);
-		static float		calcConcavityOnPatchMatrix(float u, float v, bool usePtrMiddleMatrix);
-		static const Matrix4x4 & getMiddleMatrix() { return middleMatrix; }
+		static void			preCalcMiddleMatrix(const T *hBuffer);
+		static void			calcMiddleMatrix(const T *hBuffer, Matrix4x4T<T> &out);	// thread safe, only reads the basis
+		static void			setMiddleMatrix(const Matrix4x4T<T> &m) { middleMatrix.set(m); }
+		static void			setMiddleMatrixPtr(const Matrix4x4T<T> &m) { ptrMiddleMatrix = &m; }
+		static void			setSpacing(T h, T v) { hSpacing = h; vSpacing = v; invVSpacing = (vSpacing == 0) ? 0 : T(1) / vSpacing; }
+		static T			calcHeightOnPatchMatrix(T u, T v, bool usePtrMiddleMatrix);
+		static Vector3T<T>	calcNormalOnPatchMatrix(T u, T v, bool usePtrMiddleMatrix);
+		static T			calcConcavityOnPatchMatrix(T u, T v, bool usePtrMiddleMatrix);
+		static const Matrix4x4T<T> & getMiddleMatrix() { return middleMatrix; }
 };
 
 
-class BSpline {
+template <class T>
+class BSplineT {
 
 	private:
 
 		///// Used with recursive algorithm
-		static float		N(float t, int i, int k, float *knot);
+		static T			N(T t, int i, int k, T *knot);
 
 	public:
 
@@ -117,13 +119,26 @@ class BSpline {
 			BSPLINE_TYPE_PERIODIC_NOT_NORMALIZED
 		};
 
-		static Vector3		calcPointOnBSpline(float t, int k, Vector3 *pts, int numPts, BSplineType splineType);
+		static Vector3T<T>	calcPointOnBSpline(T t, int k, Vector3T<T> *pts, int numPts, BSplineType splineType);
 
-		static Vector3		calcPointOnCubicBSpline(float t, Vector3 *pts, int numPts, BSplineType splineType);
+		static Vector3T<T>	calcPointOnCubicBSpline(T t, Vector3T<T> *pts, int numPts, BSplineType splineType);
 		
-		static Vector3		calcPointOnBiCubicPatch(float u, float v, Vector3 *pBuffer,
+		static Vector3T<T>	calcPointOnBiCubicPatch(T u, T v, Vector3T<T> *pBuffer,
 												int bufferWidth, int bufferHeight, BSplineType splineType);
 };
 
 
+/*----------------
+---- TYPEDEFS ----
+----------------*/
+
+typedef CatmullRomSplineT<float>	CatmullRomSpline;
+typedef CubicBSplineT<float>		CubicBSpline;
+typedef BSplineT<float>				BSpline;
+
+typedef CatmullRomSplineT<double>	CatmullRomSplined;
+typedef CubicBSplineT<double>		CubicBSplined;
+typedef BSplineT<double>			BSplined;
+
+
 #endif
\ No newline at end of file
@@ -9,31 +9,41 @@
 
 
 #include <sstream>
-#include "vector2.h"
+#include "Vector2.h"
 
 /*-----------------
 ---- FUNCTIONS ----
 -----------------*/
 
-////////// class Vector2 //////////
+////////// class Vector2T //////////
 
 
-void Vector2::normalize(void)
+template <class T>
+void Vector2T<T>::normalize(void)
 {
 	// Normalize the vector to unit length
-	float magSq = this->magSquared();
+	T magSq = this->magSquared();
 
 	if (magSq > 0) {
-		float invMag = 1.0f / sqrtf(magSq);
+		T invMag = T(1) / std::sqrt(magSq);
 		x *= invMag;
 		y *= invMag;
 	}
 }
 
 
-std::string Vector2::toString(void) const
+template <class T>
+std::string Vector2T<T>::toString(void) const
 {
 	std::ostringstream returnStr;
 	returnStr << "(" << x << "," << y << ")";
 	return returnStr.str();
-}
\ No newline at end of file
+}
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class Vector2T<float>;
+template class Vector2T<double>;
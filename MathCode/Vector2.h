@@ -13,8 +13,9 @@
 
 #include <string>
 #include <cmath>
-#include "..\UTILITYCODE\msgassert.h"
-#include "..\UTILITYCODE\typedefs.h"
+#include "../UtilityCode/MsgAssert.h"
+#include "../UtilityCode/Typedefs.h"
+#include "MathTypes.h"
 
 /*------------------
 ---- STRUCTURES ----
@@ -29,57 +30,58 @@ class Point2i {
 };
 
 
-class Vector2 {
+template <class T>
+class Vector2T {
 	
 	public:
 
 		///// Variables
 
-		float x, y;
+		T x, y;
 
 		///// Overloaded Operators
 
 		// Conditional operators
-		bool	operator==(const Vector2 &p) const { return (x == p.x && y == p.y); }
-		bool	operator!=(const Vector2 &p) const { return (x != p.x || y != p.y); }
+		bool	operator==(const Vector2T &p) const { return (x == p.x && y == p.y); }
+		bool	operator!=(const Vector2T &p) const { return (x != p.x || y != p.y); }
 
 		// Assignment operators
-		void	operator+=(const Vector2 &p) { x += p.x; y += p.y; }
-		void	operator-=(const Vector2 &p) { x -= p.x; y -= p.y; }
-		void	operator*=(float s) { x *= s; y *= s; }
-		void	operator/=(float s) { assert(s != 0); x /= s; y /= s; }
+		void	operator+=(const Vector2T &p) { x += p.x; y += p.y; }
+		void	operator-=(const Vector2T &p) { x -= p.x; y -= p.y; }
+		void	operator*=(T s) { x *= s; y *= s; }
+		void	operator/=(T s) { assert(s != 0); x /= s; y /= s; }
 
 		// Not as fast as functions below, but these allow streamed operations ie. V = VA + VB - VC
-		Vector2 operator- (void) const { return Vector2(-x,-y); }
-		Vector2	operator+ (const Vector2 &p) const { return Vector2(x+p.x, y+p.y); }
-		Vector2	operator- (const Vector2 &p) const { return Vector2(x-p.x, y-p.y); }
-		Vector2	operator* (float s) const { return Vector2(x*s, y*s); }
-		Vector2	operator/ (float s) const { assert(s != 0); return Vector2(x/s, y/s); }
+		Vector2T operator- (void) const { return Vector2T(-x,-y); }
+		Vector2T	operator+ (const Vector2T &p) const { return Vector2T(x+p.x, y+p.y); }
+		Vector2T	operator- (const Vector2T &p) const { return Vector2T(x-p.x, y-p.y); }
+		Vector2T	operator* (T s) const { return Vector2T(x*s, y*s); }
+		Vector2T	operator/ (T s) const { assert(s != 0); return Vector2T(x/s, y/s); }
 
 		// Dot product
-		float	operator* (const Vector2 &p) const { return (x * p.x) + (y * p.y); }
+		T		operator* (const Vector2T &p) const { return (x * p.x) + (y * p.y); }
 
 		///// Functions
 
-		void			assign(float _x, float _y) { x = _x; y = _y; }
+		void			assign(T _x, T _y) { x = _x; y = _y; }
 
 		// Check equality with floating point error, SLOW
-		__inline bool	equalTo(const Vector2 &p) const;
-		__inline bool	notEqualTo(const Vector2 &p) const;
+		__inline bool	equalTo(const Vector2T &p) const;
+		__inline bool	notEqualTo(const Vector2T &p) const;
 
 		// Faster than the overloaded operators above
-		__inline void	add(const Vector2 &p1, const Vector2 &p2);
-		__inline void	subtract(const Vector2 &p1, const Vector2 &p2);
-		__inline void	multiply(const Vector2 &p, float s);
-		__inline void	divide(const Vector2 &p, float s);
+		__inline void	add(const Vector2T &p1, const Vector2T &p2);
+		__inline void	subtract(const Vector2T &p1, const Vector2T &p2);
+		__inline void	multiply(const Vector2T &p, T s);
+		__inline void	divide(const Vector2T &p, T s);
 		
 		// Finds the distance between two points
-		__inline float	dist(const Vector2 &p) const;
-		__inline float	distSquared(const Vector2 &p) const;
+		__inline T		dist(const Vector2T &p) const;
+		__inline T		distSquared(const Vector2T &p) const;
 
 		// Finds the magnitude of the vector, or it's distance from the origin
-		float			mag(void) const { return sqrtf(x*x + y*y); }
-		float			magSquared(void) const { return x*x + y*y; }
+		T				mag(void) const { return std::sqrt(x*x + y*y); }
+		T				magSquared(void) const { return x*x + y*y; }
 
 		// Vector methods
 		void			normalize(void);
@@ -88,10 +90,12 @@ class Vector2 {
 		std::string		toString(void) const;
 
 		// Constructors / Destructor
-		Vector2() : x(0), y(0) {}
-		Vector2(const Vector2 &p) : x(p.x), y(p.y) {}
-		explicit		Vector2(float _x, float _y) : x(_x), y(_y) {}
-		~Vector2() {}
+		Vector2T() : x(0), y(0) {}
+		Vector2T(const Vector2T &p) : x(p.x), y(p.y) {}
+		explicit		Vector2T(T _x, T _y) : x(_x), y(_y) {}
+		template <class U>
+		explicit		Vector2T(const Vector2T<U> &p) : x((T)p.x), y((T)p.y) {}
+		~Vector2T() {}
 };
 
 
@@ -100,45 +104,51 @@ class Vector2 {
 ------------------------*/
 
 
-__inline bool Vector2::equalTo(const Vector2 &p) const
+template <class T>
+__inline bool Vector2T<T>::equalTo(const Vector2T<T> &p) const
 {
-	if (fabs(p.x - x) <= EPSILON)
-		if (fabs(p.y - y) <= EPSILON)
+	if (std::fabs(p.x - x) <= EPSILON)
+		if (std::fabs(p.y - y) <= EPSILON)
 			return true;
 	
 	return false;
 }
 
 
-__inline bool Vector2::notEqualTo(const Vector2 &p) const
+template <class T>
+__inline bool Vector2T<T>::notEqualTo(const Vector2T<T> &p) const
 {
-	if ((fabs(p.x - x) > EPSILON) || (fabs(p.y - y) > EPSILON)) return true;
+	if ((std::fabs(p.x - x) > EPSILON) || (std::fabs(p.y - y) > EPSILON)) return true;
 	else return false;
 }
 
 
-__inline void Vector2::add(const Vector2 &p1, const Vector2 &p2)
+template <class T>
+__inline void Vector2T<T>::add(const Vector2T<T> &p1, const Vector2T<T> &p2)
 {
 	x = p1.x + p2.x;
 	y = p1.y + p2.y;
 }
 
 
-__inline void Vector2::subtract(const Vector2 &p1, const Vector2 &p2)
+template <class T>
+__inline void Vector2T<T>::subtract(const Vector2T<T> &p1, const Vector2T<T> &p2)
 {
 	x = p1.x - p2.x;
 	y = p1.y - p2.y;
 }
 
 
-__inline void Vector2::multiply(const Vector2 &p, float s)
+template <class T>
+__inline void Vector2T<T>::multiply(const Vector2T<T> &p, T s)
 {
 	x = p.x * s;
 	y = p.y * s;
 }
 
 
-__inline void Vector2::divide(const Vector2 &p, float s)
+template <class T>
+__inline void Vector2T<T>::divide(const Vector2T<T> &p, T s)
 {
 	msgAssert(s != 0, "vector divide by 0");
 	x = p.x / s;
@@ -146,18 +156,20 @@ __inline void Vector2::divide(const Vector2 &p, float s)
 }
 
 
-__inline float Vector2::dist(const Vector2 &p) const
+template <class T>
+__inline T Vector2T<T>::dist(const Vector2T<T> &p) const
 {
-	const float dx = p.x - x;
-	const float dy = p.y - y;
-	return sqrtf(dx*dx + dy*dy);
+	const T dx = p.x - x;
+	const T dy = p.y - y;
+	return std::sqrt(dx*dx + dy*dy);
 }
 
 
-__inline float Vector2::distSquared(const Vector2 &p) const
+template <class T>
+__inline T Vector2T<T>::distSquared(const Vector2T<T> &p) const
 {
-	const float dx = p.x - x;
-	const float dy = p.y - y;
+	const T dx = p.x - x;
+	const T dy = p.y - y;
 	return dx*dx + dy*dy;
 }
 
@@ -11,30 +11,32 @@
 //	--------------------------------------------------------------------------------
 
 #include <sstream>
-#include "vector3.h"
-#include "vector4.h"
-#include "matrix4x4.h"
-#include "..\UTILITYCODE\lookupmanager.h"
+#include "Vector3.h"
+#include "Vector4.h"
+#include "Matrix4x4.h"
+#include "../UtilityCode/LookupManager.h"
 
 
 /*-----------------
 ---- FUNCTIONS ----
 -----------------*/
 
-////////// class Vector3 //////////
+////////// class Vector3T //////////
 
 
 // The following 3 functions use only the 3x3 transformation portion of the matrix
 // so the point will not be translated
-Vector3	Vector3::operator* (const Matrix4x4 &m) const
+template <class T>
+Vector3T<T> Vector3T<T>::operator* (const Matrix4x4T<T> &m) const
 {
-	return Vector3(	x*m.i[0] + y*m.i[4] + z*m.i[8],
-					x*m.i[1] + y*m.i[5] + z*m.i[9],
-					x*m.i[2] + y*m.i[6] + z*m.i[10]);
+	return Vector3T<T>(	x*m.i[0] + y*m.i[4] + z*m.i[8],
+						x*m.i[1] + y*m.i[5] + z*m.i[9],
+						x*m.i[2] + y*m.i[6] + z*m.i[10]);
 }
 
 
-void Vector3::operator*=(const Matrix4x4 &m)
+template <class T>
+void Vector3T<T>::operator*=(const Matrix4x4T<T> &m)
 {
 	x = x*m.i[0] + y*m.i[4] + z*m.i[8];
 	y = x*m.i[1] + y*m.i[5] + z*m.i[9];
@@ -42,7 +44,8 @@ void Vector3::operator*=(const Matrix4x4 &m)
 }
 
 
-void Vector3::multiplyMatrix(const Vector3 &p, const Matrix4x4 &m)
+template <class T>
+void Vector3T<T>::multiplyMatrix(const Vector3T<T> &p, const Matrix4x4T<T> &m)
 {
 	x = p.x*m.i[0] + p.y*m.i[4] + p.z*m.i[8];
 	y = p.x*m.i[1] + p.y*m.i[5] + p.z*m.i[9];
@@ -51,7 +54,8 @@ void Vector3::multiplyMatrix(const Vector3 &p, const Matrix4x4 &m)
 
 
 // Convert from 4d vector to 3d vector, ignore w component of 4d vector
-void Vector3::assign(const Vector4 &p)
+template <class T>
+void Vector3T<T>::assign(const Vector4T<T> &p)
 {
 	x = p.x;
 	y = p.y;
@@ -59,7 +63,8 @@ void Vector3::assign(const Vector4 &p)
 }
 
 
-void Vector3::unitNormalOf(const Vector3 &p1, const Vector3 &p2)
+template <class T>
+void Vector3T<T>::unitNormalOf(const Vector3T<T> &p1, const Vector3T<T> &p2)
 {
 	// Calculates the normal vector with cross product
 	x = (p1.y * p2.z) - (p1.z * p2.y);
@@ -71,13 +76,14 @@ void Vector3::unitNormalOf(const Vector3 &p1, const Vector3 &p2)
 }
 
 
-void Vector3::normalize(void)
+template <class T>
+void Vector3T<T>::normalize(void)
 {
 	// Normalize the vector to unit length
-	float magSq = this->magSquared();
+	T magSq = this->magSquared();
 
 	if (magSq > 0) {
-		float invMag = 1.0f / sqrtf(magSq);
+		T invMag = T(1) / std::sqrt(magSq);
 		x *= invMag;
 		y *= invMag;
 		z *= invMag;
@@ -85,14 +91,15 @@ void Vector3::normalize(void)
 }
 
 
-void Vector3::rot3D(Vector3 &p, int xa, int ya, int za)
+template <class T>
+void Vector3T<T>::rot3D(Vector3T<T> &p, int xa, int ya, int za)
 {
 	msgAssert(xa >= 0 && xa < math.ANGLE360, "vector x angle out of range");
 	msgAssert(ya >= 0 && ya < math.ANGLE360, "vector y angle out of range");
 	msgAssert(za >= 0 && za < math.ANGLE360, "vector z angle out of range");
 
 	*this = p;
-	Vector3 tp;
+	Vector3T<T> tp;
 	
 	tp.x = x * math.getCos(za) + y * math.getSin(za);
 	tp.y = y * math.getCos(za) - x * math.getSin(za);
@@ -111,13 +118,14 @@ void Vector3::rot3D(Vector3 &p, int xa, int ya, int za)
 }
 
 
-void Vector3::rot3D(int xa, int ya, int za)
+template <class T>
+void Vector3T<T>::rot3D(int xa, int ya, int za)
 {
 	msgAssert(xa >= 0 && xa < math.ANGLE360, "vector x angle out of range");
 	msgAssert(ya >= 0 && ya < math.ANGLE360, "vector y angle out of range");
 	msgAssert(za >= 0 && za < math.ANGLE360, "vector z angle out of range");
 
-	Vector3 tp;
+	Vector3T<T> tp;
 	
 	tp.x = x * math.getCos(za) + y * math.getSin(za);
 	tp.y = y * math.getCos(za) - x * math.getSin(za);
@@ -136,7 +144,37 @@ void Vector3::rot3D(int xa, int ya, int za)
 }
 
 
-std::string Vector3::toString(void) const
+template <class T>
+void Vector3T<T>::rot3D(Vector3T<T> &p, BinAngle xa, BinAngle ya, BinAngle za)
+{
+	*this = p;
+	rot3D(xa, ya, za);
+}
+
+
+// same order and direction as the integer version: z, then x, then y
+template <class T>
+void Vector3T<T>::rot3D(BinAngle xa, BinAngle ya, BinAngle za)
+{
+	float sx, cx, sy, cy, sz, cz;
+	xa.sinCos(sx, cx);
+	ya.sinCos(sy, cy);
+	za.sinCos(sz, cz);
+
+	T tx = x * cz + y * sz;
+	T ty = y * cz - x * sz;
+
+	T tz = z * cx - ty * sx;
+	ty = ty * cx + z * sx;
+
+	x = tx * cy - tz * sy;
+	y = ty;
+	z = tz * cy + tx * sy;
+}
+
+
+template <class T>
+std::string Vector3T<T>::toString(void) const
 {
 	std::ostringstream returnStr;
 	returnStr << "(" << x << "," << y << "," << z << ")";
@@ -144,4 +182,13 @@ std::string Vector3::toString(void) const
 }
 
 
-Vector3::Vector3(const Vector4 &p) : x(p.x), y(p.y), z(p.z) {}
+template <class T>
+Vector3T<T>::Vector3T(const Vector4T<T> &p) : x(p.x), y(p.y), z(p.z) {}
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class Vector3T<float>;
+template class Vector3T<double>;
@@ -16,16 +16,15 @@
 
 #include <string>
 #include <cmath>
-#include "..\UTILITYCODE\msgassert.h"
-#include "..\UTILITYCODE\typedefs.h"
+#include "../UtilityCode/MsgAssert.h"
+#include "../UtilityCode/Typedefs.h"
+#include "MathTypes.h"
+#include "../UtilityCode/BinAngle.h"
 
 /*------------------
 ---- STRUCTURES ----
 ------------------*/
 
-class Vector4;
-class Matrix4x4;
-
 
 class Point3i {
 	public:
@@ -36,7 +35,8 @@ class Point3i {
 };
 
 
-class Vector3 {
+template <class T>
+class Vector3T {
 
 	public:
 
@@ -44,87 +44,98 @@ class Vector3 {
 		
 		union {
 			struct {
-				float x, y, z;		// This union allows access to the same memory location through either
+				T x, y, z;			// This union allows access to the same memory location through either
 			};						// x,y,z or the array v[3]. Use v for fast OpenGL functions
 
-			float v[3];
+			T v[3];
 		};
 
 
 		///// Overloaded Operators
 
 		// Conditional operators
-		bool	operator==(const Vector3 &p) const { return (x == p.x && y == p.y && z == p.z); }
-		bool	operator!=(const Vector3 &p) const { return (x != p.x || y != p.y || z != p.z); }
+		bool	operator==(const Vector3T &p) const { return (x == p.x && y == p.y && z == p.z); }
+		bool	operator!=(const Vector3T &p) const { return (x != p.x || y != p.y || z != p.z); }
 
 		// Assignment operators
-		void	operator= (const Vector3 &p) { x = p.x; y = p.y; z = p.z; }
-		void	operator+=(const Vector3 &p) { x += p.x; y += p.y; z += p.z; }
-		void	operator-=(const Vector3 &p) { x -= p.x; y -= p.y; z -= p.z; }
-		void	operator*=(float s) { x *= s; y *= s; z *= s; }
-		void	operator*=(const Matrix4x4 &m);
-		void	operator/=(float s) { assert(s != 0); s = 1.0f / s; x *= s; y *= s; z *= s; }
+		void	operator= (const Vector3T &p) { x = p.x; y = p.y; z = p.z; }
+		void	operator+=(const Vector3T &p) { x += p.x; y += p.y; z += p.z; }
+		void	operator-=(const Vector3T &p) { x -= p.x; y -= p.y; z -= p.z; }
+		void	operator*=(T s) { x *= s; y *= s; z *= s; }
+		void	operator*=(const Matrix4x4T<T> &m);
+		void	operator/=(T s) { assert(s != 0); s = T(1) / s; x *= s; y *= s; z *= s; }
 
 		// Not as fast as functions below, but these allow streamed operations ie. V = VA + VB - VC
-		Vector3	operator- (void) const { return Vector3(-x,-y,-z); }
-		Vector3	operator+ (const Vector3 &p) const { return Vector3(x+p.x, y+p.y, z+p.z); }
-		Vector3	operator- (const Vector3 &p) const { return Vector3(x-p.x, y-p.y, z-p.z); }
-		Vector3	operator* (float s) const {	return Vector3(x*s, y*s, z*s); }
-		Vector3	operator/ (float s) const { assert(s != 0);	s = 1.0f / s; return Vector3(x*s, y*s, z*s); }
+		Vector3T	operator- (void) const { return Vector3T(-x,-y,-z); }
+		Vector3T	operator+ (const Vector3T &p) const { return Vector3T(x+p.x, y+p.y, z+p.z); }
+		Vector3T	operator- (const Vector3T &p) const { return Vector3T(x-p.x, y-p.y, z-p.z); }
+		Vector3T	operator* (T s) const {	return Vector3T(x*s, y*s, z*s); }
+		Vector3T	operator/ (T s) const { assert(s != 0);	s = T(1) / s; return Vector3T(x*s, y*s, z*s); }
 
-		Vector3	operator* (const Matrix4x4 &m) const;	// Use 3x3 portion of matrix
+		Vector3T	operator* (const Matrix4x4T<T> &m) const;	// Use 3x3 portion of matrix
 
 		// Dot product
-		float	operator* (const Vector3 &p) const { return (x * p.x) + (y * p.y) + (z * p.z); }
+		T		operator* (const Vector3T &p) const { return (x * p.x) + (y * p.y) + (z * p.z); }
 
 		// Cross Product
-		Vector3	operator% (const Vector3 &p) const { return Vector3((y*p.z)-(z*p.y),(z*p.x)-(x*p.z),(x*p.y)-(y*p.x)); }
+		Vector3T	operator% (const Vector3T &p) const { return Vector3T((y*p.z)-(z*p.y),(z*p.x)-(x*p.z),(x*p.y)-(y*p.x)); }
 
 		///// Functions
 
 		// Convert from 4d vector to 3d vector, ignore w component of 4d vector
-		void			assign(const Vector4 &p);
-		void			assign(float _x, float _y, float _z) { x = _x; y = _y; z = _z; }
+		void			assign(const Vector4T<T> &p);
+		void			assign(T _x, T _y, T _z) { x = _x; y = _y; z = _z; }
+
+		// Camera relative conversion, the difference (p - origin) is taken at the precision
+		// of the source type U before it is stored, so a float vector can hold the offset of
+		// a double precision world position from a double precision camera position
+		template <class U>
+		void			assignRelative(const Vector3T<U> &p, const Vector3T<U> &origin)
+							{ x = (T)(p.x - origin.x); y = (T)(p.y - origin.y); z = (T)(p.z - origin.z); }
 
 		// Check equality with floating point error, SLOW
-		__inline bool	equalTo(const Vector3 &p) const;
-		__inline bool	notEqualTo(const Vector3 &p) const;
+		__inline bool	equalTo(const Vector3T &p) const;
+		__inline bool	notEqualTo(const Vector3T &p) const;
 
 		// Faster than the overloaded operators above
-		__inline void	add(const Vector3 &p1, const Vector3 &p2);
-		__inline void	subtract(const Vector3 &p1, const Vector3 &p2);
-		__inline void	multiply(const Vector3 &p, float s);
-		__inline void	divide(const Vector3 &p, float s);
-		__inline void	crossProduct(const Vector3 &p1, const Vector3 &p2);
+		__inline void	add(const Vector3T &p1, const Vector3T &p2);
+		__inline void	subtract(const Vector3T &p1, const Vector3T &p2);
+		__inline void	multiply(const Vector3T &p, T s);
+		__inline void	divide(const Vector3T &p, T s);
+		__inline void	crossProduct(const Vector3T &p1, const Vector3T &p2);
 		
-		void			multiplyMatrix(const Vector3 &p, const Matrix4x4 &m);
+		void			multiplyMatrix(const Vector3T &p, const Matrix4x4T<T> &m);
 
 		// Distance
-		__inline float	dist(const Vector3 &p) const;
-		__inline float	distSquared(const Vector3 &p) const;
+		__inline T		dist(const Vector3T &p) const;
+		__inline T		distSquared(const Vector3T &p) const;
 
 		// Finds the magnitude of the vector, or it's distance from the origin
-		float			mag(void) const { return sqrtf(x*x + y*y + z*z); }
-		float			magSquared(void) const { return x*x + y*y + z*z; }
+		T				mag(void) const { return std::sqrt(x*x + y*y + z*z); }
+		T				magSquared(void) const { return x*x + y*y + z*z; }
 
 		// Vector methods
-		__inline void	normalOf(const Vector3 &p1, const Vector3 &p2);
-		void			unitNormalOf(const Vector3 &p1, const Vector3 &p2);
+		__inline void	normalOf(const Vector3T &p1, const Vector3T &p2);
+		void			unitNormalOf(const Vector3T &p1, const Vector3T &p2);
 		void			normalize(void);
 		
 		// 3D Rotation functions
-		void			rot3D(Vector3 &p, int xa, int ya, int za);
+		void			rot3D(Vector3T &p, int xa, int ya, int za);
 		void			rot3D(int xa, int ya, int za);
+		void			rot3D(Vector3T &p, BinAngle xa, BinAngle ya, BinAngle za);	// binary angles need no range check
+		void			rot3D(BinAngle xa, BinAngle ya, BinAngle za);
 
 		// Debugging
 		std::string		toString(void) const;
 
 		// Constructors / Destructor
-		Vector3() : x(0), y(0), z(0) {}
-		Vector3(const Vector3 &p) : x(p.x), y(p.y), z(p.z) {}
-		explicit		Vector3(float _x, float _y, float _z) : x(_x), y(_y), z(_z) {}
-		explicit		Vector3(const Vector4 &p);
-		~Vector3() {}
+		Vector3T() : x(0), y(0), z(0) {}
+		Vector3T(const Vector3T &p) : x(p.x), y(p.y), z(p.z) {}
+		explicit		Vector3T(T _x, T _y, T _z) : x(_x), y(_y), z(_z) {}
+		explicit		Vector3T(const Vector4T<T> &p);
+		template <class U>
+		explicit		Vector3T(const Vector3T<U> &p) : x((T)p.x), y((T)p.y), z((T)p.z) {}
+		~Vector3T() {}
 };
 
 
@@ -133,25 +144,28 @@ class Vector3 {
 ------------------------*/
 
 
-__inline bool Vector3::equalTo(const Vector3 &p) const
+template <class T>
+__inline bool Vector3T<T>::equalTo(const Vector3T<T> &p) const
 {
-	if (fabs(p.x - x) <= EPSILON)
-		if (fabs(p.y - y) <= EPSILON)
-			if (fabs(p.z - z) <= EPSILON)
+	if (std::fabs(p.x - x) <= EPSILON)
+		if (std::fabs(p.y - y) <= EPSILON)
+			if (std::fabs(p.z - z) <= EPSILON)
 				return true;
 	
 	return false;
 }
 
 
-__inline bool Vector3::notEqualTo(const Vector3 &p) const
+template <class T>
+__inline bool Vector3T<T>::notEqualTo(const Vector3T<T> &p) const
 {
-	if ((fabs(p.x - x) > EPSILON) || (fabs(p.y - y) > EPSILON) || (fabs(p.z - z) > EPSILON)) return true;
+	if ((std::fabs(p.x - x) > EPSILON) || (std::fabs(p.y - y) > EPSILON) || (std::fabs(p.z - z) > EPSILON)) return true;
 	else return false;
 }
 
 
-__inline void Vector3::add(const Vector3 &p1,const Vector3 &p2)
+template <class T>
+__inline void Vector3T<T>::add(const Vector3T<T> &p1,const Vector3T<T> &p2)
 {
 	x = p1.x + p2.x;
 	y = p1.y + p2.y;
@@ -159,7 +173,8 @@ __inline void Vector3::add(const Vector3 &p1,const Vector3 &p2)
 }
 
 
-__inline void Vector3::subtract(const Vector3 &p1,const Vector3 &p2)
+template <class T>
+__inline void Vector3T<T>::subtract(const Vector3T<T> &p1,const Vector3T<T> &p2)
 {
 	x = p1.x - p2.x;
 	y = p1.y - p2.y;
@@ -167,7 +182,8 @@ __inline void Vector3::subtract(const Vector3 &p1,const Vector3 &p2)
 }
 
 
-__inline void Vector3::multiply(const Vector3 &p, float s)
+template <class T>
+__inline void Vector3T<T>::multiply(const Vector3T<T> &p, T s)
 {
 	x = p.x * s;
 	y = p.y * s;
@@ -175,17 +191,19 @@ __inline void Vector3::multiply(const Vector3 &p, float s)
 }
 
 
-__inline void Vector3::divide(const Vector3 &p, float s)
+template <class T>
+__inline void Vector3T<T>::divide(const Vector3T<T> &p, T s)
 {
 	msgAssert(s != 0, "vector divide by 0");
-	s = 1.0f / s;
+	s = T(1) / s;
 	x = p.x * s;
 	y = p.y * s;
 	z = p.z * s;
 }
 
 
-__inline void Vector3::crossProduct(const Vector3 &p1, const Vector3 &p2)
+template <class T>
+__inline void Vector3T<T>::crossProduct(const Vector3T<T> &p1, const Vector3T<T> &p2)
 {
 	// Sets point to cross product of two vectors
 	x = (p1.y * p2.z) - (p1.z * p2.y),
@@ -194,25 +212,28 @@ __inline void Vector3::crossProduct(const Vector3 &p1, const Vector3 &p2)
 }
 
 
-__inline float Vector3::dist(const Vector3 &p) const
+template <class T>
+__inline T Vector3T<T>::dist(const Vector3T<T> &p) const
 {
-	const float dx = p.x - x;
-	const float dy = p.y - y;
-	const float dz = p.z - z;
-	return sqrtf(dx*dx + dy*dy + dz*dz);
+	const T dx = p.x - x;
+	const T dy = p.y - y;
+	const T dz = p.z - z;
+	return std::sqrt(dx*dx + dy*dy + dz*dz);
 }
 
 
-__inline float Vector3::distSquared(const Vector3 &p) const
+template <class T>
+__inline T Vector3T<T>::distSquared(const Vector3T<T> &p) const
 {
-	const float dx = p.x - x;
-	const float dy = p.y - y;
-	const float dz = p.z - z;
+	const T dx = p.x - x;
+	const T dy = p.y - y;
+	const T dz = p.z - z;
 	return dx*dx + dy*dy + dz*dz;
 }
 
 
-__inline void Vector3::normalOf(const Vector3 &p1, const Vector3 &p2)
+template <class T>
+__inline void Vector3T<T>::normalOf(const Vector3T<T> &p1, const Vector3T<T> &p2)
 {
 	// Calculates the normal vector with cross product
 	x = (p1.y * p2.z) - (p1.z * p2.y);
@@ -0,0 +1,249 @@
+//	----==== VECTOR3STREAM.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Structure of arrays vector stream. The kernels are written once with
+//					the vfloat functions from simd.h, so they compile to AVX, SSE or
+//					scalar code. Because the capacity is always padded to a multiple of
+//					8 vectors, the loops can run over whole SIMD registers and never
+//					need a scalar remainder, the padding just receives junk values.
+//	--------------------------------------------------------------------------------
+
+
+#include <cstring>
+#include "Vector3Stream.h"
+#include "Matrix4x4.h"
+#include "Quaternion.h"
+#include "../UtilityCode/SIMD.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class Vector3Stream //////////
+
+
+void Vector3Stream::resize(int size)
+{
+	msgAssert(size >= 0, "Vector3Stream: negative size");
+
+	if (size > capacity) {
+		int newCapacity = (size + 7) & ~7;
+		float *block = (float *)alignedMalloc(newCapacity * 3 * sizeof(float));
+		memset(block, 0, newCapacity * 3 * sizeof(float));
+
+		if (x) {
+			memcpy(block, x, count * sizeof(float));
+			memcpy(block + newCapacity, y, count * sizeof(float));
+			memcpy(block + newCapacity*2, z, count * sizeof(float));
+			alignedFree(x);
+		}
+
+		x = block;
+		y = block + newCapacity;
+		z = block + newCapacity*2;
+		capacity = newCapacity;
+
+	} else if (size > count) {
+		// kernels write junk into the padding, so clear the newly exposed vectors
+		memset(x + count, 0, (size - count) * sizeof(float));
+		memset(y + count, 0, (size - count) * sizeof(float));
+		memset(z + count, 0, (size - count) * sizeof(float));
+	}
+
+	count = size;
+}
+
+
+void Vector3Stream::copy(const Vector3Stream &s)
+{
+	if (&s == this) return;
+
+	resize(s.count);
+	memcpy(x, s.x, count * sizeof(float));
+	memcpy(y, s.y, count * sizeof(float));
+	memcpy(z, s.z, count * sizeof(float));
+}
+
+
+void Vector3Stream::load(const Vector3 *p, int numVectors)
+{
+	resize(numVectors);
+
+	for (int v = 0; v < count; ++v) {
+		x[v] = p[v].x;
+		y[v] = p[v].y;
+		z[v] = p[v].z;
+	}
+}
+
+
+void Vector3Stream::store(Vector3 *p) const
+{
+	for (int v = 0; v < count; ++v) {
+		p[v].x = x[v];
+		p[v].y = y[v];
+		p[v].z = z[v];
+	}
+}
+
+
+void Vector3Stream::add(const Vector3Stream &p1, const Vector3Stream &p2)
+{
+	msgAssert(p1.count == count && p2.count == count, "Vector3Stream: size mismatch");
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		vstore(x+v, vadd(vload(p1.x+v), vload(p2.x+v)));
+		vstore(y+v, vadd(vload(p1.y+v), vload(p2.y+v)));
+		vstore(z+v, vadd(vload(p1.z+v), vload(p2.z+v)));
+	}
+}
+
+
+void Vector3Stream::subtract(const Vector3Stream &p1, const Vector3Stream &p2)
+{
+	msgAssert(p1.count == count && p2.count == count, "Vector3Stream: size mismatch");
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		vstore(x+v, vsub(vload(p1.x+v), vload(p2.x+v)));
+		vstore(y+v, vsub(vload(p1.y+v), vload(p2.y+v)));
+		vstore(z+v, vsub(vload(p1.z+v), vload(p2.z+v)));
+	}
+}
+
+
+void Vector3Stream::multiply(const Vector3Stream &p, float s)
+{
+	msgAssert(p.count == count, "Vector3Stream: size mismatch");
+
+	const vfloat vs = vset1(s);
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		vstore(x+v, vmul(vload(p.x+v), vs));
+		vstore(y+v, vmul(vload(p.y+v), vs));
+		vstore(z+v, vmul(vload(p.z+v), vs));
+	}
+}
+
+
+void Vector3Stream::crossProduct(const Vector3Stream &p1, const Vector3Stream &p2)
+{
+	msgAssert(p1.count == count && p2.count == count, "Vector3Stream: size mismatch");
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		const vfloat ax = vload(p1.x+v), ay = vload(p1.y+v), az = vload(p1.z+v);
+		const vfloat bx = vload(p2.x+v), by = vload(p2.y+v), bz = vload(p2.z+v);
+
+		vstore(x+v, vsub(vmul(ay, bz), vmul(az, by)));
+		vstore(y+v, vsub(vmul(az, bx), vmul(ax, bz)));
+		vstore(z+v, vsub(vmul(ax, by), vmul(ay, bx)));
+	}
+}
+
+
+// result must hold size() floats, it does not need to be aligned
+void Vector3Stream::dotProduct(const Vector3Stream &p, float *result) const
+{
+	msgAssert(p.count == count, "Vector3Stream: size mismatch");
+
+	int v = 0;
+	for (; v + SIMD_LANES <= count; v += SIMD_LANES) {
+		vstoreu(result+v, vadd(vadd(vmul(vload(x+v), vload(p.x+v)),
+									vmul(vload(y+v), vload(p.y+v))),
+									vmul(vload(z+v), vload(p.z+v))));
+	}
+
+	for (; v < count; ++v) {
+		result[v] = x[v]*p.x[v] + y[v]*p.y[v] + z[v]*p.z[v];
+	}
+}
+
+
+// Vectors of zero length are left at zero instead of becoming NaN
+void Vector3Stream::normalize(void)
+{
+	const vfloat one = vset1(1.0f);
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		const vfloat vx = vload(x+v), vy = vload(y+v), vz = vload(z+v);
+		const vfloat magSq = vadd(vadd(vmul(vx, vx), vmul(vy, vy)), vmul(vz, vz));
+		const vfloat invMag = vselectPositive(magSq, vdiv(one, vsqrt(magSq)));
+
+		vstore(x+v, vmul(vx, invMag));
+		vstore(y+v, vmul(vy, invMag));
+		vstore(z+v, vmul(vz, invMag));
+	}
+}
+
+
+void Vector3Stream::transformPoints(const Vector3Stream &p, const Matrix4x4 &m)
+{
+	msgAssert(p.count == count, "Vector3Stream: size mismatch");
+
+	const vfloat m0 = vset1(m.i[0]), m1 = vset1(m.i[1]), m2 = vset1(m.i[2]);
+	const vfloat m4 = vset1(m.i[4]), m5 = vset1(m.i[5]), m6 = vset1(m.i[6]);
+	const vfloat m8 = vset1(m.i[8]), m9 = vset1(m.i[9]), m10 = vset1(m.i[10]);
+	const vfloat m12 = vset1(m.i[12]), m13 = vset1(m.i[13]), m14 = vset1(m.i[14]);
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		const vfloat vx = vload(p.x+v), vy = vload(p.y+v), vz = vload(p.z+v);
+
+		vstore(x+v, vadd(vadd(vmul(vx, m0), vmul(vy, m4)), vadd(vmul(vz, m8),  m12)));
+		vstore(y+v, vadd(vadd(vmul(vx, m1), vmul(vy, m5)), vadd(vmul(vz, m9),  m13)));
+		vstore(z+v, vadd(vadd(vmul(vx, m2), vmul(vy, m6)), vadd(vmul(vz, m10), m14)));
+	}
+}
+
+
+void Vector3Stream::transformVectors(const Vector3Stream &p, const Matrix4x4 &m)
+{
+	msgAssert(p.count == count, "Vector3Stream: size mismatch");
+
+	const vfloat m0 = vset1(m.i[0]), m1 = vset1(m.i[1]), m2 = vset1(m.i[2]);
+	const vfloat m4 = vset1(m.i[4]), m5 = vset1(m.i[5]), m6 = vset1(m.i[6]);
+	const vfloat m8 = vset1(m.i[8]), m9 = vset1(m.i[9]), m10 = vset1(m.i[10]);
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		const vfloat vx = vload(p.x+v), vy = vload(p.y+v), vz = vload(p.z+v);
+
+		vstore(x+v, vadd(vadd(vmul(vx, m0), vmul(vy, m4)), vmul(vz, m8)));
+		vstore(y+v, vadd(vadd(vmul(vx, m1), vmul(vy, m5)), vmul(vz, m9)));
+		vstore(z+v, vadd(vadd(vmul(vx, m2), vmul(vy, m6)), vmul(vz, m10)));
+	}
+}
+
+
+// p' = p + w*t + u x t, where t = 2(u x p) and u is the vector part of q
+void Vector3Stream::rotate(const Vector3Stream &p, const Quaternion &q)
+{
+	msgAssert(p.count == count, "Vector3Stream: size mismatch");
+
+	const vfloat qx = vset1(q.x), qy = vset1(q.y), qz = vset1(q.z), qw = vset1(q.w);
+	const vfloat two = vset1(2.0f);
+
+	for (int v = 0; v < count; v += SIMD_LANES) {
+		const vfloat vx = vload(p.x+v), vy = vload(p.y+v), vz = vload(p.z+v);
+
+		const vfloat tx = vmul(two, vsub(vmul(qy, vz), vmul(qz, vy)));
+		const vfloat ty = vmul(two, vsub(vmul(qz, vx), vmul(qx, vz)));
+		const vfloat tz = vmul(two, vsub(vmul(qx, vy), vmul(qy, vx)));
+
+		vstore(x+v, vadd(vadd(vx, vmul(qw, tx)), vsub(vmul(qy, tz), vmul(qz, ty))));
+		vstore(y+v, vadd(vadd(vy, vmul(qw, ty)), vsub(vmul(qz, tx), vmul(qx, tz))));
+		vstore(z+v, vadd(vadd(vz, vmul(qw, tz)), vsub(vmul(qx, ty), vmul(qy, tx))));
+	}
+}
+
+
+Vector3Stream::Vector3Stream(int size) : x(0), y(0), z(0), count(0), capacity(0)
+{
+	resize(size);
+}
+
+
+Vector3Stream::~Vector3Stream()
+{
+	if (x) alignedFree(x);
+}
@@ -0,0 +1,115 @@
+//	----==== VECTOR3STREAM.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	An array of 3D vectors stored as a structure of arrays, one array
+//					for each of x, y and z. Operations work on the whole stream at once
+//					and process 4 (SSE) or 8 (AVX) vectors per instruction, so large
+//					sets of vertices can be transformed much faster than one Vector3 at
+//					a time. Each array is aligned for the widest SIMD register.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef VECTOR3STREAM_H
+#define VECTOR3STREAM_H
+
+#include "MathTypes.h"
+#include "Vector3.h"
+#include "../UtilityCode/MsgAssert.h"
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class Vector3Stream {
+
+	private:
+
+		///// Variables
+
+		float		*x, *y, *z;		// component arrays, all allocated in one aligned block
+		int			count;			// number of vectors in the stream
+		int			capacity;		// number of vectors allocated, a multiple of 8
+
+		// Make copy constructor and assignment operator private, use copy instead
+		Vector3Stream(const Vector3Stream &s);
+		Vector3Stream& operator=(const Vector3Stream &s);
+
+	public:
+
+		///// Accessors
+
+		int				size(void) const { return count; }
+		float *			getX(void) { return x; }
+		float *			getY(void) { return y; }
+		float *			getZ(void) { return z; }
+		const float *	getX(void) const { return x; }
+		const float *	getY(void) const { return y; }
+		const float *	getZ(void) const { return z; }
+
+		__inline void	set(int index, const Vector3 &p);
+		__inline Vector3 get(int index) const;
+
+		///// Functions
+
+		// Sets the number of vectors, existing values are kept up to the smaller size
+		void			resize(int size);
+		void			copy(const Vector3Stream &s);
+
+		// Convert from/to an array of Vector3, resizes this stream to numVectors
+		void			load(const Vector3 *p, int numVectors);
+		void			store(Vector3 *p) const;
+
+		// Bulk operations, source streams must be the same size as this stream and may be
+		// this stream itself
+		void			add(const Vector3Stream &p1, const Vector3Stream &p2);
+		void			subtract(const Vector3Stream &p1, const Vector3Stream &p2);
+		void			multiply(const Vector3Stream &p, float s);
+		void			crossProduct(const Vector3Stream &p1, const Vector3Stream &p2);
+		void			dotProduct(const Vector3Stream &p, float *result) const;
+		void			normalize(void);
+
+		// Transform by a matrix, points use the translation of the matrix (w = 1), vectors
+		// use only the 3x3 portion like Vector3::operator*
+		void			transformPoints(const Vector3Stream &p, const Matrix4x4 &m);
+		void			transformVectors(const Vector3Stream &p, const Matrix4x4 &m);
+
+		// Rotate by a unit quaternion, same result as Quaternion::rotate on each vector
+		void			rotate(const Vector3Stream &p, const Quaternion &q);
+
+		// Constructors / Destructor
+		explicit Vector3Stream() : x(0), y(0), z(0), count(0), capacity(0) {}
+		explicit Vector3Stream(int size);
+		~Vector3Stream();
+};
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+////////// class Vector3Stream //////////
+
+
+__inline void Vector3Stream::set(int index, const Vector3 &p)
+{
+	msgAssert(index >= 0 && index < count, "Vector3Stream: index out of bounds");
+
+	x[index] = p.x;
+	y[index] = p.y;
+	z[index] = p.z;
+}
+
+
+__inline Vector3 Vector3Stream::get(int index) const
+{
+	msgAssert(index >= 0 && index < count, "Vector3Stream: index out of bounds");
+
+	return Vector3(x[index], y[index], z[index]);
+}
+
+
+#endif
@@ -9,29 +9,31 @@
 
 
 #include <sstream>
-#include "vector4.h"
-#include "vector3.h"
-#include "matrix4x4.h"
+#include "Vector4.h"
+#include "Vector3.h"
+#include "Matrix4x4.h"
 
 /*-----------------
 ---- FUNCTIONS ----
 -----------------*/
 
-////////// class Vector4 //////////
+////////// class Vector4T //////////
 
 
-Vector4	Vector4::operator* (const Matrix4x4 &m) const
+template <class T>
+Vector4T<T> Vector4T<T>::operator* (const Matrix4x4T<T> &m) const
 {
-	return Vector4(	x*m.i[0] + y*m.i[4] + z*m.i[8]  + w*m.i[12],
-					x*m.i[1] + y*m.i[5] + z*m.i[9]  + w*m.i[13],
-					x*m.i[2] + y*m.i[6] + z*m.i[10] + w*m.i[14],
-					x*m.i[3] + y*m.i[7] + z*m.i[11] + w*m.i[15]);
+	return Vector4T<T>(	x*m.i[0] + y*m.i[4] + z*m.i[8]  + w*m.i[12],
+						x*m.i[1] + y*m.i[5] + z*m.i[9]  + w*m.i[13],
+						x*m.i[2] + y*m.i[6] + z*m.i[10] + w*m.i[14],
+						x*m.i[3] + y*m.i[7] + z*m.i[11] + w*m.i[15]);
 }
 
 
-void Vector4::operator*=(const Matrix4x4 &m)
+template <class T>
+void Vector4T<T>::operator*=(const Matrix4x4T<T> &m)
 {
-	Vector4 orig(*this);
+	Vector4T<T> orig(*this);
 	x = orig.x*m.i[0] + orig.y*m.i[4] + orig.z*m.i[8]  + orig.w*m.i[12];
 	y = orig.x*m.i[1] + orig.y*m.i[5] + orig.z*m.i[9]  + orig.w*m.i[13];
 	z = orig.x*m.i[2] + orig.y*m.i[6] + orig.z*m.i[10] + orig.w*m.i[14];
@@ -39,7 +41,8 @@ void Vector4::operator*=(const Matrix4x4 &m)
 }
 
 
-void Vector4::multiplyMatrix(const Vector4 &p, const Matrix4x4 &m)
+template <class T>
+void Vector4T<T>::multiplyMatrix(const Vector4T<T> &p, const Matrix4x4T<T> &m)
 {
 	x = p.x*m.i[0] + p.y*m.i[4] + p.z*m.i[8]  + p.w*m.i[12];
 	y = p.x*m.i[1] + p.y*m.i[5] + p.z*m.i[9]  + p.w*m.i[13];
@@ -50,7 +53,8 @@ void Vector4::multiplyMatrix(const Vector4 &p, const Matrix4x4 &m)
 
 // Convert from 3d vector to 4d vector, often w = 0 used for vectors and w = 1 used for points
 // when multiplying by matrix, w = 1 means it can be translated from origin
-void Vector4::assign(const Vector3 &p, float _w)
+template <class T>
+void Vector4T<T>::assign(const Vector3T<T> &p, T _w)
 {
 	x = p.x;
 	y = p.y;
@@ -59,13 +63,14 @@ void Vector4::assign(const Vector3 &p, float _w)
 }
 
 
-void Vector4::normalize(void)
+template <class T>
+void Vector4T<T>::normalize(void)
 {
 	// Normalize the vector to unit length
-	float magSq = this->magSquared();
+	T magSq = this->magSquared();
 
 	if (magSq > 0) {
-		float invMag = 1.0f / sqrtf(magSq);
+		T invMag = T(1) / std::sqrt(magSq);
 		x *= invMag;
 		y *= invMag;
 		z *= invMag;
@@ -74,7 +79,8 @@ void Vector4::normalize(void)
 }
 
 
-std::string Vector4::toString(void) const
+template <class T>
+std::string Vector4T<T>::toString(void) const
 {
 	std::ostringstream returnStr;
 	returnStr << "(" << x << "," << y << "," << z << "," << w << ")";
@@ -82,4 +88,54 @@ std::string Vector4::toString(void) const
 }
 
 
-Vector4::Vector4(const Vector3 &p, float _w) : x(p.x), y(p.y), z(p.z), w(_w) {}
\ No newline at end of file
+template <class T>
+Vector4T<T>::Vector4T(const Vector3T<T> &p, T _w) : x(p.x), y(p.y), z(p.z), w(_w) {}
+
+
+#if defined(USE_SSE)
+
+//----------------------------------------------------------------------------------------
+//	Multiplies the row vector p by matrix m, the result is the sum of the rows of m scaled
+//	by each component of p
+//----------------------------------------------------------------------------------------
+static __inline __m128 multiplyRowSSE(__m128 p, const Matrix4x4T<float> &m)
+{
+	__m128 r = _mm_mul_ps(_mm_shuffle_ps(p,p,_MM_SHUFFLE(0,0,0,0)), _mm_load_ps(&m.i[0]));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p,p,_MM_SHUFFLE(1,1,1,1)), _mm_load_ps(&m.i[4])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p,p,_MM_SHUFFLE(2,2,2,2)), _mm_load_ps(&m.i[8])));
+	r = _mm_add_ps(r, _mm_mul_ps(_mm_shuffle_ps(p,p,_MM_SHUFFLE(3,3,3,3)), _mm_load_ps(&m.i[12])));
+	return r;
+}
+
+
+template <>
+Vector4T<float> Vector4T<float>::operator* (const Matrix4x4T<float> &m) const
+{
+	Vector4T<float> r;
+	_mm_store_ps(r.v, multiplyRowSSE(_mm_load_ps(v), m));
+	return r;
+}
+
+
+template <>
+void Vector4T<float>::operator*=(const Matrix4x4T<float> &m)
+{
+	_mm_store_ps(v, multiplyRowSSE(_mm_load_ps(v), m));
+}
+
+
+template <>
+void Vector4T<float>::multiplyMatrix(const Vector4T<float> &p, const Matrix4x4T<float> &m)
+{
+	_mm_store_ps(v, multiplyRowSSE(_mm_load_ps(p.v), m));
+}
+
+#endif
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class Vector4T<float>;
+template class Vector4T<double>;
@@ -4,7 +4,8 @@
 //					y2kiah@hotmail.com
 //	Version:		3
 //	Date:			4/04
-//	Description:	4D vector class
+//	Description:	4D vector class, 16 byte aligned so the float version can use SSE
+//					when multiplying by a matrix
 //	--------------------------------------------------------------------------------
 
 
@@ -13,18 +14,18 @@
 
 #include <string>
 #include <cmath>
-#include "..\UTILITYCODE\msgassert.h"
-#include "..\UTILITYCODE\typedefs.h"
+#include "../UtilityCode/MsgAssert.h"
+#include "../UtilityCode/Typedefs.h"
+#include "MathTypes.h"
+#include "../UtilityCode/SIMD.h"
 
 /*------------------
 ---- STRUCTURES ----
 ------------------*/
 
-class Vector3;
-class Matrix4x4;
 
-
-class Vector4 {
+template <class T>
+class ALIGN16 Vector4T {
 
 	public:
 
@@ -32,65 +33,65 @@ class Vector4 {
 		
 		union {
 			struct {
-				float x, y, z, w;	// This union allows access to the same memory location through either
+				T x, y, z, w;		// This union allows access to the same memory location through either
 			};						// x,y,z,w or the array v[4]. Use v for fast OpenGL functions
 
-			float v[4];
+			T v[4];
 		};
 
 
 		///// Overloaded Operators
 
 		// Conditional operators
-		bool	operator==(const Vector4 &p) const { return (x == p.x && y == p.y && z == p.z && w == p.w); }
-		bool	operator!=(const Vector4 &p) const { return (x != p.x || y != p.y || z != p.z || w != p.w); }
+		bool	operator==(const Vector4T &p) const { return (x == p.x && y == p.y && z == p.z && w == p.w); }
+		bool	operator!=(const Vector4T &p) const { return (x != p.x || y != p.y || z != p.z || w != p.w); }
 
 		// Assignment operators
-		void	operator= (const Vector4 &p) { x = p.x; y = p.y; z = p.z; w = p.w; }
-		void	operator+=(const Vector4 &p) { x += p.x; y += p.y; z += p.z; w += p.w; }
-		void	operator-=(const Vector4 &p) { x -= p.x; y -= p.y; z -= p.z; w -= p.w; }
-		void	operator*=(float s) { x *= s; y *= s; z *= s; w *= s; }
-		void	operator*=(const Matrix4x4 &m);
-		void	operator/=(float s) { assert(s != 0); s = 1.0f / s; x *= s; y *= s; z *= s; w *= s; }
+		void	operator= (const Vector4T &p) { x = p.x; y = p.y; z = p.z; w = p.w; }
+		void	operator+=(const Vector4T &p) { x += p.x; y += p.y; z += p.z; w += p.w; }
+		void	operator-=(const Vector4T &p) { x -= p.x; y -= p.y; z -= p.z; w -= p.w; }
+		void	operator*=(T s) { x *= s; y *= s; z *= s; w *= s; }
+		void	operator*=(const Matrix4x4T<T> &m);
+		void	operator/=(T s) { assert(s != 0); s = T(1) / s; x *= s; y *= s; z *= s; w *= s; }
 
 		// Not as fast as functions below, but these allow streamed operations ie. V = VA + VB - VC
-		Vector4 operator- (void) const { return Vector4(-x,-y,-z,-w); }
-		Vector4	operator+ (const Vector4 &p) const { return Vector4(x+p.x, y+p.y, z+p.z, w+p.w); }
-		Vector4	operator- (const Vector4 &p) const { return Vector4(x-p.x, y-p.y, z-p.z, w-p.w); }
-		Vector4	operator* (float s) const { return Vector4(x*s, y*s, z*s, w*s); }
-		Vector4	operator/ (float s) const { assert(s != 0); s = 1.0f / s; return Vector4(x*s, y*s, z*s, w*s); }
+		Vector4T	operator- (void) const { return Vector4T(-x,-y,-z,-w); }
+		Vector4T	operator+ (const Vector4T &p) const { return Vector4T(x+p.x, y+p.y, z+p.z, w+p.w); }
+		Vector4T	operator- (const Vector4T &p) const { return Vector4T(x-p.x, y-p.y, z-p.z, w-p.w); }
+		Vector4T	operator* (T s) const { return Vector4T(x*s, y*s, z*s, w*s); }
+		Vector4T	operator/ (T s) const { assert(s != 0); s = T(1) / s; return Vector4T(x*s, y*s, z*s, w*s); }
 
-		Vector4	operator* (const Matrix4x4 &m) const;
+		Vector4T	operator* (const Matrix4x4T<T> &m) const;
 
 		// Dot product
-		float	operator* (const Vector4 &p) const { return (x * p.x) + (y * p.y) + (z * p.z) + (w * p.w); }
+		T		operator* (const Vector4T &p) const { return (x * p.x) + (y * p.y) + (z * p.z) + (w * p.w); }
 
 		///// Functions
 
 		// Convert from 3d vector to 4d vector, often w = 0 used for vectors and w = 1 used for points
 		// when multiplying by matrix, w = 1 means it can be translated from origin
-		void			assign(const Vector3 &p, float _w);
-		void			assign(float _x, float _y, float _z, float _w) { x = _x; y = _y; z = _z; w = _w; }
+		void			assign(const Vector3T<T> &p, T _w);
+		void			assign(T _x, T _y, T _z, T _w) { x = _x; y = _y; z = _z; w = _w; }
 
 		// Check equality with floating point error, SLOW
-		__inline bool	equalTo(const Vector4 &p) const;
-		__inline bool	notEqualTo(const Vector4 &p) const;
+		__inline bool	equalTo(const Vector4T &p) const;
+		__inline bool	notEqualTo(const Vector4T &p) const;
 
 		// Faster than the overloaded operators above		
-		__inline void	add(const Vector4 &p1, const Vector4 &p2);
-		__inline void	subtract(const Vector4 &p1, const Vector4 &p2);
-		__inline void	multiply(const Vector4 &p, float s);
-		__inline void	divide(const Vector4 &p, float s);
+		__inline void	add(const Vector4T &p1, const Vector4T &p2);
+		__inline void	subtract(const Vector4T &p1, const Vector4T &p2);
+		__inline void	multiply(const Vector4T &p, T s);
+		__inline void	divide(const Vector4T &p, T s);
 		
-		void			multiplyMatrix(const Vector4 &p, const Matrix4x4 &m);
+		void			multiplyMatrix(const Vector4T &p, const Matrix4x4T<T> &m);
 
 		// Distance
-		__inline float	dist(const Vector4 &p) const;
-		__inline float	distSquared(const Vector4 &p) const;
+		__inline T		dist(const Vector4T &p) const;
+		__inline T		distSquared(const Vector4T &p) const;
 
 		// Finds the magnitude of the vector, or it's distance from the origin
-		float			mag(void) const { return sqrtf(x*x + y*y + z*z + w*w); }
-		float			magSquared(void) const { return x*x + y*y + z*z + w*w; }
+		T				mag(void) const { return std::sqrt(x*x + y*y + z*z + w*w); }
+		T				magSquared(void) const { return x*x + y*y + z*z + w*w; }
 
 		// Vector methods
 		void			normalize(void);
@@ -99,11 +100,13 @@ class Vector4 {
 		std::string		toString(void) const;
 
 		// Constructors / Destructor
-		Vector4() : x(0), y(0), z(0), w(0) {}
-		Vector4(const Vector4 &p) : x(p.x), y(p.y), z(p.z), w(p.w) {}
-		explicit		Vector4(float _x, float _y, float _z, float _w) : x(_x), y(_y), z(_z), w(_w) {}
-		explicit		Vector4(const Vector3 &p, float _w);
-		~Vector4() {}
+		Vector4T() : x(0), y(0), z(0), w(0) {}
+		Vector4T(const Vector4T &p) : x(p.x), y(p.y), z(p.z), w(p.w) {}
+		explicit		Vector4T(T _x, T _y, T _z, T _w) : x(_x), y(_y), z(_z), w(_w) {}
+		explicit		Vector4T(const Vector3T<T> &p, T _w);
+		template <class U>
+		explicit		Vector4T(const Vector4T<U> &p) : x((T)p.x), y((T)p.y), z((T)p.z), w((T)p.w) {}
+		~Vector4T() {}
 };
 
 
@@ -112,28 +115,31 @@ class Vector4 {
 ------------------------*/
 
 
-__inline bool Vector4::equalTo(const Vector4 &p) const
+template <class T>
+__inline bool Vector4T<T>::equalTo(const Vector4T<T> &p) const
 {
-	if (fabs(p.x - x) <= EPSILON)
-		if (fabs(p.y - y) <= EPSILON)
-			if (fabs(p.z - z) <= EPSILON)
-				if (fabs(p.w - w) <= EPSILON)
+	if (std::fabs(p.x - x) <= EPSILON)
+		if (std::fabs(p.y - y) <= EPSILON)
+			if (std::fabs(p.z - z) <= EPSILON)
+				if (std::fabs(p.w - w) <= EPSILON)
 					return true;
 	
 	return false;
 }
 
 
-__inline bool Vector4::notEqualTo(const Vector4 &p) const
+template <class T>
+__inline bool Vector4T<T>::notEqualTo(const Vector4T<T> &p) const
 {
-	if ((fabs(p.x - x) > EPSILON) || (fabs(p.y - y) > EPSILON) || (fabs(p.z - z) > EPSILON) || (fabs(p.w - w) > EPSILON))
+	if ((std::fabs(p.x - x) > EPSILON) || (std::fabs(p.y - y) > EPSILON) || (std::fabs(p.z - z) > EPSILON) || (std::fabs(p.w - w) > EPSILON))
 		return true;
 	else
 		return false;
 }
 
 
-__inline void Vector4::add(const Vector4 &p1,const Vector4 &p2)
+template <class T>
+__inline void Vector4T<T>::add(const Vector4T<T> &p1,const Vector4T<T> &p2)
 {
 	x = p1.x + p2.x;
 	y = p1.y + p2.y;
@@ -142,7 +148,8 @@ __inline void Vector4::add(const Vector4 &p1,const Vector4 &p2)
 }
 
 
-__inline void Vector4::subtract(const Vector4 &p1,const Vector4 &p2)
+template <class T>
+__inline void Vector4T<T>::subtract(const Vector4T<T> &p1,const Vector4T<T> &p2)
 {
 	x = p1.x - p2.x;
 	y = p1.y - p2.y;
@@ -151,7 +158,8 @@ __inline void Vector4::subtract(const Vector4 &p1,const Vector4 &p2)
 }
 
 
-__inline void Vector4::multiply(const Vector4 &p, float s)
+template <class T>
+__inline void Vector4T<T>::multiply(const Vector4T<T> &p, T s)
 {
 	x = p.x * s;
 	y = p.y * s;
@@ -160,10 +168,11 @@ __inline void Vector4::multiply(const Vector4 &p, float s)
 }
 
 
-__inline void Vector4::divide(const Vector4 &p, float s)
+template <class T>
+__inline void Vector4T<T>::divide(const Vector4T<T> &p, T s)
 {
 	msgAssert(s != 0, "vector divide by 0");
-	s = 1.0f / s;
+	s = T(1) / s;
 	x = p.x * s;
 	y = p.y * s;
 	z = p.z * s;
@@ -171,24 +180,39 @@ __inline void Vector4::divide(const Vector4 &p, float s)
 }
 
 
-__inline float Vector4::dist(const Vector4 &p) const
+template <class T>
+__inline T Vector4T<T>::dist(const Vector4T<T> &p) const
 {
-	const float dx = p.x - x;
-	const float dy = p.y - y;
-	const float dz = p.z - z;
-	const float dw = p.w - w;
-	return sqrtf(dx*dx + dy*dy + dz*dz + dw*dw);
+	const T dx = p.x - x;
+	const T dy = p.y - y;
+	const T dz = p.z - z;
+	const T dw = p.w - w;
+	return std::sqrt(dx*dx + dy*dy + dz*dz + dw*dw);
 }
 
 
-__inline float Vector4::distSquared(const Vector4 &p) const
+template <class T>
+__inline T Vector4T<T>::distSquared(const Vector4T<T> &p) const
 {
-	const float dx = p.x - x;
-	const float dy = p.y - y;
-	const float dz = p.z - z;
-	const float dw = p.w - w;
+	const T dx = p.x - x;
+	const T dy = p.y - y;
+	const T dz = p.z - z;
+	const T dw = p.w - w;
 	return dx*dx + dy*dy + dz*dz + dw*dw;
 }
 
 
-#endif
\ No newline at end of file
+/*-----------------------------
+---- SIMD SPECIALIZATIONS ----
+-----------------------------*/
+
+#if defined(USE_SSE)
+
+template <> Vector4T<float>	Vector4T<float>::operator* (const Matrix4x4T<float> &m) const;
+template <> void			Vector4T<float>::operator*=(const Matrix4x4T<float> &m);
+template <> void			Vector4T<float>::multiplyMatrix(const Vector4T<float> &p, const Matrix4x4T<float> &m);
+
+#endif
+
+
+#endif
@@ -0,0 +1,113 @@
+//	----==== FRAMEBUFFER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	In memory color and depth buffer for the software rasterizer
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include "FrameBuffer.h"
+#include "../UtilityCode/MsgAssert.h"
+#include "../UtilityCode/PNGFile.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class FrameBuffer //////////
+
+
+void FrameBuffer::resize(int w, int h)
+{
+	msgAssert(w > 0 && h > 0, "FrameBuffer: size must be positive");
+
+	if (w == width && h == height) return;
+
+	delete [] color;
+	delete [] depth;
+
+	width = w;
+	height = h;
+	color = new uint32[w * h];
+	depth = new float[w * h];
+}
+
+
+void FrameBuffer::clear(uint32 clearColor, float clearDepth)
+{
+	int size = width * height;
+	for (int p = 0; p < size; p++) {
+		color[p] = clearColor;
+		depth[p] = clearDepth;
+	}
+}
+
+
+bool FrameBuffer::writePPM(const char *filename) const
+{
+	FILE *f = fopen(filename, "wb");
+	if (!f) return false;
+
+	fprintf(f, "P6\n%d %d\n255\n", width, height);
+
+	uchar *row = new uchar[width * 3];
+	bool ok = true;
+
+	for (int y = 0; y < height && ok; y++) {
+		const uint32 *src = color + y * width;
+		for (int x = 0; x < width; x++) {
+			row[x*3]   = (uchar)RGBA_R(src[x]);
+			row[x*3+1] = (uchar)RGBA_G(src[x]);
+			row[x*3+2] = (uchar)RGBA_B(src[x]);
+		}
+		ok = (fwrite(row, 1, width * 3, f) == (size_t)(width * 3));
+	}
+
+	delete [] row;
+	return (fclose(f) == 0) && ok;
+}
+
+
+// 8 bit RGB
+bool FrameBuffer::writePNG(const char *filename) const
+{
+	uchar *rgb = new uchar[width * height * 3];
+	for (int p = 0; p < width * height; p++) {
+		rgb[p*3]   = (uchar)RGBA_R(color[p]);
+		rgb[p*3+1] = (uchar)RGBA_G(color[p]);
+		rgb[p*3+2] = (uchar)RGBA_B(color[p]);
+	}
+
+	bool ok = ::writePNG(filename, width, height, 8, PNG_RGB, rgb);
+
+	delete [] rgb;
+	return ok;
+}
+
+
+bool FrameBuffer::writeImage(const char *filename) const
+{
+	size_t len = strlen(filename);
+	if (len > 4 && (strcmp(filename + len - 4, ".png") == 0 || strcmp(filename + len - 4, ".PNG") == 0)) {
+		return writePNG(filename);
+	}
+	return writePPM(filename);
+}
+
+
+FrameBuffer::FrameBuffer(int w, int h) :
+	width(0), height(0), color(0), depth(0)
+{
+	resize(w, h);
+}
+
+
+FrameBuffer::~FrameBuffer()
+{
+	delete [] color;
+	delete [] depth;
+}
@@ -0,0 +1,75 @@
+//	----==== FRAMEBUFFER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	In memory color and depth buffer for the software rasterizer. Colors
+//					are 32 bit RGBA with red in the low byte, so the bytes are in R,G,B,A
+//					order in memory. Depth is a float from 0 at the near plane to 1 at the
+//					far plane. The color buffer can be saved as a binary PPM or as a PNG.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef FRAMEBUFFER_H
+#define FRAMEBUFFER_H
+
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define MAKE_RGBA(r,g,b,a)	((uint32)(r) | ((uint32)(g) << 8) | ((uint32)(b) << 16) | ((uint32)(a) << 24))
+#define RGBA_R(c)			((c) & 0xFF)
+#define RGBA_G(c)			(((c) >> 8) & 0xFF)
+#define RGBA_B(c)			(((c) >> 16) & 0xFF)
+#define RGBA_A(c)			((c) >> 24)
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class FrameBuffer {
+	private:
+
+		///// Variables
+
+		int			width, height;
+		uint32		*color;
+		float		*depth;
+
+		// Make copy constructor and assignment operator private
+		FrameBuffer(const FrameBuffer &f);
+		FrameBuffer& operator=(const FrameBuffer &f);
+
+	public:
+
+		///// Accessors
+
+		int			getWidth(void) const	{ return width; }
+		int			getHeight(void) const	{ return height; }
+		uint32 *	getColor(void)			{ return color; }
+		float *		getDepth(void)			{ return depth; }
+		const uint32 *	getColor(void) const	{ return color; }
+
+		///// Functions
+
+		void		resize(int w, int h);
+		void		clear(uint32 clearColor, float clearDepth = 1.0f);
+
+		// Return false if the file could not be written. The PNG is written without
+		// compression, it is meant for viewing and diffing rather than storage
+		bool		writePPM(const char *filename) const;
+		bool		writePNG(const char *filename) const;
+		bool		writeImage(const char *filename) const;	// PNG if the name ends in .png, else PPM
+
+		// Constructors / Destructor
+		explicit FrameBuffer(int w, int h);
+		~FrameBuffer();
+};
+
+
+#endif
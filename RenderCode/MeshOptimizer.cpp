@@ -0,0 +1,211 @@
+//	----==== MESHOPTIMIZER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Vertex cache and vertex fetch optimization of triangle lists
+//	--------------------------------------------------------------------------------
+
+
+#include <string.h>
+#include <cmath>
+#include "MeshOptimizer.h"
+#include "../UtilityCode/MsgAssert.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+// Forsyth's scoring constants
+#define CACHE_DECAYPOWER	1.5f
+#define LASTTRISCORE		0.75f
+#define VALENCEBOOSTSCALE	2.0f
+#define VALENCEBOOSTPOWER	0.5f
+#define MAXVALENCESCORE		32		// valence scores are looked up below this
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class MeshOptimizer //////////
+
+
+//-----------------------------------------------------------------------------
+//	Each vertex keeps the triangles still to be drawn that use it, the first
+//	numActive entries of its range in triList. Drawing a triangle moves its
+//	vertices to the front of an LRU cache and rescores the vertices in the
+//	cache and their triangles. The next triangle is the best one touching the
+//	cache, or when none is left, the next undrawn triangle in the old order.
+//-----------------------------------------------------------------------------
+void MeshOptimizer::optimizeVertexCache(uint *indices, int numIndices, int numVerts, int cacheSize)
+{
+	msgAssert(cacheSize > 3 && cacheSize <= MESH_MAXCACHESIZE, "MeshOptimizer: cache size out of range");
+
+	int numTris = numIndices / 3;
+	if (numTris == 0) return;
+
+	// score tables
+	float cacheScore[MESH_MAXCACHESIZE];
+	for (int c = 0; c < cacheSize; c++) {
+		if (c < 3) {
+			cacheScore[c] = LASTTRISCORE;
+		} else {
+			cacheScore[c] = powf(1.0f - (float)(c - 3) / (float)(cacheSize - 3), CACHE_DECAYPOWER);
+		}
+	}
+	float valenceScore[MAXVALENCESCORE];
+	valenceScore[0] = 0;
+	for (int v = 1; v < MAXVALENCESCORE; v++) {
+		valenceScore[v] = VALENCEBOOSTSCALE * powf((float)v, -VALENCEBOOSTPOWER);
+	}
+
+	// triangles of each vertex
+	std::vector<int> triStart(numVerts + 1, 0);
+	std::vector<int> numActive(numVerts, 0);
+	for (int i = 0; i < numTris * 3; i++) {
+		msgAssert(indices[i] < (uint)numVerts, "MeshOptimizer: index out of range");
+		numActive[indices[i]]++;
+	}
+	for (int v = 0; v < numVerts; v++) triStart[v+1] = triStart[v] + numActive[v];
+
+	std::vector<int> triList(triStart[numVerts]);
+	std::vector<int> fill(triStart.begin(), triStart.end() - 1);
+	for (int t = 0; t < numTris; t++) {
+		for (int k = 0; k < 3; k++) triList[fill[indices[t*3+k]]++] = t;
+	}
+
+	std::vector<float> vertScore(numVerts);
+	for (int v = 0; v < numVerts; v++) {
+		vertScore[v] = (numActive[v] < MAXVALENCESCORE) ? valenceScore[numActive[v]] : 0;
+	}
+
+	std::vector<float> triScore(numTris);
+	std::vector<bool> drawn(numTris, false);
+	for (int t = 0; t < numTris; t++) {
+		triScore[t] = vertScore[indices[t*3]] + vertScore[indices[t*3+1]] + vertScore[indices[t*3+2]];
+	}
+
+	std::vector<uint> output(numTris * 3);
+
+	int cache[MESH_MAXCACHESIZE + 3];
+	int cacheUsed = 0;
+	int nextTri = 0;		// undrawn triangles before this are drawn in the old order
+
+	int best = 0;
+	for (int t = 1; t < numTris; t++) if (triScore[t] > triScore[best]) best = t;
+
+	for (int o = 0; o < numTris; o++) {
+		// no triangle touching the cache is left
+		if (best < 0) {
+			while (drawn[nextTri]) nextTri++;
+			best = nextTri;
+		}
+
+		const uint *tri = &indices[best*3];
+		output[o*3] = tri[0];
+		output[o*3+1] = tri[1];
+		output[o*3+2] = tri[2];
+		drawn[best] = true;
+
+		// drop the triangle from the active lists of its vertices
+		for (int k = 0; k < 3; k++) {
+			uint v = tri[k];
+			int *list = &triList[triStart[v]];
+			for (int a = 0; a < numActive[v]; a++) {
+				if (list[a] == best) {
+					list[a] = list[numActive[v] - 1];
+					break;
+				}
+			}
+			numActive[v]--;
+		}
+
+		// the triangle's vertices go to the front, the rest keep their order behind them
+		int newCache[MESH_MAXCACHESIZE + 3];
+		int newUsed = 0;
+		for (int k = 0; k < 3; k++) newCache[newUsed++] = (int)tri[k];
+		for (int c = 0; c < cacheUsed; c++) {
+			int v = cache[c];
+			if (v != (int)tri[0] && v != (int)tri[1] && v != (int)tri[2]) newCache[newUsed++] = v;
+		}
+
+		for (int c = 0; c < newUsed; c++) {
+			int v = newCache[c];
+			float score = 0;
+			if (numActive[v] > 0) {
+				if (c < cacheSize) score = cacheScore[c];
+				if (numActive[v] < MAXVALENCESCORE) score += valenceScore[numActive[v]];
+			}
+			vertScore[v] = score;
+		}
+
+		// rescore the triangles touching the cache, or just pushed out of it, and find the best
+		best = -1;
+		float bestScore = -1;
+		cacheUsed = (newUsed < cacheSize) ? newUsed : cacheSize;
+		for (int c = 0; c < newUsed; c++) {
+			int v = newCache[c];
+			if (c < cacheUsed) cache[c] = v;
+
+			const int *list = &triList[triStart[v]];
+			for (int a = 0; a < numActive[v]; a++) {
+				int t = list[a];
+				float score = vertScore[indices[t*3]] + vertScore[indices[t*3+1]] + vertScore[indices[t*3+2]];
+				triScore[t] = score;
+				if (score > bestScore) {
+					bestScore = score;
+					best = t;
+				}
+			}
+		}
+	}
+
+	memcpy(indices, &output[0], numTris * 3 * sizeof(uint));
+}
+
+
+void MeshOptimizer::optimizeVertexFetch(uint *indices, int numIndices, int numVerts,
+										std::vector<uint> &remap)
+{
+	const uint unused = 0xFFFFFFFF;
+	remap.assign(numVerts, unused);
+
+	uint next = 0;
+	for (int i = 0; i < numIndices; i++) {
+		uint &v = remap[indices[i]];
+		if (v == unused) v = next++;
+		indices[i] = v;
+	}
+
+	for (int v = 0; v < numVerts; v++) {
+		if (remap[v] == unused) remap[v] = next++;
+	}
+}
+
+
+void MeshOptimizer::calcCacheStats(MeshCacheStats &stats, const uint *indices, int numIndices,
+								   int numVerts, int fifoSize)
+{
+	// a vertex is in the FIFO while fewer than fifoSize misses followed its own
+	std::vector<int> missTime(numVerts, -fifoSize - 1);
+	std::vector<bool> used(numVerts, false);
+	int misses = 0, numUsed = 0;
+
+	for (int i = 0; i < numIndices; i++) {
+		uint v = indices[i];
+		if (misses - missTime[v] > fifoSize) {
+			missTime[v] = misses;
+			misses++;
+		}
+		if (!used[v]) {
+			used[v] = true;
+			numUsed++;
+		}
+	}
+
+	stats.transforms = misses;
+	stats.acmr = (numIndices >= 3) ? (float)misses / (float)(numIndices / 3) : 0;
+	stats.atvr = (numUsed > 0) ? (float)misses / (float)numUsed : 0;
+}
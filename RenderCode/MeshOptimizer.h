@@ -0,0 +1,66 @@
+//	----==== MESHOPTIMIZER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A wrapper class for functions to reorder indexed triangle lists for
+//					the post-transform vertex cache and for vertex fetch. optimizeVertexCache
+//					reorders the triangles with Tom Forsyth's linear-speed vertex cache
+//					optimization, which greedily picks the triangle whose vertices score
+//					highest for being recently used and for having few triangles left.
+//					optimizeVertexFetch then renumbers the vertices in the order the
+//					triangles first use them, so the vertex reads walk memory forward.
+//
+//					calcCacheStats models a FIFO cache, the usual hardware behavior, and
+//					gives the average cache miss ratio (ACMR, vertex transforms per
+//					triangle, 0.5 at best for a large grid and 3 at worst) and the average
+//					transform to vertex ratio (ATVR, 1 at best).
+//	--------------------------------------------------------------------------------
+
+
+#ifndef MESHOPTIMIZER_H
+#define MESHOPTIMIZER_H
+
+#include <vector>
+#include "TriMesh.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define MESH_CACHESIZE		32		// LRU cache modelled by the optimizer, at most MESH_MAXCACHESIZE
+#define MESH_MAXCACHESIZE	64
+#define MESH_FIFOSIZE		16		// FIFO cache used for the statistics by default
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct MeshCacheStats {
+	int			transforms;		// cache misses
+	float		acmr;			// transforms per triangle
+	float		atvr;			// transforms per vertex used
+};
+
+
+class MeshOptimizer {
+	public:
+
+		// Reorders the triangles of the list in place, the winding of each is kept
+		static void		optimizeVertexCache(uint *indices, int numIndices, int numVerts,
+											int cacheSize = MESH_CACHESIZE);
+
+		// Renumbers the vertices in the order of first use and rewrites the indices.
+		// remap[old] gives the new position of each vertex, vertices never used go last.
+		static void		optimizeVertexFetch(uint *indices, int numIndices, int numVerts,
+											std::vector<uint> &remap);
+
+		static void		calcCacheStats(MeshCacheStats &stats, const uint *indices, int numIndices,
+									   int numVerts, int fifoSize = MESH_FIFOSIZE);
+};
+
+
+#endif
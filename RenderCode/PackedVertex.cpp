@@ -0,0 +1,199 @@
+//	----==== PACKEDVERTEX.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Quantized vertex format for tessellated heightfield meshes
+//	--------------------------------------------------------------------------------
+
+
+#include <cmath>
+#include "PackedVertex.h"
+#include "../UtilityCode/LookupManager.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define PACK_MAXGRID		65535
+#define PACK_MAXHEIGHT		65535.0f
+
+// largest value of the normal components, 127 or 32767
+#define NORMAL_MAX			(float)((1 << (sizeof(N) * 8 - 1)) - 1)
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class PackedMeshT //////////
+
+
+template <class N>
+bool PackedMeshT<N>::pack(const TriMesh &mesh, float gridSpacing)
+{
+	vertices.clear();
+	if (mesh.vertices.empty() || gridSpacing <= 0) return false;
+
+	float minX = mesh.vertices[0].position.x, minZ = mesh.vertices[0].position.z;
+	float minY = mesh.vertices[0].position.y, maxY = minY;
+	for (size_t v = 1; v < mesh.vertices.size(); v++) {
+		const Vector3 &p = mesh.vertices[v].position;
+		if (p.x < minX) minX = p.x;
+		if (p.z < minZ) minZ = p.z;
+		if (p.y < minY) minY = p.y;
+		if (p.y > maxY) maxY = p.y;
+	}
+
+	format.originX = minX;
+	format.originZ = minZ;
+	format.gridSpacing = gridSpacing;
+	format.minHeight = minY;
+	format.heightScale = (maxY > minY) ? (maxY - minY) / PACK_MAXHEIGHT : 1.0f;
+
+	float invSpacing = 1.0f / gridSpacing;
+	float invHeightScale = 1.0f / format.heightScale;
+
+	vertices.resize(mesh.vertices.size());
+	for (size_t v = 0; v < mesh.vertices.size(); v++) {
+		const RenderVertex &rv = mesh.vertices[v];
+		PackedVertexT<N> &pv = vertices[v];
+
+		int gx = (int)floorf((rv.position.x - minX) * invSpacing + 0.5f);
+		int gz = (int)floorf((rv.position.z - minZ) * invSpacing + 0.5f);
+		if (gx > PACK_MAXGRID || gz > PACK_MAXGRID) {
+			vertices.clear();
+			return false;
+		}
+		pv.gridX = (ushort)gx;
+		pv.gridZ = (ushort)gz;
+
+		float h = floorf((rv.position.y - minY) * invHeightScale + 0.5f);
+		pv.height = (ushort)((h > PACK_MAXHEIGHT) ? PACK_MAXHEIGHT : h);
+
+		encodeNormal(pv.normalU, pv.normalV, rv.normal);
+	}
+
+	return true;
+}
+
+
+template <class N>
+void PackedMeshT<N>::unpack(RenderVertex &out, int v) const
+{
+	const PackedVertexT<N> &pv = vertices[v];
+	out.position.assign(format.originX + pv.gridX * format.gridSpacing,
+						format.minHeight + pv.height * format.heightScale,
+						format.originZ + pv.gridZ * format.gridSpacing);
+	decodeNormal(out.normal, pv.normalU, pv.normalV);
+}
+
+
+template <class N>
+void PackedMeshT<N>::unpack(std::vector<RenderVertex> &out) const
+{
+	out.resize(vertices.size());
+	for (int v = 0; v < (int)vertices.size(); v++) unpack(out[v], v);
+}
+
+
+template <class N>
+void PackedMeshT<N>::calcError(PackedError &err, const TriMesh &mesh) const
+{
+	err.maxPosition = err.rmsPosition = 0;
+	err.maxNormalDeg = err.avgNormalDeg = 0;
+	if (vertices.size() != mesh.vertices.size() || vertices.empty()) return;
+
+	double sumSq = 0, sumDeg = 0;
+	RenderVertex decoded;
+
+	for (int v = 0; v < (int)vertices.size(); v++) {
+		unpack(decoded, v);
+		const RenderVertex &rv = mesh.vertices[v];
+
+		Vector3 d = decoded.position - rv.position;
+		float dist = sqrtf(d * d);
+		sumSq += dist * dist;
+		if (dist > err.maxPosition) err.maxPosition = dist;
+
+		// acos loses the small angles of the 16 bit encoding to float rounding
+		Vector3 n = rv.normal;
+		n.normalize();
+		Vector3 cross = n % decoded.normal;
+		float deg = atan2f(sqrtf(cross * cross), n * decoded.normal) / DEGTORAD;
+		sumDeg += deg;
+		if (deg > err.maxNormalDeg) err.maxNormalDeg = deg;
+	}
+
+	err.rmsPosition = (float)sqrt(sumSq / vertices.size());
+	err.avgNormalDeg = (float)(sumDeg / vertices.size());
+}
+
+
+//-----------------------------------------------------------------------------
+//	Projects the normal onto the octahedron |x|+|y|+|z| = 1 and keeps x and z,
+//	the lower half is folded out over the corners of the square
+//-----------------------------------------------------------------------------
+template <class N>
+void PackedMeshT<N>::encodeNormal(N &u, N &v, const Vector3 &n)
+{
+	float l1 = fabsf(n.x) + fabsf(n.y) + fabsf(n.z);
+	if (l1 <= 0) {
+		u = v = 0;
+		return;
+	}
+
+	float ox = n.x / l1, oz = n.z / l1;
+	if (n.y < 0) {
+		float fx = (1.0f - fabsf(oz)) * (ox >= 0 ? 1.0f : -1.0f);
+		float fz = (1.0f - fabsf(ox)) * (oz >= 0 ? 1.0f : -1.0f);
+		ox = fx;
+		oz = fz;
+	}
+
+	// rounding each component alone is not always closest on the sphere
+	Vector3 unit = n / sqrtf(n * n);
+	float qx = floorf(ox * NORMAL_MAX), qz = floorf(oz * NORMAL_MAX);
+	if (qx < -NORMAL_MAX) qx = -NORMAL_MAX;
+	if (qz < -NORMAL_MAX) qz = -NORMAL_MAX;
+	float bestDot = -2.0f;
+
+	for (int c = 0; c < 4; c++) {
+		float tx = qx + (c & 1), tz = qz + (c >> 1);
+		if (tx > NORMAL_MAX || tz > NORMAL_MAX) continue;
+
+		Vector3 decoded;
+		decodeNormal(decoded, (N)tx, (N)tz);
+		float d = decoded * unit;
+		if (d > bestDot) {
+			bestDot = d;
+			u = (N)tx;
+			v = (N)tz;
+		}
+	}
+}
+
+
+template <class N>
+void PackedMeshT<N>::decodeNormal(Vector3 &n, N u, N v)
+{
+	float ox = u / NORMAL_MAX, oz = v / NORMAL_MAX;
+	float y = 1.0f - fabsf(ox) - fabsf(oz);
+	if (y < 0) {
+		float fx = (1.0f - fabsf(oz)) * (ox >= 0 ? 1.0f : -1.0f);
+		float fz = (1.0f - fabsf(ox)) * (oz >= 0 ? 1.0f : -1.0f);
+		ox = fx;
+		oz = fz;
+	}
+	n.assign(ox, y, oz);
+	n.normalize();
+}
+
+
+/*-------------------------------
+---- EXPLICIT INSTANTIATIONS ----
+-------------------------------*/
+
+template class PackedMeshT<signed char>;
+template class PackedMeshT<short>;
@@ -0,0 +1,94 @@
+//	----==== PACKEDVERTEX.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Quantized vertex format for tessellated heightfield meshes. The float
+//					RenderVertex takes 24 bytes; a packed vertex stores its x and z as 16
+//					bit grid coordinates, its height as 16 bits over the height range of
+//					the mesh, and its normal octahedral encoded in two 8 bit (8 bytes per
+//					vertex) or two 16 bit (10 bytes per vertex) components.
+//
+//					The octahedral encoding folds the unit sphere onto the square of x and
+//					z, with the y axis at the center, so the upward normals of a terrain
+//					get the most precision. The encoder tries the four nearest quantized
+//					values and keeps the one that decodes closest to the normal.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef PACKEDVERTEX_H
+#define PACKEDVERTEX_H
+
+#include <vector>
+#include "TriMesh.h"
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// N is signed char or short
+template <class N>
+struct PackedVertexT {
+	ushort		gridX, gridZ;
+	ushort		height;
+	N			normalU, normalV;
+};
+
+
+// Decodes the grid and height values to positions
+struct PackedFormat {
+	float		originX, originZ;		// position of grid coordinate 0
+	float		gridSpacing;
+	float		minHeight;
+	float		heightScale;			// height step of one unit
+};
+
+
+struct PackedError {
+	float		maxPosition, rmsPosition;	// distance from the float position
+	float		maxNormalDeg, avgNormalDeg;	// angle from the normalized float normal
+};
+
+
+template <class N>
+class PackedMeshT {
+	public:
+
+		///// Variables
+
+		std::vector< PackedVertexT<N> >	vertices;
+		PackedFormat					format;
+
+		///// Functions
+
+		// Quantizes the vertices of the mesh, which must lie on a grid of gridSpacing in x
+		// and z no more than 65535 steps across. Returns false when they do not.
+		bool		pack(const TriMesh &mesh, float gridSpacing);
+
+		void		unpack(RenderVertex &out, int v) const;
+		void		unpack(std::vector<RenderVertex> &out) const;
+
+		// Compares the decoded vertices to the mesh they were packed from
+		void		calcError(PackedError &err, const TriMesh &mesh) const;
+
+		static int	getVertexSize(void) { return (int)sizeof(PackedVertexT<N>); }
+
+		// Octahedral normal encoding, the normal need not be unit length
+		static void	encodeNormal(N &u, N &v, const Vector3 &n);
+		static void	decodeNormal(Vector3 &n, N u, N v);
+};
+
+
+/*----------------
+---- TYPEDEFS ----
+----------------*/
+
+typedef PackedVertexT<signed char>	PackedVertex8;
+typedef PackedVertexT<short>		PackedVertex16;
+typedef PackedMeshT<signed char>	PackedMesh8;
+typedef PackedMeshT<short>			PackedMesh16;
+
+
+#endif
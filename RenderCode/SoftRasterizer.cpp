@@ -0,0 +1,503 @@
+//	----==== SOFTRASTERIZER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Multithreaded tile based software rasterizer
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include "SoftRasterizer.h"
+#include "../UtilityCode/HiResTimer.h"
+#include "../UtilityCode/Profiler.h"
+#include "../UtilityCode/MsgAssert.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class SoftRasterizer //////////
+
+
+void SoftRasterizer::setTarget(FrameBuffer *fb)
+{
+	target = fb;
+	tilesX = (fb->getWidth() + tileSize - 1) / tileSize;
+	tilesY = (fb->getHeight() + tileSize - 1) / tileSize;
+	bins.resize(tilesX * tilesY);
+}
+
+
+void SoftRasterizer::setLight(const Vector3 &dirToLight, float ambientLevel)
+{
+	lightDir = dirToLight;
+	lightDir.normalize();
+	ambient = ambientLevel;
+}
+
+
+void SoftRasterizer::beginFrame(uint32 clear)
+{
+	msgAssert(target, "SoftRasterizer: no target frame buffer");
+
+	clearColor = clear;
+	triangles.clear();
+	for (size_t b = 0; b < bins.size(); b++) bins[b].clear();
+
+	stats.trianglesIn = stats.trianglesCulled = stats.trianglesClipped = 0;
+	stats.trianglesSetup = stats.binEntries = 0;
+	stats.pixelsWritten = stats.setupTicks = stats.rasterTicks = 0;
+}
+
+
+void SoftRasterizer::transformVertices(const RenderVertex *verts, int numVerts)
+{
+	clipVerts.resize(numVerts);
+	const float *m = viewProjection.i;
+
+	for (int v = 0; v < numVerts; v++) {
+		const Vector3 &p = verts[v].position;
+		ClipVertex &c = clipVerts[v];
+		c.x = p.x*m[0] + p.y*m[4] + p.z*m[8]  + m[12];
+		c.y = p.x*m[1] + p.y*m[5] + p.z*m[9]  + m[13];
+		c.z = p.x*m[2] + p.y*m[6] + p.z*m[10] + m[14];
+		c.w = p.x*m[3] + p.y*m[7] + p.z*m[11] + m[15];
+
+		const Vector3 &n = verts[v].normal;
+		float len = sqrtf(n.x*n.x + n.y*n.y + n.z*n.z);
+		float diffuse = (len > 0) ? (n.x*lightDir.x + n.y*lightDir.y + n.z*lightDir.z) / len : 0;
+		c.shade = ambient + (1.0f - ambient) * (diffuse > 0 ? diffuse : 0);
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//	Triangles entirely outside one of the side planes are rejected in clip
+//	space. The others are only clipped against the near plane, the tile bounds
+//	take care of the sides and the depth test takes care of the far plane.
+//-----------------------------------------------------------------------------
+void SoftRasterizer::drawTriangle(uint i0, uint i1, uint i2)
+{
+	msgAssert(i0 < clipVerts.size() && i1 < clipVerts.size() && i2 < clipVerts.size(),
+			  "SoftRasterizer: index out of range");
+
+	const ClipVertex &v0 = clipVerts[i0];
+	const ClipVertex &v1 = clipVerts[i1];
+	const ClipVertex &v2 = clipVerts[i2];
+	stats.trianglesIn++;
+
+	if ((v0.x >  v0.w && v1.x >  v1.w && v2.x >  v2.w) ||
+		(v0.x < -v0.w && v1.x < -v1.w && v2.x < -v2.w) ||
+		(v0.y >  v0.w && v1.y >  v1.w && v2.y >  v2.w) ||
+		(v0.y < -v0.w && v1.y < -v1.w && v2.y < -v2.w) ||
+		(v0.z >  v0.w && v1.z >  v1.w && v2.z >  v2.w) ||
+		(v0.z < -v0.w && v1.z < -v1.w && v2.z < -v2.w))
+	{
+		stats.trianglesCulled++;
+		return;
+	}
+
+	// each submitted triangle is counted once, as culled or as set up
+	bool drawn;
+	if (v0.z < -v0.w || v1.z < -v1.w || v2.z < -v2.w) {
+		stats.trianglesClipped++;
+		drawn = clipTriangle(v0, v1, v2);
+	} else {
+		drawn = setupTriangle(v0, v1, v2);
+	}
+
+	if (drawn) stats.trianglesSetup++;
+	else stats.trianglesCulled++;
+}
+
+
+void SoftRasterizer::drawIndexed(const RenderVertex *verts, int numVerts,
+								 const uint *indices, int numIndices)
+{
+	PROFILE_ZONE("rasterSetup");
+
+	int64 start = getTicks();
+
+	transformVertices(verts, numVerts);
+
+	for (int i = 0; i + 2 < numIndices; i += 3) {
+		drawTriangle(indices[i], indices[i+1], indices[i+2]);
+	}
+
+	stats.setupTicks += getTicks() - start;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Every other triangle of a strip is wound the other way, so its first two
+//	vertices are swapped. Degenerate triangles joining strips are skipped.
+//-----------------------------------------------------------------------------
+void SoftRasterizer::drawIndexedStrip(const RenderVertex *verts, int numVerts,
+									  const uint *strip, int numIndices)
+{
+	PROFILE_ZONE("rasterSetup");
+
+	int64 start = getTicks();
+
+	transformVertices(verts, numVerts);
+
+	int first = 0;
+	for (int s = 0; s <= numIndices; s++) {
+		if (s < numIndices && strip[s] != MESH_RESTART) continue;
+
+		for (int k = first; k + 2 < s; k++) {
+			uint a = strip[k], b = strip[k+1], c = strip[k+2];
+			if (a == b || b == c || a == c) continue;
+
+			if ((k - first) & 1) drawTriangle(b, a, c);
+			else drawTriangle(a, b, c);
+		}
+		first = s + 1;
+	}
+
+	stats.setupTicks += getTicks() - start;
+}
+
+
+// Sutherland-Hodgman against z = -w, leaves a triangle or a quad that is split in two.
+// Returns false if no part of it was set up.
+bool SoftRasterizer::clipTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2)
+{
+	const ClipVertex *in[3] = { &v0, &v1, &v2 };
+	ClipVertex out[4];
+	int numOut = 0;
+
+	for (int e = 0; e < 3; e++) {
+		const ClipVertex &a = *in[e];
+		const ClipVertex &b = *in[(e + 1) % 3];
+		float da = a.z + a.w;
+		float db = b.z + b.w;
+
+		if (da >= 0) out[numOut++] = a;
+		if ((da >= 0) != (db >= 0)) {
+			float t = da / (da - db);
+			ClipVertex &c = out[numOut++];
+			c.x = a.x + (b.x - a.x) * t;
+			c.y = a.y + (b.y - a.y) * t;
+			c.z = a.z + (b.z - a.z) * t;
+			c.w = a.w + (b.w - a.w) * t;
+			c.shade = a.shade + (b.shade - a.shade) * t;
+		}
+	}
+
+	bool drawn = false;
+	for (int v = 2; v < numOut; v++) {
+		if (setupTriangle(out[0], out[v-1], out[v])) drawn = true;
+	}
+	return drawn;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Projects to pixels, culls and computes the edge equations and attribute
+//	planes. The screen y axis points down, which turns counter clockwise
+//	triangles clockwise, so front faces have a negative area here. The
+//	vertices are then swapped so every triangle is drawn with positive area.
+//
+//	Vertices are snapped to 1/256th of a pixel and the edge equations are
+//	evaluated in 64 bit integers, so the two triangles sharing an edge see
+//	exactly opposite values along it and no pixel is drawn twice or missed.
+//	Returns false if the triangle was culled.
+//-----------------------------------------------------------------------------
+bool SoftRasterizer::setupTriangle(const ClipVertex &c0, const ClipVertex &c1, const ClipVertex &c2)
+{
+	const ClipVertex *c[3] = { &c0, &c1, &c2 };
+	int64 fx[3], fy[3];
+	float sz[3], rw[3], ss[3];
+	float halfW = target->getWidth() * 0.5f;
+	float halfH = target->getHeight() * 0.5f;
+
+	for (int v = 0; v < 3; v++) {
+		rw[v] = 1.0f / c[v]->w;
+		float x = (c[v]->x * rw[v] + 1.0f) * halfW;
+		float y = (1.0f - c[v]->y * rw[v]) * halfH;
+
+		// keeps the products of the edge equations within 64 bits
+		if (x < -RASTER_GUARDBAND) x = -RASTER_GUARDBAND; else if (x > RASTER_GUARDBAND) x = RASTER_GUARDBAND;
+		if (y < -RASTER_GUARDBAND) y = -RASTER_GUARDBAND; else if (y > RASTER_GUARDBAND) y = RASTER_GUARDBAND;
+
+		fx[v] = (int64)floorf(x * RASTER_SUBPIXELS + 0.5f);
+		fy[v] = (int64)floorf(y * RASTER_SUBPIXELS + 0.5f);
+		sz[v] = c[v]->z * rw[v] * 0.5f + 0.5f;
+		ss[v] = c[v]->shade * rw[v];
+	}
+
+	int64 area = (fx[1]-fx[0])*(fy[2]-fy[0]) - (fx[2]-fx[0])*(fy[1]-fy[0]);
+	if (area == 0 || (cullBackFaces && area > 0)) return false;
+
+	int order[3] = { 0, 1, 2 };
+	if (area < 0) {
+		order[1] = 2;
+		order[2] = 1;
+		area = -area;
+	}
+
+	RasterTriangle t;
+
+	// edge e runs from vertex e to vertex e+1 and is 0 at the vertex opposite, so
+	// edge e divided by the area is the barycentric weight of vertex e+2
+	int64 minFx = fx[0], maxFx = fx[0], minFy = fy[0], maxFy = fy[0];
+	float planeA[3], planeB[3], planeC[3];
+	const float toPixels = 1.0f / RASTER_SUBPIXELS;
+
+	for (int e = 0; e < 3; e++) {
+		int a = order[e], b = order[(e + 1) % 3];
+		int64 A = fy[a] - fy[b];
+		int64 B = fx[b] - fx[a];
+		int64 C = -(A * fx[a] + B * fy[a]);
+
+		// top-left edges include the pixels exactly on them, the others are moved in by one
+		bool inclusive = (A > 0) || (A == 0 && B > 0);
+
+		// evaluated at the first pixel center, then stepped a whole pixel at a time
+		t.edgeStepX[e] = A * RASTER_SUBPIXELS;
+		t.edgeStepY[e] = B * RASTER_SUBPIXELS;
+		t.edgeC[e] = C + A * (RASTER_SUBPIXELS/2) + B * (RASTER_SUBPIXELS/2) - (inclusive ? 0 : 1);
+
+		// the same equation in pixels for the attribute planes
+		planeA[e] = (float)A;
+		planeB[e] = (float)B;
+		planeC[e] = (float)C * toPixels;
+
+		if (fx[e] < minFx) minFx = fx[e];
+		if (fx[e] > maxFx) maxFx = fx[e];
+		if (fy[e] < minFy) minFy = fy[e];
+		if (fy[e] > maxFy) maxFy = fy[e];
+	}
+
+	// pixel x is covered when its center x*256+128 is inside the bounds
+	t.minX = (int)((minFx - RASTER_SUBPIXELS/2 + RASTER_SUBPIXELS - 1) >> RASTER_SUBPIXELBITS);
+	t.maxX = (int)((maxFx - RASTER_SUBPIXELS/2) >> RASTER_SUBPIXELBITS);
+	t.minY = (int)((minFy - RASTER_SUBPIXELS/2 + RASTER_SUBPIXELS - 1) >> RASTER_SUBPIXELBITS);
+	t.maxY = (int)((maxFy - RASTER_SUBPIXELS/2) >> RASTER_SUBPIXELBITS);
+	if (t.minX < 0) t.minX = 0;
+	if (t.minY < 0) t.minY = 0;
+	if (t.maxX >= target->getWidth()) t.maxX = target->getWidth() - 1;
+	if (t.maxY >= target->getHeight()) t.maxY = target->getHeight() - 1;
+
+	if (t.minX > t.maxX || t.minY > t.maxY) return false;
+
+	// attribute planes in pixels, weight of vertex order[e+2] is edge e over the area
+	float rArea = (float)RASTER_SUBPIXELS / (float)area;
+	float *planes[3][3] = { { &t.zA, &t.zB, &t.zC }, { &t.wA, &t.wB, &t.wC }, { &t.sA, &t.sB, &t.sC } };
+	const float *attribs[3] = { sz, rw, ss };
+
+	for (int p = 0; p < 3; p++) {
+		float a0 = attribs[p][order[2]] * rArea;	// weighted by edge 0
+		float a1 = attribs[p][order[0]] * rArea;	// weighted by edge 1
+		float a2 = attribs[p][order[1]] * rArea;	// weighted by edge 2
+		*planes[p][0] = a0 * planeA[0] + a1 * planeA[1] + a2 * planeA[2];
+		*planes[p][1] = a0 * planeB[0] + a1 * planeB[1] + a2 * planeB[2];
+		*planes[p][2] = a0 * planeC[0] + a1 * planeC[1] + a2 * planeC[2];
+	}
+
+	int index = (int)triangles.size();
+	triangles.push_back(t);
+
+	int tx0 = t.minX / tileSize, tx1 = t.maxX / tileSize;
+	int ty0 = t.minY / tileSize, ty1 = t.maxY / tileSize;
+	for (int ty = ty0; ty <= ty1; ty++) {
+		for (int tx = tx0; tx <= tx1; tx++) {
+			bins[ty * tilesX + tx].push_back(index);
+		}
+	}
+	stats.binEntries += (tx1 - tx0 + 1) * (ty1 - ty0 + 1);
+	return true;
+}
+
+
+void SoftRasterizer::endFrame(void)
+{
+	PROFILE_ZONE("rasterTiles");
+
+	int64 start = getTicks();
+
+	nextTile = 0;
+	pixelsWritten = 0;
+
+	if (!workers.empty()) {
+		std::lock_guard<std::mutex> lock(poolLock);
+		workersBusy = (int)workers.size();
+		generation++;
+	}
+	poolSignal.notify_all();
+
+	drawTiles();
+
+	if (!workers.empty()) {
+		std::unique_lock<std::mutex> lock(poolLock);
+		doneSignal.wait(lock, [this] { return workersBusy == 0; });
+	}
+
+	stats.pixelsWritten = pixelsWritten.load();
+	stats.rasterTicks += getTicks() - start;
+}
+
+
+void SoftRasterizer::drawTiles(void)
+{
+	int numTiles = tilesX * tilesY;
+	int64 pixels = 0;
+
+	// tile sized color and depth buffers of this thread, small enough to stay in the cache
+	std::vector<uint32> tileColor(tileSize * tileSize);
+	std::vector<float> tileDepth(tileSize * tileSize);
+
+	for (int tile = nextTile++; tile < numTiles; tile = nextTile++) {
+		drawTile(tile, &tileColor[0], &tileDepth[0], pixels);
+	}
+
+	pixelsWritten += pixels;
+}
+
+
+//-----------------------------------------------------------------------------
+//	The tile is cleared and drawn in the thread's tile buffers, then copied to
+//	the frame buffer once. Coordinates within the tile buffers are relative to
+//	the tile corner, edge equations are still evaluated at screen positions.
+//-----------------------------------------------------------------------------
+void SoftRasterizer::drawTile(int tile, uint32 *color, float *depth, int64 &pixels)
+{
+	int x0 = (tile % tilesX) * tileSize;
+	int y0 = (tile / tilesX) * tileSize;
+	int x1 = x0 + tileSize - 1;
+	int y1 = y0 + tileSize - 1;
+	if (x1 >= target->getWidth()) x1 = target->getWidth() - 1;
+	if (y1 >= target->getHeight()) y1 = target->getHeight() - 1;
+
+	const uint32 clear = clearColor;
+	const int stride = tileSize;
+	for (int p = 0; p < stride * stride; p++) {
+		color[p] = clear;
+		depth[p] = 1.0f;
+	}
+
+	const std::vector<int> &bin = bins[tile];
+	const float r = colorR * 255.0f, g = colorG * 255.0f, b = colorB * 255.0f;
+
+	for (size_t i = 0; i < bin.size(); i++) {
+		const RasterTriangle &t = triangles[bin[i]];
+
+		int minX = (t.minX > x0) ? t.minX : x0;
+		int maxX = (t.maxX < x1) ? t.maxX : x1;
+		int minY = (t.minY > y0) ? t.minY : y0;
+		int maxY = (t.maxY < y1) ? t.maxY : y1;
+
+		// copied to locals, the stores to the depth buffer could otherwise alias the
+		// triangle and force it to be reloaded for every pixel
+		const int64 a0 = t.edgeStepX[0], a1 = t.edgeStepX[1], a2 = t.edgeStepX[2];
+		const float zA = t.zA, wA = t.wA, sA = t.sA;
+
+		for (int y = minY; y <= maxY; y++) {
+			int64 e0 = a0 * minX + t.edgeStepY[0] * y + t.edgeC[0];
+			int64 e1 = a1 * minX + t.edgeStepY[1] * y + t.edgeC[1];
+			int64 e2 = a2 * minX + t.edgeStepY[2] * y + t.edgeC[2];
+
+			float py = y + 0.5f;
+			float px = minX + 0.5f;
+			float z  = zA * px + t.zB * py + t.zC;
+			float w  = wA * px + t.wB * py + t.wC;
+			float s  = sA * px + t.sB * py + t.sC;
+
+			uint32 *colorRow = color + (y - y0) * stride - x0;
+			float *depthRow = depth + (y - y0) * stride - x0;
+
+			for (int x = minX; x <= maxX; x++) {
+				// inside when no edge value is negative
+				if ((e0 | e1 | e2) >= 0 && z < depthRow[x]) {
+					depthRow[x] = z;
+
+					float shade = s / w;
+					if (shade > 1.0f) shade = 1.0f;
+					colorRow[x] = MAKE_RGBA((int)(r * shade), (int)(g * shade), (int)(b * shade), 255);
+					pixels++;
+				}
+
+				e0 += a0;
+				e1 += a1;
+				e2 += a2;
+				z += zA;
+				w += wA;
+				s += sA;
+			}
+		}
+	}
+
+	// resolve to the frame buffer
+	int width = target->getWidth();
+	int count = x1 - x0 + 1;
+	for (int y = y0; y <= y1; y++) {
+		memcpy(target->getColor() + y * width + x0, color + (y - y0) * stride, count * sizeof(uint32));
+		memcpy(target->getDepth() + y * width + x0, depth + (y - y0) * stride, count * sizeof(float));
+	}
+}
+
+
+void SoftRasterizer::workerMain(int index)
+{
+	if (Profiler::exists()) {
+		char name[32];
+		snprintf(name, sizeof(name), "Raster %d", index + 1);
+		profiler.setThreadName(name);
+	}
+
+	std::unique_lock<std::mutex> lock(poolLock);
+	int seen = 0;		// not read from generation, endFrame may already have been called
+
+	for (;;) {
+		poolSignal.wait(lock, [this, seen] { return generation != seen || workersQuit; });
+		if (workersQuit) break;
+		seen = generation;
+
+		lock.unlock();
+		{
+			PROFILE_ZONE("rasterTiles");
+			drawTiles();
+		}
+		lock.lock();
+
+		if (--workersBusy == 0) doneSignal.notify_all();
+	}
+}
+
+
+SoftRasterizer::SoftRasterizer(int numThreads, int _tileSize) :
+	target(0), ambient(0.2f), colorR(1), colorG(1), colorB(1), clearColor(0),
+	cullBackFaces(false), tileSize(_tileSize), tilesX(0), tilesY(0),
+	generation(0), workersBusy(0), workersQuit(false), nextTile(0), pixelsWritten(0)
+{
+	msgAssert(_tileSize > 0, "SoftRasterizer: tile size must be positive");
+
+	viewProjection.setIdentity();
+	lightDir.assign(0, 1, 0);
+	stats = RasterStats();
+
+	if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads <= 0) numThreads = 1;
+	if (numThreads > RASTER_MAXTHREADS) numThreads = RASTER_MAXTHREADS;
+
+	for (int w = 0; w < numThreads - 1; w++) {
+		workers.push_back(std::thread(&SoftRasterizer::workerMain, this, w));
+	}
+}
+
+
+SoftRasterizer::~SoftRasterizer()
+{
+	{
+		std::lock_guard<std::mutex> lock(poolLock);
+		workersQuit = true;
+	}
+	poolSignal.notify_all();
+
+	for (size_t w = 0; w < workers.size(); w++) workers[w].join();
+}
@@ -0,0 +1,168 @@
+//	----==== SOFTRASTERIZER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Multithreaded tile based software rasterizer, used to render the surface
+//					on machines without a GPU. drawIndexed transforms the vertices, lights
+//					them with one directional light, clips the triangles against the near
+//					plane, sets up their edge equations and sorts them into screen tiles.
+//					endFrame then hands the tiles out to the worker threads, each of which
+//					draws the triangles binned to a tile in the order they were submitted,
+//					with a depth test and Gouraud shading, into a tile sized buffer that
+//					stays in the cache, and copies it to the frame buffer. A tile is only
+//					ever touched by one thread, so no locking is needed while drawing and
+//					the image is the same with any number of threads.
+//
+//					Triangles follow the OpenGL conventions: counter clockwise is front
+//					facing, and pixels are covered when their centers are inside, with the
+//					top-left rule deciding pixels on an edge shared by two triangles.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef SOFTRASTERIZER_H
+#define SOFTRASTERIZER_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <atomic>
+#include <condition_variable>
+#include "FrameBuffer.h"
+#include "TriMesh.h"
+#include "../MathCode/Vector3.h"
+#include "../MathCode/Matrix4x4.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define RASTER_TILESIZE			64			// pixels on a side of a screen tile
+#define RASTER_MAXTHREADS		32
+#define RASTER_SUBPIXELBITS		8			// vertex positions are snapped to 1/256th of a pixel
+#define RASTER_SUBPIXELS		(1 << RASTER_SUBPIXELBITS)
+#define RASTER_GUARDBAND		1048576.0f	// pixels, vertices beyond are clamped
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct RasterStats {
+	int			trianglesIn;		// submitted to drawIndexed
+	int			trianglesCulled;	// back facing, off screen or too small to cover a pixel center
+	int			trianglesClipped;	// crossed the near plane
+	int			trianglesSetup;		// drawn into the tiles, trianglesIn is trianglesCulled + trianglesSetup
+	int			binEntries;			// triangles times the tiles they overlap
+	int64		pixelsWritten;		// passed the depth test
+	int64		setupTicks;			// transform, clip, setup and binning
+	int64		rasterTicks;		// endFrame
+};
+
+
+class SoftRasterizer {
+	private:
+
+		///// Structures
+
+		struct ClipVertex {
+			float	x, y, z, w;
+			float	shade;
+		};
+
+		// Fixed point edge equations E = stepX*x + stepY*y + C for pixel x,y are not
+		// negative inside. The attribute planes give depth, 1/w and shade/w at any pixel
+		// center, the last two interpolate the shade with perspective correction.
+		struct RasterTriangle {
+			int64	edgeStepX[3], edgeStepY[3], edgeC[3];
+			float	zA, zB, zC;
+			float	wA, wB, wC;
+			float	sA, sB, sC;
+			int		minX, minY, maxX, maxY;	// pixel bounds, inclusive
+		};
+
+		///// Variables
+
+		FrameBuffer			*target;
+		Matrix4x4			viewProjection;
+		Vector3				lightDir;			// toward the light, unit length
+		float				ambient;
+		float				colorR, colorG, colorB;
+		uint32				clearColor;
+		bool				cullBackFaces;
+
+		int					tileSize, tilesX, tilesY;
+
+		std::vector<ClipVertex>			clipVerts;
+		std::vector<RasterTriangle>		triangles;
+		std::vector< std::vector<int> >	bins;		// triangle indices per tile
+
+		RasterStats			stats;
+
+		// worker threads, the main thread draws tiles too
+		std::vector<std::thread>	workers;
+		std::mutex			poolLock;
+		std::condition_variable	poolSignal, doneSignal;
+		int					generation;			// incremented for each endFrame
+		int					workersBusy;
+		bool				workersQuit;
+		std::atomic<int>	nextTile;
+		std::atomic<int64>	pixelsWritten;
+
+		///// Functions
+
+		void				workerMain(int index);
+		void				drawTiles(void);
+		void				drawTile(int tile, uint32 *color, float *depth, int64 &pixels);
+		void				transformVertices(const RenderVertex *verts, int numVerts);
+		void				drawTriangle(uint i0, uint i1, uint i2);
+		bool				setupTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2);
+		bool				clipTriangle(const ClipVertex &v0, const ClipVertex &v1, const ClipVertex &v2);
+
+		// Make copy constructor and assignment operator private
+		SoftRasterizer(const SoftRasterizer &r);
+		SoftRasterizer& operator=(const SoftRasterizer &r);
+
+	public:
+
+		///// Accessors
+
+		const RasterStats &	getStats(void) const	{ return stats; }
+		int					getNumThreads(void) const { return (int)workers.size() + 1; }
+		int					getTileSize(void) const	{ return tileSize; }
+
+		///// Functions
+
+		// The target must stay alive until endFrame returns
+		void				setTarget(FrameBuffer *fb);
+		void				setViewProjection(const Matrix4x4 &m) { viewProjection = m; }
+		void				setLight(const Vector3 &dirToLight, float ambientLevel);
+		void				setColor(float r, float g, float b) { colorR = r; colorG = g; colorB = b; }
+		void				setCullBackFaces(bool cull) { cullBackFaces = cull; }
+
+		// Starts a frame, the target is cleared to the color by the tiles in endFrame
+		void				beginFrame(uint32 clear);
+
+		// Adds indexed triangles to the frame, positions are transformed by the view
+		// projection matrix and normals are lit in the same space as the positions
+		void				drawIndexed(const RenderVertex *verts, int numVerts,
+										const uint *indices, int numIndices);
+
+		// Same for triangle strips separated by MESH_RESTART
+		void				drawIndexedStrip(const RenderVertex *verts, int numVerts,
+											 const uint *strip, int numIndices);
+
+		// Draws all tiles, returns when the frame buffer is complete
+		void				endFrame(void);
+
+		// Constructors / Destructor
+		// numThreads counts the calling thread, 0 uses one thread per hardware thread
+		explicit SoftRasterizer(int numThreads = 0, int tileSize = RASTER_TILESIZE);
+		~SoftRasterizer();
+};
+
+
+#endif
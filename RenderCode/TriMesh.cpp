@@ -0,0 +1,80 @@
+//	----==== TRIMESH.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Indexed triangle mesh
+//	--------------------------------------------------------------------------------
+
+
+#include <algorithm>
+#include "TriMesh.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// struct TriMesh //////////
+
+
+void TriMesh::clear(void)
+{
+	vertices.clear();
+	indices.clear();
+	strip.clear();
+	edges.clear();
+	vertexMap.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+//	Each edge is keyed by its two vertices, lowest first, so the edge shared by
+//	two triangles gives the same key from both and sorting puts them together
+//-----------------------------------------------------------------------------
+void TriMesh::buildEdges(void)
+{
+	std::vector<uint64> keys;
+	keys.reserve(indices.size());
+
+	for (size_t t = 0; t + 2 < indices.size(); t += 3) {
+		for (int e = 0; e < 3; e++) {
+			uint a = indices[t + e];
+			uint b = indices[t + (e + 1) % 3];
+			if (a > b) std::swap(a, b);
+			keys.push_back(((uint64)a << 32) | b);
+		}
+	}
+
+	std::sort(keys.begin(), keys.end());
+	keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+
+	edges.resize(keys.size() * 2);
+	for (size_t e = 0; e < keys.size(); e++) {
+		edges[e*2]   = (uint)(keys[e] >> 32);
+		edges[e*2+1] = (uint)(keys[e] & 0xFFFFFFFF);
+	}
+}
+
+
+// every other triangle of a strip is wound the other way, so its first two vertices are swapped
+void TriMesh::stripToList(void)
+{
+	indices.clear();
+
+	size_t start = 0;
+	for (size_t s = 0; s <= strip.size(); s++) {
+		if (s < strip.size() && strip[s] != MESH_RESTART) continue;
+
+		for (size_t k = start; k + 2 < s; k++) {
+			uint a = strip[k], b = strip[k+1], c = strip[k+2];
+			if (a == b || b == c || a == c) continue;
+
+			if ((k - start) & 1) std::swap(a, b);
+			indices.push_back(a);
+			indices.push_back(b);
+			indices.push_back(c);
+		}
+		start = s + 1;
+	}
+}
@@ -0,0 +1,67 @@
+//	----==== TRIMESH.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Indexed triangle mesh, the output of the surface tessellator and the
+//					input of the renderers. Vertices are shared by all the triangles that
+//					use them. The triangles can be given as a list, as strips separated by
+//					a restart index, or both, and the unique edges can be listed for
+//					wireframe drawing. Indices are 32 bit, so meshes may exceed 64k
+//					vertices.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef TRIMESH_H
+#define TRIMESH_H
+
+#include <vector>
+#include "../MathCode/Vector3.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define MESH_RESTART		0xFFFFFFFF		// ends one strip and starts the next
+
+// what the tessellator should output, the triangle list is always built
+#define MESH_STRIP			0x01
+#define MESH_EDGES			0x02
+#define MESH_OPTIMIZE		0x04		// reordered for the vertex cache and vertex fetch
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct RenderVertex {
+	Vector3		position;
+	Vector3		normal;
+};
+
+
+struct TriMesh {
+	std::vector<RenderVertex>	vertices;
+	std::vector<uint>			indices;	// triangle list, counter clockwise front faces
+	std::vector<uint>			strip;		// triangle strips separated by MESH_RESTART
+	std::vector<uint>			edges;		// line list, each edge of the triangle list once
+	std::vector<uint>			vertexMap;	// where a generator stores its n'th vertex, empty when at n
+
+	int		getNumVertices(void) const	{ return (int)vertices.size(); }
+	int		getNumTriangles(void) const	{ return (int)indices.size() / 3; }
+	uint	getVertexSlot(uint n) const	{ return vertexMap.empty() ? n : vertexMap[n]; }
+
+	void	clear(void);
+
+	// Lists the unique edges of the triangle list
+	void	buildEdges(void);
+
+	// Expands the strips to a triangle list, the degenerate triangles are dropped
+	void	stripToList(void);
+};
+
+
+#endif
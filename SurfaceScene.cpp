@@ -0,0 +1,307 @@
+//	----==== SURFACESCENE.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	State, simulation and tessellation of the bi-cubic surface test scene
+//	-------------------------------------------------------------------------------------
+
+#include <stdlib.h>
+#include <time.h>
+#include <string.h>
+#include "SurfaceScene.h"
+#include "MathCode/Spline.h"
+#include "UtilityCode/Profiler.h"
+#include "RenderCode/MeshOptimizer.h"
+#include "TerrainCode/HeightField.h"
+#include "TerrainCode/TileCache.h"
+#include "UtilityCode/MsgAssert.h"
+
+#if POINTSPERSIDE > TILECACHE_MINTILESIZE
+	#error The tile cache must not accept tiles smaller than the window of POINTSPERSIDE
+#endif
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+float		heights[POINTSPERSIDE*POINTSPERSIDE];
+Matrix4x4	patchMatrices[PATCHESPERSIDE*PATCHESPERSIDE];
+bool		usePatchMatrices = false;
+Quaternion	viewOrientation;
+
+bool		cameraRelative = true;
+
+// World positions are kept in double precision. In camera relative mode they are converted to
+// float offsets from the view target before being rendered, so vertex precision does not
+// depend on how far the surface is from the world origin.
+Vector3d	surfaceOrigin(WORLDOFFSET - 15, 0, WORLDOFFSET - 15);
+Vector3d	viewTarget(WORLDOFFSET, 0, WORLDOFFSET);
+
+// The view transform is built on the CPU once per frame and kept for culling and picking.
+// The inverse view matrix holds the camera position in its bottom row.
+MatrixStack	modelView;
+Matrix4x4	viewMatrix, inverseViewMatrix;
+
+// Simulation state, only touched by updateScene and syncScene. The previous value is kept so
+// the render can interpolate between the last two fixed steps.
+BinAngle	simSpin, simSpinPrev;
+bool		simSpinning = false;
+
+// Render copies of the simulation state, made by syncScene while the update is idle
+BinAngle	renderSpin, renderSpinPrev;
+bool		spinRequested = false;
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+void initSurfacePoints(unsigned int seed)
+{
+	srand(seed);
+
+	for (int c = 0; c < POINTSPERSIDE*POINTSPERSIDE; c++) {
+		heights[c] = (rand() % 12) - 6.0f;
+	}
+	usePatchMatrices = false;
+}
+
+
+void initSurfacePoints(void)
+{
+	initSurfacePoints((unsigned int)time(NULL) + (rand() % 100));
+}
+
+
+void loadSurfacePoints(HeightField &field, int x0, int z0)
+{
+	PROFILE_ZONE("loadSurfacePoints");
+
+	field.readRegion(heights, x0, z0, POINTSPERSIDE, POINTSPERSIDE);
+	usePatchMatrices = false;
+}
+
+
+void loadSurfacePoints(const float *field, int fieldWidth, int fieldHeight, int x0, int z0)
+{
+	for (int z = 0; z < POINTSPERSIDE; z++) {
+		int fz = (z0 + z < 0) ? 0 : (z0 + z >= fieldHeight) ? fieldHeight - 1 : z0 + z;
+		for (int x = 0; x < POINTSPERSIDE; x++) {
+			int fx = (x0 + x < 0) ? 0 : (x0 + x >= fieldWidth) ? fieldWidth - 1 : x0 + x;
+			heights[z*POINTSPERSIDE + x] = field[(size_t)fz * fieldWidth + fx];
+		}
+	}
+	usePatchMatrices = false;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	The cache refuses tiles smaller than TILECACHE_MINTILESIZE, which is no smaller than the
+//	window, so the window covers at most 2 x 2 tiles. Every tile is asked for before
+//	returning, so all the missing ones are queued at once.
+//-------------------------------------------------------------------------------------------
+bool loadSurfacePoints(TileCache &cache, int x0, int z0)
+{
+	PROFILE_ZONE("loadSurfacePoints");
+
+	const int ts = cache.getTileSize();
+	msgAssert(ts >= POINTSPERSIDE, "loadSurfacePoints: tiles are smaller than the window");
+	const int tx0 = x0 / ts, tz0 = z0 / ts;
+	const CachedTile *tiles[2][2] = { { 0, 0 }, { 0, 0 } };
+	bool resident = true;
+
+	for (int tz = tz0; tz <= (z0 + POINTSPERSIDE - 1) / ts; tz++) {
+		for (int tx = tx0; tx <= (x0 + POINTSPERSIDE - 1) / ts; tx++) {
+			tiles[tz - tz0][tx - tx0] = cache.getTile(tx, tz);
+			if (!tiles[tz - tz0][tx - tx0]) resident = false;
+		}
+	}
+	if (!resident) return false;
+
+	for (int z = 0; z < POINTSPERSIDE; z++) {
+		int tz = (z0 + z) / ts, sz = z0 + z - tz * ts;
+		for (int x = 0; x < POINTSPERSIDE; x++) {
+			int tx = (x0 + x) / ts, sx = x0 + x - tx * ts;
+			const CachedTile *tile = tiles[tz - tz0][tx - tx0];
+			heights[z*POINTSPERSIDE + x] = tile->heights[sz * ts + sx];
+			if (x < PATCHESPERSIDE && z < PATCHESPERSIDE) {
+				memcpy(patchMatrices[z*PATCHESPERSIDE + x].i, tile->getPatch(sx, sz, ts),
+					   TILECACHE_PATCHFLOATS * sizeof(float));
+			}
+		}
+	}
+	usePatchMatrices = true;
+	return true;
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	One fixed simulation step, the surface turns about the world y axis while spinning
+//-------------------------------------------------------------------------------------------
+void updateScene(double stepSeconds)
+{
+	simSpinPrev = simSpin;
+	if (simSpinning) simSpin += BinAngle::fromDegrees(SPINRATE * (float)stepSeconds);
+}
+
+
+void syncScene(void)
+{
+	renderSpinPrev = simSpinPrev;
+	renderSpin = simSpin;
+	simSpinning = spinRequested;
+}
+
+
+void buildView(float alpha)
+{
+	PROFILE_ZONE("buildView");
+
+	// reset the modelview matrix
+	modelView.loadIdentity();
+
+	// translate the view in the -z direction (straight back away from the screen)
+	// so we can see the scene
+	modelView.translate(0,0,-50);
+
+	modelView.rotate(viewOrientation);
+
+	// the difference of binary angles is the short way around, even across 0 degrees
+	BinAngle spinStep = renderSpin - renderSpinPrev;
+	BinAngle spin = renderSpinPrev + BinAngle((unsigned int)(int)((float)(int)spinStep.value * alpha));
+	modelView.rotateY(spin.toRadians());
+
+	// in camera relative mode the view target is already subtracted from every vertex
+	if (!cameraRelative) modelView.translate((float)-viewTarget.x, (float)-viewTarget.y, (float)-viewTarget.z);
+
+	viewMatrix = modelView.getMatrix();
+	inverseViewMatrix.orthonormalInverse(viewMatrix);
+}
+
+
+void toRenderSpace(Vector3 &out, const Vector3d &world)
+{
+	if (cameraRelative) {
+		out.assignRelative(world, viewTarget);
+	} else {
+		out.assign((float)world.x, (float)world.y, (float)world.z);
+	}
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	Row j of the grid runs along x at z = j, each pair of rows is one strip. The list has the
+//	same triangles, two per grid square, counter clockwise seen from above. When optimized, the
+//	list is reordered for the vertex cache and the vertices are renumbered in the order the list
+//	uses them, vertexMap then gives the slot for each grid position and the strip follows it.
+//-------------------------------------------------------------------------------------------
+void buildSurfaceIndices(TriMesh &mesh, int subdivisions, int flags)
+{
+	PROFILE_ZONE("buildSurfaceIndices");
+
+	const uint side = PATCHESPERSIDE * subdivisions + 1;
+
+	mesh.indices.clear();
+	mesh.indices.reserve((side-1) * (side-1) * 6);
+	for (uint j = 0; j < side-1; j++) {
+		for (uint i = 0; i < side-1; i++) {
+			uint v = j * side + i;
+			mesh.indices.push_back(v);		mesh.indices.push_back(v + side);	mesh.indices.push_back(v + 1);
+			mesh.indices.push_back(v + 1);	mesh.indices.push_back(v + side);	mesh.indices.push_back(v + side + 1);
+		}
+	}
+
+	mesh.vertexMap.clear();
+	if (flags & MESH_OPTIMIZE) {
+		MeshOptimizer::optimizeVertexCache(&mesh.indices[0], (int)mesh.indices.size(), side * side);
+		MeshOptimizer::optimizeVertexFetch(&mesh.indices[0], (int)mesh.indices.size(), side * side, mesh.vertexMap);
+	}
+
+	mesh.strip.clear();
+	if (flags & MESH_STRIP) {
+		mesh.strip.reserve((side-1) * (side*2 + 1));
+		for (uint j = 0; j < side-1; j++) {
+			if (j > 0) mesh.strip.push_back(MESH_RESTART);
+			for (uint i = 0; i < side; i++) {
+				mesh.strip.push_back(mesh.getVertexSlot(j * side + i));
+				mesh.strip.push_back(mesh.getVertexSlot((j+1) * side + i));
+			}
+		}
+	}
+
+	mesh.edges.clear();
+	if (flags & MESH_EDGES) mesh.buildEdges();
+}
+
+
+//-------------------------------------------------------------------------------------------
+//	The spline patch matrix is shared, so the surface must be tessellated from one thread.
+//	Each patch skips its first row and column when a neighbor has already evaluated them.
+//-------------------------------------------------------------------------------------------
+void tessellateSurface(TriMesh &mesh, int flags)
+{
+	PROFILE_ZONE("tessellateSurface");
+
+	const int side = SURFACESIDEVERTS;
+	const float tStep = 1.0f / SUBDIVISIONS;
+
+	bool wantStrip = (flags & MESH_STRIP) != 0;
+	bool wantEdges = (flags & MESH_EDGES) != 0;
+	bool wantOptimize = (flags & MESH_OPTIMIZE) != 0;
+	if (mesh.indices.empty() || wantStrip != !mesh.strip.empty() || wantEdges != !mesh.edges.empty() ||
+		wantOptimize != !mesh.vertexMap.empty())
+	{
+		buildSurfaceIndices(mesh, SUBDIVISIONS, flags);
+	}
+	mesh.vertices.resize(side * side);
+
+	float hPtr[16];
+	Vector3 patchOrigin;
+
+	// the normals are taken from tangents across patches PATCHSPACING wide
+	CubicBSpline::setSpacing(PATCHSPACING, VERTSCALE);
+
+	for (int pz = 0; pz < PATCHESPERSIDE; pz++) {
+		for (int px = 0; px < PATCHESPERSIDE; px++) {
+
+			if (usePatchMatrices) {
+				CubicBSpline::setMiddleMatrixPtr(patchMatrices[pz*PATCHESPERSIDE+px]);
+			} else {
+				// store patch heights in array
+				for (int h = 0; h < 4; h++) {
+					hPtr[h*4]   = heights[(pz+h)*POINTSPERSIDE+px];
+					hPtr[h*4+1] = heights[(pz+h)*POINTSPERSIDE+px+1];
+					hPtr[h*4+2] = heights[(pz+h)*POINTSPERSIDE+px+2];
+					hPtr[h*4+3] = heights[(pz+h)*POINTSPERSIDE+px+3];
+				}
+				CubicBSpline::preCalcMiddleMatrix(hPtr);
+			}
+			//CatmullRomSpline::setSplineMatrix(0,0,hPtr,4);
+
+			// only the patch origin goes through double precision, offsets within the patch are small
+			toRenderSpace(patchOrigin, Vector3d(surfaceOrigin.x + px*PATCHSPACING,
+												surfaceOrigin.y,
+												surfaceOrigin.z + pz*PATCHSPACING));
+
+			for (int j = (pz == 0) ? 0 : 1; j <= SUBDIVISIONS; j++) {
+				float v = j * tStep;
+				uint rowStart = (pz*SUBDIVISIONS + j) * side + px*SUBDIVISIONS;
+
+				for (int i = (px == 0) ? 0 : 1; i <= SUBDIVISIONS; i++) {
+					float u = i * tStep;
+					RenderVertex &rv = mesh.vertices[mesh.getVertexSlot(rowStart + i)];
+					rv.position.assign(	patchOrigin.x + u*PATCHSPACING,
+										patchOrigin.y + CubicBSpline::calcHeightOnPatchMatrix(u,v,usePatchMatrices),
+										patchOrigin.z + v*PATCHSPACING);
+
+					// the spline normal points down, the mesh normal points away from the front face
+					rv.normal = -CubicBSpline::calcNormalOnPatchMatrix(u,v,usePatchMatrices);
+				}
+			}
+		}
+	}
+}
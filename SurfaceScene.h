@@ -0,0 +1,99 @@
+//	----==== SURFACESCENE.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	State, simulation and tessellation of the bi-cubic surface test scene.
+//					Nothing here touches the window, OpenGL or the input managers, so the
+//					scene runs the same under the Win32 host (SurfaceTest.cpp draws it)
+//					and the headless Linux host (Linux_Main.cpp only tessellates it).
+//	-------------------------------------------------------------------------------------
+
+#ifndef SURFACESCENE_H
+#define SURFACESCENE_H
+
+#include "MathCode/Vector3.h"
+#include "MathCode/MatrixStack.h"
+#include "MathCode/Quaternion.h"
+#include "UtilityCode/BinAngle.h"
+#include "RenderCode/TriMesh.h"
+
+class HeightField;
+class TileCache;
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define SUBDIVISIONS	10
+#define POINTSPERSIDE	8
+#define HORZSCALE		2
+#define VERTSCALE		1
+#define PATCHSPACING	6
+#define PATCHESPERSIDE	(POINTSPERSIDE-3)
+#define SURFACESIDEVERTS	(PATCHESPERSIDE*SUBDIVISIONS+1)	// vertices along one side of the mesh
+#define WORLDOFFSET		1000000.0	// places the surface far from the origin to test large world precision
+#define SPINRATE		30.0f		// degrees per second the surface turns when spinning
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+extern float		heights[POINTSPERSIDE*POINTSPERSIDE];
+
+// Middle matrices of the patches when they come built from the tile cache, otherwise each
+// patch is built from the heights as it is tessellated
+extern Matrix4x4	patchMatrices[PATCHESPERSIDE*PATCHESPERSIDE];
+extern bool			usePatchMatrices;
+extern Quaternion	viewOrientation;		// rotation of the scene around the view target
+extern bool			cameraRelative;
+
+extern Vector3d		surfaceOrigin;			// world position of the first patch corner
+extern Vector3d		viewTarget;				// world position the view orbits around
+
+extern MatrixStack	modelView;
+extern Matrix4x4	viewMatrix, inverseViewMatrix;
+
+extern bool			spinRequested;			// input, passed to the simulation at the next sync
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+void	initSurfacePoints(void);
+void	initSurfacePoints(unsigned int seed);	// repeatable heights for batch runs
+
+// Takes the heights from the POINTSPERSIDE square window of the heightfield starting at
+// sample x0,z0, only the tiles under the window are paged in
+void	loadSurfacePoints(HeightField &field, int x0, int z0);
+
+// Same for a heightmap in memory, fieldWidth x fieldHeight samples in rows
+void	loadSurfacePoints(const float *field, int fieldWidth, int fieldHeight, int x0, int z0);
+
+// Takes the heights and patches from the tile cache without waiting. Returns false and leaves
+// the surface as it was when a tile under the window is not resident yet.
+bool	loadSurfacePoints(TileCache &cache, int x0, int z0);
+
+// Called by the LoopScheduler, updateScene may run on the update thread
+void	updateScene(double stepSeconds);
+void	syncScene(void);
+
+// Builds viewMatrix and inverseViewMatrix for the render state interpolated by alpha
+void	buildView(float alpha);
+
+// Converts a double precision world position to the float position used for rendering
+void	toRenderSpace(Vector3 &out, const Vector3d &world);
+
+// Builds the indices of the surface mesh for any number of subdivisions per patch. flags is a
+// combination of MESH_STRIP, MESH_EDGES and MESH_OPTIMIZE.
+void	buildSurfaceIndices(TriMesh &mesh, int subdivisions, int flags);
+
+// Evaluates the whole surface into an indexed mesh, vertices on patch borders are shared by
+// the patches on both sides. The indices only depend on SUBDIVISIONS, so they are only built
+// when the mesh is empty or the flags change.
+void	tessellateSurface(TriMesh &mesh, int flags);
+
+#endif
@@ -12,22 +12,14 @@
 #include <windows.h>
 #include <gl/gl.h>
 #include <gl/glu.h>
-#include <time.h>
-#include "utilitycode/keyboardmanager.h"
-#include "utilitycode/mousemanager.h"
-#include "mathcode/spline.h"
-#include "mathcode/vector3.h"
-#include "utilitycode/glfont.h"
-
-
-/*---------------
----- DEFINES ----
----------------*/
-
-#define SUBDIVISIONS	10
-#define POINTSPERSIDE	8
-#define HORZSCALE		2
-#define VERTSCALE		1
+#include "SurfaceTest.h"
+#include "SurfaceScene.h"
+#include "UtilityCode/KeyboardManager.h"
+#include "UtilityCode/MouseManager.h"
+#include "UtilityCode/LookupManager.h"
+#include "UtilityCode/GLFont.h"
+#include "UtilityCode/Profiler.h"
+#include "UtilityCode/Timer.h"
 
 
 /*-----------------
@@ -37,10 +29,8 @@
 extern HDC		hDC;
 extern GLFont	*font;
 
-float	heights[POINTSPERSIDE*POINTSPERSIDE];
-float	rotateX = 0, rotateY = 0;
-
 bool	drawWireframe = false;
+TriMesh	surfaceMesh;
 
 
 /*-----------------
@@ -48,113 +38,127 @@ bool	drawWireframe = false;
 -----------------*/
 
 
+//-------------------------------------------------------------------------------------------
+//	Draws the tessellated mesh from vertex arrays, lit from above in fill mode, or its edges
+//	as black lines in wireframe mode
+//-------------------------------------------------------------------------------------------
 void renderSurface(void)
 {
-	glColor3f(0,0,0);
-	glPointSize(2.5f);
-
-	float hPtr[16];
-	float tStep = 1.0f / SUBDIVISIONS;
+	PROFILE_ZONE("renderSurface");
 
-	for (int z = 0; z < POINTSPERSIDE-3; z++) {
+	tessellateSurface(surfaceMesh, MESH_OPTIMIZE | (drawWireframe ? MESH_EDGES : 0));
 
-		for (int x = 0; x < POINTSPERSIDE-3; x++) {
-			
-			// store patch heights in array
-			for (int h = 0; h < 4; h++) {
-				hPtr[h*4]   = heights[(z+h)*POINTSPERSIDE+x];
-				hPtr[h*4+1] = heights[(z+h)*POINTSPERSIDE+x+1];
-				hPtr[h*4+2] = heights[(z+h)*POINTSPERSIDE+x+2];
-				hPtr[h*4+3] = heights[(z+h)*POINTSPERSIDE+x+3];
-			}
+	PROFILE_ZONE("drawMesh");
 
-			CubicBSpline::preCalcMiddleMatrix(hPtr);
-			//CatmullRomSpline::setSplineMatrix(0,0,hPtr,4);
-
-			glBegin(GL_POINTS);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+	glVertexPointer(3, GL_FLOAT, sizeof(RenderVertex), surfaceMesh.vertices[0].position.v);
+	glNormalPointer(GL_FLOAT, sizeof(RenderVertex), surfaceMesh.vertices[0].normal.v);
 
-			float v = 0;
-			for (int j = 0; j <= SUBDIVISIONS; j++) {
-				
-				float u = 0;
-				for (int i = 0; i <= SUBDIVISIONS; i++) {
-					Vector3 p(	x*6 + u*6 - 15,
-								CubicBSpline::calcHeightOnPatchMatrix(u,v),
-								z*6 + v*6 - 15);
-
-					glColor3f(0,0,0);
-					glVertex3fv(p.v);
-								
-					glColor3f(1,0,0);
-					Vector3 n(p);
-					n += CubicBSpline::calcNormalOnPatchMatrix(u,v,6);					
-					glVertex3fv(n.v);
-
-					u += tStep;
-				}
-
-				v += tStep;
-			}
-			glEnd();			
-		}
-	}
-}
+	if (drawWireframe) {
+		glColor3f(0,0,0);
+		glDrawElements(GL_LINES, (GLsizei)surfaceMesh.edges.size(), GL_UNSIGNED_INT, &surfaceMesh.edges[0]);
 
+	} else {
+		// the light position is transformed by the view matrix already loaded
+		GLfloat lightDir[4] = { 0.5f, 1.0f, 0.3f, 0.0f };
+		glLightfv(GL_LIGHT0, GL_POSITION, lightDir);
+		glEnable(GL_LIGHTING);
+		glEnable(GL_LIGHT0);
+		glEnable(GL_NORMALIZE);
+		glEnable(GL_COLOR_MATERIAL);
 
-void initSurfacePoints(void)
-{
-	srand(time(NULL) + (rand() % 100));
+		glColor3f(0.45f, 0.7f, 0.3f);
+		glDrawElements(GL_TRIANGLES, (GLsizei)surfaceMesh.indices.size(), GL_UNSIGNED_INT, &surfaceMesh.indices[0]);
 
-	for (int c = 0; c < POINTSPERSIDE*POINTSPERSIDE; c++) {
-		heights[c] = (rand() % 12) - 6.0f;
+		glDisable(GL_COLOR_MATERIAL);
+		glDisable(GL_NORMALIZE);
+		glDisable(GL_LIGHT0);
+		glDisable(GL_LIGHTING);
 	}
+
+	glDisableClientState(GL_NORMAL_ARRAY);
+	glDisableClientState(GL_VERTEX_ARRAY);
 }
 
 
 void drawSurfaceControlPoints(void)
 {
+	PROFILE_ZONE("drawControlPoints");
+
+	Vector3 p;
+
 	glPointSize(4.0f);
 	glColor3f(0,0,1);
 	for (int z = 0; z < POINTSPERSIDE; z++) {
 		for (int x = 0; x < POINTSPERSIDE; x++) {
 			int index = z * POINTSPERSIDE + x;
+			toRenderSpace(p, Vector3d(	surfaceOrigin.x + (x-1)*PATCHSPACING,
+										surfaceOrigin.y + heights[index],
+										surfaceOrigin.z + (z-1)*PATCHSPACING));
 			glBegin(GL_POINTS);
-				glVertex3f(GLfloat(x*6-15-6), heights[index], GLfloat(z*6-15-6));
+				glVertex3fv(p.v);
 			glEnd();
 		}
 	}
 }
 
 
-void renderScene(void)
+//-------------------------------------------------------------------------------------------
+//	Lists the zones of the last profiler stat window, times are per frame in milliseconds
+//-------------------------------------------------------------------------------------------
+void drawProfilerStats(int y)
 {
+	PROFILE_ZONE("drawProfilerStats");
+
+	if (!Profiler::exists()) return;
+
+	font->print(10,y, "Zone                  avg ms   min ms   max ms  calls");
+	for (int z = 0; z < profiler.getNumZones(); z++) {
+		const ProfileZoneStats &zone = profiler.getZone(z);
+		y += 14;
+		font->print(10,y, "%-20s %7.3f  %7.3f  %7.3f  %5.0f", zone.name, zone.avgMs, zone.minMs,
+					zone.maxMs, zone.callsPerFrame);
+	}
+}
+
+
+void renderScene(float alpha)
+{
+	PROFILE_ZONE("renderScene");
+
 	// Perform a page flip immediately prior to doing all rendering for best performance
-	SwapBuffers(hDC);
+	{
+		PROFILE_ZONE("swapBuffers");
+		SwapBuffers(hDC);
+	}
 
 	// Clear the back buffer and depth buffer
 	glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
 	// handle keyboard input
 	if (kb.buttonPressed('1')) drawWireframe = !drawWireframe;
+	if (kb.buttonPressed('2')) cameraRelative = !cameraRelative;
+	if (kb.buttonPressed('3') && Profiler::exists()) profiler.writeChromeTrace("profile.json");
+	if (kb.buttonPressed('4')) timer.writeFrameTimesCSV("frametimes.csv");
+	if (kb.buttonPressed('5')) spinRequested = !spinRequested;
 
 	// handle mouse movement
 	mouse.updateMousePosition();
 
-	// reset the modelview matrix
-	glLoadIdentity();
-
-	// translate the view in the -z direction (straight back away from the screen)
-	// so we can see the scene
-	glTranslatef(0,0,-50);
-
 	// rotate the scene
+	// vertical mouse movement tilts about the screen x axis (applied last), horizontal movement
+	// turns about the world y axis (applied first), same as accumulating two Euler angles
 	if (mouse.leftButtonDown()) {
-		rotateX += mouse.getSensitiveDeltaY();
-		rotateY += mouse.getSensitiveDeltaX();
+		Quaternion tilt(Vector3(1,0,0), mouse.getSensitiveDeltaY() * DEGTORAD);
+		Quaternion turn(Vector3(0,1,0), mouse.getSensitiveDeltaX() * DEGTORAD);
+		viewOrientation.multiply(tilt, viewOrientation);
+		viewOrientation *= turn;
+		viewOrientation.normalize();
 	}
 
-	glRotatef(rotateX,1,0,0);
-	glRotatef(rotateY,0,1,0);
+	buildView(alpha);
+	glLoadMatrixf(viewMatrix.i);
 
 	// Draw the scene
 	drawSurfaceControlPoints();
@@ -167,6 +171,24 @@ void renderScene(void)
 	else
 		font->print(10,50, "<1> Render Mode FILL");
 
-	font->print(10,64, "<ENTER> Recalculate Points");
-	font->print(10,78, "<LEFT MOUSE BUTTON> Rotate Scene");
+	if (cameraRelative)
+		font->print(10,64, "<2> Camera Relative ON");
+	else
+		font->print(10,64, "<2> Camera Relative OFF");
+
+	font->print(10,78, "<ENTER> Recalculate Points");
+	font->print(10,92, "<3> Save Profile to profile.json");
+	font->print(10,106, "<4> Save Frame Times to frametimes.csv");
+	font->print(10,120, "<5> Spin Surface");
+	font->print(10,134, "<LEFT MOUSE BUTTON> Rotate Scene");
+
+	Vector3d eye(inverseViewMatrix.i[12], inverseViewMatrix.i[13], inverseViewMatrix.i[14]);
+	if (cameraRelative) eye += viewTarget;
+	font->print(10,148, "Camera %.2f %.2f %.2f", eye.x, eye.y, eye.z);
+
+	const FrameStats &stats = timer.getFrameStats();
+	font->print(10,176, "FPS %.1f  frame ms p50 %.2f p95 %.2f p99 %.2f max %.2f  hitches %d",
+				timer.getFPS(), stats.p50, stats.p95, stats.p99, stats.maxMs, timer.getHitchCount());
+
+	drawProfilerStats(204);
 }
@@ -14,7 +14,7 @@
 ---- FUNCTIONS ----
 -----------------*/
 
-void initSurfacePoints(void);
-void renderScene(void);
+// Draws the scene from SurfaceScene.h with OpenGL, called by the LoopScheduler
+void renderScene(float alpha);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,375 @@
+//	----==== HEIGHTFIELD.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Tiled binary heightfield file
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include "HeightField.h"
+#include "../UtilityCode/MsgAssert.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+//-----------------------------------------------------------------------------
+//	Gradient predictor, left + up - upper left, with only the neighbor inside
+//	the tile on the first row and column
+//-----------------------------------------------------------------------------
+static __inline int predictSample(const ushort *s, int x, int z, int size)
+{
+	if (x == 0 && z == 0) return 0;
+	if (z == 0) return s[x-1];
+	if (x == 0) return s[(z-1)*size];
+	return (int)s[z*size + x-1] + (int)s[(z-1)*size + x] - (int)s[(z-1)*size + x-1];
+}
+
+
+// residuals are zig-zag coded so small negative values stay small, then stored 7 bits per byte
+static int compressTile(const ushort *samples, int size, uchar *out)
+{
+	uchar *p = out;
+	for (int z = 0; z < size; z++) {
+		for (int x = 0; x < size; x++) {
+			int r = (int)samples[z*size + x] - predictSample(samples, x, z, size);
+			uint code = (r >= 0) ? ((uint)r << 1) : (((uint)(-r) << 1) - 1);
+			while (code >= 0x80) {
+				*p++ = (uchar)(code | 0x80);
+				code >>= 7;
+			}
+			*p++ = (uchar)code;
+		}
+	}
+	return (int)(p - out);
+}
+
+
+static bool decompressTile(const uchar *in, int bytes, int size, ushort *samples)
+{
+	const uchar *p = in, *end = in + bytes;
+	for (int z = 0; z < size; z++) {
+		for (int x = 0; x < size; x++) {
+			uint code = 0;
+			int shift = 0;
+			for (;;) {
+				if (p >= end || shift > 14) return false;
+				uchar b = *p++;
+				code |= (uint)(b & 0x7F) << shift;
+				shift += 7;
+				if (!(b & 0x80)) break;
+			}
+			int r = (code & 1) ? -(int)((code + 1) >> 1) : (int)(code >> 1);
+			samples[z*size + x] = (ushort)(predictSample(samples, x, z, size) + r);
+		}
+	}
+	return true;
+}
+
+
+////////// class HeightField //////////
+
+
+bool HeightField::open(const char *filename)
+{
+	close();
+	if (!file.open(filename)) return false;
+
+	const uchar *data = file.getData();
+	int64 size = file.getSize();
+	if (size < (int64)sizeof(HeightFieldHeader)) {
+		close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	bool valid = (header.magic == HF_MAGIC && header.version == HF_VERSION &&
+				  header.width > 0 && header.height > 0 &&
+				  header.tileSize > 0 && header.tileSize <= HF_MAXTILESIZE &&
+				  header.tilesX == (header.width + header.tileSize - 1) / header.tileSize &&
+				  header.tilesY == (header.height + header.tileSize - 1) / header.tileSize &&
+				  (header.format == HF_UINT16 || header.format == HF_FLOAT32) &&
+				  (header.compression == HF_UNCOMPRESSED ||
+				   (header.compression == HF_DELTA && header.format == HF_UINT16)));
+
+	int64 numTiles = (int64)header.tilesX * header.tilesY;
+	int64 indexEnd = sizeof(HeightFieldHeader) + numTiles * sizeof(HeightFieldTile);
+	if (!valid || indexEnd > size) {
+		close();
+		return false;
+	}
+	tiles = (const HeightFieldTile *)(data + sizeof(HeightFieldHeader));
+
+	int sampleBytes = (header.format == HF_UINT16) ? 2 : 4;
+	uint32 rawBytes = header.tileSize * header.tileSize * sampleBytes;
+	for (int64 t = 0; t < numTiles; t++) {
+		const HeightFieldTile &tile = tiles[t];
+		if (tile.offset < (uint64)indexEnd || tile.offset > (uint64)size || tile.bytes > (uint64)size - tile.offset ||
+			(header.compression == HF_UNCOMPRESSED && tile.bytes != rawBytes))
+		{
+			close();
+			return false;
+		}
+	}
+
+	heightScale = (header.maxHeight - header.minHeight) / 65535.0f;
+	return true;
+}
+
+
+void HeightField::close(void)
+{
+	file.close();
+	tiles = 0;
+	memset(&header, 0, sizeof(header));
+	sampleTile.clear();
+	sampleTileIndex = -1;
+}
+
+
+bool HeightField::readTile(int tx, int tz, float *out) const
+{
+	msgAssert(isOpen() && tx >= 0 && tz >= 0 && tx < getTilesX() && tz < getTilesZ(),
+			  "HeightField: tile out of range");
+
+	const HeightFieldTile &tile = getTileEntry(tx, tz);
+	const uchar *data = file.getData() + tile.offset;
+	int n = header.tileSize * header.tileSize;
+
+	if (header.format == HF_FLOAT32) {
+		memcpy(out, data, n * sizeof(float));
+		return true;
+	}
+
+	const ushort *samples = (const ushort *)data;
+	std::vector<ushort> decoded;
+	if (header.compression == HF_DELTA) {
+		decoded.resize(n);
+		if (!decompressTile(data, tile.bytes, header.tileSize, &decoded[0])) return false;
+		samples = &decoded[0];
+	}
+
+	for (int s = 0; s < n; s++) out[s] = header.minHeight + samples[s] * heightScale;
+	return true;
+}
+
+
+float HeightField::getSample(int x, int z)
+{
+	x = clampX(x);
+	z = clampZ(z);
+
+	int tx = x / header.tileSize, tz = z / header.tileSize;
+	int s = (z - tz * header.tileSize) * header.tileSize + (x - tx * header.tileSize);
+	const uchar *data = file.getData() + getTileEntry(tx, tz).offset;
+
+	if (header.compression == HF_UNCOMPRESSED) {
+		if (header.format == HF_FLOAT32) {
+			float h;
+			memcpy(&h, data + s * sizeof(float), sizeof(float));
+			return h;
+		}
+		ushort q;
+		memcpy(&q, data + s * sizeof(ushort), sizeof(ushort));
+		return header.minHeight + q * heightScale;
+	}
+
+	const float *tile = getSampleTile(tx, tz);
+	return tile ? tile[s] : header.minHeight;
+}
+
+
+const float * HeightField::getSampleTile(int tx, int tz)
+{
+	int index = tz * header.tilesX + tx;
+	if (index != sampleTileIndex) {
+		sampleTile.resize(header.tileSize * header.tileSize);
+		if (!readTile(tx, tz, &sampleTile[0])) {
+			sampleTileIndex = -1;
+			return 0;
+		}
+		sampleTileIndex = index;
+	}
+	return &sampleTile[0];
+}
+
+
+//-----------------------------------------------------------------------------
+//	Compressed tiles are decoded once each and their part of the block copied,
+//	sample by sample the decode buffer would swap between tiles along every row
+//	of a block that straddles them. The first and last tiles of each axis also
+//	fill the samples clamped to them from outside the field.
+//-----------------------------------------------------------------------------
+void HeightField::readRegion(float *out, int x0, int z0, int w, int h)
+{
+	if (w <= 0 || h <= 0) return;
+
+	if (header.compression == HF_UNCOMPRESSED) {
+		for (int z = 0; z < h; z++) {
+			for (int x = 0; x < w; x++) {
+				out[z*w + x] = getSample(x0 + x, z0 + z);
+			}
+		}
+		return;
+	}
+
+	const int ts = header.tileSize;
+	const int cx0 = clampX(x0), cx1 = clampX(x0 + w - 1);
+	const int cz0 = clampZ(z0), cz1 = clampZ(z0 + h - 1);
+
+	for (int tz = cz0 / ts; tz <= cz1 / ts; tz++) {
+		int zStart = (tz == cz0 / ts) ? 0 : tz * ts - z0;
+		int zEnd = (tz == cz1 / ts) ? h : (tz + 1) * ts - z0;
+
+		for (int tx = cx0 / ts; tx <= cx1 / ts; tx++) {
+			int xStart = (tx == cx0 / ts) ? 0 : tx * ts - x0;
+			int xEnd = (tx == cx1 / ts) ? w : (tx + 1) * ts - x0;
+			const float *tile = getSampleTile(tx, tz);
+
+			for (int z = zStart; z < zEnd; z++) {
+				const float *row = tile ? tile + (clampZ(z0 + z) - tz * ts) * ts : 0;
+				for (int x = xStart; x < xEnd; x++) {
+					out[z*w + x] = row ? row[clampX(x0 + x) - tx * ts] : header.minHeight;
+				}
+			}
+		}
+	}
+}
+
+
+void HeightField::prefetchTile(int tx, int tz) const
+{
+	const HeightFieldTile &tile = getTileEntry(tx, tz);
+	file.prefetch((int64)tile.offset, tile.bytes);
+}
+
+
+void HeightField::releaseTile(int tx, int tz) const
+{
+	const HeightFieldTile &tile = getTileEntry(tx, tz);
+	file.release((int64)tile.offset, tile.bytes);
+}
+
+
+//-----------------------------------------------------------------------------
+//	The index is written with zero entries first and again at the end, when
+//	the tile offsets are known. Only one tile of samples is held at a time.
+//-----------------------------------------------------------------------------
+bool HeightField::write(const char *filename, int width, int height, const HeightFieldDesc &desc,
+						HeightFieldSource source, void *param)
+{
+	if (width <= 0 || height <= 0 || desc.tileSize <= 0 || desc.tileSize > HF_MAXTILESIZE ||
+		(desc.format != HF_UINT16 && desc.format != HF_FLOAT32) ||
+		(desc.compression != HF_UNCOMPRESSED && desc.compression != HF_DELTA) ||
+		(desc.compression == HF_DELTA && desc.format != HF_UINT16))
+	{
+		return false;
+	}
+
+	HeightFieldHeader hdr;
+	memset(&hdr, 0, sizeof(hdr));
+	hdr.magic = HF_MAGIC;
+	hdr.version = HF_VERSION;
+	hdr.width = width;
+	hdr.height = height;
+	hdr.tileSize = desc.tileSize;
+	hdr.tilesX = (width + desc.tileSize - 1) / desc.tileSize;
+	hdr.tilesY = (height + desc.tileSize - 1) / desc.tileSize;
+	hdr.format = desc.format;
+	hdr.compression = desc.compression;
+	hdr.spacing = desc.spacing;
+	hdr.minHeight = desc.minHeight;
+	hdr.maxHeight = desc.maxHeight;
+
+	// the range is needed before the first 16 bit sample can be written
+	if (hdr.minHeight == hdr.maxHeight) {
+		hdr.minHeight = hdr.maxHeight = source(0, 0, param);
+		for (int z = 0; z < height; z++) {
+			for (int x = 0; x < width; x++) {
+				float h = source(x, z, param);
+				if (h < hdr.minHeight) hdr.minHeight = h;
+				if (h > hdr.maxHeight) hdr.maxHeight = h;
+			}
+		}
+		if (hdr.minHeight == hdr.maxHeight) hdr.maxHeight = hdr.minHeight + 1.0f;
+	}
+
+	FILE *f = fopen(filename, "wb");
+	if (!f) return false;
+
+	int numTiles = hdr.tilesX * hdr.tilesY;
+	std::vector<HeightFieldTile> index(numTiles);
+	memset(&index[0], 0, numTiles * sizeof(HeightFieldTile));
+
+	bool ok = (fwrite(&hdr, sizeof(hdr), 1, f) == 1 &&
+			   fwrite(&index[0], sizeof(HeightFieldTile), numTiles, f) == (size_t)numTiles);
+	uint64 offset = sizeof(hdr) + numTiles * sizeof(HeightFieldTile);
+
+	int n = desc.tileSize * desc.tileSize;
+	std::vector<float> samples(n);
+	std::vector<ushort> quantized(n);
+	std::vector<uchar> packed(n * 3);
+	static const uchar zeros[HF_PAGESIZE] = { 0 };
+	float invScale = 65535.0f / (hdr.maxHeight - hdr.minHeight);
+
+	for (int t = 0; ok && t < numTiles; t++) {
+		int x0 = (t % hdr.tilesX) * desc.tileSize;
+		int z0 = (t / hdr.tilesX) * desc.tileSize;
+
+		// the edge tiles repeat the last row and column
+		for (int z = 0; z < desc.tileSize; z++) {
+			int sz = (z0 + z < height) ? z0 + z : height - 1;
+			for (int x = 0; x < desc.tileSize; x++) {
+				int sx = (x0 + x < width) ? x0 + x : width - 1;
+				samples[z * desc.tileSize + x] = source(sx, sz, param);
+			}
+		}
+
+		const void *tileData = &samples[0];
+		uint32 bytes = n * sizeof(float);
+		if (desc.format == HF_UINT16) {
+			for (int s = 0; s < n; s++) {
+				float q = floorf((samples[s] - hdr.minHeight) * invScale + 0.5f);
+				quantized[s] = (ushort)((q < 0) ? 0 : (q > 65535.0f) ? 65535.0f : q);
+			}
+			tileData = &quantized[0];
+			bytes = n * sizeof(ushort);
+		}
+		if (desc.compression == HF_DELTA) {
+			bytes = compressTile(&quantized[0], desc.tileSize, &packed[0]);
+			tileData = &packed[0];
+		}
+
+		// uncompressed tiles are page aligned, so paging a tile does not touch its neighbors
+		if (desc.compression == HF_UNCOMPRESSED && offset % HF_PAGESIZE != 0) {
+			int pad = HF_PAGESIZE - (int)(offset % HF_PAGESIZE);
+			ok = (fwrite(zeros, 1, pad, f) == (size_t)pad);
+			offset += pad;
+		}
+
+		index[t].offset = offset;
+		index[t].bytes = bytes;
+		ok = ok && (fwrite(tileData, 1, bytes, f) == bytes);
+		offset += bytes;
+	}
+
+	ok = ok && (fseek(f, sizeof(hdr), SEEK_SET) == 0) &&
+		 (fwrite(&index[0], sizeof(HeightFieldTile), numTiles, f) == (size_t)numTiles);
+	ok = (fclose(f) == 0) && ok;
+
+	if (!ok) remove(filename);
+	return ok;
+}
+
+
+HeightField::HeightField() :
+	tiles(0), heightScale(0), sampleTileIndex(-1)
+{
+	memset(&header, 0, sizeof(header));
+}
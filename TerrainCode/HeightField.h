@@ -0,0 +1,169 @@
+//	----==== HEIGHTFIELD.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Tiled binary heightfield file, memory mapped for reading so a surface
+//					far larger than the memory can be sampled without loading it first.
+//					The file holds a header, an index with the offset and size of every
+//					tile, and the tiles of tileSize x tileSize samples in row order. Tiles
+//					on the right and bottom edges are padded with their last sample.
+//
+//					Samples are 16 bit, scaled between the minimum and maximum height, or
+//					32 bit floats. Uncompressed tiles start on a page boundary and are
+//					read straight from the mapping, so the system pages them in as they
+//					are touched and prefetchTile / releaseTile page whole tiles in or
+//					out. 16 bit tiles may be delta compressed instead: each sample is
+//					predicted from its left, upper and upper left neighbors and the
+//					difference is stored in 1 to 3 bytes, which suits smooth terrain.
+//					Compressed tiles are decoded into floats by readTile.
+//
+//					All values in the file are little endian.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef HEIGHTFIELD_H
+#define HEIGHTFIELD_H
+
+#include <vector>
+#include "../UtilityCode/MappedFile.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define HF_MAGIC			0x444C4648		// "HFLD"
+#define HF_VERSION			1
+#define HF_TILESIZE			256				// default samples on a side of a tile
+#define HF_MAXTILESIZE		4096			// larger tiles are refused
+#define HF_PAGESIZE			4096			// uncompressed tiles are aligned to this
+
+// sample formats
+#define HF_UINT16			1
+#define HF_FLOAT32			2
+
+// tile compression
+#define HF_UNCOMPRESSED		0
+#define HF_DELTA			1				// 16 bit samples only
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct HeightFieldHeader {
+	uint32		magic;
+	uint32		version;
+	uint32		width, height;			// samples
+	uint32		tileSize;
+	uint32		tilesX, tilesY;
+	uint32		format;
+	uint32		compression;
+	float		spacing;				// world distance between samples
+	float		minHeight, maxHeight;	// 16 bit samples are scaled between these
+	uint32		reserved[4];
+};
+
+
+struct HeightFieldTile {
+	uint64		offset;					// from the start of the file
+	uint32		bytes;
+	uint32		reserved;
+};
+
+
+// Options for writing a file
+struct HeightFieldDesc {
+	int			tileSize;
+	uint32		format;
+	uint32		compression;
+	float		spacing;
+	float		minHeight, maxHeight;	// for 16 bit samples, found from the samples when equal
+
+	HeightFieldDesc() : tileSize(HF_TILESIZE), format(HF_UINT16), compression(HF_UNCOMPRESSED),
+						spacing(1.0f), minHeight(0), maxHeight(0) {}
+};
+
+
+// Returns the height of sample x,z when writing a file
+typedef float (*HeightFieldSource)(int x, int z, void *param);
+
+
+class HeightField {
+	private:
+
+		///// Variables
+
+		MappedFile				file;
+		HeightFieldHeader		header;
+		const HeightFieldTile	*tiles;
+		float					heightScale;	// height of one 16 bit step
+
+		// the last compressed tile decoded by getSample
+		std::vector<float>		sampleTile;
+		int						sampleTileIndex;
+
+		///// Functions
+
+		const HeightFieldTile &	getTileEntry(int tx, int tz) const	{ return tiles[tz * header.tilesX + tx]; }
+		int						clampX(int x) const		{ return (x < 0) ? 0 : (x >= getWidth()) ? getWidth() - 1 : x; }
+		int						clampZ(int z) const		{ return (z < 0) ? 0 : (z >= getHeight()) ? getHeight() - 1 : z; }
+
+		// A compressed tile decoded into sampleTile, 0 if it could not be decoded
+		const float *			getSampleTile(int tx, int tz);
+
+		// Make copy constructor and assignment operator private
+		HeightField(const HeightField &h);
+		HeightField& operator=(const HeightField &h);
+
+	public:
+
+		///// Accessors
+
+		bool		isOpen(void) const			{ return file.isOpen(); }
+		int			getWidth(void) const		{ return (int)header.width; }
+		int			getHeight(void) const		{ return (int)header.height; }
+		int			getTileSize(void) const		{ return (int)header.tileSize; }
+		int			getTilesX(void) const		{ return (int)header.tilesX; }
+		int			getTilesZ(void) const		{ return (int)header.tilesY; }
+		float		getSpacing(void) const		{ return header.spacing; }
+		float		getMinHeight(void) const	{ return header.minHeight; }
+		float		getMaxHeight(void) const	{ return header.maxHeight; }
+		const HeightFieldHeader & getHeader(void) const	{ return header; }
+		int64		getFileSize(void) const		{ return file.getSize(); }
+		int			getTileBytes(int tx, int tz) const	{ return (int)getTileEntry(tx, tz).bytes; }
+
+		///// Functions
+
+		// Maps the file and checks the header and tile index
+		bool		open(const char *filename);
+		void		close(void);
+
+		// Decodes a whole tile, tileSize x tileSize floats
+		bool		readTile(int tx, int tz, float *out) const;
+
+		// One sample, coordinates outside the field are clamped to the edge. Not thread
+		// safe, compressed tiles are decoded into a buffer shared by all calls.
+		float		getSample(int x, int z);
+
+		// A w x h block of samples starting at x0,z0, clamped like getSample
+		void		readRegion(float *out, int x0, int z0, int w, int h);
+
+		// Paging hints for the tile's part of the file
+		void		prefetchTile(int tx, int tz) const;
+		void		releaseTile(int tx, int tz) const;
+
+		// Writes a width x height field, sampling the source one tile at a time
+		static bool	write(const char *filename, int width, int height, const HeightFieldDesc &desc,
+						  HeightFieldSource source, void *param);
+
+		// Constructors / Destructor
+		HeightField();
+		~HeightField() { close(); }
+};
+
+
+#endif
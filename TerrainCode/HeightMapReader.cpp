@@ -0,0 +1,232 @@
+//	----==== HEIGHTMAPREADER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Imports RAW16, PGM and PNG heightmaps
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <vector>
+#include <thread>
+#include "HeightMapReader.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define MINROWSPERTHREAD	64		// smaller maps are not worth splitting further
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+static void convertRows(const uchar *src, int width, int sampleBytes, int stride, bool bigEndian,
+						float mul, float offset, float *out, int row0, int row1)
+{
+	for (int y = row0; y < row1; y++) {
+		const uchar *s = src + (int64)y * width * stride;
+		float *d = out + (int64)y * width;
+
+		if (sampleBytes == 1) {
+			for (int x = 0; x < width; x++, s += stride) d[x] = offset + s[0] * mul;
+		} else if (bigEndian) {
+			for (int x = 0; x < width; x++, s += stride) d[x] = offset + ((s[0] << 8) | s[1]) * mul;
+		} else {
+			for (int x = 0; x < width; x++, s += stride) d[x] = offset + ((s[1] << 8) | s[0]) * mul;
+		}
+	}
+}
+
+
+static bool endsWith(const char *name, const char *ext)
+{
+	size_t n = strlen(name), e = strlen(ext);
+	if (n < e) return false;
+	for (size_t c = 0; c < e; c++) {
+		char a = name[n - e + c];
+		if (a >= 'A' && a <= 'Z') a = a - 'A' + 'a';
+		if (a != ext[c]) return false;
+	}
+	return true;
+}
+
+
+////////// class HeightMapReader //////////
+
+
+int HeightMapReader::getFormatFromName(const char *filename)
+{
+	if (endsWith(filename, ".raw") || endsWith(filename, ".r16")) return HMAP_RAW16;
+	if (endsWith(filename, ".pgm")) return HMAP_PGM;
+	if (endsWith(filename, ".png")) return HMAP_PNG;
+	return HMAP_UNKNOWN;
+}
+
+
+//-----------------------------------------------------------------------------
+//	"P5", width, height and maxval separated by white space or comments, then
+//	one white space character before the samples
+//-----------------------------------------------------------------------------
+bool HeightMapReader::openPGM(void)
+{
+	const uchar *p = file.getData(), *end = p + file.getSize();
+	if (end - p < 2 || p[0] != 'P' || p[1] != '5') return false;
+	p += 2;
+
+	int values[3];
+	for (int v = 0; v < 3; v++) {
+		for (;;) {
+			if (p >= end) return false;
+			if (*p == '#') {
+				while (p < end && *p != '\n') p++;
+			} else if (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') {
+				p++;
+			} else {
+				break;
+			}
+		}
+		if (*p < '0' || *p > '9') return false;
+		int64 n = 0;
+		while (p < end && *p >= '0' && *p <= '9' && n < 0x7FFFFFFF) n = n * 10 + (*p++ - '0');
+		if (n <= 0 || n >= 0x7FFFFFFF) return false;
+		values[v] = (int)n;
+	}
+	if (p >= end || values[2] > 65535) return false;
+	p++;
+
+	width = values[0];
+	height = values[1];
+	sampleBytes = (values[2] > 255) ? 2 : 1;
+	sampleStride = sampleBytes;
+	bigEndian = true;
+	widen = 65535.0f / values[2];
+	samples = p;
+
+	return (end - p) >= (int64)width * height * sampleBytes;
+}
+
+
+bool HeightMapReader::open(const char *filename, int rawWidth, int rawHeight, bool rawBigEndian)
+{
+	close();
+
+	format = getFormatFromName(filename);
+	if (format == HMAP_UNKNOWN || !file.open(filename)) {
+		close();
+		return false;
+	}
+
+	bool ok = false;
+	switch (format) {
+		case HMAP_RAW16: {
+			int64 count = file.getSize() / 2;
+			if (rawWidth <= 0 || rawHeight <= 0) {
+				rawWidth = rawHeight = (int)floor(sqrt((double)count) + 0.5);
+			}
+			width = rawWidth;
+			height = rawHeight;
+			samples = file.getData();
+			sampleBytes = sampleStride = 2;
+			bigEndian = rawBigEndian;
+			widen = 1.0f;
+			ok = ((int64)width * height == count);
+			break;
+		}
+		case HMAP_PGM:
+			ok = openPGM();
+			break;
+
+		// the header is enough for now, the image is decoded by read
+		case HMAP_PNG:
+			ok = readPNG(file.getData(), file.getSize(), png, true);
+			width = png.width;
+			height = png.height;
+			break;
+	}
+
+	if (!ok) close();
+	return ok;
+}
+
+
+void HeightMapReader::close(void)
+{
+	file.close();
+	png.pixels.clear();
+	format = HMAP_UNKNOWN;
+	width = height = 0;
+	samples = 0;
+}
+
+
+bool HeightMapReader::read(float *out, float scale, float offset, int numThreads)
+{
+	if (!isOpen()) return false;
+
+	if (format == HMAP_PNG) {
+		if (!readPNG(file.getData(), file.getSize(), png)) return false;
+		samples = &png.pixels[0];
+		sampleBytes = png.bitDepth / 8;
+		sampleStride = png.channels * sampleBytes;
+		bigEndian = true;
+		widen = (sampleBytes == 1) ? 257.0f : 1.0f;
+	}
+
+	if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads > height / MINROWSPERTHREAD) numThreads = height / MINROWSPERTHREAD;
+	if (numThreads < 1) numThreads = 1;
+
+	float mul = widen * scale;
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numThreads; t++) {
+		threads.push_back(std::thread(convertRows, samples, width, sampleBytes, sampleStride, bigEndian,
+									  mul, offset, out, (int)((int64)height * t / numThreads),
+									  (int)((int64)height * (t + 1) / numThreads)));
+	}
+	convertRows(samples, width, sampleBytes, sampleStride, bigEndian, mul, offset, out, 0, height / numThreads);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+	// the decoded image is not needed again
+	if (format == HMAP_PNG) {
+		std::vector<uchar>().swap(png.pixels);
+		samples = 0;
+	}
+	return true;
+}
+
+
+bool HeightMapReader::write(const char *filename, const ushort *samples, int w, int h)
+{
+	int format = getFormatFromName(filename);
+	if (format == HMAP_UNKNOWN || w <= 0 || h <= 0) return false;
+
+	// RAW is little endian, PGM and PNG big endian
+	std::vector<uchar> bytes((size_t)w * h * 2);
+	for (size_t s = 0; s < (size_t)w * h; s++) {
+		uchar hi = (uchar)(samples[s] >> 8), lo = (uchar)samples[s];
+		bytes[s*2]   = (format == HMAP_RAW16) ? lo : hi;
+		bytes[s*2+1] = (format == HMAP_RAW16) ? hi : lo;
+	}
+
+	if (format == HMAP_PNG) return writePNG(filename, w, h, 16, PNG_GRAY, &bytes[0]);
+
+	FILE *f = fopen(filename, "wb");
+	if (!f) return false;
+	bool ok = true;
+	if (format == HMAP_PGM) ok = (fprintf(f, "P5\n%d %d\n65535\n", w, h) > 0);
+	ok = ok && (fwrite(&bytes[0], 1, bytes.size(), f) == bytes.size());
+	return (fclose(f) == 0) && ok;
+}
+
+
+HeightMapReader::HeightMapReader() :
+	format(HMAP_UNKNOWN), width(0), height(0), samples(0), sampleBytes(2), sampleStride(2),
+	bigEndian(false), widen(1.0f)
+{}
@@ -0,0 +1,101 @@
+//	----==== HEIGHTMAPREADER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Imports heightmaps saved by terrain tools as images: headerless 16 bit
+//					RAW, binary PGM (P5) with 8 or 16 bit samples, and 8 or 16 bit PNG.
+//					The file is memory mapped; RAW and PGM samples are converted straight
+//					from the mapping, PNG is inflated and unfiltered first. Only the first
+//					channel of a color PNG is used.
+//
+//					Every sample is first widened to 16 bits, so 0 to 65535 covers the
+//					same heights whatever the format, then mapped to
+//					height = offset + sample * scale and written to the caller's storage.
+//					The conversion is split into row chunks over several threads.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef HEIGHTMAPREADER_H
+#define HEIGHTMAPREADER_H
+
+#include "../UtilityCode/MappedFile.h"
+#include "../UtilityCode/PNGFile.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+// formats
+#define HMAP_UNKNOWN		0
+#define HMAP_RAW16			1
+#define HMAP_PGM			2
+#define HMAP_PNG			3
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class HeightMapReader {
+	private:
+
+		///// Variables
+
+		MappedFile		file;
+		int				format;
+		int				width, height;
+
+		// where the samples are, for RAW and PGM in the mapping, for PNG in the image
+		PNGImage		png;
+		const uchar		*samples;
+		int				sampleBytes;		// 1 or 2
+		int				sampleStride;		// bytes from one sample to the next
+		bool			bigEndian;
+		float			widen;				// to 16 bits
+
+		///// Functions
+
+		bool			openPGM(void);
+
+		// Make copy constructor and assignment operator private
+		HeightMapReader(const HeightMapReader &r);
+		HeightMapReader& operator=(const HeightMapReader &r);
+
+	public:
+
+		///// Accessors
+
+		int				getFormat(void) const	{ return format; }
+		int				getWidth(void) const	{ return width; }
+		int				getHeight(void) const	{ return height; }
+		int64			getFileSize(void) const	{ return file.getSize(); }
+		bool			isOpen(void) const		{ return file.isOpen(); }
+
+		///// Functions
+
+		// Picks the format from the extension, .raw / .r16, .pgm or .png. RAW files have no
+		// header, so rawWidth x rawHeight must be given unless the map is square. RAW samples
+		// are little endian unless rawBigEndian is set.
+		bool			open(const char *filename, int rawWidth = 0, int rawHeight = 0,
+							 bool rawBigEndian = false);
+		void			close(void);
+
+		// Writes width * height heights, numThreads 0 uses one thread per hardware thread
+		bool			read(float *out, float scale, float offset, int numThreads = 0);
+
+		static int		getFormatFromName(const char *filename);
+
+		// Writes 16 bit samples of the format given by the extension, for tests
+		static bool		write(const char *filename, const ushort *samples, int w, int h);
+
+		// Constructors / Destructor
+		HeightMapReader();
+		~HeightMapReader() { close(); }
+};
+
+
+#endif
@@ -0,0 +1,624 @@
+//	----==== SCATTEREDFIT.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Least squares fitting of a B-spline control grid to scattered points
+//	--------------------------------------------------------------------------------
+
+
+#include <cmath>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "ScatteredFit.h"
+#include "SplineFit.h"
+#include "../MathCode/Spline.h"
+#include "../UtilityCode/HiResTimer.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define FIT_BAND				7					// neighbors a side in a row of the normal equations
+#define FIT_BANDSIZE			(FIT_BAND*FIT_BAND)
+#define FIT_CENTER				(FIT_BANDSIZE/2)	// the diagonal
+#define FIT_ROWSPERTHREAD		16					// grids with fewer control rows are not split further
+#define FIT_SUMS				3					// partial sums returned by a solver kernel
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// A point bucketed by patch, u,v from 0 to 1 across the patch
+struct FitPoint {
+	float		u, v, y;
+};
+
+
+// One grid of the hierarchy and its normal equations
+struct FitLevel {
+	FitGrid					grid;
+	std::vector<FitPoint>	points;			// in patch order
+	std::vector<int>		patchStart;		// first point of each patch, one more entry at the end
+	std::vector<float>		band;			// FIT_BANDSIZE per control, neighbor dx,dz at (dz+3)*7 + dx+3
+	std::vector<float>		rhs;
+	std::vector<float>		invDiagonal;
+	double					smoothing;		// weight of the second differences
+
+	int		getPatchesX(void) const		{ return grid.width - 3; }
+	int		getPatchesZ(void) const		{ return grid.height - 3; }
+};
+
+
+// Vectors of the conjugate gradient solve, shared by the kernels
+struct FitSolver {
+	const FitLevel	*level;
+	float			*x, *r, *z, *p, *ap;
+	float			alpha, beta;
+};
+
+typedef void (*FitKernel)(FitSolver &s, int row0, int row1, double *sums);
+
+
+//-----------------------------------------------------------------------------
+//	Threads kept for the whole fit, every conjugate gradient iteration runs four
+//	kernels and starting threads for each would cost more than the kernels on
+//	the small grids. run splits the rows of the grid over the calling thread
+//	and the workers and waits for all of them.
+//-----------------------------------------------------------------------------
+class FitThreadPool {
+	private:
+
+		///// Variables
+
+		std::vector<std::thread>	workers;
+		std::mutex				poolLock;
+		std::condition_variable	poolSignal, doneSignal;
+		int						generation;			// incremented for each run
+		int						workersBusy;
+		bool					workersQuit;
+
+		// the kernel of the current run
+		FitKernel				kernel;
+		FitSolver				*solver;
+		int						activeThreads;		// the calling thread and workers 1 to activeThreads - 1
+		std::vector<double>		partial;			// FIT_SUMS per thread
+
+		///// Functions
+
+		void					runRows(int t);
+		void					workerMain(int index);
+
+		// Make copy constructor and assignment operator private
+		FitThreadPool(const FitThreadPool &p);
+		FitThreadPool& operator=(const FitThreadPool &p);
+
+	public:
+
+		///// Accessors
+
+		int						getNumThreads(void) const { return (int)workers.size() + 1; }
+
+		///// Functions
+
+		// Runs kernel over all rows on up to numThreads threads and adds up their sums
+		void					run(FitKernel kernel, FitSolver &s, int numThreads, double *sums);
+
+		// Constructors / Destructor
+		explicit FitThreadPool(int numThreads);
+		~FitThreadPool();
+};
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+// Patch under gx,gz in knots from knot 1 and the offset into it, gx,gz must be over the grid
+static __inline void locatePatch(const FitGrid &grid, float gx, float gz, int &px, int &pz, float &u, float &v)
+{
+	px = (int)gx;
+	pz = (int)gz;
+	if (px > grid.width - 4) px = grid.width - 4;
+	if (pz > grid.height - 4) pz = grid.height - 4;
+	u = gx - px;
+	v = gz - pz;
+}
+
+
+// Same for a position, false when it is not over the grid
+static __inline bool findPatch(const FitGrid &grid, float x, float z, int &px, int &pz, float &u, float &v)
+{
+	float gx = (x - grid.originX) / grid.spacing;
+	float gz = (z - grid.originZ) / grid.spacing;
+	if (!(gx >= 0 && gz >= 0 && gx <= grid.width - 3 && gz <= grid.height - 3)) return false;
+
+	locatePatch(grid, gx, gz, px, pz, u, v);
+	return true;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Counting sort of every step'th point by patch. Returns the number of those
+//	points that are not over the grid.
+//-----------------------------------------------------------------------------
+static int bucketPoints(FitLevel &level, const Vector3 *points, int numPoints, int step)
+{
+	int numPatches = level.getPatchesX() * level.getPatchesZ();
+	std::vector<int> patchOf((numPoints + step - 1) / step);
+	level.patchStart.assign(numPatches + 1, 0);
+	int outside = 0;
+
+	for (int p = 0, n = 0; p < numPoints; p += step, n++) {
+		int px, pz;
+		float u, v;
+		if (findPatch(level.grid, points[p].x, points[p].z, px, pz, u, v)) {
+			patchOf[n] = pz * level.getPatchesX() + px;
+			level.patchStart[patchOf[n] + 1]++;
+		} else {
+			patchOf[n] = -1;
+			outside++;
+		}
+	}
+	for (int c = 0; c < numPatches; c++) level.patchStart[c+1] += level.patchStart[c];
+
+	level.points.resize(level.patchStart[numPatches]);
+	std::vector<int> next(level.patchStart.begin(), level.patchStart.end() - 1);
+	for (int p = 0, n = 0; p < numPoints; p += step, n++) {
+		if (patchOf[n] < 0) continue;
+		int px, pz;
+		FitPoint &fp = level.points[next[patchOf[n]]++];
+		findPatch(level.grid, points[p].x, points[p].z, px, pz, fp.u, fp.v);
+		fp.y = points[p].y;
+	}
+	return outside;
+}
+
+
+// Adds weight * a_i * a_j for every tap j of a difference term that has a tap at x,z
+static void addTerm(double *row, int x, int z, const int *tapX, const int *tapZ, const double *coef,
+					int taps, double weight)
+{
+	double ai = 0;
+	for (int t = 0; t < taps; t++) {
+		if (tapX[t] == x && tapZ[t] == z) ai = coef[t];
+	}
+	if (ai == 0) return;
+
+	for (int t = 0; t < taps; t++) {
+		row[(tapZ[t] - z + 3) * FIT_BAND + tapX[t] - x + 3] += weight * ai * coef[t];
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//	Builds the rows of controls row0 to row1. Each control gathers the points of
+//	the 4 x 4 patches it is part of, and the smoothing terms it is a tap of.
+//-----------------------------------------------------------------------------
+static void assembleRows(FitLevel &level, int row0, int row1)
+{
+	const int w = level.grid.width, h = level.grid.height;
+	const int patchesX = level.getPatchesX(), patchesZ = level.getPatchesZ();
+	const double lambda = level.smoothing;
+
+	static const double second[3] = { 1.0, -2.0, 1.0 };
+	static const double cross[4] = { 1.0, -1.0, -1.0, 1.0 };
+
+	for (int z = row0; z < row1; z++) {
+		for (int x = 0; x < w; x++) {
+			double row[FIT_BANDSIZE] = { 0 };
+			double b = 0;
+
+			for (int pz = (z < 3) ? 0 : z - 3; pz <= z && pz < patchesZ; pz++) {
+				int bz = z - pz;
+				for (int px = (x < 3) ? 0 : x - 3; px <= x && px < patchesX; px++) {
+					int bx = x - px;
+					double *base = row + (pz - z + 3) * FIT_BAND + (px - x + 3);
+
+					int patch = pz * patchesX + px;
+					for (int p = level.patchStart[patch]; p < level.patchStart[patch+1]; p++) {
+						const FitPoint &fp = level.points[p];
+						float wu[4], wv[4];
+						CubicBSpline::calcBasis(fp.u, wu);
+						CubicBSpline::calcBasis(fp.v, wv);
+
+						float wi = wu[bx] * wv[bz];
+						b += wi * fp.y;
+						for (int jz = 0; jz < 4; jz++) {
+							float wz = wi * wv[jz];
+							double *r = base + jz * FIT_BAND;
+							r[0] += wz * wu[0];
+							r[1] += wz * wu[1];
+							r[2] += wz * wu[2];
+							r[3] += wz * wu[3];
+						}
+					}
+				}
+			}
+
+			// second differences along x and z, and the cross difference counted twice
+			for (int c = x - 1; c <= x + 1; c++) {
+				if (c < 1 || c > w - 2) continue;
+				int tapX[3] = { c - 1, c, c + 1 }, tapZ[3] = { z, z, z };
+				addTerm(row, x, z, tapX, tapZ, second, 3, lambda);
+			}
+			for (int c = z - 1; c <= z + 1; c++) {
+				if (c < 1 || c > h - 2) continue;
+				int tapX[3] = { x, x, x }, tapZ[3] = { c - 1, c, c + 1 };
+				addTerm(row, x, z, tapX, tapZ, second, 3, lambda);
+			}
+			for (int sz = z - 1; sz <= z; sz++) {
+				for (int sx = x - 1; sx <= x; sx++) {
+					if (sx < 0 || sz < 0 || sx > w - 2 || sz > h - 2) continue;
+					int tapX[4] = { sx, sx + 1, sx, sx + 1 }, tapZ[4] = { sz, sz, sz + 1, sz + 1 };
+					addTerm(row, x, z, tapX, tapZ, cross, 4, 2.0 * lambda);
+				}
+			}
+
+			size_t i = (size_t)z * w + x;
+			float *out = &level.band[i * FIT_BANDSIZE];
+			for (int k = 0; k < FIT_BANDSIZE; k++) out[k] = (float)row[k];
+			level.rhs[i] = (float)b;
+			level.invDiagonal[i] = (row[FIT_CENTER] > 0) ? (float)(1.0 / row[FIT_CENTER]) : 0.0f;
+		}
+	}
+}
+
+
+static __inline float multiplyRow(const FitLevel &level, const float *v, int x, int z)
+{
+	const int w = level.grid.width, h = level.grid.height;
+	const size_t i = (size_t)z * w + x;
+	const float *band = &level.band[i * FIT_BANDSIZE];
+
+	int dx0 = (x < 3) ? -x : -3, dx1 = (x + 3 >= w) ? w - 1 - x : 3;
+	int dz0 = (z < 3) ? -z : -3, dz1 = (z + 3 >= h) ? h - 1 - z : 3;
+
+	float sum = 0;
+	for (int dz = dz0; dz <= dz1; dz++) {
+		const float *b = band + (dz + 3) * FIT_BAND + 3;
+		const float *s = v + (int64)i + dz * w;
+		for (int dx = dx0; dx <= dx1; dx++) sum += b[dx] * s[dx];
+	}
+	return sum;
+}
+
+
+// r = b - Ax, z = M^-1 r, p = z. Sums r.z, r.r and b.b.
+static void initKernel(FitSolver &s, int row0, int row1, double *sums)
+{
+	const FitLevel &level = *s.level;
+	const int w = level.grid.width;
+
+	for (int z = row0; z < row1; z++) {
+		for (int x = 0; x < w; x++) {
+			size_t i = (size_t)z * w + x;
+			float b = level.rhs[i];
+			s.r[i] = b - multiplyRow(level, s.x, x, z);
+			s.z[i] = s.r[i] * level.invDiagonal[i];
+			s.p[i] = s.z[i];
+			sums[0] += (double)s.r[i] * s.z[i];
+			sums[1] += (double)s.r[i] * s.r[i];
+			sums[2] += (double)b * b;
+		}
+	}
+}
+
+
+// ap = Ap, sums p.ap
+static void multiplyKernel(FitSolver &s, int row0, int row1, double *sums)
+{
+	const FitLevel &level = *s.level;
+	const int w = level.grid.width;
+
+	for (int z = row0; z < row1; z++) {
+		for (int x = 0; x < w; x++) {
+			size_t i = (size_t)z * w + x;
+			s.ap[i] = multiplyRow(level, s.p, x, z);
+			sums[0] += (double)s.p[i] * s.ap[i];
+		}
+	}
+}
+
+
+// x += alpha p, r -= alpha ap, z = M^-1 r. Sums r.z and r.r.
+static void updateKernel(FitSolver &s, int row0, int row1, double *sums)
+{
+	const FitLevel &level = *s.level;
+	const float alpha = s.alpha;
+
+	for (size_t i = (size_t)row0 * level.grid.width; i < (size_t)row1 * level.grid.width; i++) {
+		s.x[i] += alpha * s.p[i];
+		s.r[i] -= alpha * s.ap[i];
+		s.z[i] = s.r[i] * level.invDiagonal[i];
+		sums[0] += (double)s.r[i] * s.z[i];
+		sums[1] += (double)s.r[i] * s.r[i];
+	}
+}
+
+
+// p = z + beta p
+static void directionKernel(FitSolver &s, int row0, int row1, double *sums)
+{
+	const float beta = s.beta;
+	for (size_t i = (size_t)row0 * s.level->grid.width; i < (size_t)row1 * s.level->grid.width; i++) {
+		s.p[i] = s.z[i] + beta * s.p[i];
+	}
+}
+
+
+////////// class FitThreadPool //////////
+
+
+void FitThreadPool::runRows(int t)
+{
+	const int rows = solver->level->grid.height;
+	kernel(*solver, (int)((int64)rows * t / activeThreads), (int)((int64)rows * (t + 1) / activeThreads),
+		   &partial[t * FIT_SUMS]);
+}
+
+
+void FitThreadPool::run(FitKernel _kernel, FitSolver &s, int numThreads, double *sums)
+{
+	// a worker may still be waking from the last run, so the run is only changed under the lock
+	{
+		std::lock_guard<std::mutex> lock(poolLock);
+		kernel = _kernel;
+		solver = &s;
+		activeThreads = (numThreads < getNumThreads()) ? numThreads : getNumThreads();
+		if (activeThreads < 1) activeThreads = 1;
+		partial.assign(activeThreads * FIT_SUMS, 0.0);
+
+		if (activeThreads > 1) {
+			workersBusy = activeThreads - 1;
+			generation++;
+		}
+	}
+	if (activeThreads > 1) poolSignal.notify_all();
+
+	runRows(0);
+
+	if (activeThreads > 1) {
+		std::unique_lock<std::mutex> lock(poolLock);
+		doneSignal.wait(lock, [this] { return workersBusy == 0; });
+	}
+
+	for (int k = 0; k < FIT_SUMS; k++) {
+		sums[k] = 0;
+		for (int t = 0; t < activeThreads; t++) sums[k] += partial[t * FIT_SUMS + k];
+	}
+}
+
+
+// Worker index runs the rows of thread index + 1, or sits the run out when fewer are active
+void FitThreadPool::workerMain(int index)
+{
+	std::unique_lock<std::mutex> lock(poolLock);
+	int seen = 0;
+
+	for (;;) {
+		poolSignal.wait(lock, [this, seen] { return generation != seen || workersQuit; });
+		if (workersQuit) break;
+		seen = generation;
+		if (index + 1 >= activeThreads) continue;
+
+		lock.unlock();
+		runRows(index + 1);
+		lock.lock();
+
+		if (--workersBusy == 0) doneSignal.notify_all();
+	}
+}
+
+
+FitThreadPool::FitThreadPool(int numThreads) :
+	generation(0), workersBusy(0), workersQuit(false), kernel(0), solver(0), activeThreads(1)
+{
+	for (int w = 0; w < numThreads - 1; w++) {
+		workers.push_back(std::thread(&FitThreadPool::workerMain, this, w));
+	}
+}
+
+
+FitThreadPool::~FitThreadPool()
+{
+	{
+		std::lock_guard<std::mutex> lock(poolLock);
+		workersQuit = true;
+	}
+	poolSignal.notify_all();
+
+	for (size_t w = 0; w < workers.size(); w++) workers[w].join();
+}
+
+
+//-----------------------------------------------------------------------------
+//	Preconditioned conjugate gradients from the controls already in x. Returns
+//	the iterations and the final relative residual.
+//-----------------------------------------------------------------------------
+static int solveLevel(const FitLevel &level, float *x, FitThreadPool &pool, int numThreads, float &residual)
+{
+	size_t n = level.grid.getNumControls();
+	std::vector<float> r(n), z(n), p(n), ap(n);
+
+	FitSolver s;
+	s.level = &level;
+	s.x = x;
+	s.r = &r[0];
+	s.z = &z[0];
+	s.p = &p[0];
+	s.ap = &ap[0];
+	s.alpha = s.beta = 0;
+
+	double sums[FIT_SUMS];
+	pool.run(initKernel, s, numThreads, sums);
+	double rz = sums[0], rr = sums[1], bb = sums[2];
+	double limit = (double)FIT_TOLERANCE * FIT_TOLERANCE * bb;
+
+	int iteration = 0;
+	while (iteration < FIT_MAXITERATIONS && rr > limit) {
+		pool.run(multiplyKernel, s, numThreads, sums);
+		if (sums[0] <= 0) break;
+		s.alpha = (float)(rz / sums[0]);
+
+		pool.run(updateKernel, s, numThreads, sums);
+		rr = sums[1];
+		iteration++;
+		if (rr <= limit) break;
+
+		s.beta = (float)(sums[0] / rz);
+		rz = sums[0];
+		pool.run(directionKernel, s, numThreads, sums);
+	}
+
+	residual = (bb > 0) ? (float)sqrt(rr / bb) : 0.0f;
+	return iteration;
+}
+
+
+////////// class ScatteredFit //////////
+
+
+bool ScatteredFit::fit(const Vector3 *points, int numPoints, const FitGrid &grid,
+					   std::vector<float> &controls, FitStats &stats, float smoothing, int numThreads)
+{
+	stats.levels = stats.iterations = stats.totalIterations = 0;
+	stats.pointsOutside = numPoints;
+	stats.residual = 0;
+	stats.assembleSeconds = stats.solveSeconds = 0;
+	if (grid.width < 4 || grid.height < 4 || grid.spacing <= 0 || numPoints <= 0) return false;
+
+	if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads < 1) numThreads = 1;
+
+	// grids from fine to coarse, halved while the size allows
+	std::vector<FitGrid> grids(1, grid);
+	for (;;) {
+		const FitGrid &g = grids.back();
+		if ((g.width - 3) % 2 != 0 || (g.height - 3) % 2 != 0 ||
+			(g.width + 3) / 2 < FIT_COARSESIZE || (g.height + 3) / 2 < FIT_COARSESIZE)
+		{
+			break;
+		}
+		FitGrid coarse = g;
+		coarse.width = (g.width + 3) / 2;
+		coarse.height = (g.height + 3) / 2;
+		coarse.spacing = g.spacing * 2.0f;
+		grids.push_back(coarse);
+	}
+
+	// the solver threads are started once for every level
+	int poolThreads = grids[0].height / FIT_ROWSPERTHREAD;
+	FitThreadPool pool((numThreads < poolThreads) ? numThreads : poolThreads);
+
+	std::vector<float> x, refined;
+	for (int l = (int)grids.size() - 1; l >= 0; l--) {
+		FitLevel level;
+		level.grid = grids[l];
+		int numControls = level.grid.getNumControls();
+
+		int64 start = getTicks();
+		int step = 1;
+		if (l > 0 && numPoints > FIT_COARSEPOINTS * numControls) step = numPoints / (FIT_COARSEPOINTS * numControls);
+		int outside = bucketPoints(level, points, numPoints, step);
+		int used = (int)level.points.size();
+		if (used == 0) return false;
+		if (l == 0) stats.pointsOutside = outside;
+
+		// the data term of a control grows with the points per control, the smoothing with it
+		level.smoothing = (double)smoothing * used / numControls;
+		level.band.resize((size_t)numControls * FIT_BANDSIZE);
+		level.rhs.resize(numControls);
+		level.invDiagonal.resize(numControls);
+
+		int threads = numThreads;
+		if (threads > level.grid.height / FIT_ROWSPERTHREAD) threads = level.grid.height / FIT_ROWSPERTHREAD;
+		if (threads < 1) threads = 1;
+
+		std::vector<std::thread> workers;
+		for (int t = 1; t < threads; t++) {
+			workers.push_back(std::thread(assembleRows, std::ref(level),
+										  (int)((int64)level.grid.height * t / threads),
+										  (int)((int64)level.grid.height * (t + 1) / threads)));
+		}
+		assembleRows(level, 0, level.grid.height / threads);
+		for (size_t t = 0; t < workers.size(); t++) workers[t].join();
+		std::vector<FitPoint>().swap(level.points);
+		stats.assembleSeconds += ticksToSeconds(getTicks() - start);
+
+		// the coarsest grid starts flat at the mean height, the others from the coarser solution
+		start = getTicks();
+		if (x.empty()) {
+			double mean = 0;
+			for (int p = 0; p < numPoints; p += step) mean += points[p].y;
+			x.assign(numControls, (float)(mean / ((numPoints + step - 1) / step)));
+		} else {
+			refined.resize(numControls);
+			SplineFit::refine(&x[0], grids[l+1].width, grids[l+1].height, &refined[0]);
+			x.swap(refined);
+		}
+
+		float residual;
+		int iterations = solveLevel(level, &x[0], pool, threads, residual);
+		stats.solveSeconds += ticksToSeconds(getTicks() - start);
+		stats.levels++;
+		stats.totalIterations += iterations;
+		if (l == 0) {
+			stats.iterations = iterations;
+			stats.residual = residual;
+		}
+	}
+
+	controls.swap(x);
+	return true;
+}
+
+
+float ScatteredFit::calcHeight(const float *controls, const FitGrid &grid, float x, float z)
+{
+	float gx = (x - grid.originX) / grid.spacing;
+	float gz = (z - grid.originZ) / grid.spacing;
+	gx = (gx < 0) ? 0 : (gx > grid.width - 3) ? (float)(grid.width - 3) : gx;
+	gz = (gz < 0) ? 0 : (gz > grid.height - 3) ? (float)(grid.height - 3) : gz;
+
+	int px, pz;
+	float u, v, wu[4], wv[4];
+	locatePatch(grid, gx, gz, px, pz, u, v);
+	CubicBSpline::calcBasis(u, wu);
+	CubicBSpline::calcBasis(v, wv);
+
+	float height = 0;
+	for (int r = 0; r < 4; r++) {
+		const float *c = controls + (size_t)(pz + r) * grid.width + px;
+		height += wv[r] * (wu[0] * c[0] + wu[1] * c[1] + wu[2] * c[2] + wu[3] * c[3]);
+	}
+	return height;
+}
+
+
+void ScatteredFit::calcError(const float *controls, const FitGrid &grid, const Vector3 *points,
+							 int numPoints, float &rms, float &maxError)
+{
+	double sum = 0;
+	int count = 0;
+	maxError = 0;
+
+	for (int p = 0; p < numPoints; p++) {
+		int px, pz;
+		float u, v;
+		if (!findPatch(grid, points[p].x, points[p].z, px, pz, u, v)) continue;
+
+		float error = fabsf(calcHeight(controls, grid, points[p].x, points[p].z) - points[p].y);
+		sum += (double)error * error;
+		if (error > maxError) maxError = error;
+		count++;
+	}
+	rms = (count > 0) ? (float)sqrt(sum / count) : 0.0f;
+}
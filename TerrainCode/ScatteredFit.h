@@ -0,0 +1,92 @@
+//	----==== SCATTEREDFIT.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A wrapper class for functions to fit a CubicBSpline control grid to
+//					scattered points, such as survey data. The control heights minimize
+//					the squared height error at the points plus a smoothing term, the
+//					squared second differences of the controls along x, z and across, so
+//					controls with no points nearby are still well defined.
+//
+//					The grid covers its knots 1 to width - 2, the part the scene draws,
+//					with knot 1 at the origin. Every point touches the 4 x 4 controls of
+//					its patch, so the normal equations are a band of 7 x 7 neighbors per
+//					control. The points are bucketed by patch first, then each control
+//					gathers its row from the 4 x 4 patches around it, so the rows are
+//					assembled on several threads without sharing any writes.
+//
+//					The system is solved by conjugate gradients with a Jacobi
+//					preconditioner, from coarse to fine: the grid is halved while its
+//					size allows, the coarsest grid is solved from a flat start and each
+//					solution is refined by knot insertion (SplineFit::refine) to start
+//					the next finer grid, which leaves only its fine detail for the
+//					iterations to find. The coarser grids are fitted to an even subset
+//					of the points. The smoothing weight is scaled by the points per
+//					control, so it means the same for sparse and dense data.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef SCATTEREDFIT_H
+#define SCATTEREDFIT_H
+
+#include <vector>
+#include "../MathCode/Vector3.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define FIT_SMOOTHING		0.01f		// default smoothing weight
+#define FIT_TOLERANCE		1.0e-5f		// residual of the normal equations relative to the right side
+#define FIT_MAXITERATIONS	400			// per grid
+#define FIT_COARSESIZE		16			// the grid is not halved below this many controls a side
+#define FIT_COARSEPOINTS	16			// points per control used on the coarser grids
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// Placement of the control grid, points are x,z positions with the height in y
+struct FitGrid {
+	int			width, height;			// controls
+	float		originX, originZ;		// position of knot 1,1
+	float		spacing;				// between knots
+
+	int			getNumControls(void) const	{ return width * height; }
+};
+
+
+struct FitStats {
+	int			levels;					// grids solved, coarse to fine
+	int			iterations;				// on the finest grid
+	int			totalIterations;
+	int			pointsOutside;			// points not over the grid, ignored
+	float		residual;				// relative residual of the finest solve
+	double		assembleSeconds;
+	double		solveSeconds;
+};
+
+
+class ScatteredFit {
+	public:
+
+		// Fits grid.width x grid.height control heights to the points. numThreads 0 uses
+		// one thread per hardware thread. Returns false if no point is over the grid.
+		static bool		fit(const Vector3 *points, int numPoints, const FitGrid &grid,
+							std::vector<float> &controls, FitStats &stats,
+							float smoothing = FIT_SMOOTHING, int numThreads = 0);
+
+		// Height of the fitted surface at x,z, clamped to the grid
+		static float	calcHeight(const float *controls, const FitGrid &grid, float x, float z);
+
+		// Root mean square and largest height error at the points over the grid
+		static void		calcError(const float *controls, const FitGrid &grid, const Vector3 *points,
+								  int numPoints, float &rms, float &maxError);
+};
+
+
+#endif
@@ -0,0 +1,435 @@
+//	----==== SPLINEFIT.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Fitting of B-spline control heights to samples
+//	--------------------------------------------------------------------------------
+
+
+#include <cmath>
+#include <vector>
+#include <thread>
+#include <functional>
+#include "SplineFit.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define FIT_COLUMNALIGN		16		// floats in a cache line, column ranges start on one
+#define FIT_EDGESMOOTHING	1.0		// weight of the edge curvature when coarsening
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// Thomas algorithm factors for a line of n knots. The forward pass is
+// x[i] = scale[i] * s[i] - carry[i] * x[i-1], the back pass x[i] -= back[i] * x[i+1].
+struct TridiagonalFactors {
+	std::vector<float>	scale, carry, back;
+
+	void	build(int n);
+};
+
+
+// Least squares inverse of refine along a line of n coarse controls. weights are
+// the refine weights of the 5 fine controls 2j - 3 to 2j + 1 of coarse control j,
+// the rest is the Cholesky factorization of the band R'R plus the edge term,
+// L[i][i] = 1 / inv[i], L[i][i-1] = l1[i], L[i][i-2] = l2[i].
+struct ProjectionFactors {
+	std::vector<float>	weights, inv, l1, l2;
+
+	void	build(int n);
+};
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+//-----------------------------------------------------------------------------
+//	Rows of the system are (1 4 1) / 6, the first and last (4 2) / 6 and
+//	(2 4) / 6 from the mirrored edge. Factored in double, it is only done once
+//	per grid.
+//-----------------------------------------------------------------------------
+void TridiagonalFactors::build(int n)
+{
+	scale.resize(n);
+	carry.resize(n);
+	back.resize(n);
+
+	double prevBack = 0;
+	for (int i = 0; i < n; i++) {
+		double sub = (i == 0) ? 0.0 : (i == n - 1) ? 2.0 : 1.0;
+		double super = (i == n - 1) ? 0.0 : (i == 0) ? 2.0 : 1.0;
+		double m = 1.0 / (4.0 - sub * prevBack);
+		if (n == 1) m = 1.0 / 6.0;		// the mirrored neighbors are the knot itself
+
+		scale[i] = (float)(6.0 * m);
+		carry[i] = (float)(sub * m);
+		back[i] = (float)(super * m);
+		prevBack = super * m;
+	}
+}
+
+
+// Weight of coarse control j in fine control f of a refined line
+static double getRefineWeight(int f, int j)
+{
+	int x = (f + 1) / 2;
+	if ((f & 1) == 0) return (j == x || j == x + 1) ? 0.5 : 0.0;
+	return (j == x) ? 6.0/8.0 : (j == x - 1 || j == x + 1) ? 1.0/8.0 : 0.0;
+}
+
+
+// The second difference of the three controls at either edge
+static double getEdgeWeight(int i, int n)
+{
+	static const double diff[3] = { 1.0, -2.0, 1.0 };
+	if (n < 4) return 0.0;
+	return (i < 3) ? diff[i] : (i >= n - 3) ? diff[n - 1 - i] : 0.0;
+}
+
+
+void ProjectionFactors::build(int n)
+{
+	int fineSize = SplineFit::getRefinedSize(n);
+
+	weights.assign((size_t)n * 5, 0.0f);
+	for (int j = 0; j < n; j++) {
+		for (int k = 0; k < 5; k++) {
+			int f = 2*j - 3 + k;
+			if (f >= 0 && f < fineSize) weights[j*5 + k] = (float)getRefineWeight(f, j);
+		}
+	}
+
+	// a fine control only touches 3 neighboring coarse ones, so R'R is a band of 2
+	inv.resize(n);
+	l1.resize(n);
+	l2.resize(n);
+	std::vector<double> d(n), a(n, 0.0), b(n, 0.0);
+	for (int i = 0; i < n; i++) {
+		double m[3] = { 0, 0, 0 };		// R'R at i,i then i,i-1 and i,i-2
+		for (int f = (2*i - 3 > 0 ? 2*i - 3 : 0); f <= 2*i + 1 && f < fineSize; f++) {
+			for (int k = 0; k < 3 && k <= i; k++) m[k] += getRefineWeight(f, i) * getRefineWeight(f, i - k);
+		}
+		for (int k = 0; k < 3 && k <= i; k++) {
+			m[k] += FIT_EDGESMOOTHING * getEdgeWeight(i, n) * getEdgeWeight(i - k, n);
+		}
+		b[i] = (i >= 2) ? m[2] / d[i-2] : 0.0;
+		a[i] = (i >= 1) ? (m[1] - b[i] * a[i-1]) / d[i-1] : 0.0;
+		d[i] = sqrt(m[0] - a[i] * a[i] - b[i] * b[i]);
+
+		inv[i] = (float)(1.0 / d[i]);
+		l1[i] = (float)a[i];
+		l2[i] = (float)b[i];
+	}
+}
+
+
+static void solveRows(const float *samples, float *controls, int width,
+					  const TridiagonalFactors &f, int row0, int row1)
+{
+	for (int z = row0; z < row1; z++) {
+		const float *s = samples + (size_t)z * width;
+		float *c = controls + (size_t)z * width;
+
+		float prev = 0;
+		for (int x = 0; x < width; x++) {
+			prev = f.scale[x] * s[x] - f.carry[x] * prev;
+			c[x] = prev;
+		}
+		for (int x = width - 2; x >= 0; x--) c[x] -= f.back[x] * c[x+1];
+	}
+}
+
+
+// each step works on a whole row of the x range, the inner loops vectorize
+static void solveColumns(float *controls, int width, int height, const TridiagonalFactors &f,
+						 int x0, int x1)
+{
+	float *row = controls + x0;
+	int n = x1 - x0;
+
+	for (int x = 0; x < n; x++) row[x] *= f.scale[0];
+	for (int z = 1; z < height; z++) {
+		float *prev = row;
+		row += width;
+		const float scale = f.scale[z], carry = f.carry[z];
+		for (int x = 0; x < n; x++) row[x] = scale * row[x] - carry * prev[x];
+	}
+
+	for (int z = height - 2; z >= 0; z--) {
+		float *next = row;
+		row -= width;
+		const float back = f.back[z];
+		for (int x = 0; x < n; x++) row[x] -= back * next[x];
+	}
+}
+
+
+// Rows are split between threads, FIT_MINROWSPERTHREAD at least each
+static int getRowThreads(int numThreads, int height)
+{
+	if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads > height / FIT_MINROWSPERTHREAD) numThreads = height / FIT_MINROWSPERTHREAD;
+	return (numThreads < 1) ? 1 : numThreads;
+}
+
+
+// x ranges for the column passes, starting on cache lines so threads never share one
+static void splitColumns(int width, int numThreads, std::vector<int> &split)
+{
+	if (numThreads > width / FIT_COLUMNALIGN) numThreads = width / FIT_COLUMNALIGN;
+	if (numThreads < 1) numThreads = 1;
+
+	split.resize(numThreads + 1);
+	for (int t = 0; t <= numThreads; t++) {
+		split[t] = (t == numThreads) ? width :
+				   (int)((int64)width * t / numThreads) / FIT_COLUMNALIGN * FIT_COLUMNALIGN;
+	}
+}
+
+
+// R' of every fine row of rows row0 to row1, then solved by R'R in place
+static void projectRows(const float *fine, float *out, int fineWidth, int width,
+						const ProjectionFactors &f, int row0, int row1)
+{
+	for (int z = row0; z < row1; z++) {
+		const float *s = fine + (size_t)z * fineWidth;
+		float *c = out + (size_t)z * width;
+
+		for (int j = 0; j < width; j++) {
+			const float *w = &f.weights[j*5];
+			float sum = 0;
+			for (int k = 0; k < 5; k++) {
+				int x = 2*j - 3 + k;
+				if (x >= 0 && x < fineWidth) sum += w[k] * s[x];
+			}
+			c[j] = sum;
+		}
+
+		for (int x = 0; x < width; x++) {
+			float y = c[x];
+			if (x >= 1) y -= f.l1[x] * c[x-1];
+			if (x >= 2) y -= f.l2[x] * c[x-2];
+			c[x] = y * f.inv[x];
+		}
+		for (int x = width - 1; x >= 0; x--) {
+			float y = c[x];
+			if (x + 1 < width) y -= f.l1[x+1] * c[x+1];
+			if (x + 2 < width) y -= f.l2[x+2] * c[x+2];
+			c[x] = y * f.inv[x];
+		}
+	}
+}
+
+
+// The same down the columns of the x range, a whole row of it at a time
+static void projectColumns(const float *rows, float *coarse, int width, int fineHeight, int height,
+						   const ProjectionFactors &f, int x0, int x1)
+{
+	int n = x1 - x0;
+	for (int j = 0; j < height; j++) {
+		float *c = coarse + (size_t)j * width + x0;
+		for (int x = 0; x < n; x++) c[x] = 0;
+		for (int k = 0; k < 5; k++) {
+			int z = 2*j - 3 + k;
+			const float w = f.weights[j*5 + k];
+			if (z < 0 || z >= fineHeight || w == 0) continue;
+			const float *r = rows + (size_t)z * width + x0;
+			for (int x = 0; x < n; x++) c[x] += w * r[x];
+		}
+	}
+
+	for (int j = 0; j < height; j++) {
+		float *c = coarse + (size_t)j * width + x0;
+		const float inv = f.inv[j];
+		if (j >= 1) {
+			const float *p = c - width, l = f.l1[j];
+			for (int x = 0; x < n; x++) c[x] -= l * p[x];
+		}
+		if (j >= 2) {
+			const float *p = c - 2 * width, l = f.l2[j];
+			for (int x = 0; x < n; x++) c[x] -= l * p[x];
+		}
+		for (int x = 0; x < n; x++) c[x] *= inv;
+	}
+	for (int j = height - 1; j >= 0; j--) {
+		float *c = coarse + (size_t)j * width + x0;
+		const float inv = f.inv[j];
+		if (j + 1 < height) {
+			const float *p = c + width, l = f.l1[j+1];
+			for (int x = 0; x < n; x++) c[x] -= l * p[x];
+		}
+		if (j + 2 < height) {
+			const float *p = c + 2 * width, l = f.l2[j+2];
+			for (int x = 0; x < n; x++) c[x] -= l * p[x];
+		}
+		for (int x = 0; x < n; x++) c[x] *= inv;
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//	Solves every row of in into out, then every column of out in place. Rows
+//	are split between threads, the x ranges of the column pass start on cache
+//	lines so threads never share one.
+//-----------------------------------------------------------------------------
+static void solveSeparable(const float *in, float *out, int width, int height,
+						   const TridiagonalFactors &rowFactors, const TridiagonalFactors &columnFactors,
+						   int numThreads)
+{
+	numThreads = getRowThreads(numThreads, height);
+
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numThreads; t++) {
+		threads.push_back(std::thread(solveRows, in, out, width, std::cref(rowFactors),
+									  (int)((int64)height * t / numThreads),
+									  (int)((int64)height * (t + 1) / numThreads)));
+	}
+	solveRows(in, out, width, rowFactors, 0, height / numThreads);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+	threads.clear();
+
+	std::vector<int> split;
+	splitColumns(width, numThreads, split);
+	for (int t = 1; t + 1 < (int)split.size(); t++) {
+		threads.push_back(std::thread(solveColumns, out, width, height, std::cref(columnFactors),
+									  split[t], split[t+1]));
+	}
+	solveColumns(out, width, height, columnFactors, split[0], split[1]);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
+
+
+////////// class SplineFit //////////
+
+
+// the knot rows (1 4 1) / 6, mirrored at the edges
+void SplineFit::interpolate(const float *samples, float *controls, int width, int height, int numThreads)
+{
+	if (width <= 0 || height <= 0) return;
+
+	TridiagonalFactors rowFactors, columnFactors;
+	rowFactors.build(width);
+	columnFactors.build(height);
+
+	solveSeparable(samples, controls, width, height, rowFactors, columnFactors, numThreads);
+}
+
+
+float SplineFit::calcMaxError(const float *samples, const float *controls, int width, int height)
+{
+	float maxError = 0;
+
+	for (int z = 0; z < height; z++) {
+		int rows[3] = { z - 1, z, z + 1 };
+		if (rows[0] < 0) rows[0] = (height > 1) ? 1 : 0;
+		if (rows[2] >= height) rows[2] = (height > 1) ? height - 2 : 0;
+
+		for (int x = 0; x < width; x++) {
+			int cols[3] = { x - 1, x, x + 1 };
+			if (cols[0] < 0) cols[0] = (width > 1) ? 1 : 0;
+			if (cols[2] >= width) cols[2] = (width > 1) ? width - 2 : 0;
+
+			// the tensor product of the (1 4 1) / 6 knot weights
+			static const float weight[3] = { 1.0f/6.0f, 4.0f/6.0f, 1.0f/6.0f };
+			float h = 0;
+			for (int r = 0; r < 3; r++) {
+				const float *c = controls + (size_t)rows[r] * width;
+				h += weight[r] * (weight[0] * c[cols[0]] + weight[1] * c[cols[1]] + weight[2] * c[cols[2]]);
+			}
+
+			float error = fabsf(h - samples[(size_t)z * width + x]);
+			if (error > maxError) maxError = error;
+		}
+	}
+	return maxError;
+}
+
+
+//-----------------------------------------------------------------------------
+//	The cubic B-spline subdivision masks: a control point becomes
+//	(1 6 1) / 8 of itself and its neighbors, and a new one goes midway between
+//	each pair. Rows first into a buffer, then columns.
+//-----------------------------------------------------------------------------
+void SplineFit::refine(const float *coarse, int width, int height, float *fine)
+{
+	if (width < 3 || height < 3) return;
+	int fineWidth = getRefinedSize(width);
+
+	std::vector<float> rows((size_t)fineWidth * height);
+	for (int z = 0; z < height; z++) {
+		const float *c = coarse + (size_t)z * width;
+		float *r = &rows[(size_t)z * fineWidth];
+		for (int x = 0; x < width - 1; x++) {
+			if (x > 0) r[2*x - 1] = (c[x-1] + 6.0f * c[x] + c[x+1]) * 0.125f;
+			r[2*x] = (c[x] + c[x+1]) * 0.5f;
+		}
+	}
+
+	for (int z = 0; z < height - 1; z++) {
+		const float *r0 = &rows[(size_t)z * fineWidth];
+		const float *r1 = r0 + fineWidth;
+		float *mid = fine + (size_t)(2*z) * fineWidth;
+		for (int x = 0; x < fineWidth; x++) mid[x] = (r0[x] + r1[x]) * 0.5f;
+
+		if (z > 0) {
+			const float *rm = r0 - fineWidth;
+			float *even = fine + (size_t)(2*z - 1) * fineWidth;
+			for (int x = 0; x < fineWidth; x++) even[x] = (rm[x] + 6.0f * r0[x] + r1[x]) * 0.125f;
+		}
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//	The coarse controls whose refinement is nearest the fine controls in the
+//	least squares sense, c = (R'R)^-1 R' f for the refine matrix R. R is
+//	separable, so this is done along the rows of the fine grid into a buffer
+//	of fine height, then down its columns. The coarse edge controls lie a fine
+//	knot outside the grid, and any exact inverse about doubles their noise on
+//	every application, so the second difference of the three controls at each
+//	edge is also kept small, by FIT_EDGESMOOTHING. A grid refined from a
+//	coarser one that is straight across its edges gives that grid back.
+//-----------------------------------------------------------------------------
+void SplineFit::coarsen(const float *fine, int fineWidth, int fineHeight, float *coarse, int numThreads)
+{
+	int width = getCoarsenedSize(fineWidth), height = getCoarsenedSize(fineHeight);
+	if (width < 3 || height < 3 || getRefinedSize(width) != fineWidth || getRefinedSize(height) != fineHeight) {
+		return;
+	}
+
+	ProjectionFactors rowFactors, columnFactors;
+	rowFactors.build(width);
+	columnFactors.build(height);
+
+	std::vector<float> rows((size_t)width * fineHeight);
+	numThreads = getRowThreads(numThreads, fineHeight);
+
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numThreads; t++) {
+		threads.push_back(std::thread(projectRows, fine, &rows[0], fineWidth, width, std::cref(rowFactors),
+									  (int)((int64)fineHeight * t / numThreads),
+									  (int)((int64)fineHeight * (t + 1) / numThreads)));
+	}
+	projectRows(fine, &rows[0], fineWidth, width, rowFactors, 0, fineHeight / numThreads);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+	threads.clear();
+
+	std::vector<int> split;
+	splitColumns(width, numThreads, split);
+	for (int t = 1; t + 1 < (int)split.size(); t++) {
+		threads.push_back(std::thread(projectColumns, &rows[0], coarse, width, fineHeight, height,
+									  std::cref(columnFactors), split[t], split[t+1]));
+	}
+	projectColumns(&rows[0], coarse, width, fineHeight, height, columnFactors, split[0], split[1]);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+}
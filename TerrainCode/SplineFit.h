@@ -0,0 +1,72 @@
+//	----==== SPLINEFIT.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A wrapper class for functions to fit CubicBSpline control heights to a
+//					grid of samples. The surface of a uniform cubic B-spline only passes
+//					through (c[i-1] + 4c[i] + c[i+1]) / 6 at knot i, so samples used
+//					directly as control heights are smoothed out. interpolate solves for
+//					the control heights whose surface passes through every sample.
+//
+//					The 2D fit is separable: the tridiagonal system above is solved along
+//					every row, then along every column of the result. The grid is
+//					mirrored at its edges (c[-1] = c[1]), which keeps the system
+//					tridiagonal and the control grid the size of the sample grid. The
+//					system is the same for every line of the same length, so it is
+//					factored once and each line costs two passes of a multiply and add
+//					per sample. Rows are split between threads, the columns are solved a
+//					whole row of columns at a time so memory is read in order, with the x
+//					range split between threads.
+//
+//					refine halves the knot spacing by knot insertion. The finer control
+//					grid gives exactly the same surface over the knots the coarse grid
+//					covers, knots 1 to width - 2 of a grid as drawn by the scene.
+//					coarsen goes the other way, to the coarse controls whose refinement
+//					is nearest the fine ones by least squares, with the same threading,
+//					and keeps the coarse edge controls from growing level after level.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef SPLINEFIT_H
+#define SPLINEFIT_H
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define FIT_MINROWSPERTHREAD	64		// smaller grids are not worth splitting further
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class SplineFit {
+	public:
+
+		// Control heights for a width x height grid of samples in rows. controls may be the
+		// same storage as samples. numThreads 0 uses one thread per hardware thread.
+		static void		interpolate(const float *samples, float *controls, int width, int height,
+									int numThreads = 0);
+
+		// Largest difference between a sample and the surface of the control heights at
+		// its knot, with the grid mirrored at the edges as by interpolate
+		static float	calcMaxError(const float *samples, const float *controls, int width, int height);
+
+		// Inserts a knot midway between every pair of knots. fine gets (2 * width - 3) x
+		// (2 * height - 3) control heights, coarse knot k is fine knot 2k - 1.
+		static void		refine(const float *coarse, int width, int height, float *fine);
+		static int		getRefinedSize(int size)	{ return 2 * size - 3; }
+
+		// The least squares inverse of refine, width - 3 and height - 3 of the fine grid must
+		// be even. A grid refined from a coarser one with straight edges gives that grid back.
+		static void		coarsen(const float *fine, int fineWidth, int fineHeight, float *coarse,
+								int numThreads = 0);
+		static int		getCoarsenedSize(int size)	{ return (size + 3) / 2; }
+};
+
+
+#endif
@@ -0,0 +1,232 @@
+//	----==== SPLINEHIERARCHY.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Coarse B-spline control grid with levels of refined detail
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <cmath>
+#include "SplineHierarchy.h"
+#include "SplineFit.h"
+#include "../MathCode/Spline.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class SplineHierarchy //////////
+
+
+bool SplineHierarchy::build(const float *controls, int width, int height, int minSize, int numThreads)
+{
+	clear();
+	if (width < 4 || height < 4) return false;
+
+	// sizes from fine to coarse
+	std::vector<int> w(1, width), h(1, height);
+	while ((w.back() - 3) % 2 == 0 && (h.back() - 3) % 2 == 0 &&
+		   SplineFit::getCoarsenedSize(w.back()) >= minSize && SplineFit::getCoarsenedSize(h.back()) >= minSize &&
+		   SplineFit::getCoarsenedSize(w.back()) >= 4 && SplineFit::getCoarsenedSize(h.back()) >= 4)
+	{
+		w.push_back(SplineFit::getCoarsenedSize(w.back()));
+		h.push_back(SplineFit::getCoarsenedSize(h.back()));
+	}
+	int numLevels = (int)w.size();
+
+	// the full grid of every level, fine to coarse
+	std::vector< std::vector<float> > full(numLevels);
+	full[0].assign(controls, controls + (size_t)width * height);
+	for (int l = 1; l < numLevels; l++) {
+		full[l].resize((size_t)w[l] * h[l]);
+		SplineFit::coarsen(&full[l-1][0], w[l-1], h[l-1], &full[l][0], numThreads);
+	}
+
+	// levels run coarse to fine, each keeps what refining the level above misses
+	levels.resize(numLevels);
+	widths.resize(numLevels);
+	heights.resize(numLevels);
+	std::vector<float> refined;
+	for (int f = 0; f < numLevels; f++) {
+		int l = numLevels - 1 - f;
+		widths[l] = w[f];
+		heights[l] = h[f];
+		levels[l].swap(full[f]);
+
+		if (l > 0) {
+			refined.resize(levels[l].size());
+			SplineFit::refine(&full[f+1][0], w[f+1], h[f+1], &refined[0]);
+			float *detail = &levels[l][0];
+			for (size_t c = 0; c < refined.size(); c++) detail[c] -= refined[c];
+		}
+	}
+	return true;
+}
+
+
+void SplineHierarchy::clear(void)
+{
+	levels.clear();
+	widths.clear();
+	heights.clear();
+}
+
+
+void SplineHierarchy::reconstruct(int level, std::vector<float> &controls) const
+{
+	controls = levels[0];
+	std::vector<float> refined;
+	for (int l = 1; l <= level; l++) {
+		refined.resize(levels[l].size());
+		SplineFit::refine(&controls[0], widths[l-1], heights[l-1], &refined[0]);
+		const float *detail = &levels[l][0];
+		for (size_t c = 0; c < refined.size(); c++) refined[c] += detail[c];
+		controls.swap(refined);
+	}
+}
+
+
+float SplineHierarchy::getHeight(float x, float z, int maxLevel) const
+{
+	int top = (maxLevel < 0 || maxLevel >= getNumLevels()) ? getNumLevels() - 1 : maxLevel;
+	int finest = getNumLevels() - 1;
+
+	// knot 1 of every level is at the same place, knot k of a level is knot 2k - 1 of the
+	// next, so the position in knots of a level from its knot 1 halves going up
+	float gx = x, gz = z;
+	for (int l = finest; l > top; l--) {
+		gx *= 0.5f;
+		gz *= 0.5f;
+	}
+
+	float height = 0.0f;
+	for (int l = top; l >= 0; l--) {
+		int w = widths[l], h = heights[l];
+
+		// patch px uses controls px to px + 3 and covers knots px + 1 to px + 2
+		float cx = gx < 0.0f ? 0.0f : (gx > (float)(w - 3) ? (float)(w - 3) : gx);
+		float cz = gz < 0.0f ? 0.0f : (gz > (float)(h - 3) ? (float)(h - 3) : gz);
+		int px = (int)cx, pz = (int)cz;
+		if (px > w - 4) px = w - 4;
+		if (pz > h - 4) pz = h - 4;
+
+		float wx[4], wz[4];
+		CubicBSpline::calcBasis(cx - (float)px, wx);
+		CubicBSpline::calcBasis(cz - (float)pz, wz);
+
+		const float *c = &levels[l][(size_t)pz * w + px];
+		for (int r = 0; r < 4; r++, c += w) {
+			height += wz[r] * (wx[0]*c[0] + wx[1]*c[1] + wx[2]*c[2] + wx[3]*c[3]);
+		}
+
+		gx *= 0.5f;
+		gz *= 0.5f;
+	}
+	return height;
+}
+
+
+void SplineHierarchy::calcLevelStats(int level, float &rms, float &maxAbs) const
+{
+	const std::vector<float> &c = levels[level];
+	double sum = 0.0;
+	maxAbs = 0.0f;
+	for (size_t i = 0; i < c.size(); i++) {
+		sum += (double)c[i] * c[i];
+		float a = fabsf(c[i]);
+		if (a > maxAbs) maxAbs = a;
+	}
+	rms = c.empty() ? 0.0f : (float)sqrt(sum / (double)c.size());
+}
+
+
+bool SplineHierarchy::save(const char *filename) const
+{
+	if (levels.empty()) return false;
+
+	FILE *file = fopen(filename, "wb");
+	if (!file) return false;
+
+	SplineHierarchyHeader header;
+	memset(&header, 0, sizeof(header));
+	header.magic = HIER_MAGIC;
+	header.version = HIER_VERSION;
+	header.levels = (uint32)levels.size();
+	header.width = (uint32)widths[0];
+	header.height = (uint32)heights[0];
+
+	bool ok = fwrite(&header, sizeof(header), 1, file) == 1;
+	for (size_t l = 0; ok && l < levels.size(); l++) {
+		ok = fwrite(&levels[l][0], sizeof(float), levels[l].size(), file) == levels[l].size();
+	}
+	ok = (fclose(file) == 0) && ok;
+	return ok;
+}
+
+
+bool SplineHierarchy::load(const char *filename, int maxLevels)
+{
+	clear();
+
+	FILE *file = fopen(filename, "rb");
+	if (!file) return false;
+
+	SplineHierarchyHeader header;
+	if (fread(&header, sizeof(header), 1, file) != 1 ||
+		header.magic != HIER_MAGIC || header.version != HIER_VERSION ||
+		header.levels == 0 || header.levels > HIER_MAXLEVELS || header.width < 4 || header.height < 4)
+	{
+		fclose(file);
+		return false;
+	}
+
+	int numLevels = (int)header.levels;
+	if (maxLevels > 0 && maxLevels < numLevels) numLevels = maxLevels;
+
+	// the sizes are not trusted until every level to read fits in an int a side and the file
+	// holds them
+	int64 w64 = header.width, h64 = header.height, levelBytes = 0;
+	for (int l = 0; l < numLevels; l++) {
+		if (w64 > INT_MAX || h64 > INT_MAX) {
+			fclose(file);
+			return false;
+		}
+		levelBytes += w64 * h64 * (int64)sizeof(float);
+		w64 = 2 * w64 - 3;
+		h64 = 2 * h64 - 3;
+	}
+	long fileBytes = (fseek(file, 0, SEEK_END) == 0) ? ftell(file) : -1;
+	if (fileBytes < 0 || (int64)fileBytes - (int64)sizeof(header) < levelBytes ||
+		fseek(file, sizeof(header), SEEK_SET) != 0)
+	{
+		fclose(file);
+		return false;
+	}
+
+	levels.resize(numLevels);
+	widths.resize(numLevels);
+	heights.resize(numLevels);
+
+	// the levels are stored coarse to fine, reading stops after the ones asked for
+	bool ok = true;
+	int w = (int)header.width, h = (int)header.height;
+	for (int l = 0; ok && l < numLevels; l++) {
+		widths[l] = w;
+		heights[l] = h;
+		levels[l].resize((size_t)w * h);
+		ok = fread(&levels[l][0], sizeof(float), levels[l].size(), file) == levels[l].size();
+		if (l + 1 < numLevels) {
+			w = SplineFit::getRefinedSize(w);
+			h = SplineFit::getRefinedSize(h);
+		}
+	}
+	fclose(file);
+
+	if (!ok) clear();
+	return ok;
+}
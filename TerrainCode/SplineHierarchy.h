@@ -0,0 +1,105 @@
+//	----==== SPLINEHIERARCHY.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Hierarchical CubicBSpline surface. Level 0 is a coarse control grid,
+//					each finer level halves the knot spacing and stores only the detail
+//					that refining the level above by knot insertion does not give:
+//
+//						controls(l) = SplineFit::refine(controls(l-1)) + detail(l)
+//
+//					Refinement is exact, so the surface of a level is the sum of the
+//					surfaces of the coarse grid and the details up to it, and a query can
+//					stop at any level for a cheaper, smoother answer. build splits a
+//					control grid into levels with SplineFit::coarsen, the least squares
+//					coarser grid, so each detail level holds only what the coarser
+//					spacing cannot show. On terrain the detail of the finer levels is
+//					small.
+//
+//					The file holds the levels coarse to fine, so loading can stop after
+//					any number of them and the surface is still whole.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef SPLINEHIERARCHY_H
+#define SPLINEHIERARCHY_H
+
+#include <vector>
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define HIER_MAGIC			0x52454948		// "HIER"
+#define HIER_VERSION		1
+#define HIER_MINSIZE		16				// the coarsest grid is not halved below this many controls a side
+#define HIER_MAXLEVELS		16				// levels a file may hold
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct SplineHierarchyHeader {
+	uint32		magic;
+	uint32		version;
+	uint32		levels;
+	uint32		width, height;			// controls of level 0
+	uint32		reserved[3];
+};
+
+
+class SplineHierarchy {
+	private:
+
+		///// Variables
+
+		std::vector< std::vector<float> >	levels;		// controls of level 0, then the details
+		std::vector<int>	widths, heights;
+
+		// Make copy constructor and assignment operator private
+		SplineHierarchy(const SplineHierarchy &h);
+		SplineHierarchy& operator=(const SplineHierarchy &h);
+
+	public:
+
+		///// Accessors
+
+		int					getNumLevels(void) const		{ return (int)levels.size(); }
+		int					getWidth(int level) const		{ return widths[level]; }
+		int					getHeight(int level) const		{ return heights[level]; }
+		const float *		getLevel(int level) const		{ return &levels[level][0]; }
+
+		///// Functions
+
+		// Splits a width x height control grid into levels, halving while width - 3 and
+		// height - 3 are even and the coarser grid keeps minSize controls a side
+		bool				build(const float *controls, int width, int height, int minSize = HIER_MINSIZE,
+								  int numThreads = 0);
+		void				clear(void);
+
+		// The full control grid of a level, the sum of level 0 and the details up to it
+		void				reconstruct(int level, std::vector<float> &controls) const;
+
+		// Height at x,z in knots of the finest level from its knot 1, summed over the levels up
+		// to maxLevel, -1 for all of them
+		float				getHeight(float x, float z, int maxLevel = -1) const;
+
+		// Root mean square and largest absolute value of the controls of a level
+		void				calcLevelStats(int level, float &rms, float &maxAbs) const;
+
+		// Loads the first maxLevels levels, 0 for all
+		bool				save(const char *filename) const;
+		bool				load(const char *filename, int maxLevels = 0);
+
+		// Constructors / Destructor
+		SplineHierarchy() {}
+		~SplineHierarchy() {}
+};
+
+
+#endif
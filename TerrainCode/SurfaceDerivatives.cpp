@@ -0,0 +1,309 @@
+//	----==== SURFACEDERIVATIVES.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Bulk derivatives of a B-spline control grid
+//	--------------------------------------------------------------------------------
+
+
+#include <string.h>
+#include <cmath>
+#include <thread>
+#include <functional>
+#include "SurfaceDerivatives.h"
+#include "../MathCode/Spline.h"
+#include "../UtilityCode/SIMD.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+// Patch and parameter of sample g of a line of n controls, the last sample is
+// the end of the last patch
+static __inline void locateSample(int g, int samplesPerKnot, int n, int &patch, float &t)
+{
+	patch = g / samplesPerKnot;
+	t = (float)(g - patch * samplesPerKnot) / (float)samplesPerKnot;
+	if (patch > n - 4) {
+		patch = n - 4;
+		t = 1.0f;
+	}
+}
+
+
+static float *getLayer(std::vector<float> &layer, size_t offset)
+{
+	return layer.empty() ? 0 : &layer[offset];
+}
+
+
+// w0 * a0 + w1 * a1 + w2 * a2 + w3 * a3 for SIMD_LANES floats of each row
+static __inline vfloat weightRows(const vfloat *w, const float *a0, const float *a1, const float *a2,
+								  const float *a3)
+{
+	return vadd(vadd(vmul(w[0], vloadu(a0)), vmul(w[1], vloadu(a1))),
+				vadd(vmul(w[2], vloadu(a2)), vmul(w[3], vloadu(a3))));
+}
+
+
+// Tiles of tile rows row0 to row1
+static void calcTileRows(const DerivativeSurface &surface, DerivativeMaps *maps, int row0, int row1)
+{
+	int width = maps->width, height = maps->height;
+	DerivativeWorkspace ws;
+	for (int tz = row0; tz < row1; tz++) {
+		int z0 = tz * DERIV_TILESIZE;
+		int sizeZ = (height - z0 < DERIV_TILESIZE) ? height - z0 : DERIV_TILESIZE;
+
+		for (int x0 = 0; x0 < width; x0 += DERIV_TILESIZE) {
+			int sizeX = (width - x0 < DERIV_TILESIZE) ? width - x0 : DERIV_TILESIZE;
+			size_t offset = (size_t)z0 * width + x0;
+
+			DerivativeLayers out;
+			out.height = getLayer(maps->heights, offset);
+			out.dx = getLayer(maps->dx, offset);
+			out.dz = getLayer(maps->dz, offset);
+			out.dxx = getLayer(maps->dxx, offset);
+			out.dxz = getLayer(maps->dxz, offset);
+			out.dzz = getLayer(maps->dzz, offset);
+			out.mean = getLayer(maps->mean, offset);
+			out.gaussian = getLayer(maps->gaussian, offset);
+			out.stride = width;
+
+			SurfaceDerivatives::calcBlock(surface, x0, z0, sizeX, sizeZ, out, ws);
+		}
+	}
+}
+
+
+////////// class SurfaceDerivatives //////////
+
+
+//-----------------------------------------------------------------------------
+//	For the surface y = h(x,z)
+//		K = (hxx hzz - hxz^2) / (1 + hx^2 + hz^2)^2
+//		H = ((1 + hz^2) hxx - 2 hx hz hxz + (1 + hx^2) hzz) / (2 (1 + hx^2 + hz^2)^1.5)
+//-----------------------------------------------------------------------------
+void SurfaceDerivatives::calcCurvature(float dx, float dz, float dxx, float dxz, float dzz,
+									   float &mean, float &gaussian)
+{
+	float g = 1.0f + dx*dx + dz*dz;
+	gaussian = (dxx * dzz - dxz * dxz) / (g * g);
+	mean = ((1.0f + dz*dz) * dxx - 2.0f * dx * dz * dxz + (1.0f + dx*dx) * dzz) / (2.0f * g * sqrtf(g));
+}
+
+
+void SurfaceDerivatives::calcBlock(const DerivativeSurface &surface, int x0, int z0, int sizeX, int sizeZ,
+								   const DerivativeLayers &out, DerivativeWorkspace &ws)
+{
+	const int spk = surface.samplesPerKnot, width = surface.width;
+	const float invSpacing = 1.0f / surface.spacing, invSpacing2 = invSpacing * invSpacing;
+	const int span = (sizeX + SIMD_LANES - 1) / SIMD_LANES * SIMD_LANES;	// rows padded to whole vectors
+
+	// every control row of the block along x, a row each of the height, x tangent and x
+	// concavity at each sample column. The columns at the same place within their patch
+	// have the same weights and read the controls in order, samplesPerKnot apart. The
+	// sample at the far end of the grid is the end of the last patch. A block narrower
+	// than samplesPerKnot has no columns at some places, their count is 0.
+	int firstRow, lastRow;
+	float t;
+	locateSample(z0, spk, surface.height, firstRow, t);
+	locateSample(z0 + sizeZ - 1, spk, surface.height, lastRow, t);
+	int numRows = lastRow + 4 - firstRow;
+	int lastSample = (width - 3) * spk;
+	int sizeInside = (x0 + sizeX > lastSample) ? lastSample - x0 : sizeX;
+
+	ws.rows.resize((size_t)numRows * 3 * span);
+	for (int j = 0; j < spk; j++) {
+		int i0 = ((j - x0) % spk + spk) % spk;		// first column at j within its patch
+		int p0 = (x0 + i0) / spk;
+		int count = (sizeInside > i0) ? (sizeInside - i0 + spk - 1) / spk : 0;
+		if (count == 0) continue;
+		float b[12];
+		CubicBSpline::calcBasisDerivatives((float)j / (float)spk, b, b + 4, b + 8);
+
+		for (int r = 0; r < numRows; r++) {
+			const float *c = surface.controls + (size_t)(firstRow + r) * width + p0;
+			float *f0 = &ws.rows[(size_t)r * 3 * span + i0];
+			float *f1 = f0 + span, *f2 = f1 + span;
+			int m = 0;
+			if (spk == 1) {
+				const vfloat vb[12] = { vset1(b[0]), vset1(b[1]), vset1(b[2]), vset1(b[3]),
+										vset1(b[4]), vset1(b[5]), vset1(b[6]), vset1(b[7]),
+										vset1(b[8]), vset1(b[9]), vset1(b[10]), vset1(b[11]) };
+				for (; m + SIMD_LANES <= count; m += SIMD_LANES) {
+					vstoreu(f0 + m, weightRows(vb, c+m, c+m+1, c+m+2, c+m+3));
+					vstoreu(f1 + m, weightRows(vb + 4, c+m, c+m+1, c+m+2, c+m+3));
+					vstoreu(f2 + m, weightRows(vb + 8, c+m, c+m+1, c+m+2, c+m+3));
+				}
+			}
+			for (; m < count; m++) {
+				const float *a = c + m;
+				f0[m*spk] = b[0]*a[0] + b[1]*a[1] + b[2]*a[2] + b[3]*a[3];
+				f1[m*spk] = b[4]*a[0] + b[5]*a[1] + b[6]*a[2] + b[7]*a[3];
+				f2[m*spk] = b[8]*a[0] + b[9]*a[1] + b[10]*a[2] + b[11]*a[3];
+			}
+		}
+	}
+	if (sizeInside < sizeX) {
+		float b[12];
+		CubicBSpline::calcBasisDerivatives(1.0f, b, b + 4, b + 8);
+		for (int r = 0; r < numRows; r++) {
+			const float *a = surface.controls + (size_t)(firstRow + r) * width + width - 4;
+			float *f0 = &ws.rows[(size_t)r * 3 * span + sizeInside];
+			f0[0] = b[0]*a[0] + b[1]*a[1] + b[2]*a[2] + b[3]*a[3];
+			f0[span] = b[4]*a[0] + b[5]*a[1] + b[6]*a[2] + b[7]*a[3];
+			f0[2*span] = b[8]*a[0] + b[9]*a[1] + b[10]*a[2] + b[11]*a[3];
+		}
+	}
+
+	// the padding to whole vectors is read by the z pass, so it is kept at 0
+	if (span > sizeX) {
+		for (int r = 0; r < numRows * 3; r++) {
+			memset(&ws.rows[(size_t)r * span + sizeX], 0, (span - sizeX) * sizeof(float));
+		}
+	}
+
+	// each sample row is 4 of those rows weighted along z, whole vectors at a time
+	ws.temp.resize((size_t)span * 8);
+	float *h = &ws.temp[0], *hx = h + span, *hz = hx + span;
+	float *hxx = hz + span, *hxz = hxx + span, *hzz = hxz + span;
+	float *mean = hzz + span, *gauss = mean + span;
+	const vfloat vInvSpacing = vset1(invSpacing), vInvSpacing2 = vset1(invSpacing2);
+	const vfloat one = vset1(1.0f), two = vset1(2.0f);
+	const float *rows = &ws.rows[0];
+
+	for (int j = 0; j < sizeZ; j++) {
+		int pz;
+		float w[12];
+		locateSample(z0 + j, spk, surface.height, pz, t);
+		CubicBSpline::calcBasisDerivatives(t, w, w + 4, w + 8);
+		for (int k = 0; k < 4; k++) {
+			w[4 + k] *= invSpacing;
+			w[8 + k] *= invSpacing2;
+		}
+		const vfloat vw[12] = { vset1(w[0]), vset1(w[1]), vset1(w[2]), vset1(w[3]),
+								vset1(w[4]), vset1(w[5]), vset1(w[6]), vset1(w[7]),
+								vset1(w[8]), vset1(w[9]), vset1(w[10]), vset1(w[11]) };
+
+		const float *a0 = rows + (size_t)(pz - firstRow) * 3 * span;
+		const float *a1 = a0 + 3 * span, *a2 = a1 + 3 * span, *a3 = a2 + 3 * span;
+		const float *b0 = a0 + span, *b1 = a1 + span, *b2 = a2 + span, *b3 = a3 + span;
+		const float *c0 = b0 + span, *c1 = b1 + span, *c2 = b2 + span, *c3 = b3 + span;
+
+		for (int i = 0; i < span; i += SIMD_LANES) {
+			vstoreu(h + i, weightRows(vw, a0+i, a1+i, a2+i, a3+i));
+			vstoreu(hz + i, weightRows(vw + 4, a0+i, a1+i, a2+i, a3+i));
+			vstoreu(hzz + i, weightRows(vw + 8, a0+i, a1+i, a2+i, a3+i));
+			vstoreu(hx + i, vmul(weightRows(vw, b0+i, b1+i, b2+i, b3+i), vInvSpacing));
+			vstoreu(hxz + i, vmul(weightRows(vw + 4, b0+i, b1+i, b2+i, b3+i), vInvSpacing));
+			vstoreu(hxx + i, vmul(weightRows(vw, c0+i, c1+i, c2+i, c3+i), vInvSpacing2));
+		}
+
+		size_t o = (size_t)j * out.stride;
+		size_t bytes = sizeX * sizeof(float);
+		if (out.height) memcpy(out.height + o, h, bytes);
+		if (out.dx) memcpy(out.dx + o, hx, bytes);
+		if (out.dz) memcpy(out.dz + o, hz, bytes);
+		if (out.dxx) memcpy(out.dxx + o, hxx, bytes);
+		if (out.dxz) memcpy(out.dxz + o, hxz, bytes);
+		if (out.dzz) memcpy(out.dzz + o, hzz, bytes);
+
+		// as calcCurvature
+		if (out.mean || out.gaussian) {
+			for (int i = 0; i < span; i += SIMD_LANES) {
+				const vfloat dx = vloadu(hx + i), dz = vloadu(hz + i);
+				const vfloat dxx = vloadu(hxx + i), dxz = vloadu(hxz + i), dzz = vloadu(hzz + i);
+				const vfloat dx2 = vmul(dx, dx), dz2 = vmul(dz, dz);
+				const vfloat g = vadd(one, vadd(dx2, dz2));
+
+				vstoreu(gauss + i, vdiv(vsub(vmul(dxx, dzz), vmul(dxz, dxz)), vmul(g, g)));
+				vstoreu(mean + i, vdiv(vadd(vsub(vmul(vadd(one, dz2), dxx), vmul(two, vmul(vmul(dx, dz), dxz))),
+											vmul(vadd(one, dx2), dzz)),
+									   vmul(two, vmul(g, vsqrt(g)))));
+			}
+			if (out.mean) memcpy(out.mean + o, mean, bytes);
+			if (out.gaussian) memcpy(out.gaussian + o, gauss, bytes);
+		}
+	}
+}
+
+
+bool SurfaceDerivatives::calcMaps(const DerivativeSurface &surface, int layers, DerivativeMaps &maps,
+								  int numThreads)
+{
+	if (surface.width < 4 || surface.height < 4 || surface.samplesPerKnot < 1) return false;
+
+	maps.width = surface.getSamplesX();
+	maps.height = surface.getSamplesZ();
+	maps.spacing = surface.spacing / (float)surface.samplesPerKnot;
+
+	size_t size = (size_t)maps.width * maps.height;
+	maps.heights.resize((layers & DERIV_HEIGHT) ? size : 0);
+	maps.dx.resize((layers & DERIV_GRADIENT) ? size : 0);
+	maps.dz.resize((layers & DERIV_GRADIENT) ? size : 0);
+	maps.dxx.resize((layers & DERIV_HESSIAN) ? size : 0);
+	maps.dxz.resize((layers & DERIV_HESSIAN) ? size : 0);
+	maps.dzz.resize((layers & DERIV_HESSIAN) ? size : 0);
+	maps.mean.resize((layers & DERIV_CURVATURE) ? size : 0);
+	maps.gaussian.resize((layers & DERIV_CURVATURE) ? size : 0);
+
+	// rows of tiles are split between threads
+	int tileRows = (maps.height + DERIV_TILESIZE - 1) / DERIV_TILESIZE;
+	if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads > tileRows) numThreads = tileRows;
+	if (numThreads < 1) numThreads = 1;
+
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numThreads; t++) {
+		threads.push_back(std::thread(calcTileRows, std::cref(surface), &maps,
+									  tileRows * t / numThreads, tileRows * (t + 1) / numThreads));
+	}
+	calcTileRows(surface, &maps, 0, tileRows / numThreads);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+	return true;
+}
+
+
+void SurfaceDerivatives::calcPoint(const DerivativeSurface &surface, float x, float z, SurfacePoint &p)
+{
+	int width = surface.width, height = surface.height;
+	float cx = (x < 0.0f) ? 0.0f : (x > (float)(width - 3)) ? (float)(width - 3) : x;
+	float cz = (z < 0.0f) ? 0.0f : (z > (float)(height - 3)) ? (float)(height - 3) : z;
+	int px = (int)cx, pz = (int)cz;
+	if (px > width - 4) px = width - 4;
+	if (pz > height - 4) pz = height - 4;
+
+	float wx[4], dwx[4], d2wx[4], wz[4], dwz[4], d2wz[4];
+	CubicBSpline::calcBasisDerivatives(cx - (float)px, wx, dwx, d2wx);
+	CubicBSpline::calcBasisDerivatives(cz - (float)pz, wz, dwz, d2wz);
+
+	float f0[4], f1[4], f2[4];
+	const float *c = surface.controls + (size_t)pz * width + px;
+	for (int r = 0; r < 4; r++, c += width) {
+		f0[r] = wx[0]*c[0] + wx[1]*c[1] + wx[2]*c[2] + wx[3]*c[3];
+		f1[r] = dwx[0]*c[0] + dwx[1]*c[1] + dwx[2]*c[2] + dwx[3]*c[3];
+		f2[r] = d2wx[0]*c[0] + d2wx[1]*c[1] + d2wx[2]*c[2] + d2wx[3]*c[3];
+	}
+
+	const float invSpacing = 1.0f / surface.spacing, invSpacing2 = invSpacing * invSpacing;
+	p.height = p.dx = p.dz = p.dxx = p.dxz = p.dzz = 0.0f;
+	for (int r = 0; r < 4; r++) {
+		p.height += wz[r] * f0[r];
+		p.dz += dwz[r] * f0[r];
+		p.dzz += d2wz[r] * f0[r];
+		p.dx += wz[r] * f1[r];
+		p.dxz += dwz[r] * f1[r];
+		p.dxx += wz[r] * f2[r];
+	}
+	p.dx *= invSpacing;
+	p.dz *= invSpacing;
+	p.dxx *= invSpacing2;
+	p.dxz *= invSpacing2;
+	p.dzz *= invSpacing2;
+
+	calcCurvature(p.dx, p.dz, p.dxx, p.dxz, p.dzz, p.mean, p.gaussian);
+}
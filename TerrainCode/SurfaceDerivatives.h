@@ -0,0 +1,124 @@
+//	----==== SURFACEDERIVATIVES.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A wrapper class for functions to evaluate the height, gradient,
+//					Hessian, mean and Gaussian curvature of a CubicBSpline surface over a
+//					regular grid of samples, for slope, erosion and placement analysis of
+//					the whole terrain. All are exact derivatives of the spline, not finite
+//					differences of sampled heights.
+//
+//					The samples cover knots 1 to width - 2 of the control grid, the part
+//					the scene draws, samplesPerKnot of them between each pair of knots.
+//					A block of samples is evaluated separably: every control row it
+//					touches is first combined along x with the basis and its first and
+//					second derivatives at each sample column, then each row of samples
+//					is a weighted sum of four of those rows with the z weights. The second
+//					step and the curvature run SIMD_LANES samples at a time with the
+//					SIMD.h functions, and so does the first with one sample per knot.
+//					calcMaps splits the grid into tiles over several threads.
+//
+//					Derivatives are per unit of distance, x along the rows and z down the
+//					columns. Mean curvature is positive where the surface bends up, in
+//					valleys and hollows, and negative on ridges and peaks. Gaussian
+//					curvature is positive on both, negative on saddles.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef SURFACEDERIVATIVES_H
+#define SURFACEDERIVATIVES_H
+
+#include <vector>
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+// layers of calcMaps
+#define DERIV_HEIGHT		0x01
+#define DERIV_GRADIENT		0x02		// dx, dz
+#define DERIV_HESSIAN		0x04		// dxx, dxz, dzz
+#define DERIV_CURVATURE		0x08		// mean, gaussian
+#define DERIV_ALL			0x0F
+
+#define DERIV_TILESIZE		128			// samples on a side of the tiles of calcMaps
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// A control grid and the samples to take of it
+struct DerivativeSurface {
+	const float	*controls;
+	int			width, height;			// controls
+	float		spacing;				// between knots
+	int			samplesPerKnot;
+
+	int			getSamplesX(void) const		{ return (width - 3) * samplesPerKnot + 1; }
+	int			getSamplesZ(void) const		{ return (height - 3) * samplesPerKnot + 1; }
+};
+
+
+struct SurfacePoint {
+	float		height;
+	float		dx, dz;
+	float		dxx, dxz, dzz;
+	float		mean, gaussian;
+};
+
+
+// Where calcBlock writes, rows of stride floats, layers left 0 are not written
+struct DerivativeLayers {
+	float		*height;
+	float		*dx, *dz;
+	float		*dxx, *dxz, *dzz;
+	float		*mean, *gaussian;
+	int			stride;
+};
+
+
+// Buffers of calcBlock, a thread evaluating many blocks keeps one from block to block
+struct DerivativeWorkspace {
+	std::vector<float>	rows;		// control rows along x
+	std::vector<float>	temp;		// a row of each derivative and curvature
+};
+
+
+// Whole layers of a surface, the layers not asked for are empty
+struct DerivativeMaps {
+	int			width, height;			// samples
+	float		spacing;				// between samples
+	std::vector<float>	heights;
+	std::vector<float>	dx, dz;
+	std::vector<float>	dxx, dxz, dzz;
+	std::vector<float>	mean, gaussian;
+};
+
+
+class SurfaceDerivatives {
+	public:
+
+		// Samples x0 to x0 + sizeX - 1 of rows z0 to z0 + sizeZ - 1, thread safe with a
+		// workspace per thread
+		static void		calcBlock(const DerivativeSurface &surface, int x0, int z0, int sizeX, int sizeZ,
+								  const DerivativeLayers &out, DerivativeWorkspace &ws);
+
+		// The layers asked for of every sample. numThreads 0 uses one thread per hardware
+		// thread. Returns false if the grid is smaller than 4 x 4 controls.
+		static bool		calcMaps(const DerivativeSurface &surface, int layers, DerivativeMaps &maps,
+								 int numThreads = 0);
+
+		// One point at x,z in knots from knot 1, clamped to the grid
+		static void		calcPoint(const DerivativeSurface &surface, float x, float z, SurfacePoint &p);
+
+		// Mean and Gaussian curvature of a height field from its derivatives
+		static void		calcCurvature(float dx, float dz, float dxx, float dxz, float dzz,
+									  float &mean, float &gaussian);
+};
+
+
+#endif
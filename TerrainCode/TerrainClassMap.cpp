@@ -0,0 +1,293 @@
+//	----==== TERRAINCLASSMAP.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Slope, aspect and curvature classes of a B-spline surface
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include <cmath>
+#include <thread>
+#include <atomic>
+#include "TerrainClassMap.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define CLASS_PI			3.14159265f
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// The settings as the per texel tests use them
+struct ClassifyConstants {
+	float		slopeLimits[3];			// squared gradient at the gentle, steep and cliff slopes
+	float		slopeScale;				// radians to 0 - 255
+	float		aspectScale;
+	float		curvatureScale;			// mean curvature to -127 - 127
+	float		flatMean, flatGaussian;
+};
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+// landform from the signs of the Gaussian then the mean curvature, -1, 0 or 1 each
+static const uchar landforms[3][3] = {
+	{ LAND_SADDLERIDGE,	LAND_SADDLE,	LAND_SADDLEVALLEY },
+	{ LAND_RIDGE,		LAND_PLANAR,	LAND_VALLEY },
+	{ LAND_PEAK,		LAND_PLANAR,	LAND_PIT }
+};
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+static __inline int getSign(float v, float zero)
+{
+	return (v > zero) ? 1 : (v < -zero) ? -1 : 0;
+}
+
+
+// atan2 to within 2e-4 radians, well under the 0.35 degree steps of the slope
+static __inline float approxAtan2(float y, float x)
+{
+	float ax = fabsf(x), ay = fabsf(y);
+	float big = (ax > ay) ? ax : ay, small = (ax > ay) ? ay : ax;
+	if (big == 0.0f) return 0.0f;
+
+	float a = small / big, s = a * a;
+	float r = ((-0.0464964749f * s + 0.15931422f) * s - 0.327622764f) * s * a + a;
+	if (ay > ax) r = 0.5f * CLASS_PI - r;
+	if (x < 0.0f) r = CLASS_PI - r;
+	return (y < 0.0f) ? -r : r;
+}
+
+
+static __inline uchar quantize(float v)
+{
+	return (uchar)((v < 0.0f) ? 0 : (v > 255.0f) ? 255 : (int)(v + 0.5f));
+}
+
+
+// Tiles are taken from nextTile until there are none left. The derivatives of a
+// tile go to this thread's tile buffers and only the texels are written out.
+static void classifyTiles(const DerivativeSurface &surface, const ClassifyConstants &k, TerrainTexel *texels,
+						  int width, int height, int tilesX, int numTiles, std::atomic<int> *nextTile)
+{
+	const int tileTexels = CLASS_TILESIZE * CLASS_TILESIZE;
+	std::vector<float> buffers(tileTexels * 4);
+	DerivativeWorkspace ws;
+
+	DerivativeLayers layers;
+	memset(&layers, 0, sizeof(layers));
+	layers.dx = &buffers[0];
+	layers.dz = layers.dx + tileTexels;
+	layers.mean = layers.dz + tileTexels;
+	layers.gaussian = layers.mean + tileTexels;
+	layers.stride = CLASS_TILESIZE;
+
+	for (int tile = (*nextTile)++; tile < numTiles; tile = (*nextTile)++) {
+		int x0 = (tile % tilesX) * CLASS_TILESIZE, z0 = (tile / tilesX) * CLASS_TILESIZE;
+		int sizeX = (width - x0 < CLASS_TILESIZE) ? width - x0 : CLASS_TILESIZE;
+		int sizeZ = (height - z0 < CLASS_TILESIZE) ? height - z0 : CLASS_TILESIZE;
+		SurfaceDerivatives::calcBlock(surface, x0, z0, sizeX, sizeZ, layers, ws);
+
+		TerrainTexel *out = texels + (size_t)tile * tileTexels;
+		for (int z = 0; z < sizeZ; z++) {
+			for (int x = 0; x < sizeX; x++) {
+				int i = z * CLASS_TILESIZE + x;
+				float dx = layers.dx[i], dz = layers.dz[i];
+				float mean = layers.mean[i], gaussian = layers.gaussian[i];
+				float g2 = dx*dx + dz*dz;
+
+				int slopeClass = (g2 >= k.slopeLimits[2]) ? SLOPE_CLIFF : (g2 >= k.slopeLimits[1]) ? SLOPE_STEEP :
+								 (g2 >= k.slopeLimits[0]) ? SLOPE_GENTLE : SLOPE_FLAT;
+				int land = landforms[getSign(gaussian, k.flatGaussian) + 1][getSign(mean, k.flatMean) + 1];
+
+				// downhill is against the gradient
+				float aspect = approxAtan2(-dz, -dx);
+				if (aspect < 0.0f) aspect += 2.0f * CLASS_PI;
+
+				TerrainTexel &t = out[i];
+				t.slope = quantize(approxAtan2(sqrtf(g2), 1.0f) * k.slopeScale);
+				t.aspect = (uchar)((int)(aspect * k.aspectScale + 0.5f) & 255);
+				t.curvature = quantize(128.0f + mean * k.curvatureScale);
+				t.classes = (uchar)(slopeClass | (land << 2));
+			}
+
+			// padded with the last texel of the row
+			for (int x = sizeX; x < CLASS_TILESIZE; x++) out[z * CLASS_TILESIZE + x] = out[z * CLASS_TILESIZE + sizeX - 1];
+		}
+		for (int z = sizeZ; z < CLASS_TILESIZE; z++) {
+			memcpy(out + z * CLASS_TILESIZE, out + (sizeZ - 1) * CLASS_TILESIZE, CLASS_TILESIZE * sizeof(TerrainTexel));
+		}
+	}
+}
+
+
+////////// struct ClassifySettings //////////
+
+
+void ClassifySettings::setDefaults(void)
+{
+	samplesPerKnot = 1;
+	gentleDegrees = 5.0f;
+	steepDegrees = 25.0f;
+	cliffDegrees = 45.0f;
+	flatMean = 0.005f;
+	flatGaussian = flatMean * flatMean;
+	curvatureScale = 0.1f;
+}
+
+
+////////// class TerrainClassMap //////////
+
+
+bool TerrainClassMap::build(const float *controls, int width, int height, float spacing,
+							const ClassifySettings &settings, int numThreads)
+{
+	close();
+	if (width < 4 || height < 4 || settings.samplesPerKnot < 1 || spacing <= 0) return false;
+
+	DerivativeSurface surface;
+	surface.controls = controls;
+	surface.width = width;
+	surface.height = height;
+	surface.spacing = spacing;
+	surface.samplesPerKnot = settings.samplesPerKnot;
+
+	memset(&header, 0, sizeof(header));
+	header.magic = CLASS_MAGIC;
+	header.version = CLASS_VERSION;
+	header.width = (uint32)surface.getSamplesX();
+	header.height = (uint32)surface.getSamplesZ();
+	header.tileSize = CLASS_TILESIZE;
+	header.spacing = spacing / (float)settings.samplesPerKnot;
+	header.samplesPerKnot = (uint32)settings.samplesPerKnot;
+	header.gentleDegrees = settings.gentleDegrees;
+	header.steepDegrees = settings.steepDegrees;
+	header.cliffDegrees = settings.cliffDegrees;
+	header.flatMean = settings.flatMean;
+	header.flatGaussian = settings.flatGaussian;
+	header.curvatureScale = settings.curvatureScale;
+
+	tilesX = (header.width + CLASS_TILESIZE - 1) / CLASS_TILESIZE;
+	tilesZ = (header.height + CLASS_TILESIZE - 1) / CLASS_TILESIZE;
+	int numTiles = tilesX * tilesZ;
+	built.resize((size_t)numTiles * CLASS_TILESIZE * CLASS_TILESIZE);
+
+	ClassifyConstants k;
+	const float degrees[3] = { settings.gentleDegrees, settings.steepDegrees, settings.cliffDegrees };
+	for (int s = 0; s < 3; s++) {
+		float t = tanf(degrees[s] * (CLASS_PI / 180.0f));
+		k.slopeLimits[s] = t * t;
+	}
+	k.slopeScale = 255.0f / (0.5f * CLASS_PI);
+	k.aspectScale = 256.0f / (2.0f * CLASS_PI);
+	k.curvatureScale = (settings.curvatureScale > 0) ? 127.0f / settings.curvatureScale : 0.0f;
+	k.flatMean = settings.flatMean;
+	k.flatGaussian = settings.flatGaussian;
+
+	if (numThreads <= 0) numThreads = (int)std::thread::hardware_concurrency();
+	if (numThreads > numTiles) numThreads = numTiles;
+	if (numThreads < 1) numThreads = 1;
+
+	std::atomic<int> nextTile(0);
+	std::vector<std::thread> threads;
+	for (int t = 1; t < numThreads; t++) {
+		threads.push_back(std::thread(classifyTiles, std::cref(surface), std::cref(k), &built[0],
+									  (int)header.width, (int)header.height, tilesX, numTiles, &nextTile));
+	}
+	classifyTiles(surface, k, &built[0], header.width, header.height, tilesX, numTiles, &nextTile);
+	for (size_t t = 0; t < threads.size(); t++) threads[t].join();
+
+	texels = &built[0];
+	return true;
+}
+
+
+bool TerrainClassMap::save(const char *filename) const
+{
+	if (!texels) return false;
+
+	FILE *f = fopen(filename, "wb");
+	if (!f) return false;
+
+	size_t count = (size_t)tilesX * tilesZ * CLASS_TILESIZE * CLASS_TILESIZE;
+	bool ok = (fwrite(&header, sizeof(header), 1, f) == 1 &&
+			   fwrite(texels, sizeof(TerrainTexel), count, f) == count);
+	ok = (fclose(f) == 0) && ok;
+	return ok;
+}
+
+
+bool TerrainClassMap::open(const char *filename)
+{
+	close();
+	if (!file.open(filename)) return false;
+
+	const uchar *data = file.getData();
+	int64 size = file.getSize();
+	if (size < (int64)sizeof(TerrainClassHeader)) {
+		close();
+		return false;
+	}
+	memcpy(&header, data, sizeof(header));
+
+	tilesX = (header.width + CLASS_TILESIZE - 1) / CLASS_TILESIZE;
+	tilesZ = (header.height + CLASS_TILESIZE - 1) / CLASS_TILESIZE;
+	int64 expected = (int64)sizeof(header) + (int64)tilesX * tilesZ * CLASS_TILESIZE * CLASS_TILESIZE * sizeof(TerrainTexel);
+	if (header.magic != CLASS_MAGIC || header.version != CLASS_VERSION || header.tileSize != CLASS_TILESIZE ||
+		header.width == 0 || header.height == 0 || size < expected)
+	{
+		close();
+		return false;
+	}
+
+	texels = (const TerrainTexel *)(data + sizeof(header));
+	return true;
+}
+
+
+void TerrainClassMap::close(void)
+{
+	file.close();
+	built.clear();
+	texels = 0;
+	memset(&header, 0, sizeof(header));
+	tilesX = tilesZ = 0;
+}
+
+
+void TerrainClassMap::countClasses(int64 *slopeCounts, int64 *landCounts) const
+{
+	for (int c = 0; c < SLOPE_CLASSES; c++) slopeCounts[c] = 0;
+	for (int c = 0; c < LAND_CLASSES; c++) landCounts[c] = 0;
+
+	for (int z = 0; z < getHeight(); z++) {
+		for (int x = 0; x < getWidth(); x++) {
+			const TerrainTexel &t = getTexel(x, z);
+			slopeCounts[t.getSlopeClass()]++;
+			landCounts[t.getLandform()]++;
+		}
+	}
+}
+
+
+TerrainClassMap::TerrainClassMap() :
+	tilesX(0), tilesZ(0), texels(0)
+{
+	memset(&header, 0, sizeof(header));
+}
@@ -0,0 +1,162 @@
+//	----==== TERRAINCLASSMAP.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Slope, aspect and curvature of a CubicBSpline surface classified into
+//					a raster of 4 byte texels, for material blending and object placement
+//					to read without evaluating the spline again. Each texel holds
+//
+//						slope		0 to 255 for 0 to 90 degrees
+//						aspect		the downhill direction, 0 to 255 for a full turn
+//									from +x towards +z
+//						curvature	the mean curvature, 128 where the surface is flat
+//									and 0 or 255 at -/+ curvatureScale
+//						classes		the slope class in bits 0-1 and the landform in
+//									bits 2-4
+//
+//					Landforms are the signs of the mean and Gaussian curvature (as in
+//					SurfaceDerivatives, mean curvature is positive in valleys), with
+//					anything within flatMean and flatGaussian of zero taken as zero.
+//
+//					The texels are samplesPerKnot to a knot over the knots the scene
+//					draws, built from SurfaceDerivatives::calcBlock a tile at a time. The
+//					tiles are taken by several threads and each writes its own tile of
+//					the raster, which is stored tile by tile. Tiles on the right and
+//					bottom edges are padded with their last texel. A saved raster is
+//					memory mapped by open, so reading it costs nothing up front.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef TERRAINCLASSMAP_H
+#define TERRAINCLASSMAP_H
+
+#include <vector>
+#include "SurfaceDerivatives.h"
+#include "../UtilityCode/MappedFile.h"
+#include "../UtilityCode/Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define CLASS_MAGIC			0x53414C43		// "CLAS"
+#define CLASS_VERSION		1
+#define CLASS_TILESIZE		128				// texels on a side of a tile
+
+// slope classes
+#define SLOPE_FLAT			0
+#define SLOPE_GENTLE		1
+#define SLOPE_STEEP			2
+#define SLOPE_CLIFF			3
+#define SLOPE_CLASSES		4
+
+// landforms
+#define LAND_PLANAR			0
+#define LAND_PEAK			1
+#define LAND_PIT			2
+#define LAND_RIDGE			3
+#define LAND_VALLEY			4
+#define LAND_SADDLERIDGE	5
+#define LAND_SADDLEVALLEY	6
+#define LAND_SADDLE			7
+#define LAND_CLASSES		8
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct TerrainTexel {
+	uchar		slope;
+	uchar		aspect;
+	uchar		curvature;
+	uchar		classes;
+
+	int			getSlopeClass(void) const	{ return classes & 3; }
+	int			getLandform(void) const		{ return (classes >> 2) & 7; }
+};
+
+
+struct ClassifySettings {
+	int			samplesPerKnot;
+	float		gentleDegrees;			// slopes from here up are gentle
+	float		steepDegrees;
+	float		cliffDegrees;
+	float		flatMean;				// curvatures taken as zero for the landforms
+	float		flatGaussian;
+	float		curvatureScale;			// mean curvature at curvature 0 and 255
+
+	void		setDefaults(void);
+};
+
+
+struct TerrainClassHeader {
+	uint32		magic;
+	uint32		version;
+	uint32		width, height;			// texels
+	uint32		tileSize;
+	float		spacing;				// between texels
+	uint32		samplesPerKnot;
+	float		gentleDegrees, steepDegrees, cliffDegrees;
+	float		flatMean, flatGaussian;
+	float		curvatureScale;
+	uint32		reserved[3];
+};
+
+
+class TerrainClassMap {
+	private:
+
+		///// Variables
+
+		TerrainClassHeader			header;
+		int							tilesX, tilesZ;
+		std::vector<TerrainTexel>	built;			// texels of build
+		MappedFile					file;			// or of open
+		const TerrainTexel			*texels;
+
+		// Make copy constructor and assignment operator private
+		TerrainClassMap(const TerrainClassMap &m);
+		TerrainClassMap& operator=(const TerrainClassMap &m);
+
+	public:
+
+		///// Accessors
+
+		int				getWidth(void) const		{ return (int)header.width; }
+		int				getHeight(void) const		{ return (int)header.height; }
+		float			getSpacing(void) const		{ return header.spacing; }
+		bool			isReady(void) const			{ return texels != 0; }
+
+		// x,z in texels, within the raster
+		const TerrainTexel & getTexel(int x, int z) const
+		{
+			int tile = (z / CLASS_TILESIZE) * tilesX + x / CLASS_TILESIZE;
+			return texels[(size_t)tile * CLASS_TILESIZE * CLASS_TILESIZE +
+						  (z % CLASS_TILESIZE) * CLASS_TILESIZE + x % CLASS_TILESIZE];
+		}
+
+		///// Functions
+
+		// Classifies width x height controls knot spacing apart. numThreads 0 uses one thread
+		// per hardware thread. Returns false if the grid is smaller than 4 x 4 controls.
+		bool			build(const float *controls, int width, int height, float spacing,
+							  const ClassifySettings &settings, int numThreads = 0);
+
+		bool			save(const char *filename) const;
+		bool			open(const char *filename);
+		void			close(void);
+
+		// Texels in each slope class and landform
+		void			countClasses(int64 *slopeCounts, int64 *landCounts) const;
+
+		// Constructors / Destructor
+		TerrainClassMap();
+		~TerrainClassMap() { close(); }
+};
+
+
+#endif
@@ -0,0 +1,387 @@
+//	----==== TILECACHE.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Paging of heightfield tiles and their patches on a loader thread
+//	--------------------------------------------------------------------------------
+
+
+#include <string.h>
+#include <algorithm>
+#include "TileCache.h"
+#include "HeightField.h"
+#include "../MathCode/Spline.h"
+#include "../UtilityCode/HiResTimer.h"
+#include "../UtilityCode/MsgAssert.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+// tile states
+#define TILE_ABSENT			0
+#define TILE_QUEUED			1		// waiting for the loader, being built or built and not yet installed
+#define TILE_RESIDENT		2
+#define TILE_FAILED			3		// not requested again
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class TileCache //////////
+
+
+bool TileCache::open(const HeightField &heightField, int64 budgetBytes, int tileRadius)
+{
+	close();
+	if (!heightField.isOpen() || budgetBytes <= 0 || tileRadius < 0 ||
+		heightField.getTileSize() < TILECACHE_MINTILESIZE)
+	{
+		return false;
+	}
+
+	field = &heightField;
+	budget = budgetBytes;
+	radius = tileRadius;
+	tileSize = field->getTileSize();
+	tilesX = field->getTilesX();
+	tilesZ = field->getTilesZ();
+	tileBytes = (int64)tileSize * tileSize * sizeof(float) * (1 + TILECACHE_PATCHFLOATS) + sizeof(CachedTile);
+
+	int numTiles = tilesX * tilesZ;
+	tiles.assign(numTiles, (CachedTile*)0);
+	states.assign(numTiles, TILE_ABSENT);
+	lastUsed.assign(numTiles, 0);
+	residentList.clear();
+
+	// lastUsed 0 is never, a tile counts as in use during the frame it was used and the next
+	frame = 2;
+	cameraTX = cameraTZ = 0;
+	memset(&stats, 0, sizeof(stats));
+
+	pending.clear();
+	completed.clear();
+	loading = -1;
+	loadTicks = 0;
+	quit = false;
+
+	for (int s = 0; s < TILECACHE_DECODESLOTS; s++) {
+		decodedIndex[s] = -1;
+		decodedUse[s] = 0;
+	}
+	decodeClock = 0;
+	apron.resize((tileSize + 3) * (tileSize + 3));
+
+	loader = std::thread(&TileCache::loaderMain, this);
+	return true;
+}
+
+
+void TileCache::close(void)
+{
+	if (!field) return;
+
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		quit = true;
+	}
+	loaderSignal.notify_all();
+	loader.join();
+
+	for (size_t t = 0; t < tiles.size(); t++) delete tiles[t];
+	for (size_t t = 0; t < completed.size(); t++) delete completed[t];
+	tiles.clear();
+	states.clear();
+	lastUsed.clear();
+	residentList.clear();
+	pending.clear();
+	completed.clear();
+	for (int s = 0; s < TILECACHE_DECODESLOTS; s++) std::vector<float>().swap(decoded[s]);
+	std::vector<float>().swap(apron);
+
+	field = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Loader thread, the lock is only held to take a tile and hand it back
+//-----------------------------------------------------------------------------
+void TileCache::loaderMain(void)
+{
+	std::unique_lock<std::mutex> lock(queueLock);
+
+	for (;;) {
+		while (!quit && pending.empty()) loaderSignal.wait(lock);
+		if (quit) break;
+
+		loading = pending.back();
+		pending.pop_back();
+		CachedTile *tile = new CachedTile;
+		tile->tx = loading % tilesX;
+		tile->tz = loading / tilesX;
+		lock.unlock();
+
+		int64 start = getTicks();
+		if (!buildTile(*tile)) tile->heights.clear();
+		int64 ticks = getTicks() - start;
+
+		lock.lock();
+		completed.push_back(tile);
+		loading = -1;
+		loadTicks += ticks;
+		doneSignal.notify_all();
+	}
+}
+
+
+//-----------------------------------------------------------------------------
+//	Returns the decoded samples of a tile, from the slots when it was decoded
+//	recently. Loader thread only.
+//-----------------------------------------------------------------------------
+const float * TileCache::decodeTile(int tx, int tz)
+{
+	int index = tz * tilesX + tx;
+	int slot = 0;
+	for (int s = 0; s < TILECACHE_DECODESLOTS; s++) {
+		if (decodedIndex[s] == index) {
+			decodedUse[s] = ++decodeClock;
+			return &decoded[s][0];
+		}
+		if (decodedUse[s] < decodedUse[slot]) slot = s;
+	}
+
+	decoded[slot].resize(tileSize * tileSize);
+	if (!field->readTile(tx, tz, &decoded[slot][0])) {
+		decodedIndex[slot] = -1;
+		decodedUse[slot] = 0;
+		return 0;
+	}
+	decodedIndex[slot] = index;
+	decodedUse[slot] = ++decodeClock;
+	return &decoded[slot][0];
+}
+
+
+//-----------------------------------------------------------------------------
+//	Gathers the tile and the 3 samples past its right and lower edges, clamped
+//	to the field like HeightField::getSample, then builds every patch from them
+//-----------------------------------------------------------------------------
+bool TileCache::buildTile(CachedTile &tile)
+{
+	const int side = tileSize + 3;
+	const int width = field->getWidth(), height = field->getHeight();
+
+	for (int z = 0; z < side; z++) {
+		int gz = tile.tz * tileSize + z;
+		if (gz >= height) gz = height - 1;
+		int sourceTZ = gz / tileSize;
+		int row = (gz - sourceTZ * tileSize) * tileSize;
+
+		// a row crosses into the right neighbor at most once
+		const float *source = 0;
+		int sourceTX = -1;
+		float *out = &apron[z * side];
+		for (int x = 0; x < side; x++) {
+			int gx = tile.tx * tileSize + x;
+			if (gx >= width) gx = width - 1;
+			int tx = gx / tileSize;
+			if (tx != sourceTX) {
+				source = decodeTile(tx, sourceTZ);
+				if (!source) return false;
+				sourceTX = tx;
+			}
+			out[x] = source[row + gx - tx * tileSize];
+		}
+	}
+
+	tile.heights.resize(tileSize * tileSize);
+	for (int z = 0; z < tileSize; z++) {
+		memcpy(&tile.heights[z * tileSize], &apron[z * side], tileSize * sizeof(float));
+	}
+
+	tile.patches.resize(tileSize * tileSize * TILECACHE_PATCHFLOATS);
+	float hBuffer[16];
+	Matrix4x4 middle;
+	float *patch = &tile.patches[0];
+
+	for (int z = 0; z < tileSize; z++) {
+		for (int x = 0; x < tileSize; x++, patch += TILECACHE_PATCHFLOATS) {
+			for (int r = 0; r < 4; r++) memcpy(&hBuffer[r*4], &apron[(z + r) * side + x], 4 * sizeof(float));
+			CubicBSpline::calcMiddleMatrix(hBuffer, middle);
+			memcpy(patch, middle.i, TILECACHE_PATCHFLOATS * sizeof(float));
+		}
+	}
+	return true;
+}
+
+
+void TileCache::installTiles(std::vector<CachedTile*> &done)
+{
+	for (size_t t = 0; t < done.size(); t++) {
+		CachedTile *tile = done[t];
+		int index = tile->tz * tilesX + tile->tx;
+
+		if (tile->heights.empty()) {
+			delete tile;
+			states[index] = TILE_FAILED;
+			stats.failures++;
+			continue;
+		}
+
+		tiles[index] = tile;
+		states[index] = TILE_RESIDENT;
+		residentList.push_back(index);
+		stats.loads++;
+		stats.residentBytes += tileBytes;
+		if (stats.residentBytes > stats.peakBytes) stats.peakBytes = stats.residentBytes;
+	}
+	done.clear();
+}
+
+
+//-----------------------------------------------------------------------------
+//	Marks the tiles around the camera as used, as many as fit in the budget
+//	nearest first, and queues the missing ones. Queued tiles that are no longer
+//	used are dropped. Called with the queue locked.
+//-----------------------------------------------------------------------------
+void TileCache::queueTiles(void)
+{
+	// sort keys hold the squared distance above the tile index
+	std::vector<uint64> keys;
+	for (int tz = cameraTZ - radius; tz <= cameraTZ + radius; tz++) {
+		for (int tx = cameraTX - radius; tx <= cameraTX + radius; tx++) {
+			if (tx < 0 || tz < 0 || tx >= tilesX || tz >= tilesZ) continue;
+			uint64 distance = (tx - cameraTX) * (tx - cameraTX) + (tz - cameraTZ) * (tz - cameraTZ);
+			keys.push_back((distance << 32) | (uint)(tz * tilesX + tx));
+		}
+	}
+	std::sort(keys.begin(), keys.end());
+
+	int64 maxTiles = budget / tileBytes;
+	if (maxTiles < 1) maxTiles = 1;
+	if ((int64)keys.size() > maxTiles) keys.resize((size_t)maxTiles);
+
+	for (size_t k = 0; k < keys.size(); k++) {
+		int index = (int)(keys[k] & 0xFFFFFFFF);
+		lastUsed[index] = frame;
+		if (states[index] == TILE_ABSENT) {
+			states[index] = TILE_QUEUED;
+			pending.push_back(index);
+		}
+	}
+
+	// keep the tiles still in use, the farthest first so the nearest is taken next
+	keys.clear();
+	for (size_t p = 0; p < pending.size(); p++) {
+		int index = pending[p];
+		if (lastUsed[index] + 1 < frame) {
+			states[index] = TILE_ABSENT;
+			stats.cancels++;
+			continue;
+		}
+		int dx = index % tilesX - cameraTX, dz = index / tilesX - cameraTZ;
+		keys.push_back(((uint64)(dx * dx + dz * dz) << 32) | (uint)index);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	pending.resize(keys.size());
+	for (size_t k = 0; k < keys.size(); k++) pending[keys.size() - 1 - k] = (int)(keys[k] & 0xFFFFFFFF);
+}
+
+
+//-----------------------------------------------------------------------------
+//	Frees the least recently used tiles while over the budget, tiles used this
+//	frame or the last are kept even if that leaves the cache over budget
+//-----------------------------------------------------------------------------
+void TileCache::evict(void)
+{
+	while (stats.residentBytes > budget) {
+		int victim = -1;
+		for (int r = 0; r < (int)residentList.size(); r++) {
+			int index = residentList[r];
+			if (lastUsed[index] + 1 >= frame) continue;
+			if (victim < 0 || lastUsed[index] < lastUsed[residentList[victim]]) victim = r;
+		}
+		if (victim < 0) break;
+
+		int index = residentList[victim];
+		residentList[victim] = residentList.back();
+		residentList.pop_back();
+
+		field->releaseTile(tiles[index]->tx, tiles[index]->tz);
+		delete tiles[index];
+		tiles[index] = 0;
+		states[index] = TILE_ABSENT;
+		stats.evictions++;
+		stats.residentBytes -= tileBytes;
+	}
+}
+
+
+void TileCache::update(int x, int z)
+{
+	msgAssert(isOpen(), "TileCache: not open");
+
+	frame++;
+	cameraTX = std::min(std::max(x / tileSize, 0), tilesX - 1);
+	cameraTZ = std::min(std::max(z / tileSize, 0), tilesZ - 1);
+
+	std::vector<CachedTile*> done;
+	{
+		std::lock_guard<std::mutex> lock(queueLock);
+		done.swap(completed);
+		queueTiles();
+		stats.queuedTiles = (int)pending.size();
+		stats.loadSeconds = ticksToSeconds(loadTicks);
+	}
+	loaderSignal.notify_one();
+
+	installTiles(done);
+	evict();
+	stats.residentTiles = (int)residentList.size();
+}
+
+
+const CachedTile * TileCache::getTile(int tx, int tz)
+{
+	if (!isOpen() || tx < 0 || tz < 0 || tx >= tilesX || tz >= tilesZ) return 0;
+
+	int index = tz * tilesX + tx;
+	lastUsed[index] = frame;
+	if (states[index] == TILE_RESIDENT) {
+		stats.hits++;
+		return tiles[index];
+	}
+
+	stats.faults++;
+	if (states[index] == TILE_ABSENT) {
+		{
+			std::lock_guard<std::mutex> lock(queueLock);
+			states[index] = TILE_QUEUED;
+			pending.push_back(index);
+		}
+		loaderSignal.notify_one();
+	}
+	return 0;
+}
+
+
+void TileCache::waitIdle(void)
+{
+	if (!isOpen()) return;
+
+	std::unique_lock<std::mutex> lock(queueLock);
+	while (!pending.empty() || loading >= 0) doneSignal.wait(lock);
+}
+
+
+TileCache::TileCache() :
+	field(0), budget(TILECACHE_BUDGET), radius(TILECACHE_RADIUS), tileSize(0), tilesX(0), tilesZ(0),
+	tileBytes(0), frame(0), cameraTX(0), cameraTZ(0), loading(-1), loadTicks(0), quit(false),
+	decodeClock(0)
+{
+	memset(&stats, 0, sizeof(stats));
+}
@@ -0,0 +1,163 @@
+//	----==== TILECACHE.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Out of core paging of a heightfield around the camera. A background
+//					loader thread decodes the tiles near the camera and builds the B-spline
+//					middle matrix of every patch that starts in them, so the render thread
+//					only ever copies finished data. Each patch reaches 3 samples past its
+//					origin, so the loader also decodes the right and lower neighbors of a
+//					tile; the last few decoded tiles are kept for the next request.
+//
+//					The render thread owns the resident tiles. update() installs the tiles
+//					the loader has finished, queues the missing tiles within the radius of
+//					the camera, nearest first, drops queued tiles the camera has left, and
+//					evicts the least recently used tiles while over the memory budget.
+//					getTile() never waits: a tile that is not resident counts as a fault,
+//					is queued to load next and 0 is returned, the caller keeps what it had
+//					until a later frame.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef TILECACHE_H
+#define TILECACHE_H
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "../UtilityCode/Typedefs.h"
+
+class HeightField;
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define TILECACHE_BUDGET		(64*1048576)	// default bytes of resident tiles
+#define TILECACHE_RADIUS		1				// default tiles loaded around the camera tile
+#define TILECACHE_DECODESLOTS	4				// decoded tiles kept by the loader for the aprons
+#define TILECACHE_PATCHFLOATS	16				// one middle matrix
+#define TILECACHE_MINTILESIZE	8				// smallest tiles, a window this size spans at most 2 x 2
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// One tile of heights and the middle matrix of every patch whose first sample is in the
+// tile, tileSize x tileSize of each in rows
+struct CachedTile {
+	int					tx, tz;
+	std::vector<float>	heights;
+	std::vector<float>	patches;		// TILECACHE_PATCHFLOATS per patch
+
+	const float *	getPatch(int x, int z, int tileSize) const	{ return &patches[(z * tileSize + x) * TILECACHE_PATCHFLOATS]; }
+};
+
+
+struct TileCacheStats {
+	int64		faults;					// getTile calls for a tile that was not resident
+	int64		hits;
+	int64		loads;					// tiles built by the loader
+	int64		evictions;
+	int64		cancels;				// queued tiles dropped when the camera moved away
+	int64		failures;				// tiles that could not be read
+	int			residentTiles;
+	int			queuedTiles;
+	int64		residentBytes;
+	int64		peakBytes;
+	double		loadSeconds;			// loader time spent building tiles
+};
+
+
+class TileCache {
+	private:
+
+		///// Variables
+
+		const HeightField		*field;
+		int64					budget;
+		int						radius;
+		int						tileSize, tilesX, tilesZ;
+		int64					tileBytes;		// memory of one cached tile
+
+		// render thread only, one entry per tile of the field
+		std::vector<CachedTile*>	tiles;
+		std::vector<uchar>		states;
+		std::vector<uint32>		lastUsed;		// last frame the tile was asked for or near the camera
+		std::vector<int>		residentList;
+		uint32					frame;
+		int						cameraTX, cameraTZ;
+		TileCacheStats			stats;
+
+		// shared with the loader, under queueLock
+		std::thread				loader;
+		std::mutex				queueLock;
+		std::condition_variable	loaderSignal;	// work queued or quitting
+		std::condition_variable	doneSignal;		// a tile finished
+		std::vector<int>		pending;		// tile indices, the next one to load is last
+		std::vector<CachedTile*>	completed;
+		int						loading;		// tile the loader is building, -1 when idle
+		int64					loadTicks;
+		bool					quit;
+
+		// loader only
+		std::vector<float>		decoded[TILECACHE_DECODESLOTS];
+		int						decodedIndex[TILECACHE_DECODESLOTS];
+		uint32					decodedUse[TILECACHE_DECODESLOTS];
+		uint32					decodeClock;
+		std::vector<float>		apron;			// (tileSize+3)^2 samples
+
+		///// Functions
+
+		void				loaderMain(void);
+		bool				buildTile(CachedTile &tile);
+		const float *		decodeTile(int tx, int tz);
+
+		void				installTiles(std::vector<CachedTile*> &done);
+		void				queueTiles(void);
+		void				evict(void);
+
+		// Make copy constructor and assignment operator private
+		TileCache(const TileCache &c);
+		TileCache& operator=(const TileCache &c);
+
+	public:
+
+		///// Accessors
+
+		bool				isOpen(void) const			{ return field != 0; }
+		int					getTileSize(void) const		{ return tileSize; }
+		int64				getBudget(void) const		{ return budget; }
+		int					getRadius(void) const		{ return radius; }
+		int64				getTileMemory(void) const	{ return tileBytes; }
+		const TileCacheStats & getStats(void) const		{ return stats; }
+
+		///// Functions
+
+		// Starts the loader for the field, which must stay open until close. Returns false
+		// for tiles smaller than TILECACHE_MINTILESIZE.
+		bool				open(const HeightField &heightField, int64 budgetBytes = TILECACHE_BUDGET,
+								 int tileRadius = TILECACHE_RADIUS);
+		void				close(void);
+
+		// Once per frame on the render thread, x,z is the sample under the camera
+		void				update(int x, int z);
+
+		// The resident tile, or 0 after queueing it. Render thread only.
+		const CachedTile *	getTile(int tx, int tz);
+
+		// Blocks until the queue is empty, for filling the cache before the first frame
+		void				waitIdle(void);
+
+		// Constructors / Destructor
+		TileCache();
+		~TileCache() { close(); }
+};
+
+
+#endif
@@ -0,0 +1,141 @@
+//	----==== BINANGLE.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	A binary angle, a full turn is 2^32 units of an unsigned int. The
+//					angle wraps around by the normal overflow of unsigned arithmetic, so
+//					any sum or difference of angles is valid without a modulo, and there
+//					are no negative or out of range angles to check for. The top 2 bits
+//					are the quadrant, and the next 11 bits index the quarter wave table
+//					of trigtables.h directly, so sin and cos are a shift and a mask
+//					away from the table with no division or compare. One unit is about
+//					8.4e-8 degrees.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef BINANGLE_H
+#define BINANGLE_H
+
+#include "TrigTables.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define BINANGLE_QUARTER		0x40000000u		// 90 degrees
+#define BINANGLE_HALF			0x80000000u		// 180 degrees
+
+// units of the angle within one step of the QUARTER_LINEAR_STEPS table, 2^30 / 2048
+#define BINANGLE_STEPSHIFT		19
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class BinAngle {
+
+	public:
+
+		///// Variables
+
+		unsigned int	value;
+
+		///// Overloaded Operators
+
+		bool		operator==(BinAngle a) const { return value == a.value; }
+		bool		operator!=(BinAngle a) const { return value != a.value; }
+
+		void		operator+=(BinAngle a) { value += a.value; }
+		void		operator-=(BinAngle a) { value -= a.value; }
+		void		operator*=(int s) { value *= (unsigned int)s; }
+
+		BinAngle	operator- (void) const { return BinAngle(0u - value); }
+		BinAngle	operator+ (BinAngle a) const { return BinAngle(value + a.value); }
+		BinAngle	operator- (BinAngle a) const { return BinAngle(value - a.value); }
+		BinAngle	operator* (int s) const { return BinAngle(value * (unsigned int)s); }
+
+		///// Functions
+
+		// any angle is accepted, including negative angles and angles of more than one turn
+		static __inline BinAngle	fromDegrees(float degrees);
+		static __inline BinAngle	fromRadians(float radians);
+
+		float		toDegrees(void) const { return (float)value * (360.0f / 4294967296.0f); }
+		float		toRadians(void) const { return (float)value * (6.28318530717959f / 4294967296.0f); }
+		float		toSignedDegrees(void) const { return (float)(int)value * (360.0f / 4294967296.0f); }	// -180 to 180
+
+		// Index into a table of tableSize entries covering a full turn, like the LookupManager
+		// tables. The result is always below tableSize, a multiply and a shift
+		int			toIndex(int tableSize) const { return (int)(((unsigned long long)value * (unsigned int)tableSize) >> 32); }
+
+		BinAngle	half(void) const { return BinAngle(value >> 1); }	// from 0 to 180 degrees
+
+		__inline float	sin(void) const;
+		__inline float	cos(void) const;
+		__inline void	sinCos(float &sinOut, float &cosOut) const;
+
+		// Constructors / Destructor
+		BinAngle() : value(0) {}
+		explicit BinAngle(unsigned int _value) : value(_value) {}
+};
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+////////// class BinAngle //////////
+
+
+// converted through a 64 bit integer, so angles outside of 0 to 360 wrap instead of overflowing
+__inline BinAngle BinAngle::fromDegrees(float degrees)
+{
+	return BinAngle((unsigned int)(long long)((double)degrees * (4294967296.0 / 360.0)));
+}
+
+
+__inline BinAngle BinAngle::fromRadians(float radians)
+{
+	return BinAngle((unsigned int)(long long)((double)radians * (4294967296.0 / 6.28318530717958647692)));
+}
+
+
+//----------------------------------------------------------------------------------------
+//	The quadrant is the top 2 bits. The second and fourth quadrants are mirrored by
+//	flipping the remaining bits, which is one unit short of subtracting from a quarter
+//	turn but keeps the table step below QUARTER_LINEAR_STEPS. The third and fourth
+//	quadrants are negated. The step and the fraction within it are taken straight from
+//	the bits, so no precision is lost converting large angles to float.
+//----------------------------------------------------------------------------------------
+__inline float BinAngle::sin(void) const
+{
+	unsigned int r = value & (BINANGLE_QUARTER - 1);
+	if (value & BINANGLE_QUARTER) r ^= (BINANGLE_QUARTER - 1);
+
+	unsigned int step = r >> BINANGLE_STEPSHIFT;
+	float f = (float)(r & ((1u << BINANGLE_STEPSHIFT) - 1)) * (1.0f / (float)(1u << BINANGLE_STEPSHIFT));
+
+	const float *table = quarterLinearTable.v;
+	float s = table[step] + (table[step+1] - table[step]) * f;
+	return (value & BINANGLE_HALF) ? -s : s;
+}
+
+
+__inline float BinAngle::cos(void) const
+{
+	return BinAngle(value + BINANGLE_QUARTER).sin();
+}
+
+
+__inline void BinAngle::sinCos(float &sinOut, float &cosOut) const
+{
+	sinOut = sin();
+	cosOut = cos();
+}
+
+
+#endif
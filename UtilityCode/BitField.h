@@ -111,13 +111,13 @@ __inline bool BitField<T>::testBit(const int bit) const
 template <class T>
 __inline bool BitField<T>::testFlags(const T test) const
 {
-	return ((value & test) == test);
+	return ((bits & test) == test);
 }
 
 template <class T>
 __inline bool BitField<T>::testAny(const T test) const
 {
-	return (value & test);
+	return (bits & test);
 }
 
 // Info
@@ -133,7 +133,7 @@ __inline int BitField<T>::totalSet() const
 {
 	int count = 0;
 	int total = totalBits();
-	T TestValue = value;
+	T TestValue = bits;
 	
 	for (int i = total; i > 0; i--) {
 		count += (TestValue & 1);
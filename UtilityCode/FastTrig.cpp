@@ -0,0 +1,63 @@
+//	----==== FASTTRIG.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Polynomial sine and cosine, batch version. Written with the vfloat
+//					functions from simd.h, the quadrant is kept as a float so no integer
+//					SIMD instructions are needed (AVX has no 256 bit integer math).
+//	--------------------------------------------------------------------------------
+
+
+#include "FastTrig.h"
+#include "SIMD.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+void fastSinCos(const float *angles, float *sinOut, float *cosOut, int count)
+{
+	const vfloat twoOverPi = vset1(FASTTRIG_2OVERPI);
+	const vfloat pio2_1 = vset1(FASTTRIG_PIO2_1);
+	const vfloat pio2_2 = vset1(FASTTRIG_PIO2_2);
+	const vfloat pio2_3 = vset1(FASTTRIG_PIO2_3);
+	const vfloat s1 = vset1(FASTTRIG_S1), s2 = vset1(FASTTRIG_S2), s3 = vset1(FASTTRIG_S3);
+	const vfloat c1 = vset1(FASTTRIG_C1), c2 = vset1(FASTTRIG_C2), c3 = vset1(FASTTRIG_C3);
+	const vfloat zero = vset1(0.0f), half = vset1(0.5f), one = vset1(1.0f), two = vset1(2.0f);
+	const vfloat onePointFive = vset1(1.5f), quarter = vset1(0.25f), four = vset1(4.0f);
+
+	int i = 0;
+	for (; i + SIMD_LANES <= count; i += SIMD_LANES) {
+		const vfloat a = vloadu(angles + i);
+		const vfloat q = vround(vmul(a, twoOverPi));
+
+		const vfloat r = vsub(vsub(vsub(a, vmul(q, pio2_1)), vmul(q, pio2_2)), vmul(q, pio2_3));
+		const vfloat r2 = vmul(r, r);
+
+		const vfloat s = vadd(r, vmul(vmul(r, r2), vadd(s1, vmul(r2, vadd(s2, vmul(r2, s3))))));
+		const vfloat c = vadd(vsub(one, vmul(half, r2)),
+							  vmul(vmul(r2, r2), vadd(c1, vmul(r2, vadd(c2, vmul(r2, c3))))));
+
+		// quadrant 0..3 = q - 4*floor(q/4), floor of an integer over 4 is round((q - 1.5) / 4)
+		const vfloat quadrant = vsub(q, vmul(four, vround(vmul(vsub(q, onePointFive), quarter))));
+
+		// odd quadrants swap sin and cos, |quadrant - 2| is 1 only for quadrants 1 and 3
+		const vmask swap = vcmplt(vabs(vsub(vabs(vsub(quadrant, two)), one)), half);
+		vfloat sinR = vselect(swap, c, s);
+		vfloat cosR = vselect(swap, s, c);
+
+		// sin is negative in quadrants 2 and 3, cos in 1 and 2 where |quadrant - 1.5| is 0.5
+		sinR = vselect(vcmpgt(quadrant, onePointFive), vsub(zero, sinR), sinR);
+		cosR = vselect(vcmplt(vabs(vsub(quadrant, onePointFive)), one), vsub(zero, cosR), cosR);
+
+		vstoreu(sinOut + i, sinR);
+		vstoreu(cosOut + i, cosR);
+	}
+
+	for (; i < count; ++i) {
+		fastSinCos(angles[i], sinOut[i], cosOut[i]);
+	}
+}
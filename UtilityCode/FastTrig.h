@@ -0,0 +1,92 @@
+//	----==== FASTTRIG.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Polynomial sine and cosine for angles in radians. The angle is
+//					reduced to [-PI/4, PI/4] around the nearest multiple of PI/2 and
+//					minimax polynomials are evaluated for both sin and cos, the quadrant
+//					then picks and negates the right one. Accuracy is within about 1e-7
+//					for angles up to a few thousand radians, with no table and no memory
+//					access at all. The batch version processes 4 (SSE) or 8 (AVX) angles
+//					per instruction.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef FASTTRIG_H
+#define FASTTRIG_H
+
+#include <cmath>
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define FASTTRIG_2OVERPI		0.636619772367581f
+
+// PI/2 split in three parts so that q * part is exact for the first two (Cody-Waite reduction)
+#define FASTTRIG_PIO2_1			1.5703125f
+#define FASTTRIG_PIO2_2			4.837512969970703125e-4f
+#define FASTTRIG_PIO2_3			7.54978995489188216e-8f
+
+// minimax coefficients on [-PI/4, PI/4]
+#define FASTTRIG_S1				-1.6666654611e-1f
+#define FASTTRIG_S2				8.3321608736e-3f
+#define FASTTRIG_S3				-1.9515295891e-4f
+#define FASTTRIG_C1				4.166664568298827e-2f
+#define FASTTRIG_C2				-1.388731625493765e-3f
+#define FASTTRIG_C3				2.443315711809948e-5f
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+// Sine and cosine of count angles, the arrays do not need to be aligned
+void	fastSinCos(const float *angles, float *sinOut, float *cosOut, int count);
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+
+__inline void fastSinCos(float a, float &sinOut, float &cosOut)
+{
+	float qf = a * FASTTRIG_2OVERPI;
+	int q = (int)(qf >= 0 ? qf + 0.5f : qf - 0.5f);
+	qf = (float)q;
+
+	float r = ((a - qf*FASTTRIG_PIO2_1) - qf*FASTTRIG_PIO2_2) - qf*FASTTRIG_PIO2_3;
+	float r2 = r * r;
+
+	float s = r + r * r2 * (FASTTRIG_S1 + r2 * (FASTTRIG_S2 + r2 * FASTTRIG_S3));
+	float c = 1.0f - 0.5f * r2 + r2 * r2 * (FASTTRIG_C1 + r2 * (FASTTRIG_C2 + r2 * FASTTRIG_C3));
+
+	switch (q & 3) {
+		case 0: sinOut =  s; cosOut =  c; break;
+		case 1: sinOut =  c; cosOut = -s; break;
+		case 2: sinOut = -s; cosOut = -c; break;
+		default: sinOut = -c; cosOut =  s; break;		// 3
+	}
+}
+
+
+__inline float fastSin(float a)
+{
+	float s, c;
+	fastSinCos(a, s, c);
+	return s;
+}
+
+
+__inline float fastCos(float a)
+{
+	float s, c;
+	fastSinCos(a, s, c);
+	return c;
+}
+
+
+#endif
@@ -13,8 +13,8 @@
 #ifndef FONTMANAGER_H
 #define FONTMANAGER_H
 
-#include "singleton.h"
-#include "glfont.h"
+#include "Singleton.h"
+#include "GLFont.h"
 
 
 /*---------------
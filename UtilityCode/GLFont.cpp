@@ -13,7 +13,7 @@
 #include <windows.h>
 #include <GL\glew.h>
 #include <stdio.h>
-#include "glfont.h"
+#include "GLFont.h"
 
 extern	HDC		hDC;
 
@@ -0,0 +1,147 @@
+//	----==== HIRESTIMER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Portable high resolution clock
+//	--------------------------------------------------------------------------------
+
+
+#include "HiResTimer.h"
+#include "Platform.h"
+
+#if defined(HIRESTIMER_RDTSC)
+	#if defined(_MSC_VER)
+		#include <intrin.h>
+	#else
+		#include <x86intrin.h>
+	#endif
+	#include <chrono>
+	#include <thread>
+#elif defined(PLATFORM_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(PLATFORM_POSIX)
+	#include <time.h>
+#else
+	#include <chrono>
+#endif
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+static int64	tickFrequency = 0;		// measured or queried on first use
+static double	secondsPerTick = 0;
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+#if defined(HIRESTIMER_RDTSC)
+
+int64 getTicks(void)
+{
+	return (int64)__rdtsc();
+}
+
+
+const char *getTickSource(void) { return "rdtsc"; }
+
+
+// counts the time stamp ticks during 50 milliseconds of the steady clock
+static int64 queryFrequency(void)
+{
+	typedef std::chrono::steady_clock clock;
+
+	clock::time_point start = clock::now();
+	int64 startTicks = getTicks();
+	std::this_thread::sleep_for(std::chrono::milliseconds(50));
+	int64 endTicks = getTicks();
+	double seconds = std::chrono::duration<double>(clock::now() - start).count();
+
+	return (int64)((double)(endTicks - startTicks) / seconds);
+}
+
+#elif defined(PLATFORM_WIN32)
+
+int64 getTicks(void)
+{
+	LARGE_INTEGER t;
+	QueryPerformanceCounter(&t);
+	return t.QuadPart;
+}
+
+
+const char *getTickSource(void) { return "QueryPerformanceCounter"; }
+
+
+static int64 queryFrequency(void)
+{
+	LARGE_INTEGER f;
+	QueryPerformanceFrequency(&f);
+	return f.QuadPart;
+}
+
+#elif defined(PLATFORM_POSIX)
+
+int64 getTicks(void)
+{
+	timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return (int64)t.tv_sec * 1000000000 + t.tv_nsec;
+}
+
+
+const char *getTickSource(void) { return "clock_gettime"; }
+
+
+static int64 queryFrequency(void) { return 1000000000; }
+
+#else
+
+int64 getTicks(void)
+{
+	return (int64)std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+
+const char *getTickSource(void) { return "steady_clock"; }
+
+
+static int64 queryFrequency(void) { return 1000000000; }
+
+#endif
+
+
+int64 getTickFrequency(void)
+{
+	if (tickFrequency == 0) {
+		tickFrequency = queryFrequency();
+		secondsPerTick = 1.0 / (double)tickFrequency;
+	}
+	return tickFrequency;
+}
+
+
+double ticksToSeconds(int64 ticks)
+{
+	if (tickFrequency == 0) getTickFrequency();
+	return (double)ticks * secondsPerTick;
+}
+
+
+double ticksToMilliseconds(int64 ticks)
+{
+	return ticksToSeconds(ticks) * 1000.0;
+}
+
+
+double ticksToMicroseconds(int64 ticks)
+{
+	return ticksToSeconds(ticks) * 1000000.0;
+}
@@ -0,0 +1,35 @@
+//	----==== HIRESTIMER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Portable high resolution clock used by the Timer, the Profiler and
+//					the benchmarks. The tick source is picked at compile time:
+//					QueryPerformanceCounter on Windows, clock_gettime(CLOCK_MONOTONIC) on
+//					Linux and other POSIX systems, and std::chrono::steady_clock
+//					everywhere else. Define HIRESTIMER_RDTSC to read the processor time
+//					stamp counter instead, which is the cheapest to read but only valid
+//					on processors with an invariant TSC. Its frequency is measured
+//					against the system clock the first time it is needed.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef HIRESTIMER_H
+#define HIRESTIMER_H
+
+#include "Typedefs.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+int64		getTicks(void);				// current time in ticks, only differences are meaningful
+int64		getTickFrequency(void);		// ticks per second, first call it before starting other threads
+const char *getTickSource(void);		// name of the tick source, for reports
+
+double		ticksToSeconds(int64 ticks);
+double		ticksToMilliseconds(int64 ticks);
+double		ticksToMicroseconds(int64 ticks);
+
+#endif
@@ -0,0 +1,332 @@
+//	----==== INFLATE.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	zlib / deflate decompressor
+//	--------------------------------------------------------------------------------
+
+
+#include <string.h>
+#include "Inflate.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define FASTBITS		10				// codes up to this long are decoded with one lookup
+#define MAXBITS			15
+#define MAXLITLEN		288
+#define MAXDIST			32
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+// Canonical Huffman code. fast holds the symbol and code length for every FASTBITS
+// bit pattern that starts with a short enough code, 0 for the others.
+struct Huffman {
+	ushort		fast[1 << FASTBITS];
+	ushort		counts[MAXBITS + 1];	// number of codes of each length
+	ushort		symbols[MAXLITLEN];		// ordered by code
+};
+
+
+// Bits are read from the least significant end of each byte. Past the end zeros are
+// read, p keeps counting so p - count/8 is always the next unread byte.
+struct BitReader {
+	const uchar	*p, *end;
+	uint64		bits;
+	int			count;
+};
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+static const ushort lengthBase[29] = {
+	3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+	35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+static const uchar lengthExtra[29] = {
+	0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+static const ushort distBase[30] = {
+	1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+	257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+static const uchar distExtra[30] = {
+	0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+static const uchar codeLengthOrder[19] = {
+	16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+static __inline void refill(BitReader &br)
+{
+	while (br.count <= 56) {
+		if (br.p < br.end) br.bits |= (uint64)*br.p << br.count;
+		br.p++;
+		br.count += 8;
+	}
+}
+
+
+static __inline uint32 getBits(BitReader &br, int n)
+{
+	if (n == 0) return 0;
+	if (br.count < n) refill(br);
+	uint32 v = (uint32)(br.bits & ((1ull << n) - 1));
+	br.bits >>= n;
+	br.count -= n;
+	return v;
+}
+
+
+static bool buildHuffman(Huffman &h, const uchar *lengths, int n)
+{
+	memset(h.counts, 0, sizeof(h.counts));
+	memset(h.fast, 0, sizeof(h.fast));
+	for (int s = 0; s < n; s++) h.counts[lengths[s]]++;
+	h.counts[0] = 0;
+
+	// more codes than lengths allow
+	int left = 1;
+	for (int len = 1; len <= MAXBITS; len++) {
+		left <<= 1;
+		left -= h.counts[len];
+		if (left < 0) return false;
+	}
+
+	ushort offsets[MAXBITS + 2];
+	offsets[1] = 0;
+	for (int len = 1; len <= MAXBITS; len++) offsets[len+1] = offsets[len] + h.counts[len];
+	for (int s = 0; s < n; s++) {
+		if (lengths[s]) h.symbols[offsets[lengths[s]]++] = (ushort)s;
+	}
+
+	// canonical codes in order, bit reversed since deflate sends them high bit first
+	int code = 0, index = 0;
+	for (int len = 1; len <= FASTBITS; len++) {
+		for (int c = 0; c < h.counts[len]; c++, code++, index++) {
+			int reversed = 0;
+			for (int b = 0; b < len; b++) reversed |= ((code >> b) & 1) << (len - 1 - b);
+			for (int fill = reversed; fill < (1 << FASTBITS); fill += 1 << len) {
+				h.fast[fill] = (ushort)((len << 9) | h.symbols[index]);
+			}
+		}
+		code <<= 1;
+	}
+	return true;
+}
+
+
+static __inline int decodeSymbol(BitReader &br, const Huffman &h)
+{
+	if (br.count < MAXBITS) refill(br);
+
+	ushort entry = h.fast[br.bits & ((1 << FASTBITS) - 1)];
+	if (entry) {
+		int len = entry >> 9;
+		br.bits >>= len;
+		br.count -= len;
+		return entry & 0x1FF;
+	}
+
+	// longer codes, one bit at a time
+	int code = 0, first = 0, index = 0;
+	for (int len = 1; len <= MAXBITS; len++) {
+		code |= getBits(br, 1);
+		int count = h.counts[len];
+		if (code - first < count) return h.symbols[index + (code - first)];
+		index += count;
+		first = (first + count) << 1;
+		code <<= 1;
+	}
+	return -1;
+}
+
+
+static bool readDynamicTables(BitReader &br, Huffman &litLen, Huffman &dist)
+{
+	int numLitLen = getBits(br, 5) + 257;
+	int numDist = getBits(br, 5) + 1;
+	int numCodeLen = getBits(br, 4) + 4;
+	if (numLitLen > 286 || numDist > 30) return false;
+
+	uchar lengths[MAXLITLEN + MAXDIST];
+	memset(lengths, 0, 19);
+	for (int c = 0; c < numCodeLen; c++) lengths[codeLengthOrder[c]] = (uchar)getBits(br, 3);
+
+	Huffman codeLen;
+	if (!buildHuffman(codeLen, lengths, 19)) return false;
+
+	int total = numLitLen + numDist;
+	for (int c = 0; c < total; ) {
+		int sym = decodeSymbol(br, codeLen);
+		if (sym < 0) return false;
+
+		if (sym < 16) {
+			lengths[c++] = (uchar)sym;
+			continue;
+		}
+
+		int repeat;
+		uchar value = 0;
+		if (sym == 16) {
+			if (c == 0) return false;
+			value = lengths[c-1];
+			repeat = 3 + getBits(br, 2);
+		} else if (sym == 17) {
+			repeat = 3 + getBits(br, 3);
+		} else {
+			repeat = 11 + getBits(br, 7);
+		}
+		if (c + repeat > total) return false;
+		while (repeat--) lengths[c++] = value;
+	}
+
+	if (lengths[256] == 0) return false;	// no end of block code
+	return buildHuffman(litLen, lengths, numLitLen) && buildHuffman(dist, lengths + numLitLen, numDist);
+}
+
+
+static bool buildFixedTables(Huffman &litLen, Huffman &dist)
+{
+	uchar lengths[MAXLITLEN];
+	int s = 0;
+	for (; s < 144; s++) lengths[s] = 8;
+	for (; s < 256; s++) lengths[s] = 9;
+	for (; s < 280; s++) lengths[s] = 7;
+	for (; s < 288; s++) lengths[s] = 8;
+	if (!buildHuffman(litLen, lengths, 288)) return false;
+
+	for (s = 0; s < 30; s++) lengths[s] = 5;
+	return buildHuffman(dist, lengths, 30);
+}
+
+
+uint32 updateAdler32(uint32 adler, const uchar *data, int64 length)
+{
+	uint32 a = adler & 0xFFFF, b = adler >> 16;
+
+	// 5552 bytes is the most that can be summed before the 32 bit sums could overflow
+	while (length > 0) {
+		int n = (length > 5552) ? 5552 : (int)length;
+		length -= n;
+		while (n--) {
+			a += *data++;
+			b += a;
+		}
+		a %= 65521;
+		b %= 65521;
+	}
+	return (b << 16) | a;
+}
+
+
+bool zlibInflate(const uchar *in, int64 inSize, uchar *out, int64 outCapacity, int64 &outSize)
+{
+	outSize = 0;
+
+	// deflate method, 32k window at most, header check, no preset dictionary
+	if (inSize < 6 || (in[0] & 0x0F) != 8 || (in[0] >> 4) > 7 ||
+		((in[0] << 8) | in[1]) % 31 != 0 || (in[1] & 0x20))
+	{
+		return false;
+	}
+
+	BitReader br;
+	br.p = in + 2;
+	br.end = in + inSize - 4;
+	br.bits = 0;
+	br.count = 0;
+
+	uchar *op = out, *oend = out + outCapacity;
+	Huffman litLen, dist;
+	bool last = false;
+
+	while (!last) {
+		last = getBits(br, 1) != 0;
+		int type = getBits(br, 2);
+
+		if (type == 0) {
+			// stored block, the bit buffer is emptied back to the byte boundary
+			br.bits >>= br.count & 7;
+			br.count -= br.count & 7;
+			uint32 len = getBits(br, 16);
+			uint32 nlen = getBits(br, 16);
+			if ((len ^ 0xFFFF) != nlen) return false;
+
+			// bytes still in the bit buffer come first
+			while (len > 0 && br.count >= 8) {
+				if (op >= oend) return false;
+				*op++ = (uchar)getBits(br, 8);
+				len--;
+			}
+			const uchar *src = br.p - br.count / 8;
+			if (len > 0) {
+				if ((int64)len > br.end - src || (int64)len > oend - op) return false;
+				memcpy(op, src, len);
+				op += len;
+				br.p = src + len;
+				br.bits = 0;
+				br.count = 0;
+			}
+			continue;
+		}
+
+		if (type == 1) {
+			if (!buildFixedTables(litLen, dist)) return false;
+		} else if (type == 2) {
+			if (!readDynamicTables(br, litLen, dist)) return false;
+		} else {
+			return false;
+		}
+
+		for (;;) {
+			int sym = decodeSymbol(br, litLen);
+			if (sym < 256) {
+				if (sym < 0 || op >= oend) return false;
+				*op++ = (uchar)sym;
+				continue;
+			}
+			if (sym == 256) break;
+
+			sym -= 257;
+			if (sym >= 29) return false;
+			int length = lengthBase[sym] + getBits(br, lengthExtra[sym]);
+
+			int dsym = decodeSymbol(br, dist);
+			if (dsym < 0 || dsym >= 30) return false;
+			int distance = distBase[dsym] + getBits(br, distExtra[dsym]);
+
+			if (distance > op - out || length > oend - op) return false;
+
+			// the copy may overlap its own output, so it goes byte by byte when close
+			const uchar *from = op - distance;
+			if (distance >= length) {
+				memcpy(op, from, length);
+				op += length;
+			} else {
+				while (length--) *op++ = *from++;
+			}
+		}
+
+		// stopped decoding past the end of the data
+		if (br.p - br.count / 8 > br.end) return false;
+	}
+
+	// the bit buffer may have read ahead into the adler32
+	const uchar *trailer = br.p - br.count / 8;
+	if (trailer > br.end) return false;
+	uint32 adler = ((uint32)trailer[0] << 24) | ((uint32)trailer[1] << 16) | ((uint32)trailer[2] << 8) | trailer[3];
+
+	outSize = op - out;
+	return updateAdler32(1, out, outSize) == adler;
+}
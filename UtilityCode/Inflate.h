@@ -0,0 +1,31 @@
+//	----==== INFLATE.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Decompressor for zlib streams (RFC 1950) of deflate blocks (RFC 1951),
+//					as used by PNG. Stored, fixed Huffman and dynamic Huffman blocks are
+//					supported. Codes up to 10 bits long, which are nearly all of them, are
+//					decoded with one table lookup, longer ones bit by bit. The whole output
+//					goes to one buffer whose size the caller knows in advance.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef INFLATE_H
+#define INFLATE_H
+
+#include "Typedefs.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+// Returns false if the stream is corrupt, its adler32 does not match, or the output does
+// not fit. outSize receives the number of bytes written.
+bool	zlibInflate(const uchar *in, int64 inSize, uchar *out, int64 outCapacity, int64 &outSize);
+
+// zlib checksum of the uncompressed data, start with 1
+uint32	updateAdler32(uint32 adler, const uchar *data, int64 length);
+
+#endif
@@ -10,7 +10,7 @@
 //					corrects for different keyboard layouts and character sets.
 //	----------------------------------------------------------------------------
 
-#include "keyboardmanager.h"
+#include "KeyboardManager.h"
 
 /*-----------------
 ---- FUNCTIONS ----
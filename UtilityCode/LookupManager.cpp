@@ -19,7 +19,10 @@
 
 
 #include <math.h>
-#include "lookupmanager.h"
+#include <stdio.h>
+#include <string.h>
+#include "LookupManager.h"
+#include "SIMD.h"
 
 ////////// class LookupManager //////////
 
@@ -31,7 +34,9 @@
 //	should be considered out of the norm. In a debug build the program
 //	asserts the value of precision.
 //-----------------------------------------------------------------------
-LookupManager::LookupManager(unsigned int precision) : Singleton<LookupManager>(*this),
+LookupManager::LookupManager(unsigned int precision, TrigMode mode, const char *tableFile) : Singleton<LookupManager>(*this),
+	sinTable(0), cosTable(0), tanTable(0), quarterTable(0), quarterSteps(0), quarterScale(0),
+	radiansPerIndex(0),
 	ANGLE360(precision*360),
 	ANGLE315(precision*315),
 	ANGLE271(precision*271),
@@ -58,27 +63,158 @@ LookupManager::LookupManager(unsigned int precision) : Singleton<LookupManager>(
 
 	anglePrecision = precision;
 	angleIncrement = 1.0f / (float)precision;
+	radiansPerIndex = angleIncrement * DEGTORAD;
 
-	// set up the lookup tables
-	sinTable = new float[ANGLE360];
-	cosTable = new float[ANGLE360];
-	tanTable = new float[ANGLE360];
+	setTrigMode(mode, tableFile);
+}
+
+
+void LookupManager::setTrigMode(TrigMode mode, const char *tableFile)
+{
+	freeTables();
+	trigMode = mode;
+
+	if (mode == TRIG_FULLTABLES) {
+		// set up the lookup tables
+		sinTable = new float[ANGLE360];
+		cosTable = new float[ANGLE360];
+		tanTable = new float[ANGLE360];
+
+		if (tableFile && loadTables(tableFile)) return;
+
+		float angleFix = angleIncrement * DEGTORAD;
+		for (int a = 0; a < ANGLE360; a++) {
 
-	float angleFix = angleIncrement * DEGTORAD;
-	for (int a = 0; a < ANGLE360; a++) {
+			sinTable[a] = sinf((float)a * angleFix);
+			cosTable[a] = cosf((float)a * angleFix);
 
-		sinTable[a] = sinf((float)a * angleFix);
-		cosTable[a] = cosf((float)a * angleFix);
+			if (a == ANGLE90 || a == ANGLE270) tanTable[a] = INFINITY;
+			else tanTable[a] = tanf((float)a * angleFix);
+		}
 
-		if (a == ANGLE90 || a == ANGLE270) tanTable[a] = INFINITY;
-		else tanTable[a] = tanf((float)a * angleFix);
+		if (tableFile) saveTables(tableFile);
+
+	} else if (mode == TRIG_QUARTERLINEAR) {
+		quarterTable = quarterLinearTable.v;
+		quarterSteps = QUARTER_LINEAR_STEPS;
+		quarterScale = (float)quarterSteps / (float)ANGLE90;
+
+	} else if (mode == TRIG_QUARTERCUBIC) {
+		quarterTable = quarterCubicTable.v;
+		quarterSteps = QUARTER_CUBIC_STEPS;
+		quarterScale = (float)quarterSteps / (float)ANGLE90;
 	}
 }
 
 
-LookupManager::~LookupManager()
+//-----------------------------------------------------------------------
+//	The file holds an "LMTB" tag, the version, the precision and the
+//	sin, cos and tan tables in that order, in the byte order of the
+//	machine that wrote it. A file written with another precision or
+//	version is rejected and the tables are left unchanged.
+//-----------------------------------------------------------------------
+bool LookupManager::loadTables(const char *filename)
+{
+	msgAssert(trigMode == TRIG_FULLTABLES, "LookupMgr: no full tables to load");
+
+	FILE *in = fopen(filename, "rb");
+	if (!in) return false;
+
+	char tag[4];
+	int header[2];
+	bool valid = (fread(tag, 1, 4, in) == 4 && memcmp(tag, "LMTB", 4) == 0 &&
+				  fread(header, sizeof(int), 2, in) == 2 &&
+				  header[0] == TRIGFILE_VERSION && header[1] == anglePrecision);
+
+	// read into a temporary block so a short file leaves the old values in place
+	if (valid) {
+		float *temp = new float[ANGLE360 * 3];
+		valid = (fread(temp, sizeof(float), ANGLE360 * 3, in) == (size_t)(ANGLE360 * 3));
+
+		if (valid) {
+			memcpy(sinTable, temp, ANGLE360 * sizeof(float));
+			memcpy(cosTable, temp + ANGLE360, ANGLE360 * sizeof(float));
+			memcpy(tanTable, temp + ANGLE360*2, ANGLE360 * sizeof(float));
+		}
+		delete [] temp;
+	}
+
+	fclose(in);
+	return valid;
+}
+
+
+bool LookupManager::saveTables(const char *filename) const
+{
+	msgAssert(trigMode == TRIG_FULLTABLES, "LookupMgr: no full tables to save");
+
+	FILE *out = fopen(filename, "wb");
+	if (!out) return false;
+
+	int header[2] = { TRIGFILE_VERSION, anglePrecision };
+	bool success = (fwrite("LMTB", 1, 4, out) == 4 &&
+					fwrite(header, sizeof(int), 2, out) == 2 &&
+					fwrite(sinTable, sizeof(float), ANGLE360, out) == (size_t)ANGLE360 &&
+					fwrite(cosTable, sizeof(float), ANGLE360, out) == (size_t)ANGLE360 &&
+					fwrite(tanTable, sizeof(float), ANGLE360, out) == (size_t)ANGLE360);
+
+	if (fclose(out) != 0) success = false;
+	return success;
+}
+
+
+int LookupManager::getTableBytes(void) const
+{
+	if (trigMode == TRIG_FULLTABLES) return ANGLE360 * 3 * sizeof(float);
+	if (trigMode == TRIG_POLYNOMIAL) return 0;
+	return (quarterSteps + 1) * sizeof(float);
+}
+
+
+//-----------------------------------------------------------------------
+//	In polynomial mode the lookups are converted to radians in blocks that
+//	fit on the stack and passed to the vectorized fastSinCos
+//-----------------------------------------------------------------------
+void LookupManager::getSinCos(const int *lookups, float *sinOut, float *cosOut, int count) const
+{
+	if (trigMode != TRIG_POLYNOMIAL) {
+		for (int i = 0; i < count; ++i) {
+			getSinCos(lookups[i], sinOut[i], cosOut[i]);
+		}
+		return;
+	}
+
+	float angles[256];
+
+	for (int start = 0; start < count; start += 256) {
+		int n = (count - start < 256) ? count - start : 256;
+
+		int i = 0;
+		for (; i + SIMD_LANES <= n; i += SIMD_LANES) {
+			vstoreu(angles + i, vmul(vloadi(lookups + start + i), vset1(radiansPerIndex)));
+		}
+		for (; i < n; ++i) {
+			angles[i] = (float)lookups[start+i] * radiansPerIndex;
+		}
+
+		fastSinCos(angles, sinOut + start, cosOut + start, n);
+	}
+}
+
+
+void LookupManager::freeTables(void)
 {
 	delete [] sinTable;
 	delete [] cosTable;
 	delete [] tanTable;
-}
\ No newline at end of file
+	sinTable = cosTable = tanTable = 0;
+	quarterTable = 0;			// points to a static table, not allocated
+	quarterSteps = 0;
+	quarterScale = 0;
+}
+
+
+LookupManager::~LookupManager()
+{
+	freeTables();
+}
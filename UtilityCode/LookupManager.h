@@ -15,14 +15,35 @@
 //					to 1 degree in the original. There are functions provided for
 //					converting intuitive values based on 360 degrees to the actual
 //					values needed for the lookup tables.
+//
+//					The tables can be stored in one of three modes. TRIG_FULLTABLES keeps
+//					separate sin, cos and tan tables of ANGLE360 floats each (about 340 KB
+//					at precision 80). The two compact modes keep a single table of the
+//					first quarter of the sine wave at a coarser step and fold every angle
+//					into it by symmetry, cos and tan are derived from it. The values
+//					between table entries are interpolated, linearly from a 2048 step
+//					table (8 KB) or with a cubic Hermite curve from a 64 step table
+//					(260 bytes), which uses the mirrored entries as the derivative. Both
+//					are within 2e-7 of the exact values, as accurate as the full tables.
+//					TRIG_POLYNOMIAL uses no table at all, the values are calculated with
+//					the polynomials in fasttrig.h, which are usually faster than a table
+//					lookup that misses the cache and vectorize in the batch functions.
+//
+//					The quarter wave tables are generated at compile time (trigtables.h),
+//					so the compact modes do no work at startup. The full tables can be
+//					cached in a binary file given to the constructor, they are loaded
+//					from it when it matches the precision and written to it otherwise.
 //	--------------------------------------------------------------------------------
 
 
 #ifndef LOOKUPMANAGER_H
 #define LOOKUPMANAGER_H
 
-#include "singleton.h"
-#include "msgassert.h"
+#include "Singleton.h"
+#include "MsgAssert.h"
+#include "FastTrig.h"
+#include "TrigTables.h"
+#include "BinAngle.h"
 
 /*---------------
 ---- DEFINES ----
@@ -34,7 +55,19 @@
 
 #define PI				3.14159265358979f
 #define DEGTORAD		0.01745329252f		// convert degrees to radians
-#define INFINITY		2147483648.0f		// highest value for a 32 bit signed float
+#if !defined(INFINITY)								// C99 math.h defines it as the true infinity
+	#define INFINITY	2147483648.0f		// highest value for a 32 bit signed float
+#endif
+
+#define TRIGFILE_VERSION		1			// version of the binary table file written by saveTables
+
+
+enum TrigMode {
+	TRIG_FULLTABLES = 0,		// sin, cos and tan tables covering 360 degrees
+	TRIG_QUARTERLINEAR,			// quarter wave sine table, linear interpolation
+	TRIG_QUARTERCUBIC,			// quarter wave sine table, cubic Hermite interpolation
+	TRIG_POLYNOMIAL				// no tables, minimax polynomials from fasttrig.h
+};
 
 
 /*------------------
@@ -49,9 +82,20 @@ class LookupManager : public Singleton<LookupManager>
 
 		int		anglePrecision;		// stores precision of lookup tables - will be (1/anglePrecision) of a degree
 		float	angleIncrement;		// = (1 / anglePrecision), or the decimal increment of the lookup precision
-		float	*sinTable;
+		TrigMode trigMode;
+		float	*sinTable;			// full tables, only allocated in TRIG_FULLTABLES mode
 		float	*cosTable;
 		float	*tanTable;
+		const float *quarterTable;	// sin from 0 to 90 degrees, one of the static tables in the compact modes
+		int		quarterSteps;		// number of steps in quarterTable, it holds quarterSteps+1 values
+		float	quarterScale;		// converts a lookup index in the first quadrant to a table step
+		float	radiansPerIndex;	// converts a lookup index to radians for TRIG_POLYNOMIAL
+
+		///// Functions
+
+		__inline float	quarterSin(int lookup) const;
+		__inline float	compactSin(int lookup) const;
+		void			freeTables(void);
 
 	public:
 
@@ -64,23 +108,44 @@ class LookupManager : public Singleton<LookupManager>
 
 		// Accessors
 
-		const float &	getSinTable(void) const { return *sinTable; }
-		const float &	getCosTable(void) const { return *cosTable; }
-		const float &	getTanTable(void) const { return *tanTable; }
+		// the full tables exist only in TRIG_FULLTABLES mode
+		const float &	getSinTable(void) const { msgAssert(sinTable, "LookupMgr: no full tables"); return *sinTable; }
+		const float &	getCosTable(void) const { msgAssert(cosTable, "LookupMgr: no full tables"); return *cosTable; }
+		const float &	getTanTable(void) const { msgAssert(tanTable, "LookupMgr: no full tables"); return *tanTable; }
 
+		TrigMode		getTrigMode(void) const { return trigMode; }
+		int				getTableBytes(void) const;	// memory used by the tables in the current mode
 		int				getAnglePrec(void) const { return anglePrecision; }
 		float			getAngleInc(void) const { return angleIncrement; }
 
 		__inline float	getSin(int lookup) const;
 		__inline float	getCos(int lookup) const;
 		__inline float	getTan(int lookup) const;
+		__inline void	getSinCos(int lookup, float &sinOut, float &cosOut) const;
+
+		// Batch versions, vectorized in TRIG_POLYNOMIAL mode. The arrays need not be aligned
+		void			getSinCos(const int *lookups, float *sinOut, float *cosOut, int count) const;
 
 		// Note that these functions do not recognize negative angles or angles > 360
 		__inline int	degToIndex(float degree) const;
 		__inline int	degToIndex(int degree) const;
 		__inline float	indexToDeg(int index) const;
 
-		explicit LookupManager(unsigned int precision);
+		// Conversion from/to binary angles, which wrap around so any angle is valid. binToIndex
+		// is a multiply and a shift and always returns an index below ANGLE360
+		int				binToIndex(BinAngle a) const { return a.toIndex(ANGLE360); }
+		__inline BinAngle indexToBin(int index) const;
+
+		// Rebuilds the tables in another mode, any previously returned table pointers become invalid.
+		// If tableFile is given, the full tables are loaded from it, or computed and saved to it
+		// when it does not exist or was written with another precision
+		void			setTrigMode(TrigMode mode, const char *tableFile = 0);
+
+		// Read or write the full tables as a binary file, only valid in TRIG_FULLTABLES mode
+		bool			loadTables(const char *filename);
+		bool			saveTables(const char *filename) const;
+
+		explicit LookupManager(unsigned int precision, TrigMode mode = TRIG_FULLTABLES, const char *tableFile = 0);
 		~LookupManager();
 };
 
@@ -92,11 +157,44 @@ class LookupManager : public Singleton<LookupManager>
 ////////// class LookupManager //////////
 
 
+//-----------------------------------------------------------------------
+//	Sine of a lookup index between 0 and ANGLE90 inclusive, interpolated
+//	from the quarter wave table
+//-----------------------------------------------------------------------
+__inline float LookupManager::quarterSin(int lookup) const
+{
+	float t = (float)lookup * quarterScale;
+
+	if (trigMode == TRIG_QUARTERLINEAR) return quarterSinLinear(quarterTable, quarterSteps, t);
+	return quarterSinCubic(quarterTable, quarterSteps, t);
+}
+
+
+//-----------------------------------------------------------------------
+//	Folds any lookup index into the first quadrant using the symmetry of
+//	the sine wave: the second and fourth quadrants are mirrored and the
+//	third and fourth are negated
+//-----------------------------------------------------------------------
+__inline float LookupManager::compactSin(int lookup) const
+{
+	// compares instead of dividing by ANGLE90, which is not a compile time constant
+	int r = lookup;
+	int quadrant = 0;
+	if (r >= ANGLE180) { r -= ANGLE180; quadrant = 2; }
+	if (r >= ANGLE90) { r = ANGLE180 - r; quadrant |= 1; }
+
+	float s = quarterSin(r);
+	return (quadrant & 2) ? -s : s;
+}
+
+
 __inline float LookupManager::getSin(int lookup) const
 {
 	msgAssert(lookup >= 0 && lookup < ANGLE360, "LookupMgr: sinTable out of bounds");
 
-	return sinTable[lookup];
+	if (trigMode == TRIG_FULLTABLES) return sinTable[lookup];
+	if (trigMode == TRIG_POLYNOMIAL) return fastSin((float)lookup * radiansPerIndex);
+	return compactSin(lookup);
 }
 
 
@@ -104,7 +202,12 @@ __inline float LookupManager::getCos(int lookup) const
 {
 	msgAssert(lookup >= 0 && lookup < ANGLE360, "LookupMgr: cosTable out of bounds");
 
-	return cosTable[lookup];
+	if (trigMode == TRIG_FULLTABLES) return cosTable[lookup];
+	if (trigMode == TRIG_POLYNOMIAL) return fastCos((float)lookup * radiansPerIndex);
+
+	lookup += ANGLE90;
+	if (lookup >= ANGLE360) lookup -= ANGLE360;
+	return compactSin(lookup);
 }
 
 
@@ -112,7 +215,23 @@ __inline float LookupManager::getTan(int lookup) const
 {
 	msgAssert(lookup >= 0 && lookup < ANGLE360, "LookupMgr: tanTable out of bounds");
 
-	return tanTable[lookup];
+	if (trigMode == TRIG_FULLTABLES) return tanTable[lookup];
+
+	if (lookup == ANGLE90 || lookup == ANGLE270) return INFINITY;
+	return getSin(lookup) / getCos(lookup);
+}
+
+
+__inline void LookupManager::getSinCos(int lookup, float &sinOut, float &cosOut) const
+{
+	msgAssert(lookup >= 0 && lookup < ANGLE360, "LookupMgr: lookup out of bounds");
+
+	if (trigMode == TRIG_POLYNOMIAL) {
+		fastSinCos((float)lookup * radiansPerIndex, sinOut, cosOut);
+	} else {
+		sinOut = getSin(lookup);
+		cosOut = getCos(lookup);
+	}
 }
 
 
@@ -137,4 +256,13 @@ __inline float LookupManager::indexToDeg(int index) const
 	return (float)index * angleIncrement;
 }
 
+
+// rounded up, so that binToIndex returns the same index
+__inline BinAngle LookupManager::indexToBin(int index) const
+{
+	unsigned long long scaled = ((unsigned long long)index << 32) + (unsigned int)(ANGLE360 - 1);
+	return BinAngle((unsigned int)(scaled / (unsigned int)ANGLE360));
+}
+
+
 #endif
\ No newline at end of file
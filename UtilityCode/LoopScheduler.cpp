@@ -0,0 +1,201 @@
+//	----==== LOOPSCHEDULER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Main loop scheduler with a fixed simulation step
+//	--------------------------------------------------------------------------------
+
+
+#include <chrono>
+#include "LoopScheduler.h"
+#include "HiResTimer.h"
+#include "Profiler.h"
+#include "MsgAssert.h"
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class LoopScheduler //////////
+
+
+void LoopScheduler::runSteps(int steps)
+{
+	for (int s = 0; s < steps; ++s) {
+		PROFILE_ZONE("update");
+		updateFunc(stepSeconds);
+		updateCount++;
+	}
+}
+
+
+//-----------------------------------------------------------------------
+//	Whole steps are taken out of the accumulator. When the machine cannot
+//	keep up, the steps over maxSteps are dropped instead of carried over,
+//	otherwise each slow frame would make the next one slower still.
+//-----------------------------------------------------------------------
+void LoopScheduler::frame(void)
+{
+	frameStart = getTicks();
+
+	int64 elapsed = frameStart - lastTime;
+	lastTime = frameStart;
+
+	int64 maxElapsed = (int64)(LOOP_MAXFRAMETIME * (double)getTickFrequency());
+	if (elapsed > maxElapsed) elapsed = maxElapsed;
+
+	accumulator += elapsed;
+	int steps = (int)(accumulator / stepTicks);
+	if (steps > maxSteps) {
+		steps = maxSteps;
+		accumulator = stepTicks * maxSteps;
+	}
+	accumulator -= stepTicks * steps;
+	float frameAlpha = (float)accumulator / (float)stepTicks;
+
+	if (!threaded) {
+		runSteps(steps);
+		alpha = frameAlpha;
+		{
+			PROFILE_ZONE("sync");
+			if (syncFunc) syncFunc();
+		}
+
+	} else {
+		std::unique_lock<std::mutex> lock(workerLock);
+		{
+			PROFILE_ZONE("waitForUpdate");
+			workerSignal.wait(lock, [this] { return !workerBusy; });
+		}
+
+		// the worker is idle, so the state after the last batch of steps can be copied
+		{
+			PROFILE_ZONE("sync");
+			if (syncFunc) syncFunc();
+		}
+		alpha = pendingAlpha;
+
+		pendingSteps = steps;
+		pendingAlpha = frameAlpha;
+		workerBusy = true;
+		lock.unlock();
+		workerSignal.notify_all();
+	}
+
+	{
+		PROFILE_ZONE("render");
+		renderFunc(alpha);
+	}
+
+	pace();
+}
+
+
+//-----------------------------------------------------------------------
+//	Sleeps are only accurate to a millisecond or more (15ms on Windows by
+//	default), so the last millisecond is spent yielding instead
+//-----------------------------------------------------------------------
+void LoopScheduler::pace(void)
+{
+	if (frameTicks == 0) return;
+
+	PROFILE_ZONE("pace");
+
+	int64 frameEnd = frameStart + frameTicks;
+	int64 oneMs = getTickFrequency() / 1000;
+
+	int64 remaining = frameEnd - getTicks();
+	if (remaining > oneMs * 2) {
+		std::this_thread::sleep_for(std::chrono::microseconds(
+				(long long)(ticksToMicroseconds(remaining - oneMs))));
+	}
+
+	while (getTicks() < frameEnd) {
+		std::this_thread::yield();
+	}
+}
+
+
+void LoopScheduler::workerMain(void)
+{
+	if (Profiler::exists()) profiler.setThreadName("Update");
+
+	std::unique_lock<std::mutex> lock(workerLock);
+
+	for (;;) {
+		// steps already handed over are run before quitting, they go with pendingAlpha
+		workerSignal.wait(lock, [this] { return workerBusy || workerQuit; });
+		if (!workerBusy) break;
+
+		int steps = pendingSteps;
+		lock.unlock();
+		runSteps(steps);
+		lock.lock();
+
+		workerBusy = false;
+		workerSignal.notify_all();
+	}
+}
+
+
+void LoopScheduler::resetTime(void)
+{
+	lastTime = getTicks();
+}
+
+
+void LoopScheduler::setFrameCap(float fps)
+{
+	frameTicks = (fps > 0) ? (int64)((double)getTickFrequency() / (double)fps) : 0;
+}
+
+
+void LoopScheduler::setThreaded(bool enable)
+{
+	if (enable == threaded) return;
+
+	if (enable) {
+		workerBusy = false;
+		workerQuit = false;
+		pendingSteps = 0;
+		pendingAlpha = alpha;
+		worker = std::thread(&LoopScheduler::workerMain, this);
+
+	} else {
+		{
+			std::lock_guard<std::mutex> lock(workerLock);
+			workerQuit = true;
+		}
+		workerSignal.notify_all();
+		worker.join();
+
+		// the worker may have run steps that were never synced
+		if (syncFunc) syncFunc();
+		alpha = pendingAlpha;
+	}
+
+	threaded = enable;
+}
+
+
+LoopScheduler::LoopScheduler(LoopUpdateFunc update, LoopSyncFunc sync, LoopRenderFunc render,
+							 double _stepSeconds) :
+	updateFunc(update), syncFunc(sync), renderFunc(render), stepSeconds(_stepSeconds),
+	accumulator(0), frameTicks(0), frameStart(0), maxSteps(LOOP_MAXSTEPS), updateCount(0),
+	alpha(0), pendingSteps(0), pendingAlpha(0), workerBusy(false), workerQuit(false), threaded(false)
+{
+	msgAssert(update && render, "LoopScheduler: update and render functions are required");
+	msgAssert(_stepSeconds > 0, "LoopScheduler: step must be positive");
+
+	stepTicks = (int64)(_stepSeconds * (double)getTickFrequency());
+	if (stepTicks < 1) stepTicks = 1;
+	lastTime = getTicks();
+}
+
+
+LoopScheduler::~LoopScheduler()
+{
+	setThreaded(false);
+}
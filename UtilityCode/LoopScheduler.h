@@ -0,0 +1,123 @@
+//	----==== LOOPSCHEDULER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Main loop scheduler with a fixed simulation step. Real time is added
+//					to an accumulator each frame and the update function is called once
+//					for every whole step in it, so the simulation runs at the same rate
+//					on any machine. The remainder, as a fraction of a step, is passed to
+//					the render function to interpolate between the last two simulation
+//					states. The frame rate can be capped, the scheduler sleeps for most
+//					of the remaining frame time and spins for the last millisecond.
+//
+//					In threaded mode the update steps run on a worker thread while the
+//					main thread renders the previous state. The sync function is called
+//					on the main thread while the worker is idle, and should copy the
+//					simulation state to the render state. Rendering lags the simulation
+//					by one frame in this mode. Without threading the three functions
+//					are simply called in order.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef LOOPSCHEDULER_H
+#define LOOPSCHEDULER_H
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include "Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define LOOP_MAXSTEPS			5			// default limit of update steps per frame
+#define LOOP_MAXFRAMETIME		0.25		// seconds, longer frames are clamped (breakpoints, window drags)
+
+
+/*----------------
+---- TYPEDEFS ----
+----------------*/
+
+typedef void (*LoopUpdateFunc)(double stepSeconds);	// advance the simulation one fixed step
+typedef void (*LoopSyncFunc)(void);					// copy simulation state for rendering
+typedef void (*LoopRenderFunc)(float alpha);		// alpha from 0 to 1 between the last two states
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class LoopScheduler {
+
+	private:
+
+		///// Variables
+
+		LoopUpdateFunc		updateFunc;
+		LoopSyncFunc		syncFunc;
+		LoopRenderFunc		renderFunc;
+
+		double				stepSeconds;
+		int64				stepTicks;
+		int64				accumulator;		// ticks not yet simulated
+		int64				lastTime;
+		int64				frameTicks;			// minimum ticks per frame, 0 for no cap
+		int64				frameStart;
+		int					maxSteps;
+		std::atomic<int>	updateCount;		// steps run since the start, counted on the worker in threaded mode
+		float				alpha;
+
+		// worker thread for threaded mode
+		std::thread			worker;
+		std::mutex			workerLock;
+		std::condition_variable	workerSignal;
+		int					pendingSteps;		// steps given to the worker
+		float				pendingAlpha;		// alpha that goes with the state after those steps
+		bool				workerBusy;
+		bool				workerQuit;
+		bool				threaded;
+
+		///// Functions
+
+		void				workerMain(void);
+		void				runSteps(int steps);
+		void				pace(void);
+
+		// Make copy constructor and assignment operator private
+		LoopScheduler(const LoopScheduler &l);
+		LoopScheduler& operator=(const LoopScheduler &l);
+
+	public:
+
+		///// Accessors
+
+		double				getStepSeconds(void) const { return stepSeconds; }
+		float				getAlpha(void) const { return alpha; }
+		int					getUpdateCount(void) const { return updateCount; }
+		bool				isThreaded(void) const { return threaded; }
+
+		///// Functions
+
+		// Runs one frame: the update steps that are due, the sync and the render
+		void				frame(void);
+
+		// Forgets the time since the last frame, call after a pause so it is not simulated
+		void				resetTime(void);
+
+		void				setMaxSteps(int steps) { maxSteps = steps; }
+		void				setFrameCap(float fps);		// 0 for no cap
+		void				setThreaded(bool enable);	// starts or stops the worker thread
+
+		// Constructors / Destructor
+		explicit LoopScheduler(LoopUpdateFunc update, LoopSyncFunc sync, LoopRenderFunc render,
+							   double stepSeconds = 1.0 / 60.0);
+		~LoopScheduler();
+};
+
+
+#endif
@@ -0,0 +1,155 @@
+//	----==== MAPPEDFILE.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Read only memory mapped file
+//	--------------------------------------------------------------------------------
+
+
+#include "MappedFile.h"
+#include "Platform.h"
+
+#if defined(PLATFORM_WIN32)
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#elif defined(PLATFORM_POSIX)
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class MappedFile //////////
+
+
+#if defined(PLATFORM_WIN32)
+
+bool MappedFile::open(const char *filename)
+{
+	close();
+
+	HANDLE file = CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING,
+							  FILE_FLAG_RANDOM_ACCESS, 0);
+	if (file == INVALID_HANDLE_VALUE) return false;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+	if (!mapping) {
+		CloseHandle(file);
+		return false;
+	}
+
+	data = (const uchar *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+	if (!data) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mapHandle = mapping;
+	size = fileSize.QuadPart;
+	return true;
+}
+
+
+void MappedFile::close(void)
+{
+	if (data) UnmapViewOfFile(data);
+	if (mapHandle) CloseHandle((HANDLE)mapHandle);
+	if (fileHandle) CloseHandle((HANDLE)fileHandle);
+	data = 0;
+	mapHandle = fileHandle = 0;
+	size = 0;
+}
+
+
+// the pages are read on demand and the system drops unused ones itself
+void MappedFile::prefetch(int64 offset, int64 bytes) const {}
+void MappedFile::release(int64 offset, int64 bytes) const {}
+
+
+#elif defined(PLATFORM_POSIX)
+
+bool MappedFile::open(const char *filename)
+{
+	close();
+
+	int file = ::open(filename, O_RDONLY);
+	if (file < 0) return false;
+
+	struct stat st;
+	if (fstat(file, &st) != 0 || st.st_size == 0) {
+		::close(file);
+		return false;
+	}
+
+	void *mapping = mmap(0, (size_t)st.st_size, PROT_READ, MAP_SHARED, file, 0);
+	if (mapping == MAP_FAILED) {
+		::close(file);
+		return false;
+	}
+
+	// tiles are read in any order, read ahead would mostly fetch pages of other tiles
+	madvise(mapping, (size_t)st.st_size, MADV_RANDOM);
+
+	data = (const uchar *)mapping;
+	size = st.st_size;
+	fd = file;
+	return true;
+}
+
+
+void MappedFile::close(void)
+{
+	if (data) munmap((void *)data, (size_t)size);
+	if (fd >= 0) ::close(fd);
+	data = 0;
+	size = 0;
+	fd = -1;
+}
+
+
+//-----------------------------------------------------------------------------
+//	madvise needs page aligned addresses, the range is widened to whole pages
+//-----------------------------------------------------------------------------
+static void adviseRange(const uchar *data, int64 size, int64 offset, int64 bytes, int advice)
+{
+	if (!data || offset >= size || bytes <= 0) return;
+	if (offset + bytes > size) bytes = size - offset;
+
+	static const int64 pageSize = sysconf(_SC_PAGESIZE);
+	int64 start = offset - offset % pageSize;
+	madvise((void *)(data + start), (size_t)(offset + bytes - start), advice);
+}
+
+
+void MappedFile::prefetch(int64 offset, int64 bytes) const
+{
+	adviseRange(data, size, offset, bytes, MADV_WILLNEED);
+}
+
+
+// the mapping is read only, so dropped pages are simply read again from the file
+void MappedFile::release(int64 offset, int64 bytes) const
+{
+	adviseRange(data, size, offset, bytes, MADV_DONTNEED);
+}
+
+#endif
+
+
+MappedFile::MappedFile() :
+	data(0), size(0), fileHandle(0), mapHandle(0), fd(-1)
+{}
@@ -0,0 +1,64 @@
+//	----==== MAPPEDFILE.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Read only memory mapped file. The whole file is mapped, but the system
+//					only reads the pages that are touched and may drop them again under
+//					memory pressure, so files much larger than the memory can be used.
+//					prefetch and release tell the system which ranges will be needed soon
+//					and which are done with, where the platform supports it.
+//					CreateFileMapping on Windows, mmap on POSIX systems.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include "Typedefs.h"
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+class MappedFile {
+	private:
+
+		///// Variables
+
+		const uchar		*data;
+		int64			size;
+		void			*fileHandle;		// HANDLE of the file and mapping on Windows
+		void			*mapHandle;
+		int				fd;					// file descriptor on POSIX
+
+		// Make copy constructor and assignment operator private
+		MappedFile(const MappedFile &f);
+		MappedFile& operator=(const MappedFile &f);
+
+	public:
+
+		///// Accessors
+
+		const uchar *	getData(void) const		{ return data; }
+		int64			getSize(void) const		{ return size; }
+		bool			isOpen(void) const		{ return data != 0; }
+
+		///// Functions
+
+		bool			open(const char *filename);
+		void			close(void);
+
+		// Hints for the pages holding the byte range, ignored where not supported
+		void			prefetch(int64 offset, int64 bytes) const;
+		void			release(int64 offset, int64 bytes) const;
+
+		// Constructors / Destructor
+		MappedFile();
+		~MappedFile() { close(); }
+};
+
+
+#endif
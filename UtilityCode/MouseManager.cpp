@@ -10,7 +10,7 @@
 //	----------------------------------------------------------------------------
 
 
-#include "mousemanager.h"
+#include "MouseManager.h"
 
 
 /*-----------------
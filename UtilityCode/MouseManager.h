@@ -18,7 +18,7 @@
 #include <windows.h>
 #include <windowsx.h>
 #include <string>
-#include "singleton.h"
+#include "Singleton.h"
 
 /*---------------
 ---- DEFINES ----
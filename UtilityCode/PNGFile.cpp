@@ -0,0 +1,302 @@
+//	----==== PNGFILE.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Minimal PNG reader and writer
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "PNGFile.h"
+#include "Inflate.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define PNG_STOREDBLOCK		65535		// largest uncompressed deflate block
+#define PNG_MAXROWBYTES		0x40000000	// 1 GB, keeps row sizes well within an int
+#define PNG_MAXINFLATE		1032		// deflate cannot expand data by more than this
+#define PNG_MAXCHUNK		0x7FFFFFFF	// largest chunk length
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+static const uchar signature[8] = { 137, 'P', 'N', 'G', 13, 10, 26, 10 };
+
+static uint32 crcTable[256];
+static bool crcTableBuilt = false;
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+
+uint32 updateCRC32(uint32 crc, const uchar *data, int64 length)
+{
+	if (!crcTableBuilt) {
+		for (uint32 n = 0; n < 256; n++) {
+			uint32 c = n;
+			for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320 ^ (c >> 1) : c >> 1;
+			crcTable[n] = c;
+		}
+		crcTableBuilt = true;
+	}
+
+	for (int64 n = 0; n < length; n++) crc = crcTable[(crc ^ data[n]) & 0xFF] ^ (crc >> 8);
+	return crc;
+}
+
+
+static void putBigEndian(uchar *p, uint32 v)
+{
+	p[0] = (uchar)(v >> 24); p[1] = (uchar)(v >> 16); p[2] = (uchar)(v >> 8); p[3] = (uchar)v;
+}
+
+
+static uint32 getBigEndian(const uchar *p)
+{
+	return ((uint32)p[0] << 24) | ((uint32)p[1] << 16) | ((uint32)p[2] << 8) | p[3];
+}
+
+
+// writes the length, type, data and CRC of one chunk
+static bool writeChunk(FILE *f, const char *type, const uchar *data, uint32 length)
+{
+	uchar header[8];
+	putBigEndian(header, length);
+	memcpy(header + 4, type, 4);
+
+	uint32 crc = updateCRC32(0xFFFFFFFF, header + 4, 4);
+	crc = updateCRC32(crc, data, length) ^ 0xFFFFFFFF;
+	uchar crcBytes[4];
+	putBigEndian(crcBytes, crc);
+
+	return (fwrite(header, 1, 8, f) == 8 &&
+			(length == 0 || fwrite(data, 1, length, f) == length) &&
+			fwrite(crcBytes, 1, 4, f) == 4);
+}
+
+
+static int getChannels(int colorType)
+{
+	switch (colorType) {
+		case PNG_GRAY:		return 1;
+		case PNG_RGB:		return 3;
+		case PNG_GRAYALPHA:	return 2;
+		case PNG_RGBA:		return 4;
+	}
+	return 0;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Scanlines without filtering, the zlib stream holds stored deflate blocks
+//-----------------------------------------------------------------------------
+bool writePNG(const char *filename, int width, int height, int bitDepth, int colorType,
+			  const uchar *pixels)
+{
+	int channels = getChannels(colorType);
+	if (width <= 0 || height <= 0 || channels == 0 || (bitDepth != 8 && bitDepth != 16)) return false;
+
+	// raw scanlines, each starts with filter type 0. The image is written as one IDAT chunk, so
+	// larger images are refused.
+	size_t pixelBytes = (size_t)width * channels * (bitDepth / 8);
+	size_t rowBytes = pixelBytes + 1;
+	int64 rawSize = (int64)rowBytes * height;
+
+	// zlib header, stored blocks of up to 64k each with a 5 byte header, adler32
+	int64 numBlocks = (rawSize + PNG_STOREDBLOCK - 1) / PNG_STOREDBLOCK;
+	int64 zSize = 2 + rawSize + numBlocks * 5 + 4;
+	if (zSize > PNG_MAXCHUNK) return false;
+
+	FILE *f = fopen(filename, "wb");
+	if (!f) return false;
+
+	uchar *raw = new uchar[(size_t)rawSize];
+	for (int y = 0; y < height; y++) {
+		raw[(size_t)y * rowBytes] = 0;
+		memcpy(raw + (size_t)y * rowBytes + 1, pixels + (size_t)y * pixelBytes, pixelBytes);
+	}
+
+	uchar *z = new uchar[(size_t)zSize];
+	uchar *zp = z;
+
+	*zp++ = 0x78;
+	*zp++ = 0x01;
+
+	for (int64 pos = 0; pos < rawSize; pos += PNG_STOREDBLOCK) {
+		uint32 len = (uint32)(rawSize - pos);
+		if (len > PNG_STOREDBLOCK) len = PNG_STOREDBLOCK;
+
+		*zp++ = (pos + len == rawSize) ? 1 : 0;		// last block flag, type 0
+		*zp++ = (uchar)len;
+		*zp++ = (uchar)(len >> 8);
+		*zp++ = (uchar)~len;
+		*zp++ = (uchar)(~len >> 8);
+		memcpy(zp, raw + pos, len);
+		zp += len;
+	}
+	putBigEndian(zp, updateAdler32(1, raw, rawSize));
+
+	uchar ihdr[13];
+	putBigEndian(ihdr, width);
+	putBigEndian(ihdr + 4, height);
+	ihdr[8] = (uchar)bitDepth;
+	ihdr[9] = (uchar)colorType;
+	ihdr[10] = 0;		// deflate
+	ihdr[11] = 0;		// adaptive filtering
+	ihdr[12] = 0;		// no interlace
+
+	bool ok = (fwrite(signature, 1, 8, f) == 8 &&
+			   writeChunk(f, "IHDR", ihdr, 13) &&
+			   writeChunk(f, "IDAT", z, (uint32)zSize) &&
+			   writeChunk(f, "IEND", 0, 0));
+
+	delete [] z;
+	delete [] raw;
+	return (fclose(f) == 0) && ok;
+}
+
+
+static __inline int paeth(int a, int b, int c)
+{
+	int p = a + b - c;
+	int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+	if (pa <= pb && pa <= pc) return a;
+	return (pb <= pc) ? b : c;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Undoes the filter of each scanline in place, bpp is the distance in bytes
+//	to the same sample of the previous pixel
+//-----------------------------------------------------------------------------
+static bool unfilter(uchar *raw, int height, int rowBytes, int bpp)
+{
+	const uchar *prev = 0;
+
+	for (int y = 0; y < height; y++) {
+		uchar *row = raw + (size_t)y * (rowBytes + 1) + 1;
+		int filter = row[-1];
+
+		switch (filter) {
+			case 0:
+				break;
+			case 1:
+				for (int i = bpp; i < rowBytes; i++) row[i] = (uchar)(row[i] + row[i - bpp]);
+				break;
+			case 2:
+				if (prev) for (int i = 0; i < rowBytes; i++) row[i] = (uchar)(row[i] + prev[i]);
+				break;
+			case 3:
+				for (int i = 0; i < rowBytes; i++) {
+					int left = (i >= bpp) ? row[i - bpp] : 0;
+					int up = prev ? prev[i] : 0;
+					row[i] = (uchar)(row[i] + ((left + up) >> 1));
+				}
+				break;
+			case 4:
+				for (int i = 0; i < rowBytes; i++) {
+					int left = (i >= bpp) ? row[i - bpp] : 0;
+					int up = prev ? prev[i] : 0;
+					int upLeft = (prev && i >= bpp) ? prev[i - bpp] : 0;
+					row[i] = (uchar)(row[i] + paeth(left, up, upLeft));
+				}
+				break;
+			default:
+				return false;
+		}
+		prev = row;
+	}
+	return true;
+}
+
+
+bool readPNG(const uchar *data, int64 size, PNGImage &image, bool headerOnly)
+{
+	if (size < 8 + 25 || memcmp(data, signature, 8) != 0) return false;
+
+	// the first chunk must be the header
+	const uchar *p = data + 8, *end = data + size;
+	if (getBigEndian(p) != 13 || memcmp(p + 4, "IHDR", 4) != 0) return false;
+
+	image.width = (int)getBigEndian(p + 8);
+	image.height = (int)getBigEndian(p + 12);
+	image.bitDepth = p[16];
+	image.colorType = p[17];
+	image.channels = getChannels(image.colorType);
+	int interlace = p[20];
+
+	if (image.width <= 0 || image.height <= 0 || image.channels == 0 ||
+		(image.bitDepth != 8 && image.bitDepth != 16) || p[18] != 0 || p[19] != 0 || interlace != 0 ||
+		(int64)image.width * image.channels * (image.bitDepth / 8) > PNG_MAXROWBYTES)
+	{
+		return false;
+	}
+
+	// The image data may be split over any number of IDAT chunks. Their CRCs are not checked,
+	// the adler32 of the inflated data covers them and checking both would cost a third of
+	// the decode time.
+	std::vector<uchar> joined;
+	const uchar *z = 0;
+	int64 zSize = 0;
+	int numIDAT = 0;
+	bool ended = false;
+
+	while (!ended && end - p >= 12) {
+		uint32 length = getBigEndian(p);
+		if ((int64)length > end - p - 12) return false;
+
+		const uchar *type = p + 4;
+		const uchar *chunk = p + 8;
+		if (memcmp(type, "IDAT", 4) == 0) {
+			if (!headerOnly) {
+				if (numIDAT == 1) joined.assign(z, z + zSize);
+				if (numIDAT >= 1) joined.insert(joined.end(), chunk, chunk + length);
+				else z = chunk;
+			}
+			zSize += length;
+			numIDAT++;
+		} else {
+			uint32 crc = updateCRC32(0xFFFFFFFF, type, 4 + (int64)length) ^ 0xFFFFFFFF;
+			if (crc != getBigEndian(chunk + length)) return false;
+			if (memcmp(type, "IEND", 4) == 0) ended = true;
+		}
+
+		p = chunk + length + 4;
+	}
+	if (!ended || zSize == 0) return false;
+
+	// a header that claims more than the compressed data can hold is refused before anything
+	// the size of the image is allocated, here or by the caller after a headerOnly read
+	int rowBytes = image.getRowBytes();
+	int64 rawSize = (int64)(rowBytes + 1) * image.height;
+	if (rawSize / PNG_MAXINFLATE > zSize) return false;
+	if (headerOnly) return true;
+
+	if (numIDAT > 1) z = &joined[0];
+
+	std::vector<uchar> &raw = image.pixels;
+	raw.resize((size_t)rawSize);
+	int64 rawWritten;
+	if (!zlibInflate(z, zSize, &raw[0], rawSize, rawWritten) || rawWritten != rawSize) {
+		return false;
+	}
+
+	if (!unfilter(&raw[0], image.height, rowBytes, image.channels * image.bitDepth / 8)) return false;
+
+	// drop the filter bytes, in place since each row only moves toward the start
+	for (int y = 0; y < image.height; y++) {
+		memmove(&raw[(size_t)y * rowBytes], &raw[(size_t)y * (rowBytes + 1) + 1], rowBytes);
+	}
+	raw.resize((size_t)rowBytes * image.height);
+	return true;
+}
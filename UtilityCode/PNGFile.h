@@ -0,0 +1,63 @@
+//	----==== PNGFILE.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Minimal PNG reader and writer. The writer stores 8 or 16 bit gray or
+//					RGB images unfiltered in stored deflate blocks, so no compressor is
+//					needed. The reader handles any non interlaced 8 or 16 bit gray, gray
+//					and alpha, RGB or RGBA image, inflates it and undoes the filters.
+//					16 bit samples stay big endian, as they are in the file.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef PNGFILE_H
+#define PNGFILE_H
+
+#include <vector>
+#include "Typedefs.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+// color types
+#define PNG_GRAY			0
+#define PNG_RGB				2
+#define PNG_GRAYALPHA		4
+#define PNG_RGBA			6
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct PNGImage {
+	int					width, height;
+	int					bitDepth;		// 8 or 16
+	int					colorType;
+	int					channels;
+	std::vector<uchar>	pixels;			// rows of width * channels samples, no padding
+
+	int		getRowBytes(void) const		{ return width * channels * bitDepth / 8; }
+};
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+// pixels holds height rows of width * channels samples
+bool	writePNG(const char *filename, int width, int height, int bitDepth, int colorType,
+				 const uchar *pixels);
+
+// Decodes a PNG held in memory, fails on interlaced, palette and low bit depth images.
+// With headerOnly set the chunks are checked but nothing is inflated, images larger than
+// their compressed data could hold are refused either way.
+bool	readPNG(const uchar *data, int64 size, PNGImage &image, bool headerOnly = false);
+
+uint32	updateCRC32(uint32 crc, const uchar *data, int64 length);
+
+#endif
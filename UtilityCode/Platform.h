@@ -0,0 +1,55 @@
+//	----==== PLATFORM.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Identifies the platform and compiler being built for. Each platform has
+//					its own host file with the program entry point: Win32_Main.cpp opens
+//					a window and draws with OpenGL, Linux_Main.cpp runs the scene headless
+//					for batch runs and benchmarks. Code outside the host files should only
+//					test these defines, never _WIN32 or __linux__ directly.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef PLATFORM_H
+#define PLATFORM_H
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#if defined(_WIN32)
+	#define PLATFORM_WIN32
+	#define PLATFORM_NAME		"Win32"
+#elif defined(__linux__)
+	#define PLATFORM_LINUX
+	#define PLATFORM_POSIX
+	#define PLATFORM_NAME		"Linux"
+#elif defined(__unix__) || defined(__APPLE__)
+	#define PLATFORM_POSIX
+	#define PLATFORM_NAME		"POSIX"
+#else
+	#define PLATFORM_NAME		"unknown"		// only standard C++ facilities are used
+#endif
+
+#if defined(_MSC_VER)
+	#define COMPILER_MSVC
+	#define COMPILER_NAME		"MSVC"
+#elif defined(__clang__)
+	#define COMPILER_CLANG
+	#define COMPILER_NAME		"Clang"
+#elif defined(__GNUC__)
+	#define COMPILER_GCC
+	#define COMPILER_NAME		"GCC"
+#else
+	#define COMPILER_NAME		"unknown"
+#endif
+
+// 64 bit pointers
+#if defined(_WIN64) || defined(__x86_64__) || defined(__aarch64__) || defined(__LP64__)
+	#define PLATFORM_64BIT
+#endif
+
+
+#endif
@@ -0,0 +1,261 @@
+//	----==== PROFILER.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Hierarchical scoped profiler with per thread ring buffers
+//	--------------------------------------------------------------------------------
+
+
+#include <stdio.h>
+#include <string.h>
+#include "Profiler.h"
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+// Each thread caches its ring buffer. The generation changes with every new Profiler, so a
+// thread never uses a buffer that belonged to a profiler that was destroyed
+static std::atomic<int>			profilerGeneration(0);
+static thread_local ProfileThread	*currentThread = 0;
+static thread_local int			currentGeneration = 0;
+
+
+// Gives the ring buffer of a thread back to the profiler when the thread exits
+struct ProfileThreadRelease {
+	~ProfileThreadRelease()
+	{
+		if (currentThread && currentGeneration == profilerGeneration && Profiler::exists()) {
+			currentThread->inUse = false;
+		}
+	}
+};
+
+static thread_local ProfileThreadRelease	threadRelease;
+
+
+/*-----------------
+---- FUNCTIONS ----
+-----------------*/
+
+////////// class Profiler //////////
+
+
+ProfileThread * Profiler::getThread(void)
+{
+	if (!exists()) return 0;
+	if (currentThread && currentGeneration == profilerGeneration) return currentThread;
+
+	Profiler &p = instance();
+	std::lock_guard<std::mutex> lock(p.threadLock);
+
+	currentThread = 0;
+	currentGeneration = profilerGeneration;
+	(void)&threadRelease;		// constructs the release object of this thread
+
+	ProfileThread *t = 0;
+	for (int i = 0; i < p.numThreads && !t; ++i) {
+		if (!p.threads[i]->inUse) t = p.threads[i];
+	}
+
+	if (!t) {
+		if (p.numThreads == PROFILER_MAXTHREADS) return 0;
+
+		t = new ProfileThread;
+		t->count.store(0);
+		t->index = p.numThreads;
+		p.frameFirstEvent[p.numThreads] = 0;
+		p.threads[p.numThreads++] = t;
+	}
+
+	t->depth = 0;
+	t->inUse = true;
+	sprintf(t->name, "Thread %d", t->index);
+	currentThread = t;
+
+	return t;
+}
+
+
+void Profiler::setThreadName(const char *name)
+{
+	ProfileThread *t = getThread();
+	if (!t) return;
+
+	strncpy(t->name, name, sizeof(t->name) - 1);
+	t->name[sizeof(t->name) - 1] = 0;
+}
+
+
+void Profiler::beginFrame(void)
+{
+	std::lock_guard<std::mutex> lock(threadLock);
+
+	for (int t = 0; t < numThreads; ++t) {
+		frameFirstEvent[t] = threads[t]->count.load(std::memory_order_acquire);
+	}
+	frameStart = getTicks();
+}
+
+
+//-----------------------------------------------------------------------------
+//	The frame itself is recorded as a "Frame" zone, so its time appears in the
+//	statistics and in the trace along with the zones inside it
+//-----------------------------------------------------------------------------
+void Profiler::endFrame(void)
+{
+	ProfileThread *current = getThread();
+	if (current) current->record("Frame", frameStart, getTicks(), current->depth);
+
+	std::lock_guard<std::mutex> lock(threadLock);
+
+	for (int t = 0; t < numThreads; ++t) {
+		const ProfileThread *thread = threads[t];
+		unsigned int last = thread->count.load(std::memory_order_acquire);
+		unsigned int first = frameFirstEvent[t];
+
+		// the oldest events of a very long frame have been overwritten
+		if (last - first > PROFILER_RINGSIZE) first = last - PROFILER_RINGSIZE;
+
+		for (unsigned int e = first; e != last; ++e) {
+			ProfileEvent event = thread->events[e & (PROFILER_RINGSIZE - 1)];
+
+			// the thread may be recording while this runs, an event it has begun to overwrite
+			// since it was read is dropped
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (thread->count.load(std::memory_order_relaxed) - e >= PROFILER_RINGSIZE) continue;
+
+			ProfileZoneStats *zone = findZone(event.name);
+			if (zone) {
+				zone->frameTicks += event.end - event.start;
+				zone->frameCalls++;
+			}
+		}
+
+		frameFirstEvent[t] = last;
+	}
+
+	for (int z = 0; z < numZones; ++z) {
+		ProfileZoneStats &zone = zones[z];
+		if (zone.frameTicks < zone.minTicks) zone.minTicks = zone.frameTicks;
+		if (zone.frameTicks > zone.maxTicks) zone.maxTicks = zone.frameTicks;
+		zone.totalTicks += zone.frameTicks;
+		zone.totalCalls += zone.frameCalls;
+		zone.frameTicks = 0;
+		zone.frameCalls = 0;
+	}
+
+	if (++frameCount == PROFILER_STATFRAMES) publishStats();
+}
+
+
+//-----------------------------------------------------------------------------
+//	Zone names are usually the same literal, so the pointer is compared first
+//	and the string only if that fails. Returns 0 when the zone table is full.
+//-----------------------------------------------------------------------------
+ProfileZoneStats * Profiler::findZone(const char *name)
+{
+	for (int z = 0; z < numZones; ++z) {
+		if (zones[z].name == name) return &zones[z];
+	}
+	for (int z = 0; z < numZones; ++z) {
+		if (strcmp(zones[z].name, name) == 0) return &zones[z];
+	}
+
+	if (numZones == PROFILER_MAXZONES) return 0;
+
+	ProfileZoneStats &zone = zones[numZones++];
+	memset(&zone, 0, sizeof(ProfileZoneStats));
+	zone.name = name;
+	zone.minTicks = (int64)0x7FFFFFFFFFFFFFFFLL;
+	return &zone;
+}
+
+
+void Profiler::publishStats(void)
+{
+	for (int z = 0; z < numZones; ++z) {
+		ProfileZoneStats &zone = zones[z];
+
+		// a zone first seen during the window has no frames without it in minTicks
+		zone.minMs = ticksToMilliseconds(zone.minTicks);
+		zone.maxMs = ticksToMilliseconds(zone.maxTicks);
+		zone.avgMs = ticksToMilliseconds(zone.totalTicks) / (double)frameCount;
+		zone.callsPerFrame = (float)zone.totalCalls / (float)frameCount;
+
+		zone.minTicks = (int64)0x7FFFFFFFFFFFFFFFLL;
+		zone.maxTicks = 0;
+		zone.totalTicks = 0;
+		zone.totalCalls = 0;
+	}
+
+	frameCount = 0;
+}
+
+
+void Profiler::resetStats(void)
+{
+	numZones = 0;
+	frameCount = 0;
+}
+
+
+//-----------------------------------------------------------------------------
+//	Each zone is written as a complete event ("ph":"X") with its start and
+//	duration in microseconds, and each thread gets a thread_name metadata
+//	event so the viewer shows the names given to setThreadName
+//-----------------------------------------------------------------------------
+bool Profiler::writeChromeTrace(const char *filename)
+{
+	FILE *out = fopen(filename, "w");
+	if (!out) return false;
+
+	std::lock_guard<std::mutex> lock(threadLock);
+
+	fprintf(out, "{\"traceEvents\":[\n");
+	bool first = true;
+
+	for (int t = 0; t < numThreads; ++t) {
+		const ProfileThread *thread = threads[t];
+
+		fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+				first ? "" : ",\n", thread->index, thread->name);
+		first = false;
+
+		unsigned int last = thread->count.load(std::memory_order_acquire);
+		unsigned int firstEvent = (last > PROFILER_RINGSIZE) ? last - PROFILER_RINGSIZE : 0;
+
+		for (unsigned int e = firstEvent; e != last; ++e) {
+			const ProfileEvent &event = thread->events[e & (PROFILER_RINGSIZE - 1)];
+			fprintf(out, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}",
+					event.name, thread->index,
+					ticksToMicroseconds(event.start - startTicks),
+					ticksToMicroseconds(event.end - event.start));
+		}
+	}
+
+	fprintf(out, "\n],\"displayTimeUnit\":\"ms\"}\n");
+
+	return (fclose(out) == 0);
+}
+
+
+Profiler::Profiler() : Singleton<Profiler>(*this),
+	numThreads(0), frameStart(0), frameCount(0), numZones(0)
+{
+	++profilerGeneration;
+
+	getTickFrequency();		// the frequency is measured before any other thread needs it
+	startTicks = getTicks();
+	frameStart = startTicks;
+}
+
+
+Profiler::~Profiler()
+{
+	for (int t = 0; t < numThreads; ++t) {
+		delete threads[t];
+	}
+}
@@ -0,0 +1,202 @@
+//	----==== PROFILER.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Hierarchical scoped profiler. PROFILE_ZONE("name") times the enclosing
+//					scope, zones nest, and each thread records its zones into its own ring
+//					buffer so no lock is taken while profiling. At endFrame the zones of
+//					the frame are added up by name, and every PROFILER_STATFRAMES frames
+//					the min, average and max time per frame of each zone is published.
+//					writeChromeTrace saves the events still held in the ring buffers as a
+//					JSON file for chrome://tracing or Perfetto.
+//
+//					Zone names must be string literals or other strings that live as
+//					long as the profiler, only the pointer is stored. Define NO_PROFILER
+//					to compile the zones out.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <atomic>
+#include <mutex>
+#include "Singleton.h"
+#include "Typedefs.h"
+#include "HiResTimer.h"
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define profiler				Profiler::instance()
+
+#define PROFILER_RINGSIZE		16384		// events kept per thread, a power of 2
+#define PROFILER_MAXTHREADS		16
+#define PROFILER_MAXZONES		64			// distinct zone names with statistics
+#define PROFILER_STATFRAMES		120			// frames per published set of statistics
+
+#define PROFILE_CONCAT2(a,b)	a##b
+#define PROFILE_CONCAT(a,b)		PROFILE_CONCAT2(a,b)
+
+#if defined(NO_PROFILER)
+	#define PROFILE_ZONE(name)
+#else
+	#define PROFILE_ZONE(name)	ProfileZone PROFILE_CONCAT(profileZone, __LINE__)(name)
+#endif
+
+
+/*------------------
+---- STRUCTURES ----
+------------------*/
+
+
+struct ProfileEvent {
+	const char	*name;
+	int64		start, end;		// ticks
+	int			depth;			// nesting level within the thread, 0 for the outermost zone
+};
+
+
+//-----------------------------------------------------------------------------
+//	Ring buffer of one thread. Only the owning thread writes the events, count
+//	is published after each event so other threads can read up to it. When a
+//	thread exits its buffer is kept with its events and given to the next new
+//	thread.
+//-----------------------------------------------------------------------------
+struct ProfileThread {
+	ProfileEvent				events[PROFILER_RINGSIZE];
+	std::atomic<unsigned int>	count;			// events written since the start, wraps around
+	int							depth;			// current zone nesting level
+	int							index;			// used as the thread id in the trace
+	std::atomic<bool>			inUse;			// false once the owning thread has exited
+	char						name[32];
+
+	void	record(const char *name, int64 start, int64 end, int depth);
+};
+
+
+struct ProfileZoneStats {
+	const char	*name;
+	int64		frameTicks;				// accumulated during the current frame
+	int			frameCalls;
+	int64		minTicks, maxTicks, totalTicks;		// accumulated over the current stat window
+	int			totalCalls;
+
+	// published at the end of each stat window
+	double		minMs, avgMs, maxMs;	// time per frame
+	float		callsPerFrame;
+};
+
+
+class Profiler : public Singleton<Profiler> {
+	private:
+
+		///// Variables
+
+		ProfileThread		*threads[PROFILER_MAXTHREADS];
+		int					numThreads;
+		std::mutex			threadLock;			// taken by registration and the frame functions, never by zones
+
+		unsigned int		frameFirstEvent[PROFILER_MAXTHREADS];	// count of each thread at beginFrame
+		int64				frameStart;
+		int					frameCount;			// frames in the current stat window
+		int64				startTicks;			// trace timestamps are relative to this
+
+		ProfileZoneStats	zones[PROFILER_MAXZONES];
+		int					numZones;
+
+		///// Functions
+
+		ProfileZoneStats *	findZone(const char *name);
+		void				publishStats(void);
+
+		// Make copy constructor and assignment operator private
+		Profiler(const Profiler &p);
+		Profiler& operator=(const Profiler &p);
+
+	public:
+
+		///// Functions
+
+		// Ring buffer of the calling thread, created the first time a thread asks for it.
+		// Returns 0 if there is no profiler or PROFILER_MAXTHREADS threads are running
+		static ProfileThread *	getThread(void);
+		void				setThreadName(const char *name);	// for the trace, call from the thread
+
+		// Called by the main thread around each frame, endFrame adds up the zones of all
+		// threads that ended during the frame. Other threads may keep recording meanwhile,
+		// endFrame only reads published events and drops any a thread wraps its ring over
+		// while they are read.
+		void				beginFrame(void);
+		void				endFrame(void);
+
+		// Statistics of the last complete stat window
+		int					getNumZones(void) const { return numZones; }
+		const ProfileZoneStats & getZone(int z) const { return zones[z]; }
+		void				resetStats(void);
+
+		// Writes the events held in the ring buffers, returns false if the file could not
+		// be written. Threads still recording may overwrite the oldest events while the
+		// file is written, so it is best called between frames.
+		bool				writeChromeTrace(const char *filename);
+
+		// Constructors / Destructor
+		explicit Profiler();
+		~Profiler();
+};
+
+
+//-----------------------------------------------------------------------------
+//	Records the time between construction and destruction, use PROFILE_ZONE
+//-----------------------------------------------------------------------------
+class ProfileZone {
+	private:
+
+		ProfileThread	*thread;
+		const char		*name;
+		int64			start;
+
+	public:
+
+		explicit ProfileZone(const char *_name) : thread(Profiler::getThread()), name(_name)
+		{
+			if (thread) {
+				thread->depth++;
+				start = getTicks();
+			}
+		}
+
+		~ProfileZone()
+		{
+			if (thread) {
+				int64 end = getTicks();
+				thread->depth--;
+				thread->record(name, start, end, thread->depth);
+			}
+		}
+};
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+////////// struct ProfileThread //////////
+
+
+__inline void ProfileThread::record(const char *_name, int64 _start, int64 _end, int _depth)
+{
+	unsigned int c = count.load(std::memory_order_relaxed);
+	ProfileEvent &e = events[c & (PROFILER_RINGSIZE - 1)];
+	e.name = _name;
+	e.start = _start;
+	e.end = _end;
+	e.depth = _depth;
+	count.store(c + 1, std::memory_order_release);
+}
+
+
+#endif
@@ -0,0 +1,177 @@
+//	----==== SIMD.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Compile time detection of the SIMD instruction sets available to
+//					the math code, and helpers for aligned storage. USE_SSE is defined
+//					when the compiler targets SSE (always true for x64), USE_AVX when it
+//					targets AVX. Define NO_SIMD in the project settings to force the
+//					scalar code paths, for instance to compare against them in the
+//					benchmarks or to run on processors without SSE.
+//
+//					The vfloat type holds SIMD_LANES floats and the v* functions work
+//					on all lanes at once, so a bulk kernel can be written once and
+//					compile to AVX, SSE or plain scalar code.
+//----------------------------------------------------------------------------------------
+
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstdlib>
+#include <cmath>
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#if !defined(NO_SIMD) && (defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1))
+	#define USE_SSE
+	#include <xmmintrin.h>
+	#include <emmintrin.h>
+#endif
+
+#if defined(USE_SSE) && defined(__AVX__)
+	#define USE_AVX
+	#include <immintrin.h>
+#endif
+
+#if defined(USE_AVX)
+	#define SIMD_NAME		"AVX"
+	#define SIMD_LANES		8
+#elif defined(USE_SSE)
+	#define SIMD_NAME		"SSE"
+	#define SIMD_LANES		4
+#else
+	#define SIMD_NAME		"scalar"
+	#define SIMD_LANES		1
+#endif
+
+// alignment is placed before the type or member being declared, ie. class ALIGN16 Foo
+#if defined(_MSC_VER)
+	#define ALIGN16		__declspec(align(16))
+	#define ALIGN32		__declspec(align(32))
+#else
+	#define ALIGN16		__attribute__((aligned(16)))
+	#define ALIGN32		__attribute__((aligned(32)))
+#endif
+
+
+/*----------------
+---- TYPEDEFS ----
+----------------*/
+
+// vmask holds the result of a comparison for each lane, it is only used with vselect
+#if defined(USE_AVX)
+	typedef __m256		vfloat;
+	typedef __m256		vmask;
+#elif defined(USE_SSE)
+	typedef __m128		vfloat;
+	typedef __m128		vmask;
+#else
+	typedef float		vfloat;
+	typedef bool		vmask;
+#endif
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+#if defined(USE_AVX)
+
+__inline vfloat	vload(const float *p) { return _mm256_load_ps(p); }		// p must be aligned
+__inline vfloat	vloadu(const float *p) { return _mm256_loadu_ps(p); }
+__inline void	vstore(float *p, vfloat a) { _mm256_store_ps(p, a); }	// p must be aligned
+__inline void	vstoreu(float *p, vfloat a) { _mm256_storeu_ps(p, a); }
+__inline vfloat	vset1(float s) { return _mm256_set1_ps(s); }
+__inline vfloat	vadd(vfloat a, vfloat b) { return _mm256_add_ps(a, b); }
+__inline vfloat	vsub(vfloat a, vfloat b) { return _mm256_sub_ps(a, b); }
+__inline vfloat	vmul(vfloat a, vfloat b) { return _mm256_mul_ps(a, b); }
+__inline vfloat	vdiv(vfloat a, vfloat b) { return _mm256_div_ps(a, b); }
+__inline vfloat	vsqrt(vfloat a) { return _mm256_sqrt_ps(a); }
+__inline vfloat	vmin(vfloat a, vfloat b) { return _mm256_min_ps(a, b); }
+__inline vfloat	vmax(vfloat a, vfloat b) { return _mm256_max_ps(a, b); }
+// returns b in the lanes where a > 0, and 0 in the others
+__inline vfloat	vselectPositive(vfloat a, vfloat b) { return _mm256_and_ps(_mm256_cmp_ps(a, _mm256_setzero_ps(), _CMP_GT_OQ), b); }
+__inline vfloat	vabs(vfloat a) { return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), a); }
+__inline vfloat	vround(vfloat a) { return _mm256_round_ps(a, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC); }
+__inline vfloat	vloadi(const int *p) { return _mm256_cvtepi32_ps(_mm256_loadu_si256((const __m256i *)p)); }	// converts to float
+__inline vmask	vcmplt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+__inline vmask	vcmpgt(vfloat a, vfloat b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+__inline vfloat	vselect(vmask m, vfloat a, vfloat b) { return _mm256_blendv_ps(b, a, m); }	// a where m is true, else b
+
+#elif defined(USE_SSE)
+
+__inline vfloat	vload(const float *p) { return _mm_load_ps(p); }			// p must be aligned
+__inline vfloat	vloadu(const float *p) { return _mm_loadu_ps(p); }
+__inline void	vstore(float *p, vfloat a) { _mm_store_ps(p, a); }		// p must be aligned
+__inline void	vstoreu(float *p, vfloat a) { _mm_storeu_ps(p, a); }
+__inline vfloat	vset1(float s) { return _mm_set1_ps(s); }
+__inline vfloat	vadd(vfloat a, vfloat b) { return _mm_add_ps(a, b); }
+__inline vfloat	vsub(vfloat a, vfloat b) { return _mm_sub_ps(a, b); }
+__inline vfloat	vmul(vfloat a, vfloat b) { return _mm_mul_ps(a, b); }
+__inline vfloat	vdiv(vfloat a, vfloat b) { return _mm_div_ps(a, b); }
+__inline vfloat	vsqrt(vfloat a) { return _mm_sqrt_ps(a); }
+__inline vfloat	vmin(vfloat a, vfloat b) { return _mm_min_ps(a, b); }
+__inline vfloat	vmax(vfloat a, vfloat b) { return _mm_max_ps(a, b); }
+__inline vfloat	vselectPositive(vfloat a, vfloat b) { return _mm_and_ps(_mm_cmpgt_ps(a, _mm_setzero_ps()), b); }
+__inline vfloat	vabs(vfloat a) { return _mm_andnot_ps(_mm_set1_ps(-0.0f), a); }
+__inline vfloat	vround(vfloat a) { return _mm_cvtepi32_ps(_mm_cvtps_epi32(a)); }		// |a| must be below 2^31
+__inline vfloat	vloadi(const int *p) { return _mm_cvtepi32_ps(_mm_loadu_si128((const __m128i *)p)); }
+__inline vmask	vcmplt(vfloat a, vfloat b) { return _mm_cmplt_ps(a, b); }
+__inline vmask	vcmpgt(vfloat a, vfloat b) { return _mm_cmpgt_ps(a, b); }
+__inline vfloat	vselect(vmask m, vfloat a, vfloat b) { return _mm_or_ps(_mm_and_ps(m, a), _mm_andnot_ps(m, b)); }
+
+#else
+
+__inline vfloat	vload(const float *p) { return *p; }
+__inline vfloat	vloadu(const float *p) { return *p; }
+__inline void	vstore(float *p, vfloat a) { *p = a; }
+__inline void	vstoreu(float *p, vfloat a) { *p = a; }
+__inline vfloat	vset1(float s) { return s; }
+__inline vfloat	vadd(vfloat a, vfloat b) { return a + b; }
+__inline vfloat	vsub(vfloat a, vfloat b) { return a - b; }
+__inline vfloat	vmul(vfloat a, vfloat b) { return a * b; }
+__inline vfloat	vdiv(vfloat a, vfloat b) { return a / b; }
+__inline vfloat	vsqrt(vfloat a) { return sqrtf(a); }
+__inline vfloat	vmin(vfloat a, vfloat b) { return (a < b) ? a : b; }
+__inline vfloat	vmax(vfloat a, vfloat b) { return (a > b) ? a : b; }
+__inline vfloat	vselectPositive(vfloat a, vfloat b) { return (a > 0) ? b : 0; }
+__inline vfloat	vabs(vfloat a) { return fabsf(a); }
+__inline vfloat	vround(vfloat a) { return floorf(a + 0.5f); }
+__inline vfloat	vloadi(const int *p) { return (float)*p; }
+__inline vmask	vcmplt(vfloat a, vfloat b) { return a < b; }
+__inline vmask	vcmpgt(vfloat a, vfloat b) { return a > b; }
+__inline vfloat	vselect(vmask m, vfloat a, vfloat b) { return m ? a : b; }
+
+#endif
+
+
+
+//----------------------------------------------------------------------------------------
+//	Allocates memory aligned for the widest SIMD register in use. Memory must be released
+//	with alignedFree, never with delete or free.
+//----------------------------------------------------------------------------------------
+__inline void * alignedMalloc(size_t size)
+{
+	#if defined(USE_SSE)
+		return _mm_malloc(size, 32);
+	#else
+		return malloc(size);
+	#endif
+}
+
+
+__inline void alignedFree(void *p)
+{
+	#if defined(USE_SSE)
+		_mm_free(p);
+	#else
+		free(p);
+	#endif
+}
+
+#endif
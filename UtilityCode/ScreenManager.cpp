@@ -11,7 +11,7 @@
 
 #include <windows.h>
 #include <GL\glew.h>
-#include "screenmanager.h"
+#include "ScreenManager.h"
 
 
 /*-----------------
@@ -11,7 +11,7 @@
 #ifndef SCREENMANAGER_H
 #define SCREENMANAGER_H
 
-#include "singleton.h"
+#include "Singleton.h"
 
 
 /*---------------
@@ -23,9 +23,11 @@
 
 // Disable the warning regarding 'this' pointers being used in 
 // base member initializer list. Singletons rely on this action
-#pragma warning(disable : 4355)
+#if defined(_MSC_VER)
+	#pragma warning(disable : 4355)
+#endif
 
-#include "msgassert.h"
+#include "MsgAssert.h"
 
 /*------------------
 ---- STRUCTURES ----
@@ -55,6 +57,9 @@ class Singleton {
 			return (*inst);
 		}
 
+		// for code that may run before the instance is constructed or after it is destroyed
+		static bool	exists() { return inst != 0; }
+
 		///// Constructors / Destructor
 
 		//--------------------------------------------------------------------------------
@@ -12,7 +12,7 @@
 #define WIN32_LEAN_AND_MEAN
 
 #include <windows.h>
-#include "system.h"
+#include "System.h"
 
 
 /*------------------
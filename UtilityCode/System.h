@@ -12,8 +12,8 @@
 #ifndef SYSTEM_H
 #define SYSTEM_H
 
-#include "typedefs.h"
-#include "singleton.h"
+#include "Typedefs.h"
+#include "Singleton.h"
 
 /*---------------
 ---- DEFINES ----
@@ -4,13 +4,15 @@
 //					y2kiah@hotmail.com
 //	Version:		1
 //	Date:			1/04
-//	Description:	Sets up and gives functionality to the high speed Windows timer
+//	Description:	Frame timer and frames per second counter, built on the portable
+//					clock in hirestimer.h
 //	--------------------------------------------------------------------------------
 
-#define WIN32_LEAN_AND_MEAN
-
-#include <windows.h>
-#include "timer.h"
+#include <stdio.h>
+#include <math.h>
+#include <algorithm>
+#include "Timer.h"
+#include "HiResTimer.h"
 
 /*-----------------
 ---- FUNCTIONS ----
@@ -24,7 +26,7 @@
 //	calcTimeFix()
 //-----------------------------------------------------------------------
 float Timer::getTimePassed(void) {
-	QueryPerformanceCounter((LARGE_INTEGER *)&currentTime);
+	currentTime = getTicks();
 	const float offset = (float)(currentTime - lastTime) * timerFrequencyFix;
 	lastTime = currentTime;
 	
@@ -32,16 +34,113 @@ float Timer::getTimePassed(void) {
 }
 
 
+void Timer::calcTimeFix(void)
+{
+	timeFix = getTimePassed();
+	recordFrame(timeFix * 1000.0f);
+}
+
+
+//-----------------------------------------------------------------------
+//	Stores the frame time in the history. The median used for the
+//	relative hitch test is the one from the last stats update, so it is
+//	not affected by the frame being tested.
+//-----------------------------------------------------------------------
+void Timer::recordFrame(float ms)
+{
+	bool hitch = (hitchMs > 0 && ms > hitchMs) ||
+				 (hitchFactor > 0 && stats.samples >= TIMER_FPSFRAMES && ms > hitchFactor * stats.p50);
+
+	frameTimes[frameCount % TIMER_HISTORYSIZE] = hitch ? -ms : ms;
+	frameCount++;
+	if (hitch) hitchCount++;
+
+	if (frameCount % TIMER_FPSFRAMES == 0) calcFrameStats(stats);
+}
+
+
+bool Timer::lastFrameWasHitch(void) const
+{
+	return (frameCount > 0 && frameTimes[(frameCount - 1) % TIMER_HISTORYSIZE] < 0);
+}
+
+
+//-----------------------------------------------------------------------
+//	Percentiles use the nearest rank of the sorted history, so p99 of
+//	1024 frames is the 11th slowest frame
+//-----------------------------------------------------------------------
+void Timer::calcFrameStats(FrameStats &out) const
+{
+	float sorted[TIMER_HISTORYSIZE];
+	int n = (frameCount < TIMER_HISTORYSIZE) ? frameCount : TIMER_HISTORYSIZE;
+
+	out.samples = n;
+	out.hitches = 0;
+	if (n == 0) {
+		out.p50 = out.p95 = out.p99 = out.minMs = out.maxMs = out.avgMs = 0;
+		return;
+	}
+
+	double total = 0;
+	for (int f = 0; f < n; ++f) {
+		if (frameTimes[f] < 0) out.hitches++;
+		sorted[f] = fabsf(frameTimes[f]);
+		total += sorted[f];
+	}
+	std::sort(sorted, sorted + n);
+
+	out.p50 = sorted[(int)ceilf(0.50f * n) - 1];
+	out.p95 = sorted[(int)ceilf(0.95f * n) - 1];
+	out.p99 = sorted[(int)ceilf(0.99f * n) - 1];
+	out.minMs = sorted[0];
+	out.maxMs = sorted[n-1];
+	out.avgMs = (float)(total / n);
+}
+
+
+int Timer::calcHistogram(int *bins, int numBins, float binMs) const
+{
+	int n = (frameCount < TIMER_HISTORYSIZE) ? frameCount : TIMER_HISTORYSIZE;
+
+	for (int b = 0; b < numBins; ++b) bins[b] = 0;
+
+	for (int f = 0; f < n; ++f) {
+		int b = (int)(fabsf(frameTimes[f]) / binMs);
+		if (b >= numBins) b = numBins - 1;
+		bins[b]++;
+	}
+
+	return n;
+}
+
+
+bool Timer::writeFrameTimesCSV(const char *filename) const
+{
+	FILE *out = fopen(filename, "w");
+	if (!out) return false;
+
+	int n = (frameCount < TIMER_HISTORYSIZE) ? frameCount : TIMER_HISTORYSIZE;
+
+	fprintf(out, "frame,ms,hitch\n");
+	for (int f = frameCount - n; f < frameCount; ++f) {
+		float t = frameTimes[f % TIMER_HISTORYSIZE];
+		fprintf(out, "%d,%.3f,%d\n", f, fabsf(t), (t < 0) ? 1 : 0);
+	}
+
+	return (fclose(out) == 0);
+}
+
+
 //-----------------------------------------------------------------------
-//	Calculates the frames per second, updates every 75 frames
+//	Calculates the frames per second, updates every TIMER_FPSFRAMES frames
 //-----------------------------------------------------------------------
 void Timer::calcFPS(void)
 {
 	numFrames++;
 
-	if (numFrames == 75) {
-		QueryPerformanceCounter((LARGE_INTEGER *)&fpsCurrentTime);
-		fps = 75.0f / ((float)(fpsCurrentTime - fpsLastTime) * timerFrequencyFix);
+	if (numFrames == TIMER_FPSFRAMES) {
+		fpsCurrentTime = getTicks();
+		fps = (float)TIMER_FPSFRAMES / ((float)(fpsCurrentTime - fpsLastTime) * timerFrequencyFix);
 		fpsLastTime = fpsCurrentTime;
 		numFrames = 0;
 	}
@@ -49,14 +148,17 @@ void Timer::calcFPS(void)
 
 
 //-----------------------------------------------------------------------
-//	Sets up the high speed Windows timer. If this feature is not
-//	available on a system this function may cause the program to crash.
+//	Sets up the timer, the tick source is chosen in hirestimer.cpp
 //-----------------------------------------------------------------------
 void Timer::initTimer(void)
 {
-	QueryPerformanceFrequency((LARGE_INTEGER *)&timerFrequency);
+	timerFrequency = getTickFrequency();
 	timerFrequencyFix = 1.0f / (float)timerFrequency;
 
-	QueryPerformanceCounter((LARGE_INTEGER *)&fpsLastTime);
+	fpsLastTime = lastTime = getTicks();
 	timeFix = getTimePassed();
+
+	// the frames before initTimer were not timed
+	frameCount = hitchCount = 0;
+	calcFrameStats(stats);
 }
\ No newline at end of file
@@ -4,13 +4,19 @@
 //					y2kiah@hotmail.com
 //	Version:		1
 //	Date:			1/04
-//	Description:	Sets up and gives functionality to the high speed Windows timer
+//	Description:	Frame timer and frames per second counter, built on the portable
+//					clock in hirestimer.h. The time of every frame is also kept in a
+//					ring buffer of the last TIMER_HISTORYSIZE frames, from which the
+//					frame time percentiles and a histogram are calculated, so that a
+//					few slow frames are not hidden in the average frame rate. Frames
+//					slower than the hitch thresholds are counted and flagged.
 //	--------------------------------------------------------------------------------
 
 #ifndef TIMER_H
 #define TIMER_H
 
-#include "singleton.h"
+#include "Singleton.h"
+#include "Typedefs.h"
 
 
 /*---------------
@@ -19,22 +25,43 @@
 
 #define timer	Timer::instance()
 
+#define TIMER_HISTORYSIZE		1024		// frame times kept for the statistics
+#define TIMER_FPSFRAMES			75			// frames averaged by calcFPS, also how often the stats update
+
 
 /*------------------
 ---- STRUCTURES ----
 ------------------*/
 
 
+// Frame time statistics over the frames in the history, times in milliseconds
+struct FrameStats {
+	float		p50, p95, p99;		// percentiles, p50 is the median
+	float		minMs, maxMs, avgMs;
+	int			samples;			// frames in the history, up to TIMER_HISTORYSIZE
+	int			hitches;			// hitches among those frames
+};
+
+
 //------------------------------------------------------------------------------
 //------------------------------------------------------------------------------
 class Timer : public Singleton<Timer> {
 	private:
 		
-		_int64		timerFrequency, currentTime, lastTime, fpsCurrentTime, fpsLastTime;
+		int64		timerFrequency, currentTime, lastTime, fpsCurrentTime, fpsLastTime;
 		float		timeFix, timerFrequencyFix, fps;
 		int			numFrames;
 
+		// frame history, a negative time marks a hitch
+		float		frameTimes[TIMER_HISTORYSIZE];
+		int			frameCount;			// frames recorded since initTimer
+		int			hitchCount;			// hitches since initTimer
+		float		hitchMs;			// absolute hitch threshold, 0 to disable
+		float		hitchFactor;		// hitch threshold relative to the median, 0 to disable
+		FrameStats	stats;				// updated every TIMER_FPSFRAMES frames
+
 		float		getTimePassed(void);
+		void		recordFrame(float ms);
 
 	public:
 
@@ -51,15 +78,41 @@ class Timer : public Singleton<Timer> {
 
 		//-----------------------------------------------------------------------------------
 		//	Multiplier for time based calculations. This should be called once per frame
-		//	within the loop. Use getTimeFix to retrieve the result.
+		//	within the loop. Use getTimeFix to retrieve the result. Also records the frame
+		//	time in the history.
 		//-----------------------------------------------------------------------------------
-		void		calcTimeFix(void) { timeFix = getTimePassed(); } // call once per frame
+		void		calcTimeFix(void); // call once per frame
+
+		//-----------------------------------------------------------------------------------
+		//	A frame is a hitch if it takes longer than ms, or longer than factor times the
+		//	median frame time. Either test is disabled by passing 0, the defaults are 50ms
+		//	and 2.5 times the median.
+		//-----------------------------------------------------------------------------------
+		void		setHitchThresholds(float ms, float factor) { hitchMs = ms; hitchFactor = factor; }
+		bool		lastFrameWasHitch(void) const;
+		int			getHitchCount(void) const { return hitchCount; }
+
+		// Statistics as of the last update, calcFrameStats recalculates them now
+		const FrameStats & getFrameStats(void) const { return stats; }
+		void		calcFrameStats(FrameStats &out) const;
+
+		// Counts the frames in the history in bins of binMs, the last bin also counts all
+		// slower frames. Returns the number of frames counted
+		int			calcHistogram(int *bins, int numBins, float binMs) const;
+
+		// Writes the history oldest first, one frame per line: frame number, milliseconds,
+		// and 1 for a hitch. Returns false if the file could not be written
+		bool		writeFrameTimesCSV(const char *filename) const;
 		
 		explicit Timer() : Singleton<Timer>(*this)
 		{
 			timerFrequency = currentTime = lastTime = fpsCurrentTime = fpsLastTime = 0;
 			timeFix = timerFrequencyFix = fps = 0;
 			numFrames = 0;
+			frameCount = hitchCount = 0;
+			hitchMs = 50.0f;
+			hitchFactor = 2.5f;
+			calcFrameStats(stats);
 		}
 };
 
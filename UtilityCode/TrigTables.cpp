@@ -0,0 +1,19 @@
+//	----==== TRIGTABLES.CPP ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Definitions of the compile time sine tables. They are defined in
+//					this one file so the executable holds a single copy of each.
+//	--------------------------------------------------------------------------------
+
+
+#include "TrigTables.h"
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+extern constexpr QuarterSineTable<QUARTER_LINEAR_STEPS>	quarterLinearTable{};
+extern constexpr QuarterSineTable<QUARTER_CUBIC_STEPS>	quarterCubicTable{};
@@ -0,0 +1,150 @@
+//	----==== TRIGTABLES.H ====----
+//
+//	Author:			Jeffrey Kiah
+//					y2kiah@hotmail.com
+//	Version:		1
+//	Date:			10/26
+//	Description:	Quarter wave sine tables generated by the compiler. The entries are
+//					computed with constexpr functions (needs C++14) and placed in the
+//					read only data of the executable, so there is no trig work and no
+//					allocation at startup. The trigSin, trigCos and trigSinCos functions
+//					read the tables directly with the angle units of TRIG_PRECISION, so
+//					they can be called from anywhere without the LookupManager, even
+//					before it is constructed.
+//	--------------------------------------------------------------------------------
+
+
+#ifndef TRIGTABLES_H
+#define TRIGTABLES_H
+
+/*---------------
+---- DEFINES ----
+---------------*/
+
+#define QUARTER_LINEAR_STEPS	2048		// table steps per 90 degrees for TRIG_QUARTERLINEAR
+#define QUARTER_CUBIC_STEPS		64			// table steps per 90 degrees for TRIG_QUARTERCUBIC
+
+// angle units of trigSin, trigCos and trigSinCos, the same as LookupManager(TRIG_PRECISION)
+#define TRIG_PRECISION			80
+#define TRIG_ANGLE90			(TRIG_PRECISION*90)
+#define TRIG_ANGLE180			(TRIG_PRECISION*180)
+#define TRIG_ANGLE360			(TRIG_PRECISION*360)
+
+
+/*-----------------------------
+---- CONSTEXPR GENERATION ----
+-----------------------------*/
+
+//----------------------------------------------------------------------------------------
+//	Taylor series of sin in double precision. Up to x^23 the error is below 1e-16 for
+//	x in [0, PI/2], so the tables are correctly rounded floats like those computed
+//	with sin() at runtime.
+//----------------------------------------------------------------------------------------
+constexpr double constSin(double x)
+{
+	double x2 = x * x;
+	double term = x;
+	double sum = x;
+
+	for (int n = 1; n < 12; ++n) {
+		term *= -x2 / (double)((2*n) * (2*n + 1));
+		sum += term;
+	}
+	return sum;
+}
+
+
+// sin from 0 to 90 degrees in STEPS steps, v holds STEPS+1 values
+template <int STEPS>
+struct QuarterSineTable {
+	float v[STEPS + 1];
+
+	constexpr QuarterSineTable() : v()
+	{
+		for (int s = 0; s <= STEPS; ++s) {
+			v[s] = (float)constSin((double)s * (3.14159265358979323846 * 0.5 / (double)STEPS));
+		}
+	}
+};
+
+
+/*-----------------
+---- VARIABLES ----
+-----------------*/
+
+extern const QuarterSineTable<QUARTER_LINEAR_STEPS>	quarterLinearTable;		// 8 KB
+extern const QuarterSineTable<QUARTER_CUBIC_STEPS>	quarterCubicTable;		// 260 bytes
+
+
+/*------------------------
+---- INLINE FUNCTIONS ----
+------------------------*/
+
+
+//----------------------------------------------------------------------------------------
+//	Interpolate a quarter wave table at t steps, t between 0 and steps inclusive
+//----------------------------------------------------------------------------------------
+__inline float quarterSinLinear(const float *table, int steps, float t)
+{
+	int step = (int)t;
+	if (step > steps - 1) step = steps - 1;	// t == steps uses the end of the last step
+	float f = t - (float)step;
+
+	return table[step] + (table[step+1] - table[step]) * f;
+}
+
+
+// cubic Hermite, the slope of sin is cos which is the mirrored table entry. The slopes are
+// scaled by the step size in radians so they are in units of f
+__inline float quarterSinCubic(const float *table, int steps, float t)
+{
+	int step = (int)t;
+	if (step > steps - 1) step = steps - 1;
+	float f = t - (float)step;
+
+	float h = (3.14159265358979f * 0.5f) / (float)steps;
+	float p0 = table[step];
+	float p1 = table[step+1];
+	float m0 = table[steps - step] * h;
+	float m1 = table[steps - step - 1] * h;
+
+	float f2 = f * f;
+	float f3 = f2 * f;
+	return	p0 * (2.0f*f3 - 3.0f*f2 + 1.0f) + m0 * (f3 - 2.0f*f2 + f) +
+			p1 * (3.0f*f2 - 2.0f*f3) + m1 * (f3 - f2);
+}
+
+
+//----------------------------------------------------------------------------------------
+//	Sine of an angle in TRIG_PRECISION units from 0 to TRIG_ANGLE360, from the linear
+//	quarter wave table. The quadrant folding uses compile time constants.
+//----------------------------------------------------------------------------------------
+__inline float trigSin(int lookup)
+{
+	int r = lookup;
+	bool negative = false;
+	if (r >= TRIG_ANGLE180) { r -= TRIG_ANGLE180; negative = true; }
+	if (r >= TRIG_ANGLE90) r = TRIG_ANGLE180 - r;
+
+	float s = quarterSinLinear(quarterLinearTable.v, QUARTER_LINEAR_STEPS,
+							   (float)r * ((float)QUARTER_LINEAR_STEPS / (float)TRIG_ANGLE90));
+	return negative ? -s : s;
+}
+
+
+__inline float trigCos(int lookup)
+{
+	lookup += TRIG_ANGLE90;
+	if (lookup >= TRIG_ANGLE360) lookup -= TRIG_ANGLE360;
+	return trigSin(lookup);
+}
+
+
+__inline void trigSinCos(int lookup, float &sinOut, float &cosOut)
+{
+	sinOut = trigSin(lookup);
+	cosOut = trigCos(lookup);
+}
+
+
+#endif
@@ -13,7 +13,7 @@
 #ifndef TYPEDEFS_H
 #define TYPEDEFS_H
 
-#include "bitfield.h"
+#include "BitField.h"
 
 /*----------------
 ---- TYPEDEFS ----
@@ -24,10 +24,16 @@ typedef unsigned short		ushort;
 typedef unsigned int		uint;
 typedef unsigned long		ulong;
 
-typedef unsigned long		uint32;
-
-typedef __int64				int64;
-typedef unsigned __int64	uint64;
+// long is 64 bits on 64 bit Linux, so only the MSVC types keep their original definitions
+#if defined(_MSC_VER)
+	typedef unsigned long		uint32;
+	typedef __int64				int64;
+	typedef unsigned __int64	uint64;
+#else
+	typedef unsigned int		uint32;
+	typedef long long			int64;
+	typedef unsigned long long	uint64;
+#endif
 
 typedef	BitField<uchar>		u8Flags;
 typedef	BitField<ushort>	u16Flags;
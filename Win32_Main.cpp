@@ -12,17 +12,23 @@
 #include <windows.h>
 #include <gl/gl.h>
 #include <gl/glu.h>
-#include "win32_main.h"
-#include "utilitycode/keyboardmanager.h"
-#include "utilitycode/screenmanager.h"
-#include "utilitycode/mousemanager.h"
-#include "utilitycode/lookupmanager.h"
-#include "utilitycode/timer.h"
-
-#include "surfacetest.h"
+#include <string.h>
+#include <stdlib.h>
+#include "Win32_Main.h"
+#include "UtilityCode/KeyboardManager.h"
+#include "UtilityCode/ScreenManager.h"
+#include "UtilityCode/MouseManager.h"
+#include "UtilityCode/LookupManager.h"
+#include "UtilityCode/Timer.h"
+#include "UtilityCode/Profiler.h"
+#include "UtilityCode/LoopScheduler.h"
+
+#include "SurfaceTest.h"
+#include "SurfaceScene.h"
+#include "Benchmark.h"
 
 // temp until font manager
-#include "utilitycode/glfont.h"
+#include "UtilityCode/GLFont.h"
 
 
 /*-----------------
@@ -356,10 +362,14 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE hPrevInst, LPSTR lpszCmdLine, int
 {
 	// Allocate the singleton classes in the correct order
 	Timer				timerInst;
+	Profiler			profilerInst;
 	ScreenManager		screenInst(800,600,60,32,16,true,false);
 	MouseManager		mouseInst(screen.getResX(),screen.getResY());
 	KeyboardManager		kbInst;
-	LookupManager		lookupInst(80);		// precision of 1/80th of a degree is good for 3D games
+	LookupManager		lookupInst(80, TRIG_FULLTABLES, "trig.tbl");	// 1/80th of a degree, tables cached in trig.tbl
+
+	// Run the benchmarks without opening a window
+	if (strstr(lpszCmdLine, "-bench")) return runBenchmarks("benchmark.txt") ? 0 : -1;
 
 	// Open a new window for OpenGL drawing
 	if (!initWindow()) return -1;
@@ -383,6 +393,13 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE hPrevInst, LPSTR lpszCmdLine, int
 	font = new GLFont(screen.getResY());
 	font->loadTrueTypeFont("Courier New",14,0,0,0,0);
 
+	// The scene is simulated in fixed 60Hz steps. -threaded runs the steps on a second thread,
+	// -fpscap N limits the frame rate to N frames per second
+	LoopScheduler loop(updateScene, syncScene, renderScene, 1.0 / 60.0);
+	if (strstr(lpszCmdLine, "-threaded")) loop.setThreaded(true);
+	const char *fpsCap = strstr(lpszCmdLine, "-fpscap ");
+	if (fpsCap) loop.setFrameCap((float)atof(fpsCap + 8));
+
 	// Start the message loop
 	while (1) {
 		if (handleMsg()) break;		// Handle windows messages, quit on true return
@@ -392,6 +409,8 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE hPrevInst, LPSTR lpszCmdLine, int
 		// If the window is not active it will still continue to handle messages
 		// but will not execute any application functions
 		if (active) {
+			profiler.beginFrame();
+
 			// press ESC to close the app
 			if (kb.keyDown(VK_ESCAPE)) SendMessage(hWnd,WM_CLOSE,0,0);
 
@@ -399,10 +418,16 @@ int WINAPI WinMain(HINSTANCE hinst, HINSTANCE hPrevInst, LPSTR lpszCmdLine, int
 			if (kb.buttonPressed(VK_RETURN)) initSurfacePoints();
 
 			// This is where you make a call to execute your game functions
-			renderScene();
+			loop.frame();
 
 			// Get frames per second
 			timer.calcFPS();			
+
+			profiler.endFrame();
+
+		} else {
+			// time spent inactive is not simulated
+			loop.resetTime();
 		}
 	}
 